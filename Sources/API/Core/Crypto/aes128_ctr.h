@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Crypto clanCore Crypto
+	/// \{
+
+	class DataBuffer;
+	class AES_CTR_Impl;
+
+	/// \brief AES-128 encryption and decryption class (running in Counter mode)
+	///
+	/// Counter mode turns AES into a stream cipher, so encrypting and decrypting is the same operation
+	/// and the data does not need padding. The counter block starts at the initialisation vector and is
+	/// incremented as a 128 bit big endian number for every block.
+	///
+	/// Never encrypt two messages with the same key and initialisation vector.
+	class AES128_CTR
+	{
+	public:
+		/// \brief Constructs a AES-128 generator (running in Counter mode)
+		AES128_CTR();
+
+		/// \brief Get encrypted or decrypted data
+		///
+		/// This is the databuffer used internally to store the output.
+		/// You may call "set_size()" to clear the buffer, inbetween calls to "add()"
+		/// You may call "set_capacity()" to optimise storage requirements before the add() call
+		DataBuffer get_data() const;
+
+		static const int iv_size = 16;
+		static const int key_size = 16;
+
+		/// \brief Resets the encryption
+		void reset();
+
+		/// \brief Sets the initialisation vector (the initial counter block)
+		///
+		/// This must be called before the initial add()
+		void set_iv(const unsigned char iv[iv_size]);
+
+		/// \brief Sets the cipher key
+		///
+		/// This must be called before the initial add()
+		void set_key(const unsigned char key[key_size]);
+
+		/// \brief Adds data to be encrypted or decrypted
+		void add(const void *data, int size);
+
+		/// \brief Add data to be encrypted or decrypted
+		///
+		/// \param data = Data Buffer
+		void add(const DataBuffer &data);
+
+		/// \brief Finalize encryption or decryption
+		void calculate();
+
+	private:
+		std::shared_ptr<AES_CTR_Impl> impl;
+	};
+
+	/// \}
+}
@@ -0,0 +1,109 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Crypto clanCore Crypto
+	/// \{
+
+	class DataBuffer;
+	class AES_GCM_Impl;
+
+	/// \brief AES-192 authenticated encryption and decryption class (running in Galois/Counter Mode)
+	///
+	/// The data is encrypted in Counter mode and authenticated, together with any additional
+	/// authenticated data, by a 128 bit tag. Call set_iv() for every message, then add_aad(), then
+	/// encrypt() or decrypt(), then calculate(). The cipher key is kept between messages.
+	///
+	/// When decrypting, do not use the data before verify_tag() has returned true.
+	/// Never encrypt two messages with the same key and initialisation vector.
+	class AES192_GCM
+	{
+	public:
+		/// \brief Constructs a AES-192 generator (running in Galois/Counter Mode)
+		AES192_GCM();
+
+		/// \brief Get encrypted or decrypted data
+		///
+		/// This is the databuffer used internally to store the output.
+		/// You may call "set_size()" to clear the buffer, inbetween calls to "encrypt()" or "decrypt()"
+		DataBuffer get_data() const;
+
+		static const int iv_size = 12;
+		static const int key_size = 24;
+		static const int tag_size = 16;
+
+		/// \brief Resets the message. The cipher key is kept.
+		void reset();
+
+		/// \brief Sets the initialisation vector and starts a new message
+		///
+		/// 12 bytes is the recommended size, other sizes are hashed into the initial counter block.
+		void set_iv(const unsigned char *iv, int size = iv_size);
+
+		/// \brief Sets the cipher key
+		///
+		/// This must be called before the first message
+		void set_key(const unsigned char key[key_size]);
+
+		/// \brief Adds data that is authenticated but not encrypted
+		///
+		/// This must be called before encrypt() or decrypt()
+		void add_aad(const void *data, int size);
+		void add_aad(const DataBuffer &data);
+
+		/// \brief Adds data to be encrypted
+		void encrypt(const void *data, int size);
+		void encrypt(const DataBuffer &data);
+
+		/// \brief Adds data to be decrypted
+		void decrypt(const void *data, int size);
+		void decrypt(const DataBuffer &data);
+
+		/// \brief Finalize the message and calculate the authentication tag
+		void calculate();
+
+		/// \brief Get the authentication tag of the calculated message
+		void get_tag(unsigned char out_tag[tag_size]) const;
+
+		/// \brief Compares the calculated tag with a received tag, in constant time
+		///
+		/// \param size = Tag size in bytes. Tags shorter than 12 bytes are always rejected.
+		bool verify_tag(const void *tag, int size = tag_size) const;
+
+	private:
+		std::shared_ptr<AES_GCM_Impl> impl;
+	};
+
+	/// \}
+}
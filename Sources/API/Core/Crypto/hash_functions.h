@@ -41,6 +41,8 @@
 
 namespace clan
 {
+	class IODevice;
+
 	/// \addtogroup clanCore_Crypto clanCore Crypto
 	/// \{
 
@@ -92,6 +94,24 @@ namespace clan
 		/// \param out_hash = char
 		static void sha1(const DataBuffer &data, unsigned char out_hash[20]);
 
+		/// \brief Generate SHA-1 hash from everything that can be read from the device.
+		///
+		/// The device is read in large blocks until it reports no more data.
+		static std::string sha1(IODevice &device, bool uppercase = false);
+
+		/// \brief Generate SHA-1 hash from everything that can be read from the device.
+		static void sha1(IODevice &device, unsigned char out_hash[20]);
+
+		/// \brief Generate SHA-1 hashes for many separate messages.
+		///
+		/// This is faster than hashing the messages one at a time when the CPU has AVX2, but not the SHA extensions.
+		///
+		/// \param data = Pointers to the messages
+		/// \param sizes = Size of each message
+		/// \param count = Number of messages
+		/// \param out_hashes = Receives the hash of each message
+		static void sha1_multi_buffer(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[20]);
+
 		/// \brief Generate SHA-1 hash from data.
 		static std::string md5(const void *data, int size, bool uppercase = false);
 
@@ -207,6 +227,24 @@ namespace clan
 		/// \param out_hash = char
 		static void sha256(const DataBuffer &data, unsigned char out_hash[32]);
 
+		/// \brief Generate SHA-256 hash from everything that can be read from the device.
+		///
+		/// The device is read in large blocks until it reports no more data.
+		static std::string sha256(IODevice &device, bool uppercase = false);
+
+		/// \brief Generate SHA-256 hash from everything that can be read from the device.
+		static void sha256(IODevice &device, unsigned char out_hash[32]);
+
+		/// \brief Generate SHA-256 hashes for many separate messages.
+		///
+		/// This is faster than hashing the messages one at a time when the CPU has AVX2, but not the SHA extensions.
+		///
+		/// \param data = Pointers to the messages
+		/// \param sizes = Size of each message
+		/// \param count = Number of messages
+		/// \param out_hashes = Receives the hash of each message
+		static void sha256_multi_buffer(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[32]);
+
 		/// \brief Generate SHA-384 hash from data.
 		static std::string sha384(const void *data, int size, bool uppercase = false);
 
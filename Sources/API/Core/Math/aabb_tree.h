@@ -0,0 +1,121 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "vec3.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class AxisAlignedBoundingBox;
+	class FrustumPlanes;
+	class AxisAlignedBoundingBoxTree_Impl;
+
+	/// \brief Dynamic bounding volume hierarchy of axis aligned bounding boxes.
+	///
+	/// Each object is stored in a leaf together with a fat box, which is its box grown by a margin.
+	/// Moving an object only touches the tree when it leaves its fat box. New leaves are placed
+	/// where they add the least surface area, and the nodes above them are rotated to keep the
+	/// total surface area low, so the tree stays efficient as objects are added, moved and removed.
+	///
+	/// The queries test the fat boxes of the inner nodes and the exact boxes of the leaves, so they
+	/// return the same objects as testing each box with IntersectionTest.
+	class AxisAlignedBoundingBoxTree
+	{
+	public:
+		/// \brief Constructs an empty tree.
+		///
+		/// \param margin = Distance the fat box extends beyond the box of each object
+		AxisAlignedBoundingBoxTree(float margin = 0.1f);
+
+		~AxisAlignedBoundingBoxTree();
+
+		/// \brief Returns the number of objects in the tree.
+		int get_proxy_count() const;
+
+		/// \brief Returns the height of the tree. A tree with a single object has height 0.
+		int get_height() const;
+
+		/// \brief Returns the box of an object.
+		const AxisAlignedBoundingBox &get_box(int proxy) const;
+
+		/// \brief Returns the fat box of an object, used by the inner nodes of the tree.
+		const AxisAlignedBoundingBox &get_fat_box(int proxy) const;
+
+		/// \brief Returns the user data of an object.
+		void *get_data(int proxy) const;
+
+		/// \brief Adds an object to the tree.
+		///
+		/// \return The proxy id of the object. It stays valid until the object is removed.
+		int insert(const AxisAlignedBoundingBox &box, void *data = nullptr);
+
+		/// \brief Removes an object from the tree.
+		void remove(int proxy);
+
+		/// \brief Updates the box of an object.
+		///
+		/// \param displacement = Expected movement until the next update. The fat box is stretched in this direction.
+		/// \return true if the object was reinserted, false if it still fits in its fat box
+		bool move(int proxy, const AxisAlignedBoundingBox &box, const Vec3f &displacement = Vec3f());
+
+		/// \brief Removes all objects from the tree.
+		void clear();
+
+		/// \brief Rebuilds the inner nodes of the tree top-down using the surface area heuristic.
+		///
+		/// This gives a better tree than incremental insertion, for example after a level has been loaded.
+		/// Proxy ids are not changed.
+		void rebuild();
+
+		/// \brief Finds the objects overlapping a box.
+		void query(const AxisAlignedBoundingBox &box, std::vector<int> &result) const;
+
+		/// \brief Finds the objects containing a point.
+		void query(const Vec3f &point, std::vector<int> &result) const;
+
+		/// \brief Finds the objects inside or intersecting a frustum.
+		///
+		/// Subtrees found to be completely inside the frustum are added without further tests.
+		void query(const FrustumPlanes &frustum, std::vector<int> &result) const;
+
+		/// \brief Finds the objects hit by a line segment.
+		void query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &result) const;
+
+	private:
+		std::shared_ptr<AxisAlignedBoundingBoxTree_Impl> impl;
+	};
+
+	/// \}
+}
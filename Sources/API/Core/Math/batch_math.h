@@ -0,0 +1,151 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+#include <vector>
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class AxisAlignedBoundingBox;
+	class FrustumPlanes;
+
+	/// \brief 3D vectors stored as a structure of arrays, for the BatchMath kernels.
+	class Vec3fSoA
+	{
+	public:
+		Vec3fSoA() { }
+		explicit Vec3fSoA(size_t size) : x(size), y(size), z(size) { }
+
+		size_t size() const { return x.size(); }
+		void resize(size_t size) { x.resize(size); y.resize(size); z.resize(size); }
+		void clear() { x.clear(); y.clear(); z.clear(); }
+
+		void push_back(const Vec3f &v) { x.push_back(v.x); y.push_back(v.y); z.push_back(v.z); }
+		void set(size_t index, const Vec3f &v) { x[index] = v.x; y[index] = v.y; z[index] = v.z; }
+		Vec3f get(size_t index) const { return Vec3f(x[index], y[index], z[index]); }
+
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+	};
+
+	/// \brief 4D vectors stored as a structure of arrays, for the BatchMath kernels.
+	class Vec4fSoA
+	{
+	public:
+		Vec4fSoA() { }
+		explicit Vec4fSoA(size_t size) : x(size), y(size), z(size), w(size) { }
+
+		size_t size() const { return x.size(); }
+		void resize(size_t size) { x.resize(size); y.resize(size); z.resize(size); w.resize(size); }
+		void clear() { x.clear(); y.clear(); z.clear(); w.clear(); }
+
+		void push_back(const Vec4f &v) { x.push_back(v.x); y.push_back(v.y); z.push_back(v.z); w.push_back(v.w); }
+		void set(size_t index, const Vec4f &v) { x[index] = v.x; y[index] = v.y; z[index] = v.z; w[index] = v.w; }
+		Vec4f get(size_t index) const { return Vec4f(x[index], y[index], z[index], w[index]); }
+
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> w;
+	};
+
+	/// \brief Axis aligned bounding boxes stored as a structure of arrays, for the BatchMath kernels.
+	class AxisAlignedBoundingBoxSoA
+	{
+	public:
+		size_t size() const { return min_x.size(); }
+		void resize(size_t size);
+		void clear();
+
+		void push_back(const AxisAlignedBoundingBox &box);
+		void set(size_t index, const AxisAlignedBoundingBox &box);
+		AxisAlignedBoundingBox get(size_t index) const;
+
+		std::vector<float> min_x;
+		std::vector<float> min_y;
+		std::vector<float> min_z;
+		std::vector<float> max_x;
+		std::vector<float> max_y;
+		std::vector<float> max_z;
+	};
+
+	/// \brief Spheres stored as a structure of arrays, for the BatchMath kernels.
+	class SphereSoA
+	{
+	public:
+		size_t size() const { return radius.size(); }
+		void resize(size_t size) { center.resize(size); radius.resize(size); }
+		void clear() { center.clear(); radius.clear(); }
+
+		void push_back(const Vec3f &sphere_center, float sphere_radius) { center.push_back(sphere_center); radius.push_back(sphere_radius); }
+
+		Vec3fSoA center;
+		std::vector<float> radius;
+	};
+
+	/// \brief Transform and culling kernels working on many objects at a time.
+	///
+	/// The kernels use AVX or SSE2 depending on what the CPU supports, chosen at runtime.
+	/// Results match the single object functions in Mat4 and IntersectionTest.
+	///
+	/// The culling functions write a bit mask with one bit per object: object i is
+	/// represented by bit (i & 31) of result[i >> 5]. The mask is resized to fit.
+	class BatchMath
+	{
+	public:
+		/// \brief Transforms points (with w = 1) by a matrix, like matrix * Vec4f(point, 1.0f).
+		static void transform_points(const Mat4f &matrix, const Vec3fSoA &points, Vec4fSoA &result);
+
+		/// \brief Transforms points and divides by w when it is not zero, like Mat4f::get_transformed_point.
+		static void transform_points(const Mat4f &matrix, const Vec3fSoA &points, Vec3fSoA &result);
+
+		/// \brief Sets the bit of every box not outside the frustum, like IntersectionTest::frustum_aabb() != outside.
+		static void frustum_aabbs(const FrustumPlanes &frustum, const AxisAlignedBoundingBoxSoA &boxes, std::vector<uint32_t> &result);
+
+		/// \brief Sets the bit of every sphere not outside the frustum.
+		static void frustum_spheres(const FrustumPlanes &frustum, const SphereSoA &spheres, std::vector<uint32_t> &result);
+
+		/// \brief Sets the bit of every sphere overlapping the given sphere, like IntersectionTest::sphere() == overlap.
+		static void sphere_spheres(const Vec3f &center, float radius, const SphereSoA &spheres, std::vector<uint32_t> &result);
+
+		/// \brief Returns true if bit index is set in a mask produced by the culling functions.
+		static bool is_set(const std::vector<uint32_t> &mask, size_t index) { return (mask[index >> 5] & (1u << (index & 31))) != 0; }
+	};
+
+	/// \}
+}
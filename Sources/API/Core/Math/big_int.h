@@ -135,11 +135,12 @@ namespace clan
 
 		/// \brief  Compute c = (a ** b) mod m.
 		///
-		/// Uses a standard square-and-multiply
-		/// method with modular reductions at each step. (This is basically the
-		/// same code as expt(), except for the addition of the reductions)
+		/// For an odd m, the multiplications are done in Montgomery form on 64-bit limbs.
+		/// Long exponents (such as RSA private exponents) use fixed window exponentiation,
+		/// which does the same sequence of operations for every exponent of a given length.
 		///
-		/// The modular reductions are done using Barrett's algorithm (see reduce() for details)
+		/// For an even m, a standard square-and-multiply method is used, with the
+		/// modular reductions done using Barrett's algorithm (see reduce() for details)
 		void exptmod(const BigInt *b, const BigInt *m, BigInt *c) const;
 
 		/// \brief  Compute c = a (mod m).  Result will always be 0 <= c < m.
@@ -68,9 +68,9 @@ namespace clan
 
 	/// \brief Delauney triangulator.
 	///
-	///    <p>This class uses the <a href="http://astronomy.swin.edu.au/~pbourke/terrain/triangulate/">
-	///    delauney triangulation algorithm</a> to produce
-	///    triangles between a list of points.</p>
+	///    <p>This class produces the delauney triangulation of a list of points, covering their convex hull.
+	///    It uses a sweep-hull algorithm running in O(n log n) time, with exact orientation and in-circle tests
+	///    so that collinear and co-circular points are handled consistently. Duplicated points are only used once.</p>
 	class DelauneyTriangulator
 	{
 	public:
@@ -87,12 +87,17 @@ namespace clan
 		void set_orientation(PolygonOrientation orientation);
 
 		/// \brief Perform triangulation.
+		///
+		/// Holes are bridged into the outer contour here, left to right. Large polygons
+		/// use a z-order index of the vertices, so ear tests only visit nearby vertices.
 		EarClipResult triangulate();
 
 		/// \brief Mark beginning of a polygon hole.
 		void begin_hole();
 
 		/// \brief Mark ending of a polygon hole.
+		///
+		/// A hole must have the opposite orientation of the outer contour.
 		void end_hole();
 
 	private:
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace clan
 {
 	/// \addtogroup clanCore_Math clanCore Math
@@ -99,6 +101,16 @@ namespace clan
 			return base_table[(f >> 23) & 0x1ff] + ((f & 0x007fffff) >> shift_table[(f >> 23) & 0x1ff]);
 		}
 
+		/// \brief Converts an array of half floats to floats.
+		///
+		/// Uses F16C or SSE2 when available. The results are the same as half_to_float, except that F16C turns signaling NaNs into quiet NaNs.
+		static void half_to_float(const unsigned short *input, float *output, size_t count);
+
+		/// \brief Converts an array of floats to half floats.
+		///
+		/// Uses F16C or SSE2 when available. The results are the same as float_to_half, which rounds towards zero, except that F16C turns signaling NaNs into quiet NaNs.
+		static void float_to_half(const float *input, unsigned short *output, size_t count);
+
 	private:
 		unsigned short value;
 
@@ -0,0 +1,102 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "rect.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class LooseQuadtree_Impl;
+
+	/// \brief Loose quadtree of rectangles.
+	///
+	/// The loose bounds of a node are its area grown by half its size on every side. A rectangle is
+	/// stored in the deepest node that contains its center and whose loose bounds can hold it, which
+	/// is found directly from the size and center of the rectangle. Inserting and moving objects
+	/// therefore never has to search the tree or split nodes.
+	///
+	/// Rectangles with their center outside the bounds of the tree are stored in the root node.
+	class LooseQuadtree
+	{
+	public:
+		/// \brief Constructs an empty quadtree.
+		///
+		/// \param bounds = Area covered by the tree
+		/// \param max_depth = Number of levels below the root node
+		LooseQuadtree(const Rectf &bounds, int max_depth = 8);
+
+		~LooseQuadtree();
+
+		/// \brief Returns the area covered by the tree.
+		Rectf get_bounds() const;
+
+		/// \brief Returns the number of objects in the tree.
+		int get_proxy_count() const;
+
+		/// \brief Returns the rectangle of an object.
+		const Rectf &get_rect(int proxy) const;
+
+		/// \brief Returns the user data of an object.
+		void *get_data(int proxy) const;
+
+		/// \brief Adds an object to the tree.
+		///
+		/// \return The proxy id of the object. It stays valid until the object is removed.
+		int insert(const Rectf &rect, void *data = nullptr);
+
+		/// \brief Removes an object from the tree.
+		void remove(int proxy);
+
+		/// \brief Updates the rectangle of an object.
+		void move(int proxy, const Rectf &rect);
+
+		/// \brief Removes all objects from the tree.
+		void clear();
+
+		/// \brief Finds the objects overlapping a rectangle, as tested by Rectf::is_overlapped.
+		void query(const Rectf &rect, std::vector<int> &result) const;
+
+		/// \brief Finds the objects containing a point, as tested by Rectf::contains.
+		void query(const Pointf &point, std::vector<int> &result) const;
+
+		/// \brief Finds the objects hit by a line segment.
+		void query_ray(const Pointf &ray_start, const Pointf &ray_end, std::vector<int> &result) const;
+
+	private:
+		std::shared_ptr<LooseQuadtree_Impl> impl;
+	};
+
+	/// \}
+}
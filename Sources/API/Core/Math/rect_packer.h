@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "rect.h"
 
 namespace clan
@@ -51,9 +52,45 @@ namespace clan
 			fail_if_full
 		};
 
+		/// \brief Packing method, used by the groups created after it is set.
+		enum PackingMethod
+		{
+			/// \brief Binary tree of guillotine cuts. Fast, but fragments with mixed rect sizes
+			guillotine,
+
+			/// \brief Skyline bottom-left, reusing the space left below the skyline. Fast, and dense for rects of similar height such as glyphs
+			skyline_bottom_left,
+
+			/// \brief Maximal free rectangles with best short side fit. Densest packing, but slower with many rects per group
+			max_rects
+		};
+
+		/// \brief Order in which add_all() packs the rects.
+		enum SortHeuristic
+		{
+			/// \brief Pack with each heuristic below on worker threads and keep the one using the fewest groups
+			sort_best,
+
+			/// \brief Largest area first
+			sort_area,
+
+			/// \brief Largest perimeter first
+			sort_perimeter,
+
+			/// \brief Longest side first
+			sort_max_side,
+
+			/// \brief Tallest first
+			sort_height,
+
+			/// \brief Widest first
+			sort_width
+		};
+
 		struct AllocatedRect
 		{
 		public:
+			AllocatedRect() : group_index(-1) {}
 			AllocatedRect(int group_index, Rect rect) : group_index(group_index), rect(rect) {}
 			int group_index;
 			Rect rect;
@@ -63,7 +100,7 @@ namespace clan
 		RectPacker();
 
 		/// \brief Constructs a rect group.
-		RectPacker(const Size &max_group_size, AllocationPolicy policy = create_new_group);
+		RectPacker(const Size &max_group_size, AllocationPolicy policy = create_new_group, PackingMethod method = guillotine);
 
 		~RectPacker();
 
@@ -76,6 +113,9 @@ namespace clan
 		/// \brief Returns the allocation policy.
 		AllocationPolicy get_allocation_policy() const;
 
+		/// \brief Returns the packing method.
+		PackingMethod get_packing_method() const;
+
 		/// \brief Returns the max group size.
 		Size get_max_group_size() const;
 
@@ -88,12 +128,33 @@ namespace clan
 		/// \brief Returns the amount of rects used by group.
 		int get_group_count() const;
 
+		/// \brief Returns the area covered by the rects in a group.
+		int64_t get_used_area(unsigned int group_index = 0) const;
+
 		/// \brief Set the allocation policy.
 		void set_allocation_policy(AllocationPolicy policy);
 
+		/// \brief Set the packing method used for new groups.
+		void set_packing_method(PackingMethod method);
+
 		/// \brief Allocate space for another rect.
+		///
+		/// Throws an exception if the width or height is not larger than zero.
 		AllocatedRect add(const Size &size);
 
+		/// \brief Allocate space for several rects at once.
+		///
+		/// Packing the whole set sorted by size wastes far less space than adding the rects one at a time
+		/// in arbitrary order, which makes this the function to use when baking atlases offline.
+		///
+		/// \param sizes = Sizes of the rects to allocate. Widths and heights must be larger than zero
+		/// \param heuristic = Order to pack the rects in
+		/// \return The allocated rects, in the same order as sizes
+		std::vector<AllocatedRect> add_all(const std::vector<Size> &sizes, SortHeuristic heuristic = sort_best);
+
+		/// \brief Free a previously allocated rect, so its space can be reused.
+		void remove(const AllocatedRect &rect);
+
 	private:
 		std::shared_ptr<RectPacker_Impl> impl;
 	};
@@ -0,0 +1,171 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "system.h"
+#include <atomic>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief Instruction set extensions supported by the CPU and the operating system.
+	///
+	/// The extensions are detected with cpuid the first time get() is called. Extensions using the AVX
+	/// or AVX-512 registers are only reported if the operating system saves those registers (checked with xgetbv).
+	class CPUFeatures
+	{
+	public:
+		/// \brief Returns the extensions of the CPU running the program.
+		///
+		/// Thread safe. Detection only happens on the first call.
+		static const CPUFeatures &get();
+
+		/// \brief Returns true if an extension is supported.
+		bool has(System::CPU_ExtensionX86 ext) const { return (extensions & mask(ext)) != 0; }
+
+		/// \brief Returns true if all the extensions are supported.
+		bool has_all(std::initializer_list<System::CPU_ExtensionX86> exts) const
+		{
+			for (auto ext : exts)
+			{
+				if (!has(ext))
+					return false;
+			}
+			return true;
+		}
+
+		/// \brief Returns the bit used for an extension in get_extensions().
+		static unsigned long long mask(System::CPU_ExtensionX86 ext) { return 1ULL << ext; }
+
+		/// \brief Returns the supported extensions as a bit mask.
+		unsigned long long get_extensions() const { return extensions; }
+
+		/// \brief Hides extensions from get(), so the code paths for older CPUs can be tested on a newer one.
+		///
+		/// Pass 0 to report everything the CPU supports again. CPUDispatch objects pick their function again
+		/// on their next call. Not thread safe: only call this while no other thread uses dispatched functions.
+		///
+		/// \param disabled_mask = Bit mask of the extensions to hide, built with mask()
+		static void set_disabled_extensions(unsigned long long disabled_mask);
+
+		/// \brief Returns a number that changes every time set_disabled_extensions() is called.
+		static unsigned int get_generation() { return generation.load(std::memory_order_relaxed); }
+
+	private:
+		CPUFeatures();
+		static CPUFeatures &instance();
+
+		unsigned long long detected = 0;
+		unsigned long long extensions = 0;
+		static std::atomic<unsigned int> generation;
+	};
+
+	/// \brief Picks the best implementation of a function for the running CPU.
+	///
+	/// The variants are checked in order and the first one with all its extensions supported is used,
+	/// otherwise the fallback. The choice is made in the constructor, and only made again if
+	/// CPUFeatures::set_disabled_extensions() is called, so declare the dispatcher as a static object
+	/// and call through it:
+	///
+	/// \code
+	/// static CPUDispatch<void(*)(const float *, float *, size_t)> scale_dispatch(
+	///     { { System::avx2, scale_avx2 }, { { System::avx, System::f16c }, scale_avx } },
+	///     scale_sse2);
+	///
+	/// scale_dispatch(input, output, count);
+	/// \endcode
+	template<typename Function>
+	class CPUDispatch
+	{
+	public:
+		/// \brief A function and the extensions it needs.
+		class Variant
+		{
+		public:
+			Variant(System::CPU_ExtensionX86 ext, Function function) : extensions(CPUFeatures::mask(ext)), function(function) { }
+			Variant(std::initializer_list<System::CPU_ExtensionX86> exts, Function function) : function(function)
+			{
+				for (auto ext : exts)
+					extensions |= CPUFeatures::mask(ext);
+			}
+
+			unsigned long long extensions = 0;
+			Function function;
+		};
+
+		CPUDispatch(std::initializer_list<Variant> variants, Function fallback) : variants(variants), fallback(fallback)
+		{
+			select();
+		}
+
+		/// \brief Returns the chosen function.
+		Function get() const
+		{
+			if (generation != CPUFeatures::get_generation())
+				select();
+			return function;
+		}
+
+		template<typename... Args>
+		auto operator()(Args &&... args) const -> decltype(std::declval<Function>()(std::forward<Args>(args)...))
+		{
+			return get()(std::forward<Args>(args)...);
+		}
+
+	private:
+		void select() const
+		{
+			generation = CPUFeatures::get_generation();
+			function = fallback;
+
+			unsigned long long supported = CPUFeatures::get().get_extensions();
+			for (const Variant &variant : variants)
+			{
+				if ((variant.extensions & supported) == variant.extensions)
+				{
+					function = variant.function;
+					break;
+				}
+			}
+		}
+
+		std::vector<Variant> variants;
+		Function fallback;
+		mutable Function function;
+		mutable unsigned int generation = 0;
+	};
+
+	/// \}
+}
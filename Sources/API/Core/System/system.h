@@ -48,9 +48,12 @@ namespace clan
 		/// \brief Get the current time microseconds.
 		static uint64_t get_microseconds();
 
-		enum CPU_ExtensionX86 { mmx, mmx_ex, _3d_now, _3d_now_ex, sse, sse2, sse3, ssse3, sse4_a, sse4_1, sse4_2, xop, avx, aes, fma3, fma4 };
+		enum CPU_ExtensionX86 { mmx, mmx_ex, _3d_now, _3d_now_ex, sse, sse2, sse3, ssse3, sse4_a, sse4_1, sse4_2, xop, avx, aes, fma3, fma4, f16c, avx2, avx512f, avx512bw, pclmul, sha, bmi1, bmi2, popcnt, osxsave };
 		enum CPU_ExtensionPPC { altivec };
 
+		/// \brief Returns true if the CPU and the operating system support an instruction set extension.
+		///
+		/// The extensions are detected once and cached, see CPUFeatures.
 		static bool detect_cpu_extension(CPU_ExtensionX86 ext);
 		static bool detect_cpu_extension(CPU_ExtensionPPC ext);
 
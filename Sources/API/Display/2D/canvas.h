@@ -414,6 +414,7 @@ namespace clan
 		friend class Font_DrawSubPixel;
 		friend class Font_DrawFlat;
 		friend class Font_DrawScaled;
+		friend class Font_DrawDistanceField;
 		friend class Path;
 	};
 
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include "../../Core/Math/origin.h"
 #include "../../Core/Signals/signal.h"
 #include "../../Core/IOData/file_system.h"
@@ -48,6 +49,7 @@ namespace clan
 	class ResourceManager;
 	class Font_Impl;
 	class Subtexture;
+	class Texture;
 	class XMLResourceDocument;
 
 	/// \brief Sprite class.
@@ -97,7 +99,12 @@ namespace clan
 		static Resource<Sprite> resource(Canvas &canvas, const std::string &id, const ResourceManager &resources);
 
 		/// \brief Loads a Sprite from a XML resource definition
-		static Sprite load(Canvas &canvas, const std::string &id, const XMLResourceDocument &doc);
+		///
+		/// \param canvas = Canvas
+		/// \param id = Resource name of the sprite
+		/// \param doc = Resource document
+		/// \param cb_get_texture = Returns the texture resources referred to by image elements with a texture attribute. If not set, they are loaded from doc
+		static Sprite load(Canvas &canvas, const std::string &id, const XMLResourceDocument &doc, std::function<Resource<Texture>(GraphicContext &, const std::string &)> cb_get_texture = std::function<Resource<Texture>(GraphicContext &, const std::string &)>());
 
 		/// \brief Returns true if this object is invalid.
 		bool is_null() const { return !impl; }
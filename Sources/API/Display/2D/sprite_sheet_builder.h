@@ -0,0 +1,113 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../Core/Math/rect_packer.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_2D clanDisplay 2D
+	/// \{
+
+	class PixelBuffer;
+	class SpriteSheetBuilder_Impl;
+
+	/// \brief Packs sprite frames into sprite sheet pages ahead of time.
+	///
+	/// All frames are packed at once by build(), which packs far tighter than adding them to a TextureGroup at runtime.
+	/// The pages and a resource description loadable by Sprite::load can then be saved as part of the build,
+	/// so the atlas is baked once instead of every time the application starts.
+	class SpriteSheetBuilder
+	{
+	public:
+		/// \brief A frame placed on a page.
+		struct Frame
+		{
+			std::string sprite_name;
+			int page = 0;
+			Rect rect;
+		};
+
+		/// \brief Constructs a null instance
+		SpriteSheetBuilder();
+
+		/// \brief Constructs a sprite sheet builder
+		///
+		/// \param page_size = Maximum size of each page
+		/// \param padding = Transparent pixels kept between frames, preventing neighbours from bleeding in when filtering
+		/// \param packing_method = How frames are packed into each page
+		SpriteSheetBuilder(const Size &page_size, int padding = 1, RectPacker::PackingMethod packing_method = RectPacker::max_rects);
+
+		~SpriteSheetBuilder();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+		explicit operator bool() const { return bool(impl); }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Adds a frame to a sprite. Frames are kept in the order they were added.
+		void add_frame(const std::string &sprite_name, const PixelBuffer &image);
+
+		/// \brief Packs all added frames into pages
+		///
+		/// Each page is cropped to the area actually used.
+		void build(RectPacker::SortHeuristic heuristic = RectPacker::sort_best);
+
+		/// \brief Returns the pages created by build()
+		std::vector<PixelBuffer> get_pages() const;
+
+		/// \brief Returns where each frame was placed, in the order the frames were added
+		std::vector<Frame> get_frames() const;
+
+		/// \brief Returns an XML resource document describing the sprites
+		///
+		/// Every page is described once, as a texture resource named prefix_page_0, prefix_page_1 and so on.
+		/// The sprites refer to these, so a display cache shares one texture per page between all sprites.
+		///
+		/// \param page_filename_prefix = Pages are referred to as prefix_0.png, prefix_1.png and so on
+		std::string get_resource_description(const std::string &page_filename_prefix) const;
+
+		/// \brief Saves the pages as PNG files and the resource description as name.xml
+		///
+		/// \param directory = Directory to save the files in
+		/// \param name = Name used for the resource description and as prefix for the pages
+		void save(const std::string &directory, const std::string &name) const;
+
+	private:
+		std::shared_ptr<SpriteSheetBuilder_Impl> impl;
+	};
+
+	/// \}
+}
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include "../../Core/Math/rect_packer.h"
 
 namespace clan
 {
@@ -58,7 +59,10 @@ namespace clan
 		TextureGroup();
 
 		/// \brief Constructs a texture group
-		TextureGroup(const Size &texture_sizes);
+		///
+		/// \param texture_sizes = Size of the textures allocated by the group
+		/// \param packing_method = How sub-textures are packed. Skyline and max rects waste less space with mixed sizes than guillotine
+		TextureGroup(const Size &texture_sizes, RectPacker::PackingMethod packing_method = RectPacker::guillotine);
 
 		~TextureGroup();
 
@@ -81,6 +85,9 @@ namespace clan
 		/// \brief Returns the texture allocation policy.
 		TextureAllocationPolicy get_texture_allocation_policy() const;
 
+		/// \brief Returns the packing method.
+		RectPacker::PackingMethod get_packing_method() const;
+
 		/// \brief Returns the size of the textures used by this texture group.
 		Size get_texture_sizes() const;
 
@@ -88,6 +95,8 @@ namespace clan
 		std::vector<Texture2D> get_textures() const;
 
 		/// \brief Allocate space for another sub texture.
+		///
+		/// Throws an exception if the width or height is not larger than zero.
 		Subtexture add(GraphicContext &context, const Size &size);
 
 		/// \brief Deallocate space, from a previously allocated texture
@@ -100,6 +109,9 @@ namespace clan
 		/// \brief Set the texture allocation policy.
 		void set_texture_allocation_policy(TextureAllocationPolicy policy);
 
+		/// \brief Set the packing method used for textures added after this call.
+		void set_packing_method(RectPacker::PackingMethod packing_method);
+
 		/// \brief Insert an existing texture into the texture group
 		///
 		/// \param texture = Texture to insert
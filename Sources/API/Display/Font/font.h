@@ -35,6 +35,7 @@
 #include "../2D/sprite.h"
 #include "font_description.h"
 #include "glyph_metrics.h"
+#include "font_family.h"
 
 namespace clan
 {
@@ -123,6 +124,13 @@ namespace clan
 		/// All font sizes are scalable when using sprite fonts
 		void set_scalable(float height_threshold = 64.0f);
 
+		/// \brief Draws the font from signed distance field glyphs
+		///
+		/// The glyphs are rasterized once at a reference size and drawn at any height with a distance field shader,
+		/// so changing the height does not rasterize the glyphs again. The setting is ignored for sprite fonts and
+		/// for display targets without GLSL programs.
+		void set_distance_field(bool enable = true);
+
 		/// \brief Print text
 		///
 		/// \param canvas = Canvas
@@ -132,6 +140,15 @@ namespace clan
 		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color = StandardColorf::white());
 		void draw_text(Canvas &canvas, float xpos, float ypos, const std::string &text, const Colorf &color = StandardColorf::white()) { draw_text(canvas, Pointf(xpos, ypos), text, color); }
 
+		/// \brief Rasterize the glyphs of a set of characters ahead of drawing them
+		///
+		/// If the font engine supports it, the glyphs are rasterized by worker threads and this function returns
+		/// immediately. They are added to the glyph cache the next time text is drawn or measured with the font.
+		///
+		/// \param canvas = Canvas
+		/// \param charset = The characters to prepare
+		void prewarm(Canvas &canvas, const std::string &charset);
+
 		/// \brief Gets the glyph metrics
 		///
 		/// \param glyph = The glyph to get
@@ -174,6 +191,9 @@ namespace clan
 		// Get the font description
 		FontDescription get_description() const;
 
+		/// \brief Returns the statistics of the glyph atlas of the font family used by this font
+		GlyphAtlasStatistics get_glyph_atlas_statistics() const;
+
 		/// \brief Get the font handle interface
 		///
 		/// For example, use auto handle = dynamic_cast<FontHandle_Win32>(font.get_handle()); if (handle) {...} to obtain a specific interface
@@ -185,6 +205,7 @@ namespace clan
 		std::shared_ptr<Font_Impl> impl;
 
 		friend class Path;
+		friend class GlyphRun;
 	};
 
 	#ifdef WIN32
@@ -47,6 +47,31 @@ namespace clan
 	class FontFamily_Impl;
 	class GlyphMetrics;
 
+	/// \brief Statistics of the glyph atlas shared by the fonts of a font family
+	class GlyphAtlasStatistics
+	{
+	public:
+		/// Number of glyph lookups that found the glyph in the cache
+		int64_t hits = 0;
+		/// Number of glyph lookups that had to rasterize the glyph
+		int64_t misses = 0;
+		/// Number of glyphs stored in the atlas
+		int glyph_count = 0;
+		/// Number of atlas texture pages
+		int page_count = 0;
+		/// Texture memory used by the atlas pages, in bytes
+		size_t bytes = 0;
+		/// Fraction of the page area allocated to glyphs
+		float occupancy = 0.0f;
+		/// Number of pages evicted to stay within the budget
+		int evicted_pages = 0;
+		/// Number of times the glyphs in use were re-packed into fresh pages
+		int compactions = 0;
+
+		/// Returns the fraction of glyph lookups that found the glyph in the cache
+		float get_hit_rate() const { return hits + misses > 0 ? (float)((double)hits / (hits + misses)) : 0.0f; }
+	};
+
 	/// \brief FontFamily class
 	///
 	/// A FontFamily is a collection of font descriptions
@@ -57,6 +82,8 @@ namespace clan
 		FontFamily();
 
 		/// \brief Constructs a font family with the given family name
+		///
+		/// The texture size of the texture group sets the size of the glyph atlas pages.
 		FontFamily(const std::string &family_name, const TextureGroup &new_texture_group = TextureGroup(Size(256, 256)));
 
 		/// \brief Returns true if this object is invalid.
@@ -69,6 +96,54 @@ namespace clan
 		/// \brief Font family name used for this font family
 		const std::string &get_family_name() const;
 
+		/// \brief Returns the maximum texture memory used by the glyphs of this family, in bytes (0 = unlimited)
+		size_t get_glyph_atlas_budget() const;
+
+		/// \brief Returns the statistics of the glyph atlas
+		GlyphAtlasStatistics get_glyph_atlas_statistics() const;
+
+		/// \brief Sets the maximum texture memory used by the glyphs of this family, in bytes
+		///
+		/// When the budget is reached, the least recently used atlas page is evicted, and its glyphs rasterized
+		/// again when they are next drawn. A single glyph larger than the budget still gets a page.
+		///
+		/// \param bytes = Budget in bytes, 0 for unlimited
+		void set_glyph_atlas_budget(size_t bytes);
+
+		/// \brief Returns the maximum memory used by the cached text layouts of this family, in bytes
+		size_t get_text_layout_cache_budget() const;
+
+		/// \brief Sets the maximum memory used by the cached text layouts of this family, in bytes
+		///
+		/// Measuring, hit testing and drawing a string share one cached layout, keyed by the text, font and pixel ratio.
+		/// The least recently used layouts are discarded when the budget is reached. The default is 1 MB.
+		///
+		/// \param bytes = Budget in bytes, 0 to disable the cache
+		void set_text_layout_cache_budget(size_t bytes);
+
+		/// \brief Rasterize missing glyphs on worker threads instead of in the middle of drawing text
+		///
+		/// A glyph that is not cached yet is skipped by draw_text until a worker thread has rasterized it,
+		/// usually by the next frame. Measuring text still rasterizes glyphs immediately, so layout is not affected.
+		/// Has no effect if the font engine cannot rasterize glyphs on other threads (FreeType only).
+		void set_background_rasterization(bool enable = true);
+
+		/// \brief Stores rasterized glyphs in a directory, so later runs load them instead of rasterizing them again
+		///
+		/// Each font file, size and rendering setting gets its own cache file, named after a hash of the font file and the settings.
+		/// The files are written by save_glyph_disk_cache() and when the font family is destroyed.
+		///
+		/// \param directory = Cache directory, created if missing. An empty string disables the cache
+		void set_glyph_disk_cache(const std::string &directory);
+
+		/// \brief Writes the glyphs rasterized since the cache files were loaded to the glyph disk cache
+		void save_glyph_disk_cache();
+
+		/// \brief Sets the fraction of the atlas held by unused glyphs at which the atlas is re-packed instead of evicting a page
+		///
+		/// Glyphs are unused if they have not been drawn or measured since the atlas last ran out of space.
+		void set_glyph_atlas_compaction_threshold(float fraction = 0.5f);
+
 		/// \brief Add standard font
 		void add(const std::string &typeface_name, float height);
 
@@ -0,0 +1,86 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include "font.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Font clanDisplay Font
+	/// \{
+
+	class Canvas;
+	class GlyphRun_Impl;
+
+	/// \brief Glyphs of a string, resolved once so that unchanging text can be drawn many times at a low cost
+	///
+	/// The first draw lays out the text and stores a textured quad for each glyph. Later draws append the quads
+	/// to the render batch without decoding the text or looking up glyphs. The quads are resolved again when the
+	/// font settings or pixel ratio change, or when the glyph atlas of the font family moves or evicts glyphs.
+	///
+	/// Bitmap glyphs are snapped to pixels relative to the grid fitted draw position, which matches
+	/// Font::draw_text as long as the canvas transform is a translation. Fonts drawn as paths fall back to Font::draw_text.
+	class GlyphRun
+	{
+	public:
+		/// \brief Constructs a null instance
+		GlyphRun();
+
+		/// \brief Constructs a glyph run for the text, resolved when it is first drawn
+		GlyphRun(const Font &font, const std::string &text);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+		explicit operator bool() const { return bool(impl); }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the font used by the glyph run
+		Font get_font() const;
+
+		/// \brief Returns the text of the glyph run
+		const std::string &get_text() const;
+
+		/// \brief Draw the text
+		///
+		/// \param canvas = Canvas
+		/// \param position = Dest position, using the same baseline as Font::draw_text
+		/// \param color = The text color
+		void draw(Canvas &canvas, const Pointf &position, const Colorf &color = StandardColorf::white());
+		void draw(Canvas &canvas, float xpos, float ypos, const Colorf &color = StandardColorf::white()) { draw(canvas, Pointf(xpos, ypos), color); }
+
+	private:
+		std::shared_ptr<GlyphRun_Impl> impl;
+	};
+
+	/// \}
+}
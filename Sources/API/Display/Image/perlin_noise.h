@@ -39,6 +39,8 @@ namespace clan
 	class PerlinNoise_Impl;
 
 	/// \brief Perlin Noise Generator class
+	///
+	/// Large images are generated on several threads, four pixels at a time where SSE2 is available.
 	class PerlinNoise
 	{
 	public:
@@ -92,6 +94,29 @@ namespace clan
 		/// \param w_position = The w position of the noise
 		PixelBuffer create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position);
 
+		/// \brief Create simplex noise
+		///
+		/// Simplex noise has fewer directional artifacts than perlin noise.
+		/// It uses the same permutation table, size, format, amplitude and octaves.
+		///
+		/// \param start_x = Start x position of the noise
+		/// \param end_x = End x position of the noise
+		/// \param start_y = Start y position of the noise
+		/// \param end_y = End y position of the noise
+		PixelBuffer create_simplex_noise2d(float start_x, float end_x, float start_y, float end_y);
+
+		/// \brief Create simplex noise
+		///
+		/// Simplex noise has fewer directional artifacts than perlin noise.
+		/// It uses the same permutation table, size, format, amplitude and octaves.
+		///
+		/// \param start_x = Start x position of the noise
+		/// \param end_x = End x position of the noise
+		/// \param start_y = Start y position of the noise
+		/// \param end_y = End y position of the noise
+		/// \param z_position = The z position of the noise
+		PixelBuffer create_simplex_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position);
+
 		/// \brief Get the size of the output pixelbuffer
 		Size get_size() const;
 
@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include "texture_2d.h"
+#include "../Image/image_import_description.h"
+#include "../../Core/Resources/resource.h"
+#include "../../Core/Signals/signal.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class FileSystem;
+	class AsyncTextureLoader_Impl;
+
+	/// \brief Loads textures in the background
+	///
+	/// Images are decoded on worker threads and uploaded through transfer textures (pixel buffer objects)
+	/// in slices, limited by an upload budget per frame. Until a texture is fully uploaded, its resource
+	/// holds a placeholder texture. The resource is then set to the loaded texture, which can be detected
+	/// with Resource::updated().
+	///
+	/// update() must be called once per frame on the thread owning the graphic context.
+	class AsyncTextureLoader
+	{
+	public:
+		/// \brief Constructs a null instance.
+		AsyncTextureLoader();
+
+		/// \brief Constructs a texture loader
+		///
+		/// \param gc = Graphic Context
+		/// \param upload_bytes_per_frame = Maximum number of bytes uploaded per call to update()
+		AsyncTextureLoader(GraphicContext &gc, int upload_bytes_per_frame = 4 * 1024 * 1024);
+
+		~AsyncTextureLoader();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+		explicit operator bool() const { return bool(impl); }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the maximum number of bytes uploaded per call to update()
+		int get_upload_budget() const;
+
+		/// \brief Returns the number of textures that are still being decoded or uploaded
+		int get_pending_count() const;
+
+		/// \brief Returns the texture used until a texture is loaded
+		Texture2D get_placeholder() const;
+
+		/// \brief Signal emitted on the update() thread when a texture fails to load
+		///
+		/// The parameters are the filename and the error message. The resource keeps the placeholder texture.
+		Signal<void(const std::string &, const std::string &)> &sig_load_failed();
+
+		/// \brief Sets the maximum number of bytes uploaded per call to update()
+		///
+		/// Textures are uploaded in slices of about this size, and a slice that does not fit in what is left of
+		/// the budget waits for the next frame. At least one slice is uploaded per call, whatever the budget.
+		/// A new budget applies to textures that have not started uploading yet.
+		void set_upload_budget(int upload_bytes_per_frame);
+
+		/// \brief Sets the texture used until a texture is loaded
+		void set_placeholder(const Texture2D &texture);
+
+		/// \brief Queues a texture for loading
+		///
+		/// \param filename = Image filename within the file system
+		/// \param fs = File system. It is read from worker threads.
+		/// \param import_desc = Image import description. process() is called on a worker thread.
+		/// \return Resource holding the placeholder until the texture is loaded
+		Resource<Texture> load(const std::string &filename, const FileSystem &fs, const ImageImportDescription &import_desc = ImageImportDescription());
+
+		/// \brief Queues a texture for loading
+		///
+		/// \param fullname = Image filename, including the path
+		/// \param import_desc = Image import description. process() is called on a worker thread.
+		/// \return Resource holding the placeholder until the texture is loaded
+		Resource<Texture> load(const std::string &fullname, const ImageImportDescription &import_desc = ImageImportDescription());
+
+		/// \brief Uploads the next slices of the decoded textures, within the upload budget
+		void update(GraphicContext &gc);
+
+		/// \brief Waits for all queued textures and uploads them, ignoring the upload budget
+		void finish(GraphicContext &gc);
+
+	private:
+		std::shared_ptr<AsyncTextureLoader_Impl> impl;
+	};
+
+	/// \}
+}
@@ -0,0 +1,147 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class FrameProfiler_Impl;
+
+	/// \brief A measured scope of a profiled frame
+	struct FrameProfilerScope
+	{
+		/// \brief Name passed to FrameProfiler::begin_scope
+		std::string name;
+
+		/// \brief Frame number the scope was recorded in
+		int frame = 0;
+
+		/// \brief Nesting depth, 0 for the outermost scopes
+		int depth = 0;
+
+		/// \brief CPU time in microseconds, as returned by System::get_microseconds()
+		uint64_t cpu_begin = 0;
+		uint64_t cpu_end = 0;
+
+		/// \brief True if GPU timestamps have been resolved for this scope
+		bool gpu_valid = false;
+
+		/// \brief GPU timestamps in nanoseconds
+		uint64_t gpu_begin = 0;
+		uint64_t gpu_end = 0;
+	};
+
+	/// \brief Records CPU and GPU time spent in named scopes of each frame
+	///
+	/// GPU times are measured with timer queries. Results are collected a few frames later, when the
+	/// GPU has caught up, so the profiler never stalls the pipeline. If the display target does not
+	/// support timer queries, only CPU times are recorded.
+	///
+	/// The recorded frames can be exported in the Chrome trace event format and viewed in chrome://tracing.
+	class FrameProfiler
+	{
+	public:
+		/// \brief Constructs a null instance.
+		FrameProfiler();
+
+		/// \brief Constructs a frame profiler
+		///
+		/// \param gc = Graphic Context
+		/// \param max_frames = Number of most recent frames kept
+		FrameProfiler(GraphicContext &gc, int max_frames = 256);
+
+		~FrameProfiler();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+		explicit operator bool() const { return bool(impl); }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns true if GPU times are measured
+		bool is_gpu_timing_supported() const;
+
+		/// \brief Returns the scopes of all recorded frames, oldest first
+		std::vector<FrameProfilerScope> get_scopes() const;
+
+		/// \brief Returns the recorded frames in the Chrome trace event format
+		std::string to_chrome_trace() const;
+
+		/// \brief Saves the recorded frames as a Chrome trace file
+		void save_chrome_trace(const std::string &filename) const;
+
+		/// \brief Start recording a frame
+		void begin_frame(GraphicContext &gc);
+
+		/// \brief Finish recording a frame and collect GPU results of earlier frames
+		void end_frame(GraphicContext &gc);
+
+		/// \brief Open a named scope in the current frame
+		void begin_scope(GraphicContext &gc, const std::string &name);
+
+		/// \brief Close the innermost open scope
+		void end_scope(GraphicContext &gc);
+
+	private:
+		std::shared_ptr<FrameProfiler_Impl> impl;
+	};
+
+	/// \brief Opens a frame profiler scope for the lifetime of the object
+	class FrameProfileScope
+	{
+	public:
+		FrameProfileScope(FrameProfiler &profiler, GraphicContext &gc, const std::string &name) : profiler(profiler), gc(gc)
+		{
+			profiler.begin_scope(gc, name);
+		}
+
+		~FrameProfileScope()
+		{
+			profiler.end_scope(gc);
+		}
+
+	private:
+		FrameProfileScope(const FrameProfileScope &) = delete;
+		FrameProfileScope &operator=(const FrameProfileScope &) = delete;
+
+		FrameProfiler &profiler;
+		GraphicContext &gc;
+	};
+
+	/// \}
+}
@@ -33,6 +33,7 @@
 #include "../2D/color.h"
 #include "../Image/texture_format.h"
 #include <memory>
+#include <cstdint>
 #include "../../Core/Math/mat4.h"
 #include "../../Core/Math/rect.h"
 #include "../../Core/Signals/signal.h"
@@ -240,7 +241,8 @@ namespace clan
 		color_only,
 		single_texture,
 		sprite,
-		path
+		path,
+		distance_field_glyph
 	};
 
 	/// Shader language used
@@ -252,6 +254,21 @@ namespace clan
 		num_shader_languages
 	};
 
+	/// Statistics collected by the graphic context target during a frame
+	class GraphicContextStatistics
+	{
+	public:
+		/// Number of bytes streamed into vertex buffers
+		int64_t bytes_uploaded = 0;
+
+		/// Number of times the CPU had to wait for the GPU before it could write to a buffer
+		int upload_stalls = 0;
+		/// Number of render state and binding changes sent to the driver
+		int state_changes = 0;
+		/// Number of render state and binding changes skipped because they matched the current state
+		int state_changes_skipped = 0;
+	};
+
 	/// Interface to drawing graphics.
 	class GraphicContext
 	{
@@ -358,6 +375,11 @@ namespace clan
 		 */
 		Size get_max_texture_size() const;
 
+		/** Returns the statistics collected during the last completed frame.
+		 *  A frame ends when the display window owning this context is flipped.
+		 */
+		GraphicContextStatistics get_frame_statistics() const;
+
 		/// Returns the provider for this graphic context.
 		GraphicContextProvider *get_provider();
 
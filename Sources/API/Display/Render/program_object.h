@@ -213,6 +213,22 @@ namespace clan
 		/// \return Program Object
 		static ProgramObject load_and_link(GraphicContext &gc, IODevice &vertex_file, IODevice &geometry_file, IODevice &fragment_file);
 
+		/// \brief Enables the on-disk program binary cache
+		///
+		/// When enabled, link() first tries to load a program binary stored in the cache directory by an earlier run.
+		/// Binaries are keyed by a hash of the shader sources, the attribute and frag data bindings and the driver
+		/// vendor, renderer and version. If no usable binary is found the program is linked from source and the
+		/// result is written to the cache.
+		///
+		/// Shaders attached without being compiled are compiled by link() only when the cache misses.
+		/// The standard programs of a graphic context use the cache if it is enabled before the context is created.
+		///
+		/// \param cache_directory = Directory to store the binaries in. An empty string disables the cache.
+		static void set_binary_cache_directory(const std::string &cache_directory);
+
+		/// \brief Returns the program binary cache directory, or an empty string if the cache is disabled
+		static std::string get_binary_cache_directory();
+
 		virtual ~ProgramObject();
 
 		/// \brief Returns true if this object is invalid.
@@ -282,7 +298,8 @@ namespace clan
 		void bind_frag_data_location(int color_number, const std::string &name);
 
 		/// \brief Link program.
-		/** <p>If the linking fails, get_info_log() will return the link log.</p>*/
+		/** <p>Attached shaders that have not been compiled yet are compiled first.
+			If compiling or linking fails, get_info_log() will return the compile or link log.</p>*/
 		bool link();
 
 		/// \brief Validate program.
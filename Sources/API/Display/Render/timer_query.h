@@ -0,0 +1,101 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include "graphic_context.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class TimerQuery_Impl;
+	class GraphicContext;
+	class TimerQueryProvider;
+
+	/// \brief GPU timer query class.
+	///
+	/// Measures the time the GPU spends executing commands, either as the time elapsed between begin() and end(),
+	/// or as a timestamp taken when the GPU reaches the timestamp() call. Elapsed time queries cannot be nested,
+	/// use two timestamps for nested measurements.
+	class TimerQuery
+	{
+	public:
+		/// \brief Constructs a null instance.
+		TimerQuery();
+
+		/// \brief Constructs a timer query object.
+		///
+		/// An exception is thrown if the display target does not support timer queries.
+		TimerQuery(GraphicContext &context);
+
+		virtual ~TimerQuery();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+		explicit operator bool() const { return bool(impl); }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns true if the display target of the graphic context supports timer queries.
+		///
+		/// The answer is cached by the graphic context, so this does not create a query object.
+		static bool is_supported(GraphicContext &context);
+
+		/// \brief Returns the result of the timer query in nanoseconds.
+		///
+		/// Waits for the GPU if the result is not ready yet.
+		uint64_t get_result();
+
+		/// \brief Returns true if the GPU is ready to return the result.
+		bool is_result_ready();
+
+		/// \brief Get Provider
+		///
+		/// \return provider
+		TimerQueryProvider *get_provider() const;
+
+		/// \brief Start measuring the GPU time elapsed.
+		void begin();
+
+		/// \brief Finish measuring the GPU time elapsed.
+		void end();
+
+		/// \brief Record the GPU time once all previous commands have completed.
+		void timestamp();
+
+	private:
+		std::shared_ptr<TimerQuery_Impl> impl;
+	};
+
+	/// \}
+}
@@ -44,6 +44,7 @@ namespace clan
 	class Texture;
 	class Font;
 	class FontDescription;
+	class AsyncTextureLoader;
 
 	class DisplayCache
 	{
@@ -54,6 +55,12 @@ namespace clan
 		virtual Resource<Texture> get_texture(GraphicContext &gc, const std::string &id) = 0;
 		virtual Resource<Font> get_font(Canvas &canvas, const std::string &family_name, const FontDescription &desc) = 0;
 
+		/// \brief Sets the loader used to load textures in the background
+		///
+		/// Caches supporting it return textures holding the loader placeholder until they are loaded.
+		/// Other caches keep loading textures synchronously.
+		virtual void set_texture_loader(const AsyncTextureLoader &loader) { }
+
 		static DisplayCache &get(const ResourceManager &resources);
 		static void set(ResourceManager &resources, const std::shared_ptr<DisplayCache> &cache);
 	};
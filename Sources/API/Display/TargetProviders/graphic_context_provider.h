@@ -36,6 +36,7 @@
 #include "../../Core/Math/mat4.h"
 #include "../../Core/Signals/signal.h"
 #include "../../Core/System/disposable_object.h"
+#include "timer_query_provider.h"
 
 namespace clan
 {
@@ -144,6 +145,14 @@ namespace clan
 		/// \brief Allocate occlusion query provider of this gc.
 		virtual std::unique_ptr<OcclusionQueryProvider> alloc_occlusion_query() = 0;
 
+		/// \brief Allocate timer query provider of this gc.
+		///
+		/// Returns null if the target does not support timer queries.
+		virtual std::unique_ptr<TimerQueryProvider> alloc_timer_query() { return nullptr; }
+
+		/// \brief Returns true if alloc_timer_query() returns timer query providers.
+		virtual bool is_timer_query_supported() { return false; }
+
 		/// \brief Allocate program object provider of this gc.
 		virtual std::unique_ptr<ProgramObjectProvider> alloc_program_object() = 0;
 
@@ -335,6 +344,19 @@ namespace clan
 		virtual void set_depth_range(int viewport, float n, float f) = 0;
 
 		virtual void flush() = 0;
+
+		/// \brief Statistics accumulated for the frame currently being rendered
+		GraphicContextStatistics &get_current_statistics() { return current_statistics; }
+
+		/// \brief Statistics of the last completed frame
+		const GraphicContextStatistics &get_frame_statistics() const { return frame_statistics; }
+
+		/// \brief Ends the current statistics frame. Called when the display window is flipped.
+		void end_statistics_frame() { frame_statistics = current_statistics; current_statistics = GraphicContextStatistics(); }
+
+	private:
+		GraphicContextStatistics current_statistics;
+		GraphicContextStatistics frame_statistics;
 	};
 
 	/// \}
@@ -37,6 +37,7 @@ namespace clan
 
 	class ShaderObject;
 	class UniformBuffer;
+	class DataBuffer;
 
 	/// \brief Program Object provider.
 	class ProgramObjectProvider
@@ -118,6 +119,21 @@ namespace clan
 		virtual void set_uniform_buffer_index(int block_index, int bind_index) = 0;
 
 		virtual void set_storage_buffer_index(int buffer_index, int bind_unit_index) = 0;
+
+		/// \brief Returns a string identifying the driver that produces program binaries.
+		/** <p>An empty string means program binaries are not supported.</p>*/
+		virtual std::string get_binary_driver_id() const { return std::string(); }
+
+		/// \brief Hint that the program binary will be retrieved after linking.
+		/** <p>This function must be called before linking.</p>*/
+		virtual void set_binary_retrievable_hint() { }
+
+		/// \brief Retrieves the binary of a linked program.
+		virtual bool get_program_binary(unsigned int &out_format, DataBuffer &out_binary) const { return false; }
+
+		/// \brief Replaces linking by loading a program binary.
+		/** <p>Returns false if the driver rejected the binary.</p>*/
+		virtual bool load_program_binary(unsigned int format, const DataBuffer &binary) { return false; }
 	};
 
 	/// \}
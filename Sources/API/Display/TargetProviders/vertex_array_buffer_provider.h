@@ -61,6 +61,21 @@ namespace clan
 
 		/// \brief Copies data to transfer buffer
 		virtual void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) = 0;
+
+		/// \brief Returns a pointer for writing vertices directly into a stream_draw buffer
+		///
+		/// Waits until the GPU has finished drawing from the data submitted before the last fence_stream() call.
+		/// Returns nullptr if the target cannot keep the buffer mapped while drawing from it.
+		virtual void *map_stream(GraphicContext &gc) { return nullptr; }
+
+		/// \brief Makes streamed vertices available to the GPU, replacing the previous contents of the buffer
+		///
+		/// \param data = Vertices to upload, or the pointer returned by map_stream()
+		/// \param size = Size of the data in bytes
+		virtual void upload_stream(GraphicContext &gc, const void *data, int size) { upload_data(gc, 0, data, size); }
+
+		/// \brief Marks the end of the draw commands using the streamed vertices
+		virtual void fence_stream(GraphicContext &gc) { }
 	};
 
 	/// \}
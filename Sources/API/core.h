@@ -69,6 +69,7 @@
 #include "Core/System/service.h"
 #include "Core/System/thread_local_storage.h"
 #include "Core/System/system.h"
+#include "Core/System/cpu_features.h"
 #include "Core/System/registry_key.h"
 #include "Core/System/userdata.h"
 #include "Core/System/game_time.h"
@@ -130,7 +131,10 @@
 #include "Core/Math/big_int.h"
 #include "Core/Math/frustum_planes.h"
 #include "Core/Math/intersection_test.h"
+#include "Core/Math/batch_math.h"
 #include "Core/Math/aabb.h"
+#include "Core/Math/aabb_tree.h"
+#include "Core/Math/loose_quadtree.h"
 #include "Core/Math/obb.h"
 #include "Core/Math/easing.h"
 #include "Core/Crypto/random.h"
@@ -149,6 +153,12 @@
 #include "Core/Crypto/aes192_decrypt.h"
 #include "Core/Crypto/aes256_encrypt.h"
 #include "Core/Crypto/aes256_decrypt.h"
+#include "Core/Crypto/aes128_ctr.h"
+#include "Core/Crypto/aes192_ctr.h"
+#include "Core/Crypto/aes256_ctr.h"
+#include "Core/Crypto/aes128_gcm.h"
+#include "Core/Crypto/aes192_gcm.h"
+#include "Core/Crypto/aes256_gcm.h"
 #include "Core/Crypto/rsa.h"
 #include "Core/Crypto/tls_client.h"
 #include "Core/Math/size.h"
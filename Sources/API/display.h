@@ -52,6 +52,7 @@
 #include "Display/2D/brush.h"
 #include "Display/2D/subtexture.h"
 #include "Display/2D/texture_group.h"
+#include "Display/2D/sprite_sheet_builder.h"
 #include "Display/2D/span_layout.h"
 #include "Display/System/run_loop.h"
 #include "Display/System/timer.h"
@@ -61,6 +62,7 @@
 #include "Display/Font/font_description.h"
 #include "Display/Font/font_metrics.h"
 #include "Display/Font/glyph_metrics.h"
+#include "Display/Font/glyph_run.h"
 #include "Display/Image/pixel_buffer.h"
 #include "Display/Image/pixel_buffer_lock.h"
 #include "Display/Image/pixel_buffer_help.h"
@@ -89,6 +91,9 @@
 #include "Display/Render/frame_buffer.h"
 #include "Display/Render/graphic_context.h"
 #include "Display/Render/occlusion_query.h"
+#include "Display/Render/timer_query.h"
+#include "Display/Render/frame_profiler.h"
+#include "Display/Render/async_texture_loader.h"
 #include "Display/Render/primitives_array.h"
 #include "Display/Render/program_object.h"
 #include "Display/Render/uniform_buffer.h"
@@ -122,6 +127,7 @@
 #include "Display/TargetProviders/graphic_context_provider.h"
 #include "Display/TargetProviders/input_device_provider.h"
 #include "Display/TargetProviders/occlusion_query_provider.h"
+#include "Display/TargetProviders/timer_query_provider.h"
 #include "Display/TargetProviders/program_object_provider.h"
 #include "Display/TargetProviders/render_buffer_provider.h"
 #include "Display/TargetProviders/shader_object_provider.h"
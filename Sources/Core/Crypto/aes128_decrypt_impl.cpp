@@ -56,10 +56,10 @@ namespace clan
 
 	void AES128_Decrypt_Impl::set_iv(const unsigned char iv[16])
 	{
-		initialisation_vector_1 = get_word(iv);
-		initialisation_vector_2 = get_word(iv + 4);
-		initialisation_vector_3 = get_word(iv + 8);
-		initialisation_vector_4 = get_word(iv + 12);
+		initialisation_vector[0] = get_word(iv);
+		initialisation_vector[1] = get_word(iv + 4);
+		initialisation_vector[2] = get_word(iv + 8);
+		initialisation_vector[3] = get_word(iv + 12);
 
 		initialisation_vector_set = true;
 	}
@@ -92,6 +92,20 @@ namespace clan
 		int pos = 0;
 		while (pos < size)
 		{
+			if (chunk_filled == 0)
+			{
+				// Decrypt whole blocks straight from the input, keeping the last block for calculate() when padding is enabled
+				int num_blocks = (size - pos) / aes128_block_size_bytes;
+				if (padding_enabled && pos + num_blocks * aes128_block_size_bytes == size)
+					num_blocks--;
+				if (num_blocks > 0)
+				{
+					process_blocks(data + pos, num_blocks);
+					pos += num_blocks * aes128_block_size_bytes;
+					continue;
+				}
+			}
+
 			int data_left = size - pos;
 			int buffer_space = aes128_block_size_bytes - chunk_filled;
 			int data_used = min(buffer_space, data_left);
@@ -102,7 +116,7 @@ namespace clan
 			{
 				if ((!padding_enabled) || (pos < size))	// Do not process chunk on the last block if padding is enabled, as calculate() must process it
 				{
-					process_chunk();
+					process_blocks(chunk, 1);
 					chunk_filled = 0;
 				}
 			}
@@ -121,7 +135,7 @@ namespace clan
 		{
 			if (chunk_filled == aes128_block_size_bytes)
 			{
-				process_chunk();
+				process_blocks(chunk, 1);
 				chunk_filled = 0;
 				int current_size = databuffer.get_size();
 				if (current_size > 0)
@@ -178,88 +192,9 @@ namespace clan
 
 	}
 
-	void AES128_Decrypt_Impl::process_chunk()
+	void AES128_Decrypt_Impl::process_blocks(const unsigned char *input, int num_blocks)
 	{
-		const uint32_t *key_expanded_ptr = key_expanded;
-
-		uint32_t chunk1 = get_word(chunk);
-		uint32_t chunk2 = get_word(chunk + 4);
-		uint32_t chunk3 = get_word(chunk + 8);
-		uint32_t chunk4 = get_word(chunk + 12);
-
-		uint32_t s0 = chunk1 ^ key_expanded_ptr[0];
-		uint32_t s1 = chunk2 ^ key_expanded_ptr[1];
-		uint32_t s2 = chunk3 ^ key_expanded_ptr[2];
-		uint32_t s3 = chunk4 ^ key_expanded_ptr[3];
-
-		uint32_t t0;
-		uint32_t t1;
-		uint32_t t2;
-		uint32_t t3;
-
-		// Round 1
-		t0 = table_d0[s0 >> 24] ^ table_d1[(s3 >> 16) & 0xff] ^ table_d2[(s2 >> 8) & 0xff] ^ table_d3[s1 & 0xff] ^ key_expanded_ptr[4];
-		t1 = table_d0[s1 >> 24] ^ table_d1[(s0 >> 16) & 0xff] ^ table_d2[(s3 >> 8) & 0xff] ^ table_d3[s2 & 0xff] ^ key_expanded_ptr[5];
-		t2 = table_d0[s2 >> 24] ^ table_d1[(s1 >> 16) & 0xff] ^ table_d2[(s0 >> 8) & 0xff] ^ table_d3[s3 & 0xff] ^ key_expanded_ptr[6];
-		t3 = table_d0[s3 >> 24] ^ table_d1[(s2 >> 16) & 0xff] ^ table_d2[(s1 >> 8) & 0xff] ^ table_d3[s0 & 0xff] ^ key_expanded_ptr[7];
-		// Round 2
-		s0 = table_d0[t0 >> 24] ^ table_d1[(t3 >> 16) & 0xff] ^ table_d2[(t2 >> 8) & 0xff] ^ table_d3[t1 & 0xff] ^ key_expanded_ptr[8];
-		s1 = table_d0[t1 >> 24] ^ table_d1[(t0 >> 16) & 0xff] ^ table_d2[(t3 >> 8) & 0xff] ^ table_d3[t2 & 0xff] ^ key_expanded_ptr[9];
-		s2 = table_d0[t2 >> 24] ^ table_d1[(t1 >> 16) & 0xff] ^ table_d2[(t0 >> 8) & 0xff] ^ table_d3[t3 & 0xff] ^ key_expanded_ptr[10];
-		s3 = table_d0[t3 >> 24] ^ table_d1[(t2 >> 16) & 0xff] ^ table_d2[(t1 >> 8) & 0xff] ^ table_d3[t0 & 0xff] ^ key_expanded_ptr[11];
-		// Round 3
-		t0 = table_d0[s0 >> 24] ^ table_d1[(s3 >> 16) & 0xff] ^ table_d2[(s2 >> 8) & 0xff] ^ table_d3[s1 & 0xff] ^ key_expanded_ptr[12];
-		t1 = table_d0[s1 >> 24] ^ table_d1[(s0 >> 16) & 0xff] ^ table_d2[(s3 >> 8) & 0xff] ^ table_d3[s2 & 0xff] ^ key_expanded_ptr[13];
-		t2 = table_d0[s2 >> 24] ^ table_d1[(s1 >> 16) & 0xff] ^ table_d2[(s0 >> 8) & 0xff] ^ table_d3[s3 & 0xff] ^ key_expanded_ptr[14];
-		t3 = table_d0[s3 >> 24] ^ table_d1[(s2 >> 16) & 0xff] ^ table_d2[(s1 >> 8) & 0xff] ^ table_d3[s0 & 0xff] ^ key_expanded_ptr[15];
-		// Round 4
-		s0 = table_d0[t0 >> 24] ^ table_d1[(t3 >> 16) & 0xff] ^ table_d2[(t2 >> 8) & 0xff] ^ table_d3[t1 & 0xff] ^ key_expanded_ptr[16];
-		s1 = table_d0[t1 >> 24] ^ table_d1[(t0 >> 16) & 0xff] ^ table_d2[(t3 >> 8) & 0xff] ^ table_d3[t2 & 0xff] ^ key_expanded_ptr[17];
-		s2 = table_d0[t2 >> 24] ^ table_d1[(t1 >> 16) & 0xff] ^ table_d2[(t0 >> 8) & 0xff] ^ table_d3[t3 & 0xff] ^ key_expanded_ptr[18];
-		s3 = table_d0[t3 >> 24] ^ table_d1[(t2 >> 16) & 0xff] ^ table_d2[(t1 >> 8) & 0xff] ^ table_d3[t0 & 0xff] ^ key_expanded_ptr[19];
-		// Round 5
-		t0 = table_d0[s0 >> 24] ^ table_d1[(s3 >> 16) & 0xff] ^ table_d2[(s2 >> 8) & 0xff] ^ table_d3[s1 & 0xff] ^ key_expanded_ptr[20];
-		t1 = table_d0[s1 >> 24] ^ table_d1[(s0 >> 16) & 0xff] ^ table_d2[(s3 >> 8) & 0xff] ^ table_d3[s2 & 0xff] ^ key_expanded_ptr[21];
-		t2 = table_d0[s2 >> 24] ^ table_d1[(s1 >> 16) & 0xff] ^ table_d2[(s0 >> 8) & 0xff] ^ table_d3[s3 & 0xff] ^ key_expanded_ptr[22];
-		t3 = table_d0[s3 >> 24] ^ table_d1[(s2 >> 16) & 0xff] ^ table_d2[(s1 >> 8) & 0xff] ^ table_d3[s0 & 0xff] ^ key_expanded_ptr[23];
-		// Round 6
-		s0 = table_d0[t0 >> 24] ^ table_d1[(t3 >> 16) & 0xff] ^ table_d2[(t2 >> 8) & 0xff] ^ table_d3[t1 & 0xff] ^ key_expanded_ptr[24];
-		s1 = table_d0[t1 >> 24] ^ table_d1[(t0 >> 16) & 0xff] ^ table_d2[(t3 >> 8) & 0xff] ^ table_d3[t2 & 0xff] ^ key_expanded_ptr[25];
-		s2 = table_d0[t2 >> 24] ^ table_d1[(t1 >> 16) & 0xff] ^ table_d2[(t0 >> 8) & 0xff] ^ table_d3[t3 & 0xff] ^ key_expanded_ptr[26];
-		s3 = table_d0[t3 >> 24] ^ table_d1[(t2 >> 16) & 0xff] ^ table_d2[(t1 >> 8) & 0xff] ^ table_d3[t0 & 0xff] ^ key_expanded_ptr[27];
-		// Round 7
-		t0 = table_d0[s0 >> 24] ^ table_d1[(s3 >> 16) & 0xff] ^ table_d2[(s2 >> 8) & 0xff] ^ table_d3[s1 & 0xff] ^ key_expanded_ptr[28];
-		t1 = table_d0[s1 >> 24] ^ table_d1[(s0 >> 16) & 0xff] ^ table_d2[(s3 >> 8) & 0xff] ^ table_d3[s2 & 0xff] ^ key_expanded_ptr[29];
-		t2 = table_d0[s2 >> 24] ^ table_d1[(s1 >> 16) & 0xff] ^ table_d2[(s0 >> 8) & 0xff] ^ table_d3[s3 & 0xff] ^ key_expanded_ptr[30];
-		t3 = table_d0[s3 >> 24] ^ table_d1[(s2 >> 16) & 0xff] ^ table_d2[(s1 >> 8) & 0xff] ^ table_d3[s0 & 0xff] ^ key_expanded_ptr[31];
-		// Round 8
-		s0 = table_d0[t0 >> 24] ^ table_d1[(t3 >> 16) & 0xff] ^ table_d2[(t2 >> 8) & 0xff] ^ table_d3[t1 & 0xff] ^ key_expanded_ptr[32];
-		s1 = table_d0[t1 >> 24] ^ table_d1[(t0 >> 16) & 0xff] ^ table_d2[(t3 >> 8) & 0xff] ^ table_d3[t2 & 0xff] ^ key_expanded_ptr[33];
-		s2 = table_d0[t2 >> 24] ^ table_d1[(t1 >> 16) & 0xff] ^ table_d2[(t0 >> 8) & 0xff] ^ table_d3[t3 & 0xff] ^ key_expanded_ptr[34];
-		s3 = table_d0[t3 >> 24] ^ table_d1[(t2 >> 16) & 0xff] ^ table_d2[(t1 >> 8) & 0xff] ^ table_d3[t0 & 0xff] ^ key_expanded_ptr[35];
-		// Round 9
-		t0 = table_d0[s0 >> 24] ^ table_d1[(s3 >> 16) & 0xff] ^ table_d2[(s2 >> 8) & 0xff] ^ table_d3[s1 & 0xff] ^ key_expanded_ptr[36];
-		t1 = table_d0[s1 >> 24] ^ table_d1[(s0 >> 16) & 0xff] ^ table_d2[(s3 >> 8) & 0xff] ^ table_d3[s2 & 0xff] ^ key_expanded_ptr[37];
-		t2 = table_d0[s2 >> 24] ^ table_d1[(s1 >> 16) & 0xff] ^ table_d2[(s0 >> 8) & 0xff] ^ table_d3[s3 & 0xff] ^ key_expanded_ptr[38];
-		t3 = table_d0[s3 >> 24] ^ table_d1[(s2 >> 16) & 0xff] ^ table_d2[(s1 >> 8) & 0xff] ^ table_d3[s0 & 0xff] ^ key_expanded_ptr[39];
-
-		key_expanded_ptr += aes128_num_rounds_nr * 4;
-
-		// Apply last round
-		s0 = (sbox_inverse_substitution_values[(t0 >> 24)] & 0xff000000) ^ (sbox_inverse_substitution_values[(t3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_inverse_substitution_values[(t2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_inverse_substitution_values[(t1)& 0xff] & 0x000000ff) ^ key_expanded_ptr[0];
-		s1 = (sbox_inverse_substitution_values[(t1 >> 24)] & 0xff000000) ^ (sbox_inverse_substitution_values[(t0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_inverse_substitution_values[(t3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_inverse_substitution_values[(t2)& 0xff] & 0x000000ff) ^ key_expanded_ptr[1];
-		s2 = (sbox_inverse_substitution_values[(t2 >> 24)] & 0xff000000) ^ (sbox_inverse_substitution_values[(t1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_inverse_substitution_values[(t0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_inverse_substitution_values[(t3)& 0xff] & 0x000000ff) ^ key_expanded_ptr[2];
-		s3 = (sbox_inverse_substitution_values[(t3 >> 24)] & 0xff000000) ^ (sbox_inverse_substitution_values[(t2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_inverse_substitution_values[(t1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_inverse_substitution_values[(t0)& 0xff] & 0x000000ff) ^ key_expanded_ptr[3];
-
-		s0 ^= initialisation_vector_1;
-		s1 ^= initialisation_vector_2;
-		s2 ^= initialisation_vector_3;
-		s3 ^= initialisation_vector_4;
-		store_block(s0, s1, s2, s3, databuffer);
-
-		initialisation_vector_1 = chunk1;
-		initialisation_vector_2 = chunk2;
-		initialisation_vector_3 = chunk3;
-		initialisation_vector_4 = chunk4;
+		unsigned char *output = append_data(databuffer, num_blocks * aes128_block_size_bytes);
+		decrypt_cbc(key_expanded, aes128_num_rounds_nr, initialisation_vector, input, output, num_blocks);
 	}
 }
@@ -56,10 +56,10 @@ namespace clan
 
 	void AES128_Encrypt_Impl::set_iv(const unsigned char iv[16])
 	{
-		initialisation_vector_1 = get_word(iv);
-		initialisation_vector_2 = get_word(iv + 4);
-		initialisation_vector_3 = get_word(iv + 8);
-		initialisation_vector_4 = get_word(iv + 12);
+		initialisation_vector[0] = get_word(iv);
+		initialisation_vector[1] = get_word(iv + 4);
+		initialisation_vector[2] = get_word(iv + 8);
+		initialisation_vector[3] = get_word(iv + 12);
 
 		initialisation_vector_set = true;
 	}
@@ -94,6 +94,18 @@ namespace clan
 		int pos = 0;
 		while (pos < size)
 		{
+			if (chunk_filled == 0)
+			{
+				// Encrypt whole blocks straight from the input
+				int num_blocks = (size - pos) / aes128_block_size_bytes;
+				if (num_blocks > 0)
+				{
+					process_blocks(data + pos, num_blocks);
+					pos += num_blocks * aes128_block_size_bytes;
+					continue;
+				}
+			}
+
 			int data_left = size - pos;
 			int buffer_space = aes128_block_size_bytes - chunk_filled;
 			int data_used = min(buffer_space, data_left);
@@ -102,7 +114,7 @@ namespace clan
 			pos += data_used;
 			if (chunk_filled == aes128_block_size_bytes)
 			{
-				process_chunk();
+				process_blocks(chunk, 1);
 				chunk_filled = 0;
 			}
 		}
@@ -121,7 +133,7 @@ namespace clan
 				// PKCS#7
 				unsigned char pad_size = aes128_block_size_bytes - chunk_filled;
 				memset(chunk + chunk_filled, pad_size, pad_size);
-				process_chunk();
+				process_blocks(chunk, 1);
 				chunk_filled = 0;
 			}
 			else
@@ -146,87 +158,9 @@ namespace clan
 		memset(key_expanded, 0, sizeof(key_expanded));	// Remove the key from memory
 	}
 
-	void AES128_Encrypt_Impl::process_chunk()
+	void AES128_Encrypt_Impl::process_blocks(const unsigned char *input, int num_blocks)
 	{
-		const uint32_t *key_expanded_ptr = key_expanded;
-
-		/* Electronic Codebook Mode
-		uint32_t s0 = get_word(chunk) ^ key_expanded_ptr[0];
-		uint32_t s1 = get_word(chunk + 4) ^ key_expanded_ptr[1];
-		uint32_t s2 = get_word(chunk + 8) ^ key_expanded_ptr[2];
-		uint32_t s3 = get_word(chunk + 12) ^ key_expanded_ptr[3];
-		*/
-
-		// Cipher Block Chaining Mode
-		uint32_t s0 = initialisation_vector_1 ^ get_word(chunk) ^ key_expanded_ptr[0];
-		uint32_t s1 = initialisation_vector_2 ^ get_word(chunk + 4) ^ key_expanded_ptr[1];
-		uint32_t s2 = initialisation_vector_3 ^ get_word(chunk + 8) ^ key_expanded_ptr[2];
-		uint32_t s3 = initialisation_vector_4 ^ get_word(chunk + 12) ^ key_expanded_ptr[3];
-
-		uint32_t t0;
-		uint32_t t1;
-		uint32_t t2;
-		uint32_t t3;
-
-		// round 1
-		t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[4];
-		t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[5];
-		t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[6];
-		t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[7];
-		// round 2
-		s0 = table_e0[t0 >> 24] ^ table_e1[(t1 >> 16) & 0xff] ^ table_e2[(t2 >> 8) & 0xff] ^ table_e3[t3 & 0xff] ^ key_expanded_ptr[8];
-		s1 = table_e0[t1 >> 24] ^ table_e1[(t2 >> 16) & 0xff] ^ table_e2[(t3 >> 8) & 0xff] ^ table_e3[t0 & 0xff] ^ key_expanded_ptr[9];
-		s2 = table_e0[t2 >> 24] ^ table_e1[(t3 >> 16) & 0xff] ^ table_e2[(t0 >> 8) & 0xff] ^ table_e3[t1 & 0xff] ^ key_expanded_ptr[10];
-		s3 = table_e0[t3 >> 24] ^ table_e1[(t0 >> 16) & 0xff] ^ table_e2[(t1 >> 8) & 0xff] ^ table_e3[t2 & 0xff] ^ key_expanded_ptr[11];
-		// round 3
-		t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[12];
-		t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[13];
-		t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[14];
-		t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[15];
-		// round 4
-		s0 = table_e0[t0 >> 24] ^ table_e1[(t1 >> 16) & 0xff] ^ table_e2[(t2 >> 8) & 0xff] ^ table_e3[t3 & 0xff] ^ key_expanded_ptr[16];
-		s1 = table_e0[t1 >> 24] ^ table_e1[(t2 >> 16) & 0xff] ^ table_e2[(t3 >> 8) & 0xff] ^ table_e3[t0 & 0xff] ^ key_expanded_ptr[17];
-		s2 = table_e0[t2 >> 24] ^ table_e1[(t3 >> 16) & 0xff] ^ table_e2[(t0 >> 8) & 0xff] ^ table_e3[t1 & 0xff] ^ key_expanded_ptr[18];
-		s3 = table_e0[t3 >> 24] ^ table_e1[(t0 >> 16) & 0xff] ^ table_e2[(t1 >> 8) & 0xff] ^ table_e3[t2 & 0xff] ^ key_expanded_ptr[19];
-		// round 5
-		t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[20];
-		t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[21];
-		t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[22];
-		t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[23];
-		// round 6
-		s0 = table_e0[t0 >> 24] ^ table_e1[(t1 >> 16) & 0xff] ^ table_e2[(t2 >> 8) & 0xff] ^ table_e3[t3 & 0xff] ^ key_expanded_ptr[24];
-		s1 = table_e0[t1 >> 24] ^ table_e1[(t2 >> 16) & 0xff] ^ table_e2[(t3 >> 8) & 0xff] ^ table_e3[t0 & 0xff] ^ key_expanded_ptr[25];
-		s2 = table_e0[t2 >> 24] ^ table_e1[(t3 >> 16) & 0xff] ^ table_e2[(t0 >> 8) & 0xff] ^ table_e3[t1 & 0xff] ^ key_expanded_ptr[26];
-		s3 = table_e0[t3 >> 24] ^ table_e1[(t0 >> 16) & 0xff] ^ table_e2[(t1 >> 8) & 0xff] ^ table_e3[t2 & 0xff] ^ key_expanded_ptr[27];
-		// round 7
-		t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[28];
-		t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[29];
-		t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[30];
-		t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[31];
-		// round 8
-		s0 = table_e0[t0 >> 24] ^ table_e1[(t1 >> 16) & 0xff] ^ table_e2[(t2 >> 8) & 0xff] ^ table_e3[t3 & 0xff] ^ key_expanded_ptr[32];
-		s1 = table_e0[t1 >> 24] ^ table_e1[(t2 >> 16) & 0xff] ^ table_e2[(t3 >> 8) & 0xff] ^ table_e3[t0 & 0xff] ^ key_expanded_ptr[33];
-		s2 = table_e0[t2 >> 24] ^ table_e1[(t3 >> 16) & 0xff] ^ table_e2[(t0 >> 8) & 0xff] ^ table_e3[t1 & 0xff] ^ key_expanded_ptr[34];
-		s3 = table_e0[t3 >> 24] ^ table_e1[(t0 >> 16) & 0xff] ^ table_e2[(t1 >> 8) & 0xff] ^ table_e3[t2 & 0xff] ^ key_expanded_ptr[35];
-		// round 9
-		t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[36];
-		t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[37];
-		t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[38];
-		t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[39];
-
-		key_expanded_ptr += aes128_num_rounds_nr * 4;
-
-		// Apply last round
-		s0 = (sbox_substitution_values[(t0 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(t1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(t2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(t3)& 0xff] & 0x000000ff) ^ key_expanded_ptr[0];
-		s1 = (sbox_substitution_values[(t1 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(t2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(t3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(t0)& 0xff] & 0x000000ff) ^ key_expanded_ptr[1];
-		s2 = (sbox_substitution_values[(t2 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(t3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(t0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(t1)& 0xff] & 0x000000ff) ^ key_expanded_ptr[2];
-		s3 = (sbox_substitution_values[(t3 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(t0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(t1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(t2)& 0xff] & 0x000000ff) ^ key_expanded_ptr[3];
-
-		store_block(s0, s1, s2, s3, databuffer);
-
-		initialisation_vector_1 = s0;
-		initialisation_vector_2 = s1;
-		initialisation_vector_3 = s2;
-		initialisation_vector_4 = s3;
+		unsigned char *output = append_data(databuffer, num_blocks * aes128_block_size_bytes);
+		encrypt_cbc(key_expanded, aes128_num_rounds_nr, initialisation_vector, input, output, num_blocks);
 	}
 }
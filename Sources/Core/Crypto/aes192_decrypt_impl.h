@@ -83,15 +83,12 @@ namespace clan
 		bool calculate();
 
 	private:
-		void process_chunk();
+		void process_blocks(const unsigned char *input, int num_blocks);
 
 		uint32_t key_expanded[aes192_nb_mult_nr_plus1];
 
 		unsigned char chunk[aes192_block_size_bytes];
-		uint32_t initialisation_vector_1;
-		uint32_t initialisation_vector_2;
-		uint32_t initialisation_vector_3;
-		uint32_t initialisation_vector_4;
+		uint32_t initialisation_vector[4];
 
 		int chunk_filled;
 
@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Crypto/aes192_gcm.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_gcm_impl.h"
+
+namespace clan
+{
+	AES192_GCM::AES192_GCM()
+		: impl(std::make_shared<AES_GCM_Impl>(key_size))
+	{
+	}
+
+	DataBuffer AES192_GCM::get_data() const
+	{
+		return impl->get_data();
+	}
+
+	void AES192_GCM::reset()
+	{
+		impl->reset();
+	}
+
+	void AES192_GCM::set_iv(const unsigned char *iv, int size)
+	{
+		impl->set_iv(iv, size);
+	}
+
+	void AES192_GCM::set_key(const unsigned char key[key_size])
+	{
+		impl->set_key(key);
+	}
+
+	void AES192_GCM::add_aad(const void *data, int size)
+	{
+		impl->add_aad(data, size);
+	}
+
+	void AES192_GCM::add_aad(const DataBuffer &data)
+	{
+		add_aad(data.get_data(), data.get_size());
+	}
+
+	void AES192_GCM::encrypt(const void *data, int size)
+	{
+		impl->add(data, size, false);
+	}
+
+	void AES192_GCM::encrypt(const DataBuffer &data)
+	{
+		encrypt(data.get_data(), data.get_size());
+	}
+
+	void AES192_GCM::decrypt(const void *data, int size)
+	{
+		impl->add(data, size, true);
+	}
+
+	void AES192_GCM::decrypt(const DataBuffer &data)
+	{
+		decrypt(data.get_data(), data.get_size());
+	}
+
+	void AES192_GCM::calculate()
+	{
+		impl->calculate();
+	}
+
+	void AES192_GCM::get_tag(unsigned char out_tag[tag_size]) const
+	{
+		impl->get_tag(out_tag);
+	}
+
+	bool AES192_GCM::verify_tag(const void *tag, int size) const
+	{
+		return impl->verify_tag(tag, size);
+	}
+}
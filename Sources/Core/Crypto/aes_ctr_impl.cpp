@@ -0,0 +1,138 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "aes_ctr_impl.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/Text/string_format.h"
+
+#ifndef WIN32
+#include <cstring>
+#endif
+
+namespace clan
+{
+	AES_CTR_Impl::AES_CTR_Impl(int key_length_bytes) : key_length_bytes(key_length_bytes), initialisation_vector_set(false), cipher_key_set(false)
+	{
+		switch (key_length_bytes)
+		{
+		case aes128_key_length_bytes: num_rounds = aes128_num_rounds_nr; break;
+		case aes192_key_length_bytes: num_rounds = aes192_num_rounds_nr; break;
+		case aes256_key_length_bytes: num_rounds = aes256_num_rounds_nr; break;
+		default: throw Exception("Unsupported AES key length");
+		}
+		reset();
+	}
+
+	DataBuffer AES_CTR_Impl::get_data() const
+	{
+		return databuffer;
+	}
+
+	void AES_CTR_Impl::reset()
+	{
+		calculated = false;
+		memset(keystream, 0, sizeof(keystream));
+		keystream_used = aes128_block_size_bytes;
+		databuffer.set_size(0);
+	}
+
+	void AES_CTR_Impl::set_iv(const unsigned char iv[16])
+	{
+		memcpy(counter, iv, aes128_block_size_bytes);
+		keystream_used = aes128_block_size_bytes;
+		initialisation_vector_set = true;
+	}
+
+	void AES_CTR_Impl::set_key(const unsigned char *key)
+	{
+		cipher_key_set = true;
+		switch (key_length_bytes)
+		{
+		case aes128_key_length_bytes: extract_encrypt_key128(key, key_expanded); break;
+		case aes192_key_length_bytes: extract_encrypt_key192(key, key_expanded); break;
+		default: extract_encrypt_key256(key, key_expanded); break;
+		}
+	}
+
+	void AES_CTR_Impl::add(const void *_data, int size)
+	{
+		if (calculated)
+			reset();
+
+		if (!initialisation_vector_set)
+			throw Exception(string_format("AES-%1 initialisation vector has not been set", key_length_bytes * 8));
+
+		if (!cipher_key_set)
+			throw Exception(string_format("AES-%1 cipher key has not been set", key_length_bytes * 8));
+
+		const unsigned char *data = (const unsigned char *)_data;
+		unsigned char *output = append_data(databuffer, size);
+		int pos = 0;
+
+		// Use up the keystream left over from the previous call
+		while (pos < size && keystream_used < aes128_block_size_bytes)
+		{
+			output[pos] = data[pos] ^ keystream[keystream_used++];
+			pos++;
+		}
+
+		int num_blocks = (size - pos) / aes128_block_size_bytes;
+		if (num_blocks > 0)
+		{
+			crypt_ctr(key_expanded, num_rounds, counter, data + pos, output + pos, num_blocks);
+			pos += num_blocks * aes128_block_size_bytes;
+		}
+
+		if (pos < size)
+		{
+			unsigned char zeros[aes128_block_size_bytes] = { 0 };
+			crypt_ctr(key_expanded, num_rounds, counter, zeros, keystream, 1);
+			keystream_used = 0;
+			while (pos < size)
+			{
+				output[pos] = data[pos] ^ keystream[keystream_used++];
+				pos++;
+			}
+		}
+	}
+
+	void AES_CTR_Impl::calculate()
+	{
+		if (calculated)
+			reset();
+
+		calculated = true;
+		initialisation_vector_set = false;	// Force to reset after each call
+		cipher_key_set = false;				// Force to reset after each call (to avoid keeping the cipher key in memory)
+		memset(key_expanded, 0, sizeof(key_expanded));
+		memset(keystream, 0, sizeof(keystream));
+		keystream_used = aes128_block_size_bytes;
+	}
+}
@@ -0,0 +1,73 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_impl.h"
+
+namespace clan
+{
+	/// \brief Counter mode shared by AES128_CTR, AES192_CTR and AES256_CTR
+	class AES_CTR_Impl : public AES_Impl
+	{
+	public:
+		AES_CTR_Impl(int key_length_bytes);
+
+		DataBuffer get_data() const;
+
+		void reset();
+
+		void set_iv(const unsigned char iv[16]);
+		void set_key(const unsigned char *key);
+
+		void add(const void *data, int size);
+
+		void calculate();
+
+	private:
+		int key_length_bytes;
+		int num_rounds;
+
+		uint32_t key_expanded[aes256_nb_mult_nr_plus1];
+
+		unsigned char counter[aes128_block_size_bytes];
+
+		/// \brief Keystream left over from the last block when the data was not a multiple of the block size
+		unsigned char keystream[aes128_block_size_bytes];
+		int keystream_used;
+
+		bool initialisation_vector_set;
+		bool cipher_key_set;
+		bool calculated;
+
+		DataBuffer databuffer;
+	};
+}
@@ -0,0 +1,568 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "aes_gcm_impl.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/cpu_features.h"
+#include "API/Core/Text/string_format.h"
+
+#ifndef WIN32
+#include <cstring>
+#endif
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_GHASH_PCLMUL
+#if defined(__GNUC__)
+#define CL_TARGET_PCLMUL __attribute__((target("pclmul,ssse3")))
+#else
+#define CL_TARGET_PCLMUL
+#endif
+#endif
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		typedef void(*GHashInitKernel)(const unsigned char h[16], AES_GHashKey &key);
+		typedef void(*GHashKernel)(const AES_GHashKey &key, unsigned char state[16], const unsigned char *data, int num_blocks);
+
+		inline uint64_t get_uint64(const unsigned char *data)
+		{
+			return (((uint64_t)AES_Impl::get_word(data)) << 32) | AES_Impl::get_word(data + 4);
+		}
+
+		inline void put_uint64(uint64_t value, unsigned char *data)
+		{
+			AES_Impl::put_word((uint32_t)(value >> 32), data);
+			AES_Impl::put_word((uint32_t)value, data + 4);
+		}
+
+		// Shoup's method with 4-bit tables. The multiples of H are built by halving H in GF(2^128).
+
+		void ghash_init_tables(const unsigned char h[16], AES_GHashKey &key)
+		{
+			uint64_t vh = get_uint64(h);
+			uint64_t vl = get_uint64(h + 8);
+
+			key.table_high[0] = 0;
+			key.table_low[0] = 0;
+			key.table_high[8] = vh;
+			key.table_low[8] = vl;
+
+			for (int i = 4; i > 0; i >>= 1)
+			{
+				uint64_t reduce = (vl & 1) * 0xe100000000000000ULL;
+				vl = (vh << 63) | (vl >> 1);
+				vh = (vh >> 1) ^ reduce;
+				key.table_high[i] = vh;
+				key.table_low[i] = vl;
+			}
+
+			for (int i = 2; i <= 8; i *= 2)
+			{
+				for (int j = 1; j < i; j++)
+				{
+					key.table_high[i + j] = key.table_high[i] ^ key.table_high[j];
+					key.table_low[i + j] = key.table_low[i] ^ key.table_low[j];
+				}
+			}
+		}
+
+		// Reduction of the four bits shifted out of the low end
+		const uint64_t ghash_last4[16] =
+		{
+			0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+			0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+		};
+
+		void ghash_tables(const AES_GHashKey &key, unsigned char state[16], const unsigned char *data, int num_blocks)
+		{
+			unsigned char x[16];
+			for (int block = 0; block < num_blocks; block++, data += 16)
+			{
+				for (int i = 0; i < 16; i++)
+					x[i] = state[i] ^ data[i];
+
+				int nibble = x[15] & 0xf;
+				uint64_t zh = key.table_high[nibble];
+				uint64_t zl = key.table_low[nibble];
+
+				for (int i = 15; i >= 0; i--)
+				{
+					if (i != 15)
+					{
+						nibble = x[i] & 0xf;
+						int rem = (int)(zl & 0xf);
+						zl = (zh << 60) | (zl >> 4);
+						zh = (zh >> 4) ^ (ghash_last4[rem] << 48);
+						zh ^= key.table_high[nibble];
+						zl ^= key.table_low[nibble];
+					}
+
+					nibble = x[i] >> 4;
+					int rem = (int)(zl & 0xf);
+					zl = (zh << 60) | (zl >> 4);
+					zh = (zh >> 4) ^ (ghash_last4[rem] << 48);
+					zh ^= key.table_high[nibble];
+					zl ^= key.table_low[nibble];
+				}
+
+				put_uint64(zh, state);
+				put_uint64(zl, state + 8);
+			}
+		}
+
+#ifdef CL_GHASH_PCLMUL
+
+		// Carry-less multiplication on byte reversed blocks, following the Intel GCM white paper.
+		// The 256 bit products are kept apart from the reduction so several of them can be summed first.
+
+		CL_TARGET_PCLMUL inline __m128i byte_reverse_mask()
+		{
+			return _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		}
+
+		CL_TARGET_PCLMUL inline void clmul(__m128i a, __m128i b, __m128i &low, __m128i &high)
+		{
+			__m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+			__m128i t1 = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+			__m128i t2 = _mm_clmulepi64_si128(a, b, 0x11);
+			low = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+			high = _mm_xor_si128(t2, _mm_srli_si128(t1, 8));
+		}
+
+		CL_TARGET_PCLMUL inline __m128i reduce(__m128i low, __m128i high)
+		{
+			// Shift the product left by one bit to account for the reflected bit order
+			__m128i carry_low = _mm_srli_epi32(low, 31);
+			__m128i carry_high = _mm_srli_epi32(high, 31);
+			low = _mm_slli_epi32(low, 1);
+			high = _mm_slli_epi32(high, 1);
+			__m128i carry_across = _mm_srli_si128(carry_low, 12);
+			carry_high = _mm_slli_si128(carry_high, 4);
+			carry_low = _mm_slli_si128(carry_low, 4);
+			low = _mm_or_si128(low, carry_low);
+			high = _mm_or_si128(high, _mm_or_si128(carry_high, carry_across));
+
+			// Reduce modulo x^128 + x^7 + x^2 + x + 1
+			__m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+			__m128i a_high = _mm_srli_si128(a, 4);
+			low = _mm_xor_si128(low, _mm_slli_si128(a, 12));
+
+			__m128i b = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+			b = _mm_xor_si128(b, a_high);
+			return _mm_xor_si128(high, _mm_xor_si128(low, b));
+		}
+
+		CL_TARGET_PCLMUL inline __m128i gfmul(__m128i a, __m128i b)
+		{
+			__m128i low, high;
+			clmul(a, b, low, high);
+			return reduce(low, high);
+		}
+
+		CL_TARGET_PCLMUL void ghash_init_pclmul(const unsigned char h[16], AES_GHashKey &key)
+		{
+			ghash_init_tables(h, key);
+
+			__m128i h1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)h), byte_reverse_mask());
+			__m128i power = h1;
+			for (int i = 0; i < 4; i++)
+			{
+				_mm_storeu_si128((__m128i*)key.powers[i], power);
+				power = gfmul(power, h1);
+			}
+		}
+
+		CL_TARGET_PCLMUL void ghash_pclmul(const AES_GHashKey &key, unsigned char state[16], const unsigned char *data, int num_blocks)
+		{
+			__m128i mask = byte_reverse_mask();
+			__m128i h1 = _mm_loadu_si128((const __m128i*)key.powers[0]);
+			__m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)state), mask);
+
+			int block = 0;
+			if (num_blocks >= 4)
+			{
+				__m128i h2 = _mm_loadu_si128((const __m128i*)key.powers[1]);
+				__m128i h3 = _mm_loadu_si128((const __m128i*)key.powers[2]);
+				__m128i h4 = _mm_loadu_si128((const __m128i*)key.powers[3]);
+
+				// ((((x + d0) * H + d1) * H + d2) * H + d3) * H = (x + d0) * H^4 + d1 * H^3 + d2 * H^2 + d3 * H
+				for (; block + 4 <= num_blocks; block += 4, data += 64)
+				{
+					__m128i d0 = _mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), mask));
+					__m128i d1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), mask);
+					__m128i d2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), mask);
+					__m128i d3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), mask);
+
+					__m128i low, high, l, h;
+					clmul(d0, h4, low, high);
+					clmul(d1, h3, l, h);
+					low = _mm_xor_si128(low, l);
+					high = _mm_xor_si128(high, h);
+					clmul(d2, h2, l, h);
+					low = _mm_xor_si128(low, l);
+					high = _mm_xor_si128(high, h);
+					clmul(d3, h1, l, h);
+					low = _mm_xor_si128(low, l);
+					high = _mm_xor_si128(high, h);
+					x = reduce(low, high);
+				}
+			}
+
+			for (; block < num_blocks; block++, data += 16)
+				x = gfmul(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), mask)), h1);
+
+			_mm_storeu_si128((__m128i*)state, _mm_shuffle_epi8(x, mask));
+		}
+
+#endif
+
+		void ghash_init(const unsigned char h[16], AES_GHashKey &key)
+		{
+#ifdef CL_GHASH_PCLMUL
+			static const CPUDispatch<GHashInitKernel> kernel({ { { System::pclmul, System::ssse3 }, ghash_init_pclmul } }, ghash_init_tables);
+#else
+			static const CPUDispatch<GHashInitKernel> kernel({}, ghash_init_tables);
+#endif
+			kernel(h, key);
+		}
+
+		void ghash_blocks(const AES_GHashKey &key, unsigned char state[16], const unsigned char *data, int num_blocks)
+		{
+#ifdef CL_GHASH_PCLMUL
+			static const CPUDispatch<GHashKernel> kernel({ { { System::pclmul, System::ssse3 }, ghash_pclmul } }, ghash_tables);
+#else
+			static const CPUDispatch<GHashKernel> kernel({}, ghash_tables);
+#endif
+			kernel(key, state, data, num_blocks);
+		}
+
+		// Blocks processed per pass, so the ciphertext is still in the L1 cache when it is hashed
+		const int blocks_per_pass = 256;
+	}
+
+	AES_GCM_Impl::AES_GCM_Impl(int key_length_bytes) : key_length_bytes(key_length_bytes), cipher_key_set(false), state(state_no_iv)
+	{
+		switch (key_length_bytes)
+		{
+		case aes128_key_length_bytes: num_rounds = aes128_num_rounds_nr; break;
+		case aes192_key_length_bytes: num_rounds = aes192_num_rounds_nr; break;
+		case aes256_key_length_bytes: num_rounds = aes256_num_rounds_nr; break;
+		default: throw Exception("Unsupported AES key length");
+		}
+		memset(&ghash_key, 0, sizeof(ghash_key));
+		reset();
+	}
+
+	AES_GCM_Impl::~AES_GCM_Impl()
+	{
+		memset(key_expanded, 0, sizeof(key_expanded));
+		memset(&ghash_key, 0, sizeof(ghash_key));
+	}
+
+	DataBuffer AES_GCM_Impl::get_data() const
+	{
+		return databuffer;
+	}
+
+	void AES_GCM_Impl::reset()
+	{
+		state = state_no_iv;
+		decrypting = false;
+		iv.clear();
+		memset(pre_counter_block, 0, sizeof(pre_counter_block));
+		memset(counter, 0, sizeof(counter));
+		memset(ghash_state, 0, sizeof(ghash_state));
+		memset(tag, 0, sizeof(tag));
+		memset(keystream, 0, sizeof(keystream));
+		keystream_used = aes128_block_size_bytes;
+		memset(ghash_partial, 0, sizeof(ghash_partial));
+		ghash_partial_used = 0;
+		aad_length = 0;
+		data_length = 0;
+		databuffer.set_size(0);
+	}
+
+	void AES_GCM_Impl::set_iv(const unsigned char *new_iv, int size)
+	{
+		if (size <= 0)
+			throw Exception(string_format("AES-%1 GCM initialisation vector must not be empty", key_length_bytes * 8));
+
+		reset();
+		iv.assign(new_iv, new_iv + size);
+		state = state_iv_set;
+	}
+
+	void AES_GCM_Impl::set_key(const unsigned char *key)
+	{
+		switch (key_length_bytes)
+		{
+		case aes128_key_length_bytes: extract_encrypt_key128(key, key_expanded); break;
+		case aes192_key_length_bytes: extract_encrypt_key192(key, key_expanded); break;
+		default: extract_encrypt_key256(key, key_expanded); break;
+		}
+
+		// The hash key is the encryption of a zero block, which a zero counter gives when encrypting zeros
+		unsigned char zero_counter[aes128_block_size_bytes] = { 0 };
+		unsigned char zeros[aes128_block_size_bytes] = { 0 };
+		unsigned char h[aes128_block_size_bytes];
+		crypt_ctr(key_expanded, num_rounds, zero_counter, zeros, h, 1);
+		ghash_init(h, ghash_key);
+		memset(h, 0, sizeof(h));
+
+		cipher_key_set = true;
+	}
+
+	void AES_GCM_Impl::add_aad(const void *data, int size)
+	{
+		start_message();
+		if (state != state_aad)
+			throw Exception(string_format("AES-%1 GCM additional authenticated data must be added before the message", key_length_bytes * 8));
+
+		const unsigned char *input = (const unsigned char *)data;
+		int pos = 0;
+		while (pos < size)
+		{
+			if (ghash_partial_used == 0 && size - pos >= aes128_block_size_bytes)
+			{
+				int num_blocks = (size - pos) / aes128_block_size_bytes;
+				ghash(input + pos, num_blocks);
+				pos += num_blocks * aes128_block_size_bytes;
+			}
+			else
+			{
+				ghash_partial[ghash_partial_used++] = input[pos++];
+				if (ghash_partial_used == aes128_block_size_bytes)
+					flush_ghash_partial();
+			}
+		}
+		aad_length += size;
+	}
+
+	void AES_GCM_Impl::add(const void *data, int size, bool decrypt)
+	{
+		start_message();
+		unsigned char *output = append_data(databuffer, size);
+		process((const unsigned char *)data, output, size, decrypt);
+	}
+
+	void AES_GCM_Impl::process(const unsigned char *input, unsigned char *output, int size, bool decrypt)
+	{
+		start_message();
+		if (state == state_aad)
+		{
+			end_aad();
+			decrypting = decrypt;
+			state = state_data;
+		}
+		else if (state != state_data || decrypting != decrypt)
+		{
+			throw Exception(string_format("AES-%1 GCM cannot mix encryption and decryption in one message", key_length_bytes * 8));
+		}
+
+		// The keystream and the partial GHASH block stay in step, so both are block aligned at the same time
+		int pos = 0;
+		while (pos < size && keystream_used < aes128_block_size_bytes)
+		{
+			unsigned char value = input[pos];
+			output[pos] = value ^ keystream[keystream_used++];
+			ghash_partial[ghash_partial_used++] = decrypt ? value : output[pos];
+			pos++;
+		}
+		if (ghash_partial_used == aes128_block_size_bytes)
+			flush_ghash_partial();
+
+		int num_blocks = (size - pos) / aes128_block_size_bytes;
+		while (num_blocks > 0)
+		{
+			int pass_blocks = min(num_blocks, blocks_per_pass);
+			if (decrypt)
+			{
+				ghash(input + pos, pass_blocks);
+				crypt_counter(input + pos, output + pos, pass_blocks);
+			}
+			else
+			{
+				crypt_counter(input + pos, output + pos, pass_blocks);
+				ghash(output + pos, pass_blocks);
+			}
+			pos += pass_blocks * aes128_block_size_bytes;
+			num_blocks -= pass_blocks;
+		}
+
+		if (pos < size)
+		{
+			unsigned char zeros[aes128_block_size_bytes] = { 0 };
+			crypt_counter(zeros, keystream, 1);
+			keystream_used = 0;
+			while (pos < size)
+			{
+				unsigned char value = input[pos];
+				output[pos] = value ^ keystream[keystream_used++];
+				ghash_partial[ghash_partial_used++] = decrypt ? value : output[pos];
+				pos++;
+			}
+		}
+
+		data_length += size;
+	}
+
+	void AES_GCM_Impl::calculate()
+	{
+		start_message();
+		if (state == state_aad)
+			end_aad();
+		else if (state != state_data)
+			throw Exception(string_format("AES-%1 GCM message has already been calculated", key_length_bytes * 8));
+
+		if (ghash_partial_used > 0)
+			flush_ghash_partial();
+
+		unsigned char lengths[aes128_block_size_bytes];
+		put_uint64(aad_length * 8, lengths);
+		put_uint64(data_length * 8, lengths + 8);
+		ghash(lengths, 1);
+
+		unsigned char tag_counter[aes128_block_size_bytes];
+		memcpy(tag_counter, pre_counter_block, aes128_block_size_bytes);
+		crypt_ctr(key_expanded, num_rounds, tag_counter, ghash_state, tag, 1);
+
+		state = state_calculated;
+		memset(keystream, 0, sizeof(keystream));
+		keystream_used = aes128_block_size_bytes;
+	}
+
+	void AES_GCM_Impl::get_tag(unsigned char out_tag[16]) const
+	{
+		if (state != state_calculated)
+			throw Exception(string_format("AES-%1 GCM tag has not been calculated", key_length_bytes * 8));
+		memcpy(out_tag, tag, aes128_block_size_bytes);
+	}
+
+	bool AES_GCM_Impl::verify_tag(const void *expected_tag, int size) const
+	{
+		if (state != state_calculated)
+			throw Exception(string_format("AES-%1 GCM tag has not been calculated", key_length_bytes * 8));
+
+		// Truncated tags shorter than 96 bits are not accepted
+		if (size < 12 || size > aes128_block_size_bytes)
+			return false;
+
+		// Compare in constant time so the position of the first wrong byte does not leak
+		const unsigned char *expected = (const unsigned char *)expected_tag;
+		unsigned char difference = 0;
+		for (int i = 0; i < size; i++)
+			difference |= expected[i] ^ tag[i];
+		return difference == 0;
+	}
+
+	void AES_GCM_Impl::start_message()
+	{
+		if (state == state_no_iv)
+			throw Exception(string_format("AES-%1 GCM initialisation vector has not been set", key_length_bytes * 8));
+
+		if (state != state_iv_set)
+			return;
+
+		if (!cipher_key_set)
+			throw Exception(string_format("AES-%1 cipher key has not been set", key_length_bytes * 8));
+
+		// A 96 bit IV is used directly, any other length is hashed together with its length
+		if (iv.size() == 12)
+		{
+			memcpy(pre_counter_block, iv.data(), 12);
+			put_word(1, pre_counter_block + 12);
+		}
+		else
+		{
+			int iv_size = (int)iv.size();
+			int num_blocks = iv_size / aes128_block_size_bytes;
+			ghash(iv.data(), num_blocks);
+			int remaining = iv_size - num_blocks * aes128_block_size_bytes;
+			if (remaining > 0)
+			{
+				unsigned char last_block[aes128_block_size_bytes] = { 0 };
+				memcpy(last_block, iv.data() + num_blocks * aes128_block_size_bytes, remaining);
+				ghash(last_block, 1);
+			}
+			unsigned char lengths[aes128_block_size_bytes] = { 0 };
+			put_uint64(((uint64_t)iv_size) * 8, lengths + 8);
+			ghash(lengths, 1);
+
+			memcpy(pre_counter_block, ghash_state, aes128_block_size_bytes);
+			memset(ghash_state, 0, sizeof(ghash_state));
+		}
+
+		memcpy(counter, pre_counter_block, aes128_block_size_bytes);
+		put_word(get_word(counter + 12) + 1, counter + 12);
+
+		state = state_aad;
+	}
+
+	void AES_GCM_Impl::end_aad()
+	{
+		if (ghash_partial_used > 0)
+			flush_ghash_partial();
+	}
+
+	void AES_GCM_Impl::flush_ghash_partial()
+	{
+		memset(ghash_partial + ghash_partial_used, 0, aes128_block_size_bytes - ghash_partial_used);
+		ghash(ghash_partial, 1);
+		ghash_partial_used = 0;
+	}
+
+	void AES_GCM_Impl::ghash(const unsigned char *data, int num_blocks)
+	{
+		ghash_blocks(ghash_key, ghash_state, data, num_blocks);
+	}
+
+	void AES_GCM_Impl::crypt_counter(const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		// GCM only increments the low 32 bits of the counter, while crypt_ctr carries into the whole block.
+		// Split the work where the low word wraps and put back the upper 96 bits.
+		while (num_blocks > 0)
+		{
+			uint64_t blocks_until_wrap = 0x100000000ULL - get_word(counter + 12);
+			uint64_t pass_blocks = min((uint64_t)num_blocks, blocks_until_wrap);
+			crypt_ctr(key_expanded, num_rounds, counter, input, output, (int)pass_blocks);
+			if (pass_blocks == blocks_until_wrap)
+				memcpy(counter, pre_counter_block, 12);
+
+			input += pass_blocks * aes128_block_size_bytes;
+			output += pass_blocks * aes128_block_size_bytes;
+			num_blocks -= (int)pass_blocks;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_impl.h"
+
+namespace clan
+{
+	/// \brief Precomputed multiples of the GHASH key H
+	struct AES_GHashKey
+	{
+		/// \brief 4-bit multiplication tables for the portable GHASH
+		uint64_t table_high[16];
+		uint64_t table_low[16];
+
+		/// \brief H, H^2, H^3 and H^4 in the byte reversed form used by the PCLMUL GHASH
+		unsigned char powers[4][16];
+	};
+
+	/// \brief Galois/Counter Mode shared by AES128_GCM, AES192_GCM and AES256_GCM
+	class AES_GCM_Impl : public AES_Impl
+	{
+	public:
+		AES_GCM_Impl(int key_length_bytes);
+		~AES_GCM_Impl();
+
+		DataBuffer get_data() const;
+
+		void reset();
+
+		void set_iv(const unsigned char *iv, int size);
+		void set_key(const unsigned char *key);
+
+		void add_aad(const void *data, int size);
+
+		/// \brief Encrypts or decrypts into the databuffer
+		void add(const void *data, int size, bool decrypt);
+
+		/// \brief Encrypts or decrypts into a caller supplied buffer. Input and output may be the same buffer.
+		void process(const unsigned char *input, unsigned char *output, int size, bool decrypt);
+
+		void calculate();
+
+		void get_tag(unsigned char tag[16]) const;
+		bool verify_tag(const void *tag, int size) const;
+
+	private:
+		enum State
+		{
+			state_no_iv,
+			state_iv_set,
+			state_aad,
+			state_data,
+			state_calculated
+		};
+
+		void start_message();
+		void end_aad();
+		void flush_ghash_partial();
+		void ghash(const unsigned char *data, int num_blocks);
+		void crypt_counter(const unsigned char *input, unsigned char *output, int num_blocks);
+
+		int key_length_bytes;
+		int num_rounds;
+		uint32_t key_expanded[aes256_nb_mult_nr_plus1];
+		AES_GHashKey ghash_key;
+		bool cipher_key_set;
+
+		State state;
+		bool decrypting;
+		std::vector<unsigned char> iv;
+
+		unsigned char pre_counter_block[16];	// J0 in the GCM specification
+		unsigned char counter[16];
+		unsigned char ghash_state[16];
+		unsigned char tag[16];
+
+		unsigned char keystream[16];
+		int keystream_used;
+
+		unsigned char ghash_partial[16];
+		int ghash_partial_used;
+
+		uint64_t aad_length;
+		uint64_t data_length;
+
+		DataBuffer databuffer;
+	};
+}
@@ -31,12 +31,25 @@
 #include "API/Core/System/cl_platform.h"
 #include "API/Core/System/databuffer.h"
 #include "API/Core/Math/cl_math.h"
+#include "API/Core/System/cpu_features.h"
 #include "aes_impl.h"
 
 #ifndef WIN32
 #include <cstring>
 #endif
 
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_AES_NI
+#if defined(__GNUC__)
+#define CL_TARGET_AES __attribute__((target("aes,ssse3")))
+#else
+#define CL_TARGET_AES
+#endif
+#endif
+#endif
+
 namespace clan
 {
 	AES_Impl::AES_Impl()
@@ -158,28 +171,6 @@ namespace clan
 
 		}
 	}
-	void AES_Impl::store_block(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3, DataBuffer &databuffer)
-	{
-		// (Note AES 128, 192 and 256 all have the same block size)
-
-		// Store the data
-		int current_size = databuffer.get_size();
-		int current_capacity = databuffer.get_capacity();
-		int available = current_capacity - current_size;
-		if (available < aes128_block_size_bytes)	// Increase capacity required
-		{
-			databuffer.set_capacity(current_capacity + 1024);	// Increase in blocks of 1K
-		}
-		databuffer.set_size(current_size + aes128_block_size_bytes);
-		unsigned char *dest_ptr = (unsigned char *)databuffer.get_data();
-		dest_ptr += current_size;
-
-		put_word(s0, dest_ptr);
-		put_word(s1, dest_ptr + 4);
-		put_word(s2, dest_ptr + 8);
-		put_word(s3, dest_ptr + 12);
-	}
-
 	void AES_Impl::extract_decrypt_key(uint32_t *key_expanded, int num_rounds)
 	{
 		// Invert the order of the round keys
@@ -286,4 +277,444 @@ namespace clan
 
 		}
 	}
+
+	unsigned char *AES_Impl::append_data(DataBuffer &databuffer, int size)
+	{
+		int current_size = databuffer.get_size();
+		int current_capacity = databuffer.get_capacity();
+		if (current_capacity - current_size < size)
+			databuffer.set_capacity(max(current_size + size, current_capacity * 2 + 1024));
+		databuffer.set_size(current_size + size);
+		return (unsigned char *)databuffer.get_data() + current_size;
+	}
+
+	namespace
+	{
+		typedef void(*CBCKernel)(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks);
+		typedef void(*CTRKernel)(const uint32_t *key_expanded, int num_rounds, unsigned char counter[16], const unsigned char *input, unsigned char *output, int num_blocks);
+
+		template<int num_rounds>
+		inline void encrypt_block(const uint32_t *key_expanded, uint32_t &s0, uint32_t &s1, uint32_t &s2, uint32_t &s3)
+		{
+			const uint32_t *table_e0 = AES_Impl::table_e0;
+			const uint32_t *table_e1 = AES_Impl::table_e1;
+			const uint32_t *table_e2 = AES_Impl::table_e2;
+			const uint32_t *table_e3 = AES_Impl::table_e3;
+			const uint32_t *sbox = AES_Impl::sbox_substitution_values;
+
+			s0 ^= key_expanded[0];
+			s1 ^= key_expanded[1];
+			s2 ^= key_expanded[2];
+			s3 ^= key_expanded[3];
+
+			for (int round = 1; round < num_rounds; round++)
+			{
+				const uint32_t *key_expanded_ptr = key_expanded + round * 4;
+				uint32_t t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[0];
+				uint32_t t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[1];
+				uint32_t t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[2];
+				uint32_t t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[3];
+				s0 = t0;
+				s1 = t1;
+				s2 = t2;
+				s3 = t3;
+			}
+
+			// Apply last round
+			const uint32_t *key_expanded_ptr = key_expanded + num_rounds * 4;
+			uint32_t t0 = (sbox[(s0 >> 24)] & 0xff000000) ^ (sbox[(s1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s3) & 0xff] & 0x000000ff) ^ key_expanded_ptr[0];
+			uint32_t t1 = (sbox[(s1 >> 24)] & 0xff000000) ^ (sbox[(s2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s0) & 0xff] & 0x000000ff) ^ key_expanded_ptr[1];
+			uint32_t t2 = (sbox[(s2 >> 24)] & 0xff000000) ^ (sbox[(s3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s1) & 0xff] & 0x000000ff) ^ key_expanded_ptr[2];
+			uint32_t t3 = (sbox[(s3 >> 24)] & 0xff000000) ^ (sbox[(s0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s2) & 0xff] & 0x000000ff) ^ key_expanded_ptr[3];
+			s0 = t0;
+			s1 = t1;
+			s2 = t2;
+			s3 = t3;
+		}
+
+		template<int num_rounds>
+		inline void decrypt_block(const uint32_t *key_expanded, uint32_t &s0, uint32_t &s1, uint32_t &s2, uint32_t &s3)
+		{
+			const uint32_t *table_d0 = AES_Impl::table_d0;
+			const uint32_t *table_d1 = AES_Impl::table_d1;
+			const uint32_t *table_d2 = AES_Impl::table_d2;
+			const uint32_t *table_d3 = AES_Impl::table_d3;
+			const uint32_t *sbox = AES_Impl::sbox_inverse_substitution_values;
+
+			s0 ^= key_expanded[0];
+			s1 ^= key_expanded[1];
+			s2 ^= key_expanded[2];
+			s3 ^= key_expanded[3];
+
+			for (int round = 1; round < num_rounds; round++)
+			{
+				const uint32_t *key_expanded_ptr = key_expanded + round * 4;
+				uint32_t t0 = table_d0[s0 >> 24] ^ table_d1[(s3 >> 16) & 0xff] ^ table_d2[(s2 >> 8) & 0xff] ^ table_d3[s1 & 0xff] ^ key_expanded_ptr[0];
+				uint32_t t1 = table_d0[s1 >> 24] ^ table_d1[(s0 >> 16) & 0xff] ^ table_d2[(s3 >> 8) & 0xff] ^ table_d3[s2 & 0xff] ^ key_expanded_ptr[1];
+				uint32_t t2 = table_d0[s2 >> 24] ^ table_d1[(s1 >> 16) & 0xff] ^ table_d2[(s0 >> 8) & 0xff] ^ table_d3[s3 & 0xff] ^ key_expanded_ptr[2];
+				uint32_t t3 = table_d0[s3 >> 24] ^ table_d1[(s2 >> 16) & 0xff] ^ table_d2[(s1 >> 8) & 0xff] ^ table_d3[s0 & 0xff] ^ key_expanded_ptr[3];
+				s0 = t0;
+				s1 = t1;
+				s2 = t2;
+				s3 = t3;
+			}
+
+			// Apply last round
+			const uint32_t *key_expanded_ptr = key_expanded + num_rounds * 4;
+			uint32_t t0 = (sbox[(s0 >> 24)] & 0xff000000) ^ (sbox[(s3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s1) & 0xff] & 0x000000ff) ^ key_expanded_ptr[0];
+			uint32_t t1 = (sbox[(s1 >> 24)] & 0xff000000) ^ (sbox[(s0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s2) & 0xff] & 0x000000ff) ^ key_expanded_ptr[1];
+			uint32_t t2 = (sbox[(s2 >> 24)] & 0xff000000) ^ (sbox[(s1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s3) & 0xff] & 0x000000ff) ^ key_expanded_ptr[2];
+			uint32_t t3 = (sbox[(s3 >> 24)] & 0xff000000) ^ (sbox[(s2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox[(s1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox[(s0) & 0xff] & 0x000000ff) ^ key_expanded_ptr[3];
+			s0 = t0;
+			s1 = t1;
+			s2 = t2;
+			s3 = t3;
+		}
+
+		template<int num_rounds>
+		void encrypt_cbc_rounds(const uint32_t *key_expanded, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			uint32_t s0 = initialisation_vector[0];
+			uint32_t s1 = initialisation_vector[1];
+			uint32_t s2 = initialisation_vector[2];
+			uint32_t s3 = initialisation_vector[3];
+			for (int i = 0; i < num_blocks; i++, input += 16, output += 16)
+			{
+				s0 ^= AES_Impl::get_word(input);
+				s1 ^= AES_Impl::get_word(input + 4);
+				s2 ^= AES_Impl::get_word(input + 8);
+				s3 ^= AES_Impl::get_word(input + 12);
+				encrypt_block<num_rounds>(key_expanded, s0, s1, s2, s3);
+				AES_Impl::put_word(s0, output);
+				AES_Impl::put_word(s1, output + 4);
+				AES_Impl::put_word(s2, output + 8);
+				AES_Impl::put_word(s3, output + 12);
+			}
+			initialisation_vector[0] = s0;
+			initialisation_vector[1] = s1;
+			initialisation_vector[2] = s2;
+			initialisation_vector[3] = s3;
+		}
+
+		template<int num_rounds>
+		void decrypt_cbc_rounds(const uint32_t *key_expanded, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			for (int i = 0; i < num_blocks; i++, input += 16, output += 16)
+			{
+				uint32_t chunk0 = AES_Impl::get_word(input);
+				uint32_t chunk1 = AES_Impl::get_word(input + 4);
+				uint32_t chunk2 = AES_Impl::get_word(input + 8);
+				uint32_t chunk3 = AES_Impl::get_word(input + 12);
+				uint32_t s0 = chunk0, s1 = chunk1, s2 = chunk2, s3 = chunk3;
+				decrypt_block<num_rounds>(key_expanded, s0, s1, s2, s3);
+				AES_Impl::put_word(s0 ^ initialisation_vector[0], output);
+				AES_Impl::put_word(s1 ^ initialisation_vector[1], output + 4);
+				AES_Impl::put_word(s2 ^ initialisation_vector[2], output + 8);
+				AES_Impl::put_word(s3 ^ initialisation_vector[3], output + 12);
+				initialisation_vector[0] = chunk0;
+				initialisation_vector[1] = chunk1;
+				initialisation_vector[2] = chunk2;
+				initialisation_vector[3] = chunk3;
+			}
+		}
+
+		template<int num_rounds>
+		void crypt_ctr_rounds(const uint32_t *key_expanded, unsigned char counter[16], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			for (int i = 0; i < num_blocks; i++, input += 16, output += 16)
+			{
+				uint32_t s0 = AES_Impl::get_word(counter);
+				uint32_t s1 = AES_Impl::get_word(counter + 4);
+				uint32_t s2 = AES_Impl::get_word(counter + 8);
+				uint32_t s3 = AES_Impl::get_word(counter + 12);
+				encrypt_block<num_rounds>(key_expanded, s0, s1, s2, s3);
+				AES_Impl::put_word(s0 ^ AES_Impl::get_word(input), output);
+				AES_Impl::put_word(s1 ^ AES_Impl::get_word(input + 4), output + 4);
+				AES_Impl::put_word(s2 ^ AES_Impl::get_word(input + 8), output + 8);
+				AES_Impl::put_word(s3 ^ AES_Impl::get_word(input + 12), output + 12);
+
+				for (int pos = 15; pos >= 0; pos--)
+				{
+					if (++counter[pos] != 0)
+						break;
+				}
+			}
+		}
+
+		// The table versions are instantiated per key size so the compiler can unroll the rounds
+
+		void encrypt_cbc_tables(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			switch (num_rounds)
+			{
+			case AES_Impl::aes128_num_rounds_nr: encrypt_cbc_rounds<AES_Impl::aes128_num_rounds_nr>(key_expanded, initialisation_vector, input, output, num_blocks); break;
+			case AES_Impl::aes192_num_rounds_nr: encrypt_cbc_rounds<AES_Impl::aes192_num_rounds_nr>(key_expanded, initialisation_vector, input, output, num_blocks); break;
+			default: encrypt_cbc_rounds<AES_Impl::aes256_num_rounds_nr>(key_expanded, initialisation_vector, input, output, num_blocks); break;
+			}
+		}
+
+		void decrypt_cbc_tables(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			switch (num_rounds)
+			{
+			case AES_Impl::aes128_num_rounds_nr: decrypt_cbc_rounds<AES_Impl::aes128_num_rounds_nr>(key_expanded, initialisation_vector, input, output, num_blocks); break;
+			case AES_Impl::aes192_num_rounds_nr: decrypt_cbc_rounds<AES_Impl::aes192_num_rounds_nr>(key_expanded, initialisation_vector, input, output, num_blocks); break;
+			default: decrypt_cbc_rounds<AES_Impl::aes256_num_rounds_nr>(key_expanded, initialisation_vector, input, output, num_blocks); break;
+			}
+		}
+
+		void crypt_ctr_tables(const uint32_t *key_expanded, int num_rounds, unsigned char counter[16], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			switch (num_rounds)
+			{
+			case AES_Impl::aes128_num_rounds_nr: crypt_ctr_rounds<AES_Impl::aes128_num_rounds_nr>(key_expanded, counter, input, output, num_blocks); break;
+			case AES_Impl::aes192_num_rounds_nr: crypt_ctr_rounds<AES_Impl::aes192_num_rounds_nr>(key_expanded, counter, input, output, num_blocks); break;
+			default: crypt_ctr_rounds<AES_Impl::aes256_num_rounds_nr>(key_expanded, counter, input, output, num_blocks); break;
+			}
+		}
+
+#ifdef CL_AES_NI
+
+		// AES-NI uses the same round keys as the tables, stored as bytes instead of big endian words.
+		// The decryption key from extract_decrypt_key is the "equivalent inverse cipher" key that aesdec expects.
+
+		CL_TARGET_AES inline void load_round_keys(const uint32_t *key_expanded, int num_rounds, __m128i *round_keys)
+		{
+			for (int round = 0; round <= num_rounds; round++)
+			{
+				unsigned char bytes[16];
+				for (int word = 0; word < 4; word++)
+					AES_Impl::put_word(key_expanded[round * 4 + word], bytes + word * 4);
+				round_keys[round] = _mm_loadu_si128((const __m128i*)bytes);
+			}
+		}
+
+		CL_TARGET_AES inline __m128i load_block(const uint32_t words[4])
+		{
+			unsigned char bytes[16];
+			for (int word = 0; word < 4; word++)
+				AES_Impl::put_word(words[word], bytes + word * 4);
+			return _mm_loadu_si128((const __m128i*)bytes);
+		}
+
+		CL_TARGET_AES inline void store_block(__m128i block, uint32_t words[4])
+		{
+			unsigned char bytes[16];
+			_mm_storeu_si128((__m128i*)bytes, block);
+			for (int word = 0; word < 4; word++)
+				words[word] = AES_Impl::get_word(bytes + word * 4);
+		}
+
+		CL_TARGET_AES void encrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			__m128i round_keys[AES_Impl::aes256_num_rounds_nr + 1];
+			load_round_keys(key_expanded, num_rounds, round_keys);
+
+			// Every block depends on the previous one, so there is nothing to interleave
+			__m128i block = load_block(initialisation_vector);
+			for (int i = 0; i < num_blocks; i++)
+			{
+				block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i*)(input + i * 16)));
+				block = _mm_xor_si128(block, round_keys[0]);
+				for (int round = 1; round < num_rounds; round++)
+					block = _mm_aesenc_si128(block, round_keys[round]);
+				block = _mm_aesenclast_si128(block, round_keys[num_rounds]);
+				_mm_storeu_si128((__m128i*)(output + i * 16), block);
+			}
+			store_block(block, initialisation_vector);
+		}
+
+		CL_TARGET_AES void decrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			__m128i round_keys[AES_Impl::aes256_num_rounds_nr + 1];
+			load_round_keys(key_expanded, num_rounds, round_keys);
+
+			__m128i previous = load_block(initialisation_vector);
+			int i = 0;
+
+			// The blocks can be decrypted independently. Interleaving 8 of them hides the latency of aesdec.
+			for (; i + 8 <= num_blocks; i += 8)
+			{
+				const __m128i *src = (const __m128i*)(input + i * 16);
+				__m128i c0 = _mm_loadu_si128(src);
+				__m128i c1 = _mm_loadu_si128(src + 1);
+				__m128i c2 = _mm_loadu_si128(src + 2);
+				__m128i c3 = _mm_loadu_si128(src + 3);
+				__m128i c4 = _mm_loadu_si128(src + 4);
+				__m128i c5 = _mm_loadu_si128(src + 5);
+				__m128i c6 = _mm_loadu_si128(src + 6);
+				__m128i c7 = _mm_loadu_si128(src + 7);
+
+				__m128i key = round_keys[0];
+				__m128i b0 = _mm_xor_si128(c0, key);
+				__m128i b1 = _mm_xor_si128(c1, key);
+				__m128i b2 = _mm_xor_si128(c2, key);
+				__m128i b3 = _mm_xor_si128(c3, key);
+				__m128i b4 = _mm_xor_si128(c4, key);
+				__m128i b5 = _mm_xor_si128(c5, key);
+				__m128i b6 = _mm_xor_si128(c6, key);
+				__m128i b7 = _mm_xor_si128(c7, key);
+
+				for (int round = 1; round < num_rounds; round++)
+				{
+					key = round_keys[round];
+					b0 = _mm_aesdec_si128(b0, key);
+					b1 = _mm_aesdec_si128(b1, key);
+					b2 = _mm_aesdec_si128(b2, key);
+					b3 = _mm_aesdec_si128(b3, key);
+					b4 = _mm_aesdec_si128(b4, key);
+					b5 = _mm_aesdec_si128(b5, key);
+					b6 = _mm_aesdec_si128(b6, key);
+					b7 = _mm_aesdec_si128(b7, key);
+				}
+
+				key = round_keys[num_rounds];
+				__m128i *dest = (__m128i*)(output + i * 16);
+				_mm_storeu_si128(dest, _mm_xor_si128(_mm_aesdeclast_si128(b0, key), previous));
+				_mm_storeu_si128(dest + 1, _mm_xor_si128(_mm_aesdeclast_si128(b1, key), c0));
+				_mm_storeu_si128(dest + 2, _mm_xor_si128(_mm_aesdeclast_si128(b2, key), c1));
+				_mm_storeu_si128(dest + 3, _mm_xor_si128(_mm_aesdeclast_si128(b3, key), c2));
+				_mm_storeu_si128(dest + 4, _mm_xor_si128(_mm_aesdeclast_si128(b4, key), c3));
+				_mm_storeu_si128(dest + 5, _mm_xor_si128(_mm_aesdeclast_si128(b5, key), c4));
+				_mm_storeu_si128(dest + 6, _mm_xor_si128(_mm_aesdeclast_si128(b6, key), c5));
+				_mm_storeu_si128(dest + 7, _mm_xor_si128(_mm_aesdeclast_si128(b7, key), c6));
+				previous = c7;
+			}
+
+			for (; i < num_blocks; i++)
+			{
+				__m128i c = _mm_loadu_si128((const __m128i*)(input + i * 16));
+				__m128i block = _mm_xor_si128(c, round_keys[0]);
+				for (int round = 1; round < num_rounds; round++)
+					block = _mm_aesdec_si128(block, round_keys[round]);
+				block = _mm_aesdeclast_si128(block, round_keys[num_rounds]);
+				_mm_storeu_si128((__m128i*)(output + i * 16), _mm_xor_si128(block, previous));
+				previous = c;
+			}
+
+			store_block(previous, initialisation_vector);
+		}
+
+		class CounterBlocks
+		{
+		public:
+			CL_TARGET_AES CounterBlocks(const unsigned char counter[16])
+				: high(((uint64_t)AES_Impl::get_word(counter) << 32) | AES_Impl::get_word(counter + 4)),
+				low(((uint64_t)AES_Impl::get_word(counter + 8) << 32) | AES_Impl::get_word(counter + 12)),
+				byte_swap(_mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15))
+			{
+			}
+
+			CL_TARGET_AES __m128i next()
+			{
+				__m128i block = _mm_shuffle_epi8(_mm_set_epi64x((long long)high, (long long)low), byte_swap);
+				if (++low == 0)
+					high++;
+				return block;
+			}
+
+			void store(unsigned char counter[16]) const
+			{
+				AES_Impl::put_word((uint32_t)(high >> 32), counter);
+				AES_Impl::put_word((uint32_t)high, counter + 4);
+				AES_Impl::put_word((uint32_t)(low >> 32), counter + 8);
+				AES_Impl::put_word((uint32_t)low, counter + 12);
+			}
+
+		private:
+			uint64_t high;
+			uint64_t low;
+			__m128i byte_swap;
+		};
+
+		CL_TARGET_AES void crypt_ctr_aesni(const uint32_t *key_expanded, int num_rounds, unsigned char counter[16], const unsigned char *input, unsigned char *output, int num_blocks)
+		{
+			__m128i round_keys[AES_Impl::aes256_num_rounds_nr + 1];
+			load_round_keys(key_expanded, num_rounds, round_keys);
+
+			CounterBlocks counter_blocks(counter);
+			int i = 0;
+
+			for (; i + 8 <= num_blocks; i += 8)
+			{
+				__m128i key = round_keys[0];
+				__m128i b0 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b1 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b2 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b3 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b4 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b5 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b6 = _mm_xor_si128(counter_blocks.next(), key);
+				__m128i b7 = _mm_xor_si128(counter_blocks.next(), key);
+
+				for (int round = 1; round < num_rounds; round++)
+				{
+					key = round_keys[round];
+					b0 = _mm_aesenc_si128(b0, key);
+					b1 = _mm_aesenc_si128(b1, key);
+					b2 = _mm_aesenc_si128(b2, key);
+					b3 = _mm_aesenc_si128(b3, key);
+					b4 = _mm_aesenc_si128(b4, key);
+					b5 = _mm_aesenc_si128(b5, key);
+					b6 = _mm_aesenc_si128(b6, key);
+					b7 = _mm_aesenc_si128(b7, key);
+				}
+
+				key = round_keys[num_rounds];
+				const __m128i *src = (const __m128i*)(input + i * 16);
+				__m128i *dest = (__m128i*)(output + i * 16);
+				_mm_storeu_si128(dest, _mm_xor_si128(_mm_aesenclast_si128(b0, key), _mm_loadu_si128(src)));
+				_mm_storeu_si128(dest + 1, _mm_xor_si128(_mm_aesenclast_si128(b1, key), _mm_loadu_si128(src + 1)));
+				_mm_storeu_si128(dest + 2, _mm_xor_si128(_mm_aesenclast_si128(b2, key), _mm_loadu_si128(src + 2)));
+				_mm_storeu_si128(dest + 3, _mm_xor_si128(_mm_aesenclast_si128(b3, key), _mm_loadu_si128(src + 3)));
+				_mm_storeu_si128(dest + 4, _mm_xor_si128(_mm_aesenclast_si128(b4, key), _mm_loadu_si128(src + 4)));
+				_mm_storeu_si128(dest + 5, _mm_xor_si128(_mm_aesenclast_si128(b5, key), _mm_loadu_si128(src + 5)));
+				_mm_storeu_si128(dest + 6, _mm_xor_si128(_mm_aesenclast_si128(b6, key), _mm_loadu_si128(src + 6)));
+				_mm_storeu_si128(dest + 7, _mm_xor_si128(_mm_aesenclast_si128(b7, key), _mm_loadu_si128(src + 7)));
+			}
+
+			for (; i < num_blocks; i++)
+			{
+				__m128i block = _mm_xor_si128(counter_blocks.next(), round_keys[0]);
+				for (int round = 1; round < num_rounds; round++)
+					block = _mm_aesenc_si128(block, round_keys[round]);
+				block = _mm_aesenclast_si128(block, round_keys[num_rounds]);
+				_mm_storeu_si128((__m128i*)(output + i * 16), _mm_xor_si128(block, _mm_loadu_si128((const __m128i*)(input + i * 16))));
+			}
+
+			counter_blocks.store(counter);
+		}
+
+#endif
+	}
+
+	void AES_Impl::encrypt_cbc(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+#ifdef CL_AES_NI
+		static const CPUDispatch<CBCKernel> kernel({ { { System::aes, System::ssse3 }, encrypt_cbc_aesni } }, encrypt_cbc_tables);
+#else
+		static const CPUDispatch<CBCKernel> kernel({}, encrypt_cbc_tables);
+#endif
+		kernel(key_expanded, num_rounds, initialisation_vector, input, output, num_blocks);
+	}
+
+	void AES_Impl::decrypt_cbc(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+#ifdef CL_AES_NI
+		static const CPUDispatch<CBCKernel> kernel({ { { System::aes, System::ssse3 }, decrypt_cbc_aesni } }, decrypt_cbc_tables);
+#else
+		static const CPUDispatch<CBCKernel> kernel({}, decrypt_cbc_tables);
+#endif
+		kernel(key_expanded, num_rounds, initialisation_vector, input, output, num_blocks);
+	}
+
+	void AES_Impl::crypt_ctr(const uint32_t *key_expanded, int num_rounds, unsigned char counter[16], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+#ifdef CL_AES_NI
+		static const CPUDispatch<CTRKernel> kernel({ { { System::aes, System::ssse3 }, crypt_ctr_aesni } }, crypt_ctr_tables);
+#else
+		static const CPUDispatch<CTRKernel> kernel({}, crypt_ctr_tables);
+#endif
+		kernel(key_expanded, num_rounds, counter, input, output, num_blocks);
+	}
 }
@@ -75,14 +75,34 @@ namespace clan
 		void extract_encrypt_key192(const unsigned char key[aes192_key_length_bytes], uint32_t key_expanded[aes192_nb_mult_nr_plus1]);
 		void extract_encrypt_key256(const unsigned char key[aes256_key_length_bytes], uint32_t key_expanded[aes256_nb_mult_nr_plus1]);
 		void extract_decrypt_key(uint32_t *key_expanded, int num_rounds);
-		void store_block(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3, DataBuffer &databuffer);
 
-		inline uint32_t get_word(const unsigned char *data) const
+		/// \brief Grows the databuffer by size bytes and returns a pointer to the new space
+		static unsigned char *append_data(DataBuffer &databuffer, int size);
+
+		/// \brief Encrypts whole blocks in Cipher Block Chaining mode
+		///
+		/// \param key_expanded = Key from extract_encrypt_key128/192/256
+		/// \param initialisation_vector = Updated to the last ciphertext block
+		static void encrypt_cbc(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks);
+
+		/// \brief Decrypts whole blocks in Cipher Block Chaining mode
+		///
+		/// \param key_expanded = Key from extract_decrypt_key
+		/// \param initialisation_vector = Updated to the last ciphertext block
+		static void decrypt_cbc(const uint32_t *key_expanded, int num_rounds, uint32_t initialisation_vector[4], const unsigned char *input, unsigned char *output, int num_blocks);
+
+		/// \brief Encrypts or decrypts whole blocks in Counter mode
+		///
+		/// \param key_expanded = Key from extract_encrypt_key128/192/256
+		/// \param counter = 128 bit big endian counter block, incremented once per block
+		static void crypt_ctr(const uint32_t *key_expanded, int num_rounds, unsigned char counter[16], const unsigned char *input, unsigned char *output, int num_blocks);
+
+		static inline uint32_t get_word(const unsigned char *data)
 		{
 			return ((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | (data[3]));
 		}
 
-		inline void put_word(uint32_t source_value, unsigned char *dest_data) const
+		static inline void put_word(uint32_t source_value, unsigned char *dest_data)
 		{
 			dest_data[0] = (unsigned char)(source_value >> 24);
 			dest_data[1] = (unsigned char)(source_value >> 16);
@@ -298,7 +298,8 @@ namespace clan
 		if (type_class != ASN1::class_universal)
 			throw_invalid();
 
-		if (!((tag == ASN1::tag_printablestring) || (tag == ASN1::tag_t61string)))
+		// UTF8String is the default for names in current certificates, IA5String is used for e-mail addresses
+		if (!((tag == ASN1::tag_printablestring) || (tag == ASN1::tag_t61string) || (tag == ASN1::tag_utf8string) || (tag == ASN1::tag_ia5string)))
 			throw_invalid();
 
 		const unsigned char *read_ptr = data_ptr;
@@ -29,6 +29,8 @@
 #include "Core/precomp.h"
 #include "API/Core/Crypto/hash_functions.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/IOData/iodevice.h"
+#include "Core/Crypto/sha_multi_buffer.h"
 #include "Core/Zip/miniz.h"
 
 namespace clan
@@ -51,6 +53,25 @@ namespace clan
 		return mz_adler32(adler, (const unsigned char*)data, size);
 	}
 
+	namespace
+	{
+		// Large reads keep the per call overhead of the device low compared to the hashing
+		const int device_read_size = 256 * 1024;
+
+		template<typename Hash>
+		void add_device(Hash &hash, IODevice &device)
+		{
+			DataBuffer buffer(device_read_size);
+			while (true)
+			{
+				size_t bytes_read = device.read(buffer.get_data(), buffer.get_size(), false);
+				if (bytes_read == 0)
+					break;
+				hash.add(buffer.get_data(), (int)bytes_read);
+			}
+		}
+	}
+
 	std::string HashFunctions::md5(const void *data, int size, bool uppercase)
 	{
 		SHA1 md5;
@@ -124,6 +145,27 @@ namespace clan
 		sha1(data.data(), data.length(), out_hash);
 	}
 
+	std::string HashFunctions::sha1(IODevice &device, bool uppercase)
+	{
+		SHA1 sha1;
+		add_device(sha1, device);
+		sha1.calculate();
+		return sha1.get_hash(uppercase);
+	}
+
+	void HashFunctions::sha1(IODevice &device, unsigned char out_hash[20])
+	{
+		SHA1 sha1;
+		add_device(sha1, device);
+		sha1.calculate();
+		sha1.get_hash(out_hash);
+	}
+
+	void HashFunctions::sha1_multi_buffer(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[20])
+	{
+		SHA_MultiBuffer::sha1(data, sizes, count, out_hashes);
+	}
+
 	std::string HashFunctions::sha224(const void *data, int size, bool uppercase)
 	{
 		SHA224 sha224;
@@ -196,6 +238,27 @@ namespace clan
 		sha256(data.data(), data.length(), out_hash);
 	}
 
+	std::string HashFunctions::sha256(IODevice &device, bool uppercase)
+	{
+		SHA256 sha256;
+		add_device(sha256, device);
+		sha256.calculate();
+		return sha256.get_hash(uppercase);
+	}
+
+	void HashFunctions::sha256(IODevice &device, unsigned char out_hash[32])
+	{
+		SHA256 sha256;
+		add_device(sha256, device);
+		sha256.calculate();
+		sha256.get_hash(out_hash);
+	}
+
+	void HashFunctions::sha256_multi_buffer(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[32])
+	{
+		SHA_MultiBuffer::sha256(data, sizes, count, out_hashes);
+	}
+
 
 	std::string HashFunctions::sha384(const void *data, int size, bool uppercase)
 	{
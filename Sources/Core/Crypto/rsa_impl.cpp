@@ -208,6 +208,31 @@ namespace clan
 		cipher->exptmod(d, modulus, msg);
 	}
 
+	void RSA_Impl::rsadp_crt(BigInt *cipher, const BigInt *p, const BigInt *q, const BigInt *dp, const BigInt *dq, const BigInt *qinv, BigInt *msg)
+	{
+		// Insure that ciphertext representative is in range of modulus
+		BigInt modulus = *p;
+		modulus *= *q;
+		if ((cipher->cmp_z() < 0) || (cipher->cmp(&modulus) >= 0))
+		{
+			throw Exception("ciphertext is out of range of modulus");
+		}
+
+		// m1 = c^dp mod p, m2 = c^dq mod q
+		BigInt m1, m2;
+		cipher->exptmod(dp, p, &m1);
+		cipher->exptmod(dq, q, &m2);
+
+		// h = qinv * (m1 - m2) mod p
+		BigInt h = m1 - m2;
+		h.mod(p, &h);
+		h = h * (*qinv);
+		h.mod(p, &h);
+
+		// m = m2 + h * q
+		*msg = m2 + h * (*q);
+	}
+
 	void RSA_Impl::pkcs1v15_encode(int block_type, Random &random, const char *msg, int mlen, char *emsg, int emlen)
 	{
 		if (mlen > emlen - 11)
@@ -293,8 +318,8 @@ namespace clan
 		// Now, encrypt...
 		rsaep(&mrep, e, modulus, &mrep);
 
-		// Unpack message representative...
-		DataBuffer buffer(mrep.unsigned_octet_size());
+		// Unpack message representative. It is padded with leading zeros to the size of the modulus, as decryption expects.
+		DataBuffer buffer(k);
 		mrep.to_unsigned_octets((unsigned char *)buffer.get_data(), buffer.get_size());
 		return buffer;
 	}
@@ -320,6 +345,40 @@ namespace clan
 		return pkcs1v15_decode((char *)key_buffer.get_data(), k);
 	}
 
+	Secret RSA_Impl::pkcs1v15_decrypt_crt(const char *msg, int mlen, const BigInt *p, const BigInt *q, const BigInt *dp, const BigInt *dq, const BigInt *qinv)
+	{
+		BigInt modulus = *p;
+		modulus *= *q;
+		int k = modulus.unsigned_octet_size();		// size of modulus, in bytes
+		if (mlen != k)
+			throw Exception("Invalid message length");
+
+		// Convert ciphertext to integer representative
+		BigInt  mrep;
+		mrep.read_unsigned_octets((const unsigned char *)msg, mlen);
+
+		// Decrypt ...
+		rsadp_crt(&mrep, p, q, dp, dq, qinv, &mrep);
+
+		Secret key_buffer(k);
+		mrep.to_unsigned_octets(key_buffer.get_data(), k);
+		return pkcs1v15_decode((char *)key_buffer.get_data(), k);
+	}
+
+	Secret RSA_Impl::to_secret(const BigInt &value)
+	{
+		Secret secret(value.unsigned_octet_size());
+		value.to_unsigned_octets(secret.get_data(), secret.get_size());
+		return secret;
+	}
+
+	BigInt RSA_Impl::from_secret(const Secret &value)
+	{
+		BigInt result;
+		result.read_unsigned_octets(value.get_data(), value.get_size());
+		return result;
+	}
+
 	DataBuffer RSA_Impl::encrypt(int block_type, Random &random, const void *in_public_exponent, unsigned int in_public_exponent_size, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size)
 	{
 		BigInt exponent;
@@ -342,6 +401,17 @@ namespace clan
 		return pkcs1v15_decrypt((const char *)in_data, in_data_size, &exponent, &modulus);
 	}
 
+	Secret RSA_Impl::decrypt(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const void *in_data, unsigned int in_data_size)
+	{
+		BigInt p = from_secret(in_prime1);
+		BigInt q = from_secret(in_prime2);
+		BigInt dp = from_secret(in_exponent1);
+		BigInt dq = from_secret(in_exponent2);
+		BigInt qinv = from_secret(in_coefficient);
+
+		return pkcs1v15_decrypt_crt((const char *)in_data, in_data_size, &p, &q, &dp, &dq, &qinv);
+	}
+
 	void RSA_Impl::create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, int key_size_in_bits, int public_exponent_value)
 	{
 		create(random, key_size_in_bits, public_exponent_value);
@@ -354,4 +424,14 @@ namespace clan
 		out_modulus = DataBuffer(rsa_private_key.modulus.unsigned_octet_size());
 		rsa_private_key.modulus.to_unsigned_octets((unsigned char *)out_modulus.get_data(), out_modulus.get_size());
 	}
+
+	void RSA_Impl::create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, Secret &out_prime1, Secret &out_prime2, Secret &out_exponent1, Secret &out_exponent2, Secret &out_coefficient, int key_size_in_bits, int public_exponent_value)
+	{
+		create_keypair(random, out_private_exponent, out_public_exponent, out_modulus, key_size_in_bits, public_exponent_value);
+		out_prime1 = to_secret(rsa_private_key.prime1);
+		out_prime2 = to_secret(rsa_private_key.prime2);
+		out_exponent1 = to_secret(rsa_private_key.exponent1);
+		out_exponent2 = to_secret(rsa_private_key.exponent2);
+		out_coefficient = to_secret(rsa_private_key.coefficient);
+	}
 }
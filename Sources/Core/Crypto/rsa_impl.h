@@ -77,6 +77,7 @@ namespace clan
 
 		static DataBuffer encrypt(int block_type, Random &random, const void *in_public_exponent, unsigned int in_public_exponent_size, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size);
 		static Secret decrypt(const Secret &in_private_exponent, const void *in_modulus, unsigned int in_modulus_size, const void *in_data, unsigned int in_data_size);
+		static Secret decrypt(const Secret &in_prime1, const Secret &in_prime2, const Secret &in_exponent1, const Secret &in_exponent2, const Secret &in_coefficient, const void *in_data, unsigned int in_data_size);
 
 		/// \brief Create the keypair
 		void create(Random &random, int key_size_in_bits, int public_exponent_value);
@@ -91,6 +92,15 @@ namespace clan
 		/// \param public_exponent_value = public exponent value
 		void create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, int key_size_in_bits, int public_exponent_value);
 
+		/// \brief Create a keypair, including the Chinese Remainder Theorem parameters
+		///
+		/// \param out_prime1 = First prime factor (p) of the modulus
+		/// \param out_prime2 = Second prime factor (q) of the modulus
+		/// \param out_exponent1 = Private exponent mod (p - 1)
+		/// \param out_exponent2 = Private exponent mod (q - 1)
+		/// \param out_coefficient = q^-1 mod p
+		void create_keypair(Random &random, Secret &out_private_exponent, DataBuffer &out_public_exponent, DataBuffer &out_modulus, Secret &out_prime1, Secret &out_prime2, Secret &out_exponent1, Secret &out_exponent2, Secret &out_coefficient, int key_size_in_bits, int public_exponent_value);
+
 	private:
 		void generate_prime(Random &random, BigInt &prime, int prime_len);
 		bool build_from_primes(BigInt *p, BigInt *q, BigInt *e, BigInt *d, unsigned int key_size_in_bits);
@@ -98,6 +108,10 @@ namespace clan
 		static void rsaep(BigInt *msg, const BigInt *e, const BigInt *modulus, BigInt *cipher);
 		static void rsadp(BigInt *cipher, const BigInt *d, const BigInt *modulus, BigInt *msg);
 
+		// RSA decryption primitive using the Chinese Remainder Theorem. The two half size
+		// exponentiations are about four times cheaper than one with the full modulus.
+		static void rsadp_crt(BigInt *cipher, const BigInt *p, const BigInt *q, const BigInt *dp, const BigInt *dq, const BigInt *qinv, BigInt *msg);
+
 		// PKCS#1 v.1.5 message padding and encoding
 		// msg       - input message
 		// mlen      - length of input message, in bytes
@@ -125,6 +139,17 @@ namespace clan
 		// modulus   - decryption key modulus
 		static Secret pkcs1v15_decrypt(const char *msg, int mlen, const BigInt *d, const BigInt *modulus);
 
+		// Decrypt a message using RSA with the Chinese Remainder Theorem and PKCS#1 v.1.5 padding
+		// msg       - input message (ciphertext)
+		// mlen      - length of input message, in bytes
+		// p, q      - prime factors of the modulus, p > q
+		// dp, dq    - decryption exponent mod (p - 1) and mod (q - 1)
+		// qinv      - q^-1 mod p
+		static Secret pkcs1v15_decrypt_crt(const char *msg, int mlen, const BigInt *p, const BigInt *q, const BigInt *dp, const BigInt *dq, const BigInt *qinv);
+
+		static Secret to_secret(const BigInt &value);
+		static BigInt from_secret(const Secret &value);
+
 		RSAPrivateKey rsa_private_key;
 	};
 }
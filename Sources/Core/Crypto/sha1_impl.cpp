@@ -30,13 +30,160 @@
 #include "sha1_impl.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Crypto/sha1.h"
+#include "API/Core/System/cpu_features.h"
 
 #ifndef WIN32
 #include <cstring>
 #endif
 
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_SHA_NI
+#if defined(__GNUC__)
+#define CL_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define CL_TARGET_SHA
+#endif
+#endif
+#endif
+
 namespace clan
 {
+	namespace
+	{
+		typedef void(*SHA1Kernel)(uint32_t hash_state[5], const unsigned char *data, int num_blocks);
+
+		inline unsigned int leftrotate_uint32(unsigned int value, int shift)
+		{
+			return (value << shift) + (value >> (32 - shift));
+		}
+
+		void process_blocks_scalar(uint32_t hash_state[5], const unsigned char *data, int num_blocks)
+		{
+			for (int block = 0; block < num_blocks; block++, data += 64)
+			{
+				int i;
+				unsigned int w[80];
+
+				for (i = 0; i < 16; i++)
+				{
+					unsigned int b1 = data[i * 4];
+					unsigned int b2 = data[i * 4 + 1];
+					unsigned int b3 = data[i * 4 + 2];
+					unsigned int b4 = data[i * 4 + 3];
+					w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
+				}
+
+				for (i = 16; i < 80; i++)
+					w[i] = leftrotate_uint32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+				uint32_t a = hash_state[0];
+				uint32_t b = hash_state[1];
+				uint32_t c = hash_state[2];
+				uint32_t d = hash_state[3];
+				uint32_t e = hash_state[4];
+
+				for (i = 0; i < 80; i++)
+				{
+					uint32_t f, k;
+					if (i < 20)
+					{
+						f = (b & c) | ((~b) & d);
+						k = 0x5A827999;
+					}
+					else if (i < 40)
+					{
+						f = b ^ c ^ d;
+						k = 0x6ED9EBA1;
+					}
+					else if (i < 60)
+					{
+						f = (b & c) | (b & d) | (c & d);
+						k = 0x8F1BBCDC;
+					}
+					else
+					{
+						f = b ^ c ^ d;
+						k = 0xCA62C1D6;
+					}
+
+					uint32_t temp = leftrotate_uint32(a, 5) + f + e + k + w[i];
+					e = d;
+					d = c;
+					c = leftrotate_uint32(b, 30);
+					b = a;
+					a = temp;
+				}
+
+				hash_state[0] += a;
+				hash_state[1] += b;
+				hash_state[2] += c;
+				hash_state[3] += d;
+				hash_state[4] += e;
+			}
+		}
+
+#ifdef CL_SHA_NI
+		CL_TARGET_SHA void process_blocks_shani(uint32_t hash_state[5], const unsigned char *data, int num_blocks)
+		{
+			const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+			__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)hash_state), 0x1b);
+			__m128i e0 = _mm_set_epi32(hash_state[4], 0, 0, 0);
+
+			for (int block = 0; block < num_blocks; block++, data += 64)
+			{
+				__m128i abcd_save = abcd;
+				__m128i e0_save = e0;
+				__m128i e1;
+				__m128i msg[4];
+
+				// Each group does four rounds, alternating between e0 and e1 for the rotated E value.
+				// The message schedule for group i + 4 is built in msg[i & 3] over the three groups before it.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 20
+#endif
+				for (int group = 0; group < 20; group++)
+				{
+					if (group < 4)
+						msg[group] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + group * 16)), byte_swap);
+
+					__m128i &e_current = (group & 1) ? e1 : e0;
+					__m128i &e_next = (group & 1) ? e0 : e1;
+					if (group == 0)
+						e0 = _mm_add_epi32(e0, msg[0]);
+					else
+						e_current = _mm_sha1nexte_epu32(e_current, msg[group & 3]);
+					e_next = abcd;
+
+					if (group >= 3 && group < 19)
+						msg[(group + 1) & 3] = _mm_sha1msg2_epu32(msg[(group + 1) & 3], msg[group & 3]);
+
+					switch (group / 5)
+					{
+					case 0: abcd = _mm_sha1rnds4_epu32(abcd, e_current, 0); break;
+					case 1: abcd = _mm_sha1rnds4_epu32(abcd, e_current, 1); break;
+					case 2: abcd = _mm_sha1rnds4_epu32(abcd, e_current, 2); break;
+					default: abcd = _mm_sha1rnds4_epu32(abcd, e_current, 3); break;
+					}
+
+					if (group >= 1 && group < 17)
+						msg[(group - 1) & 3] = _mm_sha1msg1_epu32(msg[(group - 1) & 3], msg[group & 3]);
+					if (group >= 2 && group < 18)
+						msg[(group + 2) & 3] = _mm_xor_si128(msg[(group + 2) & 3], msg[group & 3]);
+				}
+
+				e0 = _mm_sha1nexte_epu32(e0, e0_save);
+				abcd = _mm_add_epi32(abcd, abcd_save);
+			}
+
+			_mm_storeu_si128((__m128i*)hash_state, _mm_shuffle_epi32(abcd, 0x1b));
+			hash_state[4] = _mm_extract_epi32(e0, 3);
+		}
+#endif
+	}
+
 	SHA1_Impl::SHA1_Impl()
 	{
 		reset();
@@ -48,11 +195,8 @@ namespace clan
 			throw Exception("SHA-1 hash has not been calculated yet!");
 
 		char digest[41];
-		to_hex_be(digest, h0, uppercase);
-		to_hex_be(digest + 8, h1, uppercase);
-		to_hex_be(digest + 16, h2, uppercase);
-		to_hex_be(digest + 24, h3, uppercase);
-		to_hex_be(digest + 32, h4, uppercase);
+		for (int i = 0; i < 5; i++)
+			to_hex_be(digest + i * 8, state[i], uppercase);
 		digest[40] = 0;
 		return digest;
 	}
@@ -62,36 +206,23 @@ namespace clan
 		if (calculated == false)
 			throw Exception("SHA-1 hash has not been calculated yet!");
 
-		out_hash[0] = (unsigned char)((h0 >> 24) & 0xff);
-		out_hash[1] = (unsigned char)((h0 >> 16) & 0xff);
-		out_hash[2] = (unsigned char)((h0 >> 8) & 0xff);
-		out_hash[3] = (unsigned char)(h0 & 0xff);
-		out_hash[4] = (unsigned char)((h1 >> 24) & 0xff);
-		out_hash[5] = (unsigned char)((h1 >> 16) & 0xff);
-		out_hash[6] = (unsigned char)((h1 >> 8) & 0xff);
-		out_hash[7] = (unsigned char)(h1 & 0xff);
-		out_hash[8] = (unsigned char)((h2 >> 24) & 0xff);
-		out_hash[9] = (unsigned char)((h2 >> 16) & 0xff);
-		out_hash[10] = (unsigned char)((h2 >> 8) & 0xff);
-		out_hash[11] = (unsigned char)(h2 & 0xff);
-		out_hash[12] = (unsigned char)((h3 >> 24) & 0xff);
-		out_hash[13] = (unsigned char)((h3 >> 16) & 0xff);
-		out_hash[14] = (unsigned char)((h3 >> 8) & 0xff);
-		out_hash[15] = (unsigned char)(h3 & 0xff);
-		out_hash[16] = (unsigned char)((h4 >> 24) & 0xff);
-		out_hash[17] = (unsigned char)((h4 >> 16) & 0xff);
-		out_hash[18] = (unsigned char)((h4 >> 8) & 0xff);
-		out_hash[19] = (unsigned char)(h4 & 0xff);
+		for (int i = 0; i < 5; i++)
+		{
+			out_hash[i * 4] = (unsigned char)((state[i] >> 24) & 0xff);
+			out_hash[i * 4 + 1] = (unsigned char)((state[i] >> 16) & 0xff);
+			out_hash[i * 4 + 2] = (unsigned char)((state[i] >> 8) & 0xff);
+			out_hash[i * 4 + 3] = (unsigned char)(state[i] & 0xff);
+		}
 	}
 
 	void SHA1_Impl::reset()
 	{
 		//  FIPS 180-3 section 5.3.1
-		h0 = 0x67452301;
-		h1 = 0xEFCDAB89;
-		h2 = 0x98BADCFE;
-		h3 = 0x10325476;
-		h4 = 0xC3D2E1F0;
+		state[0] = 0x67452301;
+		state[1] = 0xEFCDAB89;
+		state[2] = 0x98BADCFE;
+		state[3] = 0x10325476;
+		state[4] = 0xC3D2E1F0;
 		memset(chunk, 0, block_size);
 		chunk_filled = 0;
 		length_message = 0;
@@ -107,20 +238,34 @@ namespace clan
 
 		const unsigned char *data = (const unsigned char *)_data;
 		int pos = 0;
-		while (pos < size)
+
+		// Complete a partially filled chunk first
+		if (chunk_filled > 0)
 		{
-			int data_left = size - pos;
-			int buffer_space = block_size - chunk_filled;
-			int data_used = min(buffer_space, data_left);
-			memcpy(chunk + chunk_filled, data + pos, data_used);
+			int data_used = min(block_size - chunk_filled, size);
+			memcpy(chunk + chunk_filled, data, data_used);
 			chunk_filled += data_used;
 			pos += data_used;
 			if (chunk_filled == block_size)
 			{
-				process_chunk();
+				process_blocks(state, chunk, 1);
 				chunk_filled = 0;
 			}
 		}
+
+		// Whole blocks are hashed directly from the input
+		int num_blocks = (size - pos) / block_size;
+		if (num_blocks > 0)
+		{
+			process_blocks(state, data + pos, num_blocks);
+			pos += num_blocks * block_size;
+		}
+
+		if (pos < size)
+		{
+			memcpy(chunk + chunk_filled, data + pos, size - pos);
+			chunk_filled += size - pos;
+		}
 		length_message += size * (uint64_t)8;
 	}
 
@@ -203,65 +348,13 @@ namespace clan
 		}
 	}
 
-	void SHA1_Impl::process_chunk()
+	void SHA1_Impl::process_blocks(uint32_t hash_state[5], const unsigned char *data, int num_blocks)
 	{
-		int i;
-		unsigned int w[80];
-
-		for (i = 0; i < 16; i++)
-		{
-			unsigned int b1 = chunk[i * 4];
-			unsigned int b2 = chunk[i * 4 + 1];
-			unsigned int b3 = chunk[i * 4 + 2];
-			unsigned int b4 = chunk[i * 4 + 3];
-			w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
-		}
-
-		for (i = 16; i < 80; i++)
-			w[i] = leftrotate_uint32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
-
-		uint32_t a = h0;
-		uint32_t b = h1;
-		uint32_t c = h2;
-		uint32_t d = h3;
-		uint32_t e = h4;
-
-		for (i = 0; i < 80; i++)
-		{
-			uint32_t f, k;
-			if (i < 20)
-			{
-				f = (b & c) | ((~b) & d);
-				k = 0x5A827999;
-			}
-			else if (i < 40)
-			{
-				f = b ^ c ^ d;
-				k = 0x6ED9EBA1;
-			}
-			else if (i < 60)
-			{
-				f = (b & c) | (b & d) | (c & d);
-				k = 0x8F1BBCDC;
-			}
-			else
-			{
-				f = b ^ c ^ d;
-				k = 0xCA62C1D6;
-			}
-
-			uint32_t temp = leftrotate_uint32(a, 5) + f + e + k + w[i];
-			e = d;
-			d = c;
-			c = leftrotate_uint32(b, 30);
-			b = a;
-			a = temp;
-		}
-
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
+#ifdef CL_SHA_NI
+		static const CPUDispatch<SHA1Kernel> kernel({ { { System::sha, System::sse4_1, System::ssse3 }, process_blocks_shani } }, process_blocks_scalar);
+#else
+		static const CPUDispatch<SHA1Kernel> kernel({}, process_blocks_scalar);
+#endif
+		kernel(hash_state, data, num_blocks);
 	}
 }
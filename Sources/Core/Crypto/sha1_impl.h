@@ -45,15 +45,13 @@ namespace clan
 		void add(const void *data, int size);
 		void calculate();
 
-	private:
-		void process_chunk();
-
-		inline unsigned int leftrotate_uint32(unsigned int value, int shift) const
-		{
-			return (value << shift) + (value >> (32 - shift));
-		}
+		/// \brief Runs the compression function over whole 64 byte blocks
+		///
+		/// Uses the SHA extensions (SHA-NI) when the CPU supports them.
+		static void process_blocks(uint32_t hash_state[5], const unsigned char *data, int num_blocks);
 
-		uint32_t h0, h1, h2, h3, h4;
+	private:
+		uint32_t state[5];
 		const static int block_size = 64;
 		unsigned char chunk[block_size];
 		int chunk_filled;
@@ -31,13 +31,192 @@
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Crypto/sha224.h"
 #include "API/Core/Crypto/sha256.h"
+#include "API/Core/System/cpu_features.h"
 
 #ifndef WIN32
 #include <cstring>
 #endif
 
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_SHA_NI
+#if defined(__GNUC__)
+#define CL_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define CL_TARGET_SHA
+#endif
+#endif
+#endif
+
 namespace clan
 {
+	namespace
+	{
+		// Constants defined in FIPS 180-3, section 4.2.2
+		alignas(16) const uint32_t constant_K[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+			0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+			0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+			0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+			0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+			0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+			0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+			0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+			0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+			0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+			0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+			0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+		};
+
+		typedef void(*SHA256Kernel)(uint32_t hash_state[8], const unsigned char *data, int num_blocks);
+
+		inline uint32_t rightrotate(uint32_t value, int shift)
+		{
+			return (value >> shift) | (value << (32 - shift));
+		}
+
+		inline uint32_t sigma_rr2_rr13_rr22(uint32_t value)
+		{
+			return (rightrotate(value, 2) ^ rightrotate(value, 13) ^ rightrotate(value, 22));
+		}
+
+		inline uint32_t sigma_rr6_rr11_rr25(uint32_t value)
+		{
+			return (rightrotate(value, 6) ^ rightrotate(value, 11) ^ rightrotate(value, 25));
+		}
+
+		inline uint32_t sigma_rr7_rr18_sr3(uint32_t value)
+		{
+			return (rightrotate(value, 7) ^ rightrotate(value, 18) ^ (value >> 3));
+		}
+
+		inline uint32_t sigma_rr17_rr19_sr10(uint32_t value)
+		{
+			return (rightrotate(value, 17) ^ rightrotate(value, 19) ^ (value >> 10));
+		}
+
+		inline uint32_t sha_ch(uint32_t x, uint32_t y, uint32_t z)
+		{
+			return (((x)& ((y) ^ (z))) ^ (z));
+		}
+
+		inline uint32_t sha_maj(uint32_t x, uint32_t y, uint32_t z)
+		{
+			return  (((x)& ((y) | (z))) | ((y)& (z)));
+		}
+
+		void process_blocks_scalar(uint32_t hash_state[8], const unsigned char *data, int num_blocks)
+		{
+			for (int block = 0; block < num_blocks; block++, data += 64)
+			{
+				int i;
+				unsigned int w[64];
+
+				for (i = 0; i < 16; i++)
+				{
+					unsigned int b1 = data[i * 4];
+					unsigned int b2 = data[i * 4 + 1];
+					unsigned int b3 = data[i * 4 + 2];
+					unsigned int b4 = data[i * 4 + 3];
+					w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
+				}
+
+				for (i = 16; i < 64; i++)
+				{
+					w[i] = sigma_rr17_rr19_sr10(w[i - 2]) + w[i - 7] + sigma_rr7_rr18_sr3(w[i - 15]) + w[i - 16];
+				}
+
+				uint32_t a = hash_state[0];
+				uint32_t b = hash_state[1];
+				uint32_t c = hash_state[2];
+				uint32_t d = hash_state[3];
+				uint32_t e = hash_state[4];
+				uint32_t f = hash_state[5];
+				uint32_t g = hash_state[6];
+				uint32_t h = hash_state[7];
+
+				for (i = 0; i < 64; i++)
+				{
+					uint32_t t1, t2;
+
+					t1 = h + sigma_rr6_rr11_rr25(e) + sha_ch(e, f, g) + constant_K[i] + w[i];
+					t2 = sigma_rr2_rr13_rr22(a) + sha_maj(a, b, c);
+					h = g;
+					g = f;
+					f = e;
+					e = d + t1;
+					d = c;
+					c = b;
+					b = a;
+					a = t1 + t2;
+				}
+
+				hash_state[0] += a;
+				hash_state[1] += b;
+				hash_state[2] += c;
+				hash_state[3] += d;
+				hash_state[4] += e;
+				hash_state[5] += f;
+				hash_state[6] += g;
+				hash_state[7] += h;
+			}
+		}
+
+#ifdef CL_SHA_NI
+		CL_TARGET_SHA void process_blocks_shani(uint32_t hash_state[8], const unsigned char *data, int num_blocks)
+		{
+			// The SHA-NI instructions keep the state as ABEF and CDGH, and do two rounds at a time
+			const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+			__m128i dcba = _mm_loadu_si128((const __m128i*)&hash_state[0]);
+			__m128i hgfe = _mm_loadu_si128((const __m128i*)&hash_state[4]);
+			__m128i cdab = _mm_shuffle_epi32(dcba, 0xb1);
+			__m128i efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+			__m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+			__m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+			for (int block = 0; block < num_blocks; block++, data += 64)
+			{
+				__m128i abef_save = abef;
+				__m128i cdgh_save = cdgh;
+				__m128i msg[4];
+
+				// Each group does four rounds. The message schedule for group i + 4 is built in msg[i & 3] over the three groups before it.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 16
+#endif
+				for (int group = 0; group < 16; group++)
+				{
+					if (group < 4)
+						msg[group] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + group * 16)), byte_swap);
+
+					__m128i wk = _mm_add_epi32(msg[group & 3], _mm_load_si128((const __m128i*)&constant_K[group * 4]));
+					cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+					if (group >= 3 && group < 15)
+					{
+						__m128i &next = msg[(group + 1) & 3];
+						next = _mm_add_epi32(next, _mm_alignr_epi8(msg[group & 3], msg[(group - 1) & 3], 4));
+						next = _mm_sha256msg2_epu32(next, msg[group & 3]);
+					}
+					abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0e));
+					if (group >= 1 && group < 13)
+						msg[(group - 1) & 3] = _mm_sha256msg1_epu32(msg[(group - 1) & 3], msg[group & 3]);
+				}
+
+				abef = _mm_add_epi32(abef, abef_save);
+				cdgh = _mm_add_epi32(cdgh, cdgh_save);
+			}
+
+			__m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+			__m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+			_mm_storeu_si128((__m128i*)&hash_state[0], _mm_blend_epi16(feba, dchg, 0xf0));
+			_mm_storeu_si128((__m128i*)&hash_state[4], _mm_alignr_epi8(dchg, feba, 8));
+		}
+#endif
+	}
+
 	SHA256_Impl::SHA256_Impl(cl_sha_type new_sha_type) : sha_type(new_sha_type)
 	{
 		reset();
@@ -49,24 +228,10 @@ namespace clan
 			throw Exception("SHA-256 hash has not been calculated yet!");
 
 		char digest[32 * 2 + 1];
-		to_hex_be(digest, h0, uppercase);
-		to_hex_be(digest + 8, h1, uppercase);
-		to_hex_be(digest + 16, h2, uppercase);
-		to_hex_be(digest + 24, h3, uppercase);
-		to_hex_be(digest + 32, h4, uppercase);
-		to_hex_be(digest + 40, h5, uppercase);
-		to_hex_be(digest + 48, h6, uppercase);
-
-		if (sha_type == cl_sha_224)
-		{
-			digest[56] = 0;
-		}
-		else
-		{
-			// Must be cl_sha_256
-			to_hex_be(digest + 56, h7, uppercase);
-			digest[64] = 0;
-		}
+		int hash_words = (sha_type == cl_sha_224) ? 7 : 8;
+		for (int i = 0; i < hash_words; i++)
+			to_hex_be(digest + i * 8, state[i], uppercase);
+		digest[hash_words * 8] = 0;
 		return digest;
 	}
 
@@ -75,68 +240,40 @@ namespace clan
 		if (calculated == false)
 			throw Exception("SHA-256 hash has not been calculated yet!");
 
-		out_hash[0] = (unsigned char)((h0 >> 24) & 0xff);
-		out_hash[1] = (unsigned char)((h0 >> 16) & 0xff);
-		out_hash[2] = (unsigned char)((h0 >> 8) & 0xff);
-		out_hash[3] = (unsigned char)(h0 & 0xff);
-		out_hash[4] = (unsigned char)((h1 >> 24) & 0xff);
-		out_hash[5] = (unsigned char)((h1 >> 16) & 0xff);
-		out_hash[6] = (unsigned char)((h1 >> 8) & 0xff);
-		out_hash[7] = (unsigned char)(h1 & 0xff);
-		out_hash[8] = (unsigned char)((h2 >> 24) & 0xff);
-		out_hash[9] = (unsigned char)((h2 >> 16) & 0xff);
-		out_hash[10] = (unsigned char)((h2 >> 8) & 0xff);
-		out_hash[11] = (unsigned char)(h2 & 0xff);
-		out_hash[12] = (unsigned char)((h3 >> 24) & 0xff);
-		out_hash[13] = (unsigned char)((h3 >> 16) & 0xff);
-		out_hash[14] = (unsigned char)((h3 >> 8) & 0xff);
-		out_hash[15] = (unsigned char)(h3 & 0xff);
-		out_hash[16] = (unsigned char)((h4 >> 24) & 0xff);
-		out_hash[17] = (unsigned char)((h4 >> 16) & 0xff);
-		out_hash[18] = (unsigned char)((h4 >> 8) & 0xff);
-		out_hash[19] = (unsigned char)(h4 & 0xff);
-		out_hash[20] = (unsigned char)((h5 >> 24) & 0xff);
-		out_hash[21] = (unsigned char)((h5 >> 16) & 0xff);
-		out_hash[22] = (unsigned char)((h5 >> 8) & 0xff);
-		out_hash[23] = (unsigned char)(h5 & 0xff);
-		out_hash[24] = (unsigned char)((h6 >> 24) & 0xff);
-		out_hash[25] = (unsigned char)((h6 >> 16) & 0xff);
-		out_hash[26] = (unsigned char)((h6 >> 8) & 0xff);
-		out_hash[27] = (unsigned char)(h6 & 0xff);
-
-		if (sha_type == cl_sha_256)
+		int hash_words = (sha_type == cl_sha_224) ? 7 : 8;
+		for (int i = 0; i < hash_words; i++)
 		{
-			out_hash[28] = (unsigned char)((h7 >> 24) & 0xff);
-			out_hash[29] = (unsigned char)((h7 >> 16) & 0xff);
-			out_hash[30] = (unsigned char)((h7 >> 8) & 0xff);
-			out_hash[31] = (unsigned char)(h7 & 0xff);
-		}	// Else cl_sha_224
+			out_hash[i * 4] = (unsigned char)((state[i] >> 24) & 0xff);
+			out_hash[i * 4 + 1] = (unsigned char)((state[i] >> 16) & 0xff);
+			out_hash[i * 4 + 2] = (unsigned char)((state[i] >> 8) & 0xff);
+			out_hash[i * 4 + 3] = (unsigned char)(state[i] & 0xff);
+		}
 	}
 
 	void SHA256_Impl::reset()
 	{
 		if (sha_type == cl_sha_224)
 		{
-			h0 = 0xc1059ed8;
-			h1 = 0x367cd507;
-			h2 = 0x3070dd17;
-			h3 = 0xf70e5939;
-			h4 = 0xffc00b31;
-			h5 = 0x68581511;
-			h6 = 0x64f98fa7;
-			h7 = 0xbefa4fa4;
+			state[0] = 0xc1059ed8;
+			state[1] = 0x367cd507;
+			state[2] = 0x3070dd17;
+			state[3] = 0xf70e5939;
+			state[4] = 0xffc00b31;
+			state[5] = 0x68581511;
+			state[6] = 0x64f98fa7;
+			state[7] = 0xbefa4fa4;
 		}
 		else if (sha_type == cl_sha_256)
 		{
 			// These words were obtained by taking the first thirty-two bits of the fractional parts of the square roots of the first eight prime numbers
-			h0 = 0x6a09e667;
-			h1 = 0xbb67ae85;
-			h2 = 0x3c6ef372;
-			h3 = 0xa54ff53a;
-			h4 = 0x510e527f;
-			h5 = 0x9b05688c;
-			h6 = 0x1f83d9ab;
-			h7 = 0x5be0cd19;
+			state[0] = 0x6a09e667;
+			state[1] = 0xbb67ae85;
+			state[2] = 0x3c6ef372;
+			state[3] = 0xa54ff53a;
+			state[4] = 0x510e527f;
+			state[5] = 0x9b05688c;
+			state[6] = 0x1f83d9ab;
+			state[7] = 0x5be0cd19;
 		}
 		else
 		{
@@ -157,20 +294,34 @@ namespace clan
 
 		const unsigned char *data = (const unsigned char *)_data;
 		int pos = 0;
-		while (pos < size)
+
+		// Complete a partially filled chunk first
+		if (chunk_filled > 0)
 		{
-			int data_left = size - pos;
-			int buffer_space = block_size - chunk_filled;
-			int data_used = min(buffer_space, data_left);
-			memcpy(chunk + chunk_filled, data + pos, data_used);
+			int data_used = min(block_size - chunk_filled, size);
+			memcpy(chunk + chunk_filled, data, data_used);
 			chunk_filled += data_used;
 			pos += data_used;
 			if (chunk_filled == block_size)
 			{
-				process_chunk();
+				process_blocks(state, chunk, 1);
 				chunk_filled = 0;
 			}
 		}
+
+		// Whole blocks are hashed directly from the input
+		int num_blocks = (size - pos) / block_size;
+		if (num_blocks > 0)
+		{
+			process_blocks(state, data + pos, num_blocks);
+			pos += num_blocks * block_size;
+		}
+
+		if (pos < size)
+		{
+			memcpy(chunk + chunk_filled, data + pos, size - pos);
+			chunk_filled += size - pos;
+		}
 		length_message += size * (uint64_t)8;
 	}
 
@@ -281,74 +432,13 @@ namespace clan
 		}
 	}
 
-	void SHA256_Impl::process_chunk()
+	void SHA256_Impl::process_blocks(uint32_t hash_state[8], const unsigned char *data, int num_blocks)
 	{
-		// Constants defined in FIPS 180-3, section 4.2.2
-		static const uint32_t constant_K[64] = {
-			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-			0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-			0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-			0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-			0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-			0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-			0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-			0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-			0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-			0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-			0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-			0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-		};
-
-		int i;
-		unsigned int w[64];
-
-		for (i = 0; i < 16; i++)
-		{
-			unsigned int b1 = chunk[i * 4];
-			unsigned int b2 = chunk[i * 4 + 1];
-			unsigned int b3 = chunk[i * 4 + 2];
-			unsigned int b4 = chunk[i * 4 + 3];
-			w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
-		}
-
-		for (i = 16; i < 64; i++)
-		{
-			w[i] = sigma_rr17_rr19_sr10(w[i - 2]) + w[i - 7] + sigma_rr7_rr18_sr3(w[i - 15]) + w[i - 16];
-		}
-
-		uint32_t a = h0;
-		uint32_t b = h1;
-		uint32_t c = h2;
-		uint32_t d = h3;
-		uint32_t e = h4;
-		uint32_t f = h5;
-		uint32_t g = h6;
-		uint32_t h = h7;
-
-		for (i = 0; i < 64; i++)
-		{
-			uint32_t t1, t2;
-
-			t1 = h + sigma_rr6_rr11_rr25(e) + sha_ch(e, f, g) + constant_K[i] + w[i];
-			t2 = sigma_rr2_rr13_rr22(a) + sha_maj(a, b, c);
-			h = g;
-			g = f;
-			f = e;
-			e = d + t1;
-			d = c;
-			c = b;
-			b = a;
-			a = t1 + t2;
-		}
-
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
-		h5 += f;
-		h6 += g;
-		h7 += h;
+#ifdef CL_SHA_NI
+		static const CPUDispatch<SHA256Kernel> kernel({ { { System::sha, System::sse4_1, System::ssse3 }, process_blocks_shani } }, process_blocks_scalar);
+#else
+		static const CPUDispatch<SHA256Kernel> kernel({}, process_blocks_scalar);
+#endif
+		kernel(hash_state, data, num_blocks);
 	}
 }
@@ -45,40 +45,13 @@ namespace clan
 		void add(const void *data, int size);
 		void calculate();
 
-	private:
-		inline uint32_t sigma_rr2_rr13_rr22(uint32_t value) const
-		{
-			return (rightrotate_uint32(value, 2) ^ rightrotate_uint32(value, 13) ^ rightrotate_uint32(value, 22));
-		}
-
-		inline uint32_t sigma_rr6_rr11_rr25(uint32_t value) const
-		{
-			return (rightrotate_uint32(value, 6) ^ rightrotate_uint32(value, 11) ^ rightrotate_uint32(value, 25));
-		}
-
-		inline uint32_t sigma_rr7_rr18_sr3(uint32_t value) const
-		{
-			return (rightrotate_uint32(value, 7) ^ rightrotate_uint32(value, 18) ^ (value >> 3));
-		}
-
-		inline uint32_t sigma_rr17_rr19_sr10(uint32_t value) const
-		{
-			return (rightrotate_uint32(value, 17) ^ rightrotate_uint32(value, 19) ^ (value >> 10));
-		}
+		/// \brief Runs the compression function over whole 64 byte blocks
+		///
+		/// Uses the SHA extensions (SHA-NI) when the CPU supports them.
+		static void process_blocks(uint32_t hash_state[8], const unsigned char *data, int num_blocks);
 
-		inline uint32_t sha_ch(uint32_t x, uint32_t y, uint32_t z) const
-		{
-			return (((x)& ((y) ^ (z))) ^ (z));
-		}
-
-		inline uint32_t sha_maj(uint32_t x, uint32_t y, uint32_t z) const
-		{
-			return  (((x)& ((y) | (z))) | ((y)& (z)));
-		}
-
-		void process_chunk();
-
-		uint32_t h0, h1, h2, h3, h4, h5, h6, h7;
+	private:
+		uint32_t state[8];
 		const static int block_size = 64;
 		unsigned char chunk[block_size];
 		int chunk_filled;
@@ -0,0 +1,510 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "sha_multi_buffer.h"
+#include "sha1_impl.h"
+#include "sha256_impl.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/cpu_features.h"
+#include <climits>
+
+#ifndef WIN32
+#include <cstring>
+#endif
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_SHA_AVX2
+#if defined(__GNUC__)
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_AVX2
+#endif
+#endif
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		const int lane_count = 8;
+		const int block_size = 64;
+
+		// Runs the compression function on num_blocks consecutive blocks of each lane. hash_state[word][lane] holds the state words.
+		typedef void(*MultiBufferKernel)(uint32_t (*hash_state)[lane_count], const unsigned char * const *blocks, int num_blocks);
+
+		// Runs the compression function on whole blocks of a single message
+		typedef void(*SingleBufferKernel)(uint32_t *hash_state, const unsigned char *data, int num_blocks);
+
+		const uint32_t sha1_initial_state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+		const uint32_t sha256_initial_state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+		void sha1_single(uint32_t *hash_state, const unsigned char *data, int num_blocks)
+		{
+			SHA1_Impl::process_blocks(hash_state, data, num_blocks);
+		}
+
+		void sha256_single(uint32_t *hash_state, const unsigned char *data, int num_blocks)
+		{
+			SHA256_Impl::process_blocks(hash_state, data, num_blocks);
+		}
+
+		// A message being hashed in one of the lanes. The whole blocks are read directly from the message,
+		// and the remaining bytes with the padding and length are copied to the tail blocks.
+		class MultiBufferLane
+		{
+		public:
+			void start(int new_message, const unsigned char *data, int size)
+			{
+				message = new_message;
+				int full_blocks = size / block_size;
+				int rest = size % block_size;
+
+				memset(tail, 0, sizeof(tail));
+				if (rest > 0)
+					memcpy(tail, data + full_blocks * block_size, rest);
+				tail[rest] = 0x80;
+				tail_blocks = (rest + 9 <= block_size) ? 1 : 2;
+
+				uint64_t length_bits = (uint64_t)size * 8;
+				unsigned char *length = tail + tail_blocks * block_size - 8;
+				for (int i = 0; i < 8; i++)
+					length[i] = (unsigned char)(length_bits >> (56 - i * 8));
+
+				blocks = data;
+				blocks_left = full_blocks;
+				in_tail = false;
+				if (blocks_left == 0)
+					next_segment();
+			}
+
+			// Moves on to the tail blocks, returning false if they are already done
+			bool next_segment()
+			{
+				if (in_tail)
+					return false;
+				blocks = tail;
+				blocks_left = tail_blocks;
+				in_tail = true;
+				return true;
+			}
+
+			int message = -1;
+			const unsigned char *blocks = nullptr;
+			int blocks_left = 0;
+			bool in_tail = false;
+			int tail_blocks = 0;
+			unsigned char tail[block_size * 2];
+		};
+
+		template<int StateWords, int HashSize>
+		void hash_multi_buffer(MultiBufferKernel kernel, SingleBufferKernel single, const uint32_t *initial_state, const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[HashSize])
+		{
+			// With only a few lanes left in use, hashing them one at a time is faster
+			const int min_active_lanes = 3;
+
+			MultiBufferLane lanes[lane_count];
+			alignas(32) uint32_t hash_state[StateWords][lane_count];
+			int next_message = 0;
+
+			auto store_hash = [&](const uint32_t *words, int message)
+			{
+				for (int i = 0; i < HashSize / 4; i++)
+				{
+					out_hashes[message][i * 4] = (unsigned char)(words[i] >> 24);
+					out_hashes[message][i * 4 + 1] = (unsigned char)(words[i] >> 16);
+					out_hashes[message][i * 4 + 2] = (unsigned char)(words[i] >> 8);
+					out_hashes[message][i * 4 + 3] = (unsigned char)words[i];
+				}
+			};
+
+			auto start_next_message = [&](int lane)
+			{
+				if (next_message < count)
+				{
+					for (int i = 0; i < StateWords; i++)
+						hash_state[i][lane] = initial_state[i];
+					lanes[lane].start(next_message, (const unsigned char *)data[next_message], sizes[next_message]);
+					next_message++;
+				}
+				else
+				{
+					lanes[lane].message = -1;
+				}
+			};
+
+			for (int lane = 0; lane < lane_count; lane++)
+				start_next_message(lane);
+
+			while (true)
+			{
+				int active_lanes = 0;
+				int num_blocks = INT_MAX;
+				const unsigned char *active_blocks = nullptr;
+				for (auto &lane : lanes)
+				{
+					if (lane.message >= 0)
+					{
+						active_lanes++;
+						num_blocks = min(num_blocks, lane.blocks_left);
+						active_blocks = lane.blocks;
+					}
+				}
+
+				if (active_lanes == 0)
+					break;
+
+				if (next_message == count && active_lanes < min_active_lanes)
+				{
+					for (int lane = 0; lane < lane_count; lane++)
+					{
+						if (lanes[lane].message < 0)
+							continue;
+
+						uint32_t words[StateWords];
+						for (int i = 0; i < StateWords; i++)
+							words[i] = hash_state[i][lane];
+						do
+						{
+							single(words, lanes[lane].blocks, lanes[lane].blocks_left);
+						} while (lanes[lane].next_segment());
+						store_hash(words, lanes[lane].message);
+					}
+					break;
+				}
+
+				// Unused lanes hash a copy of an active lane, and the result is ignored
+				const unsigned char *blocks[lane_count];
+				for (int lane = 0; lane < lane_count; lane++)
+					blocks[lane] = (lanes[lane].message >= 0) ? lanes[lane].blocks : active_blocks;
+
+				kernel(hash_state, blocks, num_blocks);
+
+				for (int lane = 0; lane < lane_count; lane++)
+				{
+					if (lanes[lane].message < 0)
+						continue;
+
+					lanes[lane].blocks += num_blocks * block_size;
+					lanes[lane].blocks_left -= num_blocks;
+					if (lanes[lane].blocks_left == 0 && !lanes[lane].next_segment())
+					{
+						uint32_t words[StateWords];
+						for (int i = 0; i < StateWords; i++)
+							words[i] = hash_state[i][lane];
+						store_hash(words, lanes[lane].message);
+						start_next_message(lane);
+					}
+				}
+			}
+		}
+
+		template<int StateWords, int HashSize>
+		void hash_one_at_a_time(SingleBufferKernel single, const uint32_t *initial_state, const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[HashSize])
+		{
+			for (int message = 0; message < count; message++)
+			{
+				MultiBufferLane lane;
+				lane.start(message, (const unsigned char *)data[message], sizes[message]);
+
+				uint32_t words[StateWords];
+				memcpy(words, initial_state, sizeof(words));
+				do
+				{
+					single(words, lane.blocks, lane.blocks_left);
+				} while (lane.next_segment());
+
+				for (int i = 0; i < HashSize / 4; i++)
+				{
+					out_hashes[message][i * 4] = (unsigned char)(words[i] >> 24);
+					out_hashes[message][i * 4 + 1] = (unsigned char)(words[i] >> 16);
+					out_hashes[message][i * 4 + 2] = (unsigned char)(words[i] >> 8);
+					out_hashes[message][i * 4 + 3] = (unsigned char)words[i];
+				}
+			}
+		}
+
+		typedef void(*SHA1MultiBufferFunction)(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[20]);
+		typedef void(*SHA256MultiBufferFunction)(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[32]);
+
+		void sha1_one_at_a_time(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[20])
+		{
+			hash_one_at_a_time<5, 20>(sha1_single, sha1_initial_state, data, sizes, count, out_hashes);
+		}
+
+		void sha256_one_at_a_time(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[32])
+		{
+			hash_one_at_a_time<8, 32>(sha256_single, sha256_initial_state, data, sizes, count, out_hashes);
+		}
+
+#ifdef CL_SHA_AVX2
+
+		template<int shift>
+		CL_TARGET_AVX2 inline __m256i rightrotate(__m256i value)
+		{
+			return _mm256_or_si256(_mm256_srli_epi32(value, shift), _mm256_slli_epi32(value, 32 - shift));
+		}
+
+		template<int shift>
+		CL_TARGET_AVX2 inline __m256i leftrotate(__m256i value)
+		{
+			return _mm256_or_si256(_mm256_slli_epi32(value, shift), _mm256_srli_epi32(value, 32 - shift));
+		}
+
+		// Loads eight big endian words at offset from each lane, and transposes them so that w[i] holds word i of every lane
+		CL_TARGET_AVX2 inline void load_transposed(const unsigned char * const *blocks, int offset, __m256i w[8])
+		{
+			const __m256i byte_swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+			__m256i row[8];
+			for (int lane = 0; lane < lane_count; lane++)
+				row[lane] = _mm256_loadu_si256((const __m256i*)(blocks[lane] + offset));
+
+			__m256i t0 = _mm256_unpacklo_epi32(row[0], row[1]);
+			__m256i t1 = _mm256_unpackhi_epi32(row[0], row[1]);
+			__m256i t2 = _mm256_unpacklo_epi32(row[2], row[3]);
+			__m256i t3 = _mm256_unpackhi_epi32(row[2], row[3]);
+			__m256i t4 = _mm256_unpacklo_epi32(row[4], row[5]);
+			__m256i t5 = _mm256_unpackhi_epi32(row[4], row[5]);
+			__m256i t6 = _mm256_unpacklo_epi32(row[6], row[7]);
+			__m256i t7 = _mm256_unpackhi_epi32(row[6], row[7]);
+
+			__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+			__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+			__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+			__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+			__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+			__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+			__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+			__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+			w[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x20), byte_swap);
+			w[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x20), byte_swap);
+			w[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x20), byte_swap);
+			w[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x20), byte_swap);
+			w[4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x31), byte_swap);
+			w[5] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x31), byte_swap);
+			w[6] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x31), byte_swap);
+			w[7] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x31), byte_swap);
+		}
+
+		CL_TARGET_AVX2 void sha1_avx2(uint32_t (*hash_state)[lane_count], const unsigned char * const *blocks, int num_blocks)
+		{
+			__m256i state[5];
+			for (int i = 0; i < 5; i++)
+				state[i] = _mm256_load_si256((const __m256i*)hash_state[i]);
+
+			const unsigned char *pointers[lane_count];
+			for (int lane = 0; lane < lane_count; lane++)
+				pointers[lane] = blocks[lane];
+
+			for (int block = 0; block < num_blocks; block++)
+			{
+				__m256i w[16];
+				load_transposed(pointers, 0, w);
+				load_transposed(pointers, 32, w + 8);
+
+				__m256i a = state[0];
+				__m256i b = state[1];
+				__m256i c = state[2];
+				__m256i d = state[3];
+				__m256i e = state[4];
+
+				for (int i = 0; i < 80; i++)
+				{
+					if (i >= 16)
+						w[i & 15] = leftrotate<1>(_mm256_xor_si256(_mm256_xor_si256(w[(i - 3) & 15], w[(i - 8) & 15]), _mm256_xor_si256(w[(i - 14) & 15], w[i & 15])));
+
+					__m256i f, k;
+					if (i < 20)
+					{
+						f = _mm256_xor_si256(_mm256_and_si256(b, _mm256_xor_si256(c, d)), d);
+						k = _mm256_set1_epi32(0x5A827999);
+					}
+					else if (i < 40)
+					{
+						f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+						k = _mm256_set1_epi32(0x6ED9EBA1);
+					}
+					else if (i < 60)
+					{
+						f = _mm256_or_si256(_mm256_and_si256(b, _mm256_or_si256(c, d)), _mm256_and_si256(c, d));
+						k = _mm256_set1_epi32(0x8F1BBCDC);
+					}
+					else
+					{
+						f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+						k = _mm256_set1_epi32(0xCA62C1D6);
+					}
+
+					__m256i temp = _mm256_add_epi32(_mm256_add_epi32(leftrotate<5>(a), f), _mm256_add_epi32(_mm256_add_epi32(e, k), w[i & 15]));
+					e = d;
+					d = c;
+					c = leftrotate<30>(b);
+					b = a;
+					a = temp;
+				}
+
+				state[0] = _mm256_add_epi32(state[0], a);
+				state[1] = _mm256_add_epi32(state[1], b);
+				state[2] = _mm256_add_epi32(state[2], c);
+				state[3] = _mm256_add_epi32(state[3], d);
+				state[4] = _mm256_add_epi32(state[4], e);
+
+				for (int lane = 0; lane < lane_count; lane++)
+					pointers[lane] += block_size;
+			}
+
+			for (int i = 0; i < 5; i++)
+				_mm256_store_si256((__m256i*)hash_state[i], state[i]);
+		}
+
+		CL_TARGET_AVX2 void sha256_avx2(uint32_t (*hash_state)[lane_count], const unsigned char * const *blocks, int num_blocks)
+		{
+			// Constants defined in FIPS 180-3, section 4.2.2
+			static const uint32_t constant_K[64] = {
+				0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+				0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+				0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+				0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+				0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+				0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+				0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+				0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+				0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+				0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+				0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+				0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+				0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+			};
+
+			__m256i state[8];
+			for (int i = 0; i < 8; i++)
+				state[i] = _mm256_load_si256((const __m256i*)hash_state[i]);
+
+			const unsigned char *pointers[lane_count];
+			for (int lane = 0; lane < lane_count; lane++)
+				pointers[lane] = blocks[lane];
+
+			for (int block = 0; block < num_blocks; block++)
+			{
+				__m256i w[16];
+				load_transposed(pointers, 0, w);
+				load_transposed(pointers, 32, w + 8);
+
+				__m256i a = state[0];
+				__m256i b = state[1];
+				__m256i c = state[2];
+				__m256i d = state[3];
+				__m256i e = state[4];
+				__m256i f = state[5];
+				__m256i g = state[6];
+				__m256i h = state[7];
+
+				for (int i = 0; i < 64; i++)
+				{
+					if (i >= 16)
+					{
+						__m256i w2 = w[(i - 2) & 15];
+						__m256i w15 = w[(i - 15) & 15];
+						__m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rightrotate<17>(w2), rightrotate<19>(w2)), _mm256_srli_epi32(w2, 10));
+						__m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rightrotate<7>(w15), rightrotate<18>(w15)), _mm256_srli_epi32(w15, 3));
+						w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(sigma1, w[(i - 7) & 15]), _mm256_add_epi32(sigma0, w[i & 15]));
+					}
+
+					__m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(rightrotate<6>(e), rightrotate<11>(e)), rightrotate<25>(e));
+					__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, _mm256_xor_si256(f, g)), g);
+					__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(constant_K[i]), w[i & 15])));
+
+					__m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(rightrotate<2>(a), rightrotate<13>(a)), rightrotate<22>(a));
+					__m256i maj = _mm256_or_si256(_mm256_and_si256(a, _mm256_or_si256(b, c)), _mm256_and_si256(b, c));
+					__m256i t2 = _mm256_add_epi32(sum0, maj);
+
+					h = g;
+					g = f;
+					f = e;
+					e = _mm256_add_epi32(d, t1);
+					d = c;
+					c = b;
+					b = a;
+					a = _mm256_add_epi32(t1, t2);
+				}
+
+				state[0] = _mm256_add_epi32(state[0], a);
+				state[1] = _mm256_add_epi32(state[1], b);
+				state[2] = _mm256_add_epi32(state[2], c);
+				state[3] = _mm256_add_epi32(state[3], d);
+				state[4] = _mm256_add_epi32(state[4], e);
+				state[5] = _mm256_add_epi32(state[5], f);
+				state[6] = _mm256_add_epi32(state[6], g);
+				state[7] = _mm256_add_epi32(state[7], h);
+
+				for (int lane = 0; lane < lane_count; lane++)
+					pointers[lane] += block_size;
+			}
+
+			for (int i = 0; i < 8; i++)
+				_mm256_store_si256((__m256i*)hash_state[i], state[i]);
+		}
+
+		void sha1_multi_buffer_avx2(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[20])
+		{
+			hash_multi_buffer<5, 20>(sha1_avx2, sha1_single, sha1_initial_state, data, sizes, count, out_hashes);
+		}
+
+		void sha256_multi_buffer_avx2(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[32])
+		{
+			hash_multi_buffer<8, 32>(sha256_avx2, sha256_single, sha256_initial_state, data, sizes, count, out_hashes);
+		}
+
+#endif
+	}
+
+	void SHA_MultiBuffer::sha1(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[20])
+	{
+#ifdef CL_SHA_AVX2
+		static const CPUDispatch<SHA1MultiBufferFunction> function({ { { System::sha }, sha1_one_at_a_time }, { { System::avx2 }, sha1_multi_buffer_avx2 } }, sha1_one_at_a_time);
+#else
+		static const CPUDispatch<SHA1MultiBufferFunction> function({}, sha1_one_at_a_time);
+#endif
+		function(data, sizes, count, out_hashes);
+	}
+
+	void SHA_MultiBuffer::sha256(const void * const *data, const int *sizes, int count, unsigned char (*out_hashes)[32])
+	{
+#ifdef CL_SHA_AVX2
+		static const CPUDispatch<SHA256MultiBufferFunction> function({ { { System::sha }, sha256_one_at_a_time }, { { System::avx2 }, sha256_multi_buffer_avx2 } }, sha256_one_at_a_time);
+#else
+		static const CPUDispatch<SHA256MultiBufferFunction> function({}, sha256_one_at_a_time);
+#endif
+		function(data, sizes, count, out_hashes);
+	}
+}
@@ -35,21 +35,74 @@
 #include "API/Core/Crypto/aes128_decrypt.h"
 #include "API/Core/Crypto/aes256_encrypt.h"
 #include "API/Core/Crypto/aes256_decrypt.h"
+#include "API/Core/Crypto/aes128_gcm.h"
+#include "API/Core/Crypto/aes256_gcm.h"
 #include "API/Core/IOData/file.h"
 #include <ctime>
 #include <algorithm>
 #include "x509.h"
+#include "aes_gcm_impl.h"
 #include "API/Core/Math/cl_math.h"
 
 namespace clan
 {
+	namespace
+	{
+		inline void set_sequence_number(unsigned char *dest_ptr, uint64_t sequence_number)
+		{
+			for (int cnt = 0; cnt < 8; cnt++)
+				dest_ptr[cnt] = (unsigned char)(sequence_number >> (56 - cnt * 8));
+		}
+
+		// RFC 5246 (5): P_hash(secret, seed) = HMAC_hash(secret, A(1) + seed) + HMAC_hash(secret, A(2) + seed) + ...
+		// where A(0) = seed and A(i) = HMAC_hash(secret, A(i-1))
+		template<typename HashFunction>
+		void P_hash(unsigned char *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2)
+		{
+			int label_length = strlen(label_ptr);
+
+			Secret output_a(HashFunction::hash_size);
+			Secret output_block(HashFunction::hash_size);
+
+			HashFunction hash;
+			hash.set_hmac(secret.get_data(), secret.get_size());
+			hash.add(label_ptr, label_length);
+			hash.add(seed_part1.get_data(), seed_part1.get_size());
+			hash.add(seed_part2.get_data(), seed_part2.get_size());
+			hash.calculate();
+			hash.get_hash(output_a.get_data());
+
+			unsigned int position = 0;
+			while (position < output_size)
+			{
+				hash.set_hmac(secret.get_data(), secret.get_size());
+				hash.add(output_a.get_data(), output_a.get_size());
+				hash.add(label_ptr, label_length);
+				hash.add(seed_part1.get_data(), seed_part1.get_size());
+				hash.add(seed_part2.get_data(), seed_part2.get_size());
+				hash.calculate();
+				hash.get_hash(output_block.get_data());
+
+				unsigned int block_size = clan::min(output_size - position, (unsigned int)HashFunction::hash_size);
+				memcpy(output_ptr + position, output_block.get_data(), block_size);
+				position += block_size;
+
+				hash.set_hmac(secret.get_data(), secret.get_size());
+				hash.add(output_a.get_data(), output_a.get_size());
+				hash.calculate();
+				hash.get_hash(output_a.get_data());
+			}
+		}
+	}
+
 	TLSClient_Impl::TLSClient_Impl() :
 		recv_in_data_read_pos(0), recv_out_data_read_pos(0), send_in_data_read_pos(0), send_out_data_read_pos(0), handshake_in_read_pos(0),
 		conversation_state(cl_tls_state_send_client_hello), security_parameters(), protocol(), is_protocol_chosen()
 	{
-		// Set TLS 3.1
+		// Offer TLS 3.3 (TLS 1.2). The server may choose down to 3.1
 		protocol.major = 3;
-		protocol.minor = 1;
+		protocol.minor = 3;
+		offered_protocol = protocol;
 		is_protocol_chosen = false;
 
 		create_security_parameters_client_random();
@@ -216,8 +269,8 @@ namespace clan
 		const char *data = send_in_data.get_data() + send_in_data_read_pos;
 		int size = send_in_data.get_size() - send_in_data_read_pos;
 
-		unsigned int max_record_length_gcc_fix = max_record_length;
-		unsigned int data_in_record = clan::min((unsigned int)size, max_record_length_gcc_fix);
+		unsigned int max_plaintext_length_gcc_fix = max_plaintext_length;
+		unsigned int data_in_record = clan::min((unsigned int)size, max_plaintext_length_gcc_fix);
 
 		int offset = 0;
 		int offset_tls_record = offset;					offset += sizeof(TLS_Record);
@@ -625,6 +678,18 @@ namespace clan
 		select_cipher_suite(buffer[0], buffer[1]);
 		select_compression_method(buffer[2]);
 
+		if (protocol.minor < 3)
+		{
+			if (security_parameters.cipher_type == cl_tls_cipher_type_aead || security_parameters.mac_algorithm == cl_tls_mac_algorithm_sha256)
+				throw Exception("TLS server chose a cipher suite that requires TLS 1.2");
+
+			security_parameters.prf_algorithm = cl_tls_prf_md5_sha1;
+		}
+
+		// TLS 1.1 and later send the CBC initialisation vector in front of every record (RFC 4346 6.2.3.2)
+		if (security_parameters.cipher_type == cl_tls_cipher_type_block && protocol.minor >= 2)
+			security_parameters.record_iv_size = security_parameters.iv_size;
+
 		conversation_state = cl_tls_state_receive_certificate;
 	}
 
@@ -704,16 +769,24 @@ namespace clan
 
 		Secret client_verify_data(verify_data_size);
 
-		Secret md5_handshake_messages(16);
-		Secret sha1_handshake_messages(20);
+		if (security_parameters.prf_algorithm == cl_tls_prf_md5_sha1)
+		{
+			Secret md5_handshake_messages(16);
+			Secret sha1_handshake_messages(20);
 
-		server_handshake_md5_hash.calculate();
-		server_handshake_sha1_hash.calculate();
+			server_handshake_md5_hash.calculate();
+			server_handshake_sha1_hash.calculate();
 
-		server_handshake_md5_hash.get_hash(md5_handshake_messages.get_data());
-		server_handshake_sha1_hash.get_hash(sha1_handshake_messages.get_data());
+			server_handshake_md5_hash.get_hash(md5_handshake_messages.get_data());
+			server_handshake_sha1_hash.get_hash(sha1_handshake_messages.get_data());
 
-		PRF(client_verify_data.get_data(), verify_data_size, security_parameters.master_secret, "server finished", md5_handshake_messages, sha1_handshake_messages);
+			PRF(client_verify_data.get_data(), verify_data_size, security_parameters.master_secret, "server finished", md5_handshake_messages, sha1_handshake_messages);
+		}
+		else
+		{
+			Secret handshake_messages = calculate_handshake_hash(server_handshake_sha256_hash, server_handshake_sha384_hash);
+			PRF(client_verify_data.get_data(), verify_data_size, security_parameters.master_secret, "server finished", handshake_messages, Secret());
+		}
 
 		if (memcmp(client_verify_data.get_data(), server_verify_data.get_data(), verify_data_size))
 			throw Exception("TLS server finished verify data failed");
@@ -740,7 +813,11 @@ namespace clan
 		if (record_length + sizeof(TLS_Record) != data_size)
 			throw Exception("Record length mismatch");
 
-		if (security_parameters.is_send_encrypted)
+		if (security_parameters.is_send_encrypted && security_parameters.cipher_type == cl_tls_cipher_type_aead)
+		{
+			send_aead_record(data_ptr, data_size);
+		}
+		else if (security_parameters.is_send_encrypted)
 		{
 			// "the encryption and MAC functions convert TLSCompressed.fragment structures to and from block TLSCiphertext.fragment structures."
 			const unsigned char *input_ptr = (const unsigned char *) data_ptr + sizeof(TLS_Record);
@@ -778,6 +855,13 @@ namespace clan
 		client_handshake_sha1_hash.reset();
 		server_handshake_md5_hash.reset();
 		server_handshake_sha1_hash.reset();
+		client_handshake_sha256_hash.reset();
+		client_handshake_sha384_hash.reset();
+		server_handshake_sha256_hash.reset();
+		server_handshake_sha384_hash.reset();
+
+		client_write_gcm.reset();
+		server_write_gcm.reset();
 	}
 
 	void TLSClient_Impl::copy_data(void *out_data, int size, const void *&data, int &data_left)
@@ -868,6 +952,33 @@ namespace clan
 		*(dest_ptr) = cl_tls_compression_null;
 	}
 
+	int TLSClient_Impl::get_extensions_length() const
+	{
+		// Extension extensions<0..2^16-1>;
+		return 2 + (2 + 2 + 2 + 4*2);	// Only the signature_algorithms extension, with 4 algorithms
+	}
+
+	void TLSClient_Impl::set_extensions(unsigned char *dest_ptr) const
+	{
+		const int num_algorithms = 4;	// If changing, you MUST change get_extensions_length
+		int list_length = num_algorithms * 2;
+		int extension_length = 2 + list_length;
+		int length = 2 + 2 + extension_length;
+		*(dest_ptr++) = length >> 8;
+		*(dest_ptr++) = length;
+
+		// Without it a TLS 1.2 server must assume SHA-1 signatures (RFC 5246 7.4.1.4.1), which current servers refuse
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x0D;	// signature_algorithms
+		*(dest_ptr++) = extension_length >> 8;
+		*(dest_ptr++) = extension_length;
+		*(dest_ptr++) = list_length >> 8;
+		*(dest_ptr++) = list_length;
+		*(dest_ptr++) = 0x04;	*(dest_ptr++) = 0x01;	// SHA-256, RSA
+		*(dest_ptr++) = 0x05;	*(dest_ptr++) = 0x01;	// SHA-384, RSA
+		*(dest_ptr++) = 0x06;	*(dest_ptr++) = 0x01;	// SHA-512, RSA
+		*(dest_ptr++) = 0x02;	*(dest_ptr++) = 0x01;	// SHA-1, RSA
+	}
+
 	void TLSClient_Impl::select_compression_method(uint8_t value)
 	{
 		switch (value)
@@ -886,17 +997,19 @@ namespace clan
 	int TLSClient_Impl::get_cipher_suites_length() const
 	{
 		// CipherSuite cipher_suites<2..2^16-1>;
-		return 2 + (4*2);	// We support 4 cipher suites, each id contains 2 bytes
+		return 2 + (6*2);	// We support 6 cipher suites, each id contains 2 bytes
 	}
 
 	void TLSClient_Impl::set_cipher_suites(unsigned char *dest_ptr) const
 	{
-		const int num_ciphers = 4;	// If changing, you MUST change get_cipher_suites_length
+		const int num_ciphers = 6;	// If changing, you MUST change get_cipher_suites_length
 		int length = num_ciphers * 2;
 		*(dest_ptr++) = length >> 8;
 		*(dest_ptr++) = length;
 
 		// Strongest first ... maybe that should be controlled by the user, strong and fast first
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x9D;	// TLS_RSA_WITH_AES_256_GCM_SHA384
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x9C;	// TLS_RSA_WITH_AES_128_GCM_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x3D;	// TLS_RSA_WITH_AES_256_CBC_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x3C;	// TLS_RSA_WITH_AES_128_CBC_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x35;	// TLS_RSA_WITH_AES_256_CBC_SHA
@@ -907,8 +1020,36 @@ namespace clan
 	{
 		if (value1 == 0)
 		{
+			// The key block for GCM has no MAC secrets, and the IV is the 4 byte implicit part of the nonce (RFC 5288 3)
+			security_parameters.cipher_type = cl_tls_cipher_type_block;
+			security_parameters.record_iv_size = 0;
+			security_parameters.prf_algorithm = cl_tls_prf_sha256;
+
 			switch (value2)
 			{
+				case 0x9D:	// TLS_RSA_WITH_AES_256_GCM_SHA384
+				{
+					security_parameters.cipher_type = cl_tls_cipher_type_aead;
+					security_parameters.prf_algorithm = cl_tls_prf_sha384;
+					security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+					security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes256;
+					security_parameters.hash_size = 0;
+					security_parameters.iv_size = 4;
+					security_parameters.record_iv_size = 8;
+					security_parameters.key_material_length = AES256_GCM::key_size;
+					break;
+				}
+				case 0x9C:	// TLS_RSA_WITH_AES_128_GCM_SHA256
+				{
+					security_parameters.cipher_type = cl_tls_cipher_type_aead;
+					security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+					security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes128;
+					security_parameters.hash_size = 0;
+					security_parameters.iv_size = 4;
+					security_parameters.record_iv_size = 8;
+					security_parameters.key_material_length = AES128_GCM::key_size;
+					break;
+				}
 				case 0x3D:	// TLS_RSA_WITH_AES_256_CBC_SHA256
 				{
 					security_parameters.mac_algorithm = cl_tls_mac_algorithm_sha256;
@@ -969,6 +1110,7 @@ namespace clan
 		int offset_tls_session_id = offset;				offset += get_session_id_length();
 		int offset_tls_cipher_suites = offset;			offset += get_cipher_suites_length();
 		int offset_tls_compression_methods = offset;	offset += get_compression_methods_length();
+		int offset_tls_extensions = offset;				offset += get_extensions_length();
 
 		Secret message(offset);	// keep data secure
 		unsigned char *message_ptr = message.get_data();
@@ -980,6 +1122,7 @@ namespace clan
 		set_session_id(message_ptr + offset_tls_session_id);
 		set_cipher_suites(message_ptr + offset_tls_cipher_suites);
 		set_compression_methods(message_ptr + offset_tls_compression_methods);
+		set_extensions(message_ptr + offset_tls_extensions);
 
 		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
 
@@ -1010,8 +1153,8 @@ namespace clan
 		Secret pre_master_secret(48);
 		unsigned char *pms_ptr = pre_master_secret.get_data();
 		m_Random.get_random_bytes(pms_ptr + 2, 46);
-		pms_ptr[0] = protocol.major;	// Version number
-		pms_ptr[1] = protocol.minor;
+		pms_ptr[0] = offered_protocol.major;	// The latest version supported by the client (RFC 5246 7.4.7.1), not the negotiated one
+		pms_ptr[1] = offered_protocol.minor;
 
 		DataBuffer wrapped_pre_master_secret = RSA::encrypt(2, m_Random, server_public_exponent,  server_public_modulus, pre_master_secret);
 
@@ -1047,6 +1190,15 @@ namespace clan
 		memcpy(security_parameters.server_write_iv.get_data(), key_block_ptr, security_parameters.server_write_iv.get_size());
 		key_block_ptr+=security_parameters.server_write_iv.get_size();
 
+		// The GCM contexts keep the expanded keys and GHASH tables for the lifetime of the connection
+		if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+		{
+			client_write_gcm = std::make_shared<AES_GCM_Impl>(security_parameters.key_material_length);
+			client_write_gcm->set_key(security_parameters.client_write_key.get_data());
+			server_write_gcm = std::make_shared<AES_GCM_Impl>(security_parameters.key_material_length);
+			server_write_gcm->set_key(security_parameters.server_write_key.get_data());
+		}
+
 		const int wrapped_pre_master_secret_length = wrapped_pre_master_secret.get_size();
 
 		int offset = 0;
@@ -1074,6 +1226,18 @@ namespace clan
 
 	void TLSClient_Impl::PRF(void *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2)
 	{
+		// TLS 1.2 uses a single hash, chosen by the cipher suite (RFC 5246 5)
+		if (security_parameters.prf_algorithm == cl_tls_prf_sha256)
+		{
+			P_hash<SHA256>((unsigned char *)output_ptr, output_size, secret, label_ptr, seed_part1, seed_part2);
+			return;
+		}
+		else if (security_parameters.prf_algorithm == cl_tls_prf_sha384)
+		{
+			P_hash<SHA384>((unsigned char *)output_ptr, output_size, secret, label_ptr, seed_part1, seed_part2);
+			return;
+		}
+
 		const uint8_t *secret_part1 = secret.get_data();
 		int secret_length = secret.get_size();
 		int split_length = secret_length / 2;
@@ -1209,16 +1373,24 @@ namespace clan
 		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
 		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_finished, offset - offset_tls_handshake);
 
-		Secret md5_handshake_messages(MD5::hash_size);
-		Secret sha1_handshake_messages(SHA1::hash_size);
+		if (security_parameters.prf_algorithm == cl_tls_prf_md5_sha1)
+		{
+			Secret md5_handshake_messages(MD5::hash_size);
+			Secret sha1_handshake_messages(SHA1::hash_size);
 
-		client_handshake_md5_hash.calculate();
-		client_handshake_sha1_hash.calculate();
+			client_handshake_md5_hash.calculate();
+			client_handshake_sha1_hash.calculate();
 
-		client_handshake_md5_hash.get_hash(md5_handshake_messages.get_data());
-		client_handshake_sha1_hash.get_hash(sha1_handshake_messages.get_data());
+			client_handshake_md5_hash.get_hash(md5_handshake_messages.get_data());
+			client_handshake_sha1_hash.get_hash(sha1_handshake_messages.get_data());
 
-		PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", md5_handshake_messages, sha1_handshake_messages);
+			PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", md5_handshake_messages, sha1_handshake_messages);
+		}
+		else
+		{
+			Secret handshake_messages = calculate_handshake_hash(client_handshake_sha256_hash, client_handshake_sha384_hash);
+			PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", handshake_messages, Secret());
+		}
 
 		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
 		send_record(message_ptr, offset);
@@ -1232,6 +1404,10 @@ namespace clan
 		int additional_unpadded_blocks;
 		m_Random.get_random_bool() ? additional_unpadded_blocks = 1 : additional_unpadded_blocks = 0;
 
+		// With an explicit IV every record starts from a fresh random IV, instead of the last block of the previous record
+		if (security_parameters.record_iv_size > 0)
+			m_Random.get_random_bytes(security_parameters.client_write_iv.get_data(), security_parameters.client_write_iv.get_size());
+
 		DataBuffer buffer;
 		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128)
 		{
@@ -1259,6 +1435,15 @@ namespace clan
 		{
 			throw Exception("Unsupported cipher");
 		}
+
+		if (security_parameters.record_iv_size > 0)
+		{
+			DataBuffer record_buffer(security_parameters.record_iv_size + buffer.get_size());
+			memcpy(record_buffer.get_data(), security_parameters.client_write_iv.get_data(), security_parameters.record_iv_size);
+			memcpy(record_buffer.get_data() + security_parameters.record_iv_size, buffer.get_data(), buffer.get_size());
+			return record_buffer;
+		}
+
 		memcpy(security_parameters.client_write_iv.get_data(), buffer.get_data() + buffer.get_size() - security_parameters.client_write_iv.get_size(), security_parameters.client_write_iv.get_size());
 		return buffer;
 
@@ -1267,15 +1452,7 @@ namespace clan
 	Secret TLSClient_Impl::calculate_mac(const void *data_ptr, unsigned int data_size, const void *data2_ptr, unsigned int data2_size, uint64_t sequence_number, const Secret &mac_secret)
 	{
 		unsigned char sequence_number_buffer[8];
-
-		sequence_number_buffer[0] = sequence_number >> 56; 
-		sequence_number_buffer[1] = sequence_number >> 48; 
-		sequence_number_buffer[2] = sequence_number >> 40; 
-		sequence_number_buffer[3] = sequence_number >> 32; 
-		sequence_number_buffer[4] = sequence_number >> 24; 
-		sequence_number_buffer[5] = sequence_number >> 16; 
-		sequence_number_buffer[6] = sequence_number >> 8; 
-		sequence_number_buffer[7] = sequence_number; 
+		set_sequence_number(sequence_number_buffer, sequence_number);
 
 		if (security_parameters.mac_algorithm == cl_tls_mac_algorithm_sha)
 		{
@@ -1317,10 +1494,42 @@ namespace clan
 		client_handshake_sha1_hash.add(data_ptr, data_size);
 		server_handshake_md5_hash.add(data_ptr, data_size);
 		server_handshake_sha1_hash.add(data_ptr, data_size);
+		client_handshake_sha256_hash.add(data_ptr, data_size);
+		client_handshake_sha384_hash.add(data_ptr, data_size);
+		server_handshake_sha256_hash.add(data_ptr, data_size);
+		server_handshake_sha384_hash.add(data_ptr, data_size);
+	}
+
+	Secret TLSClient_Impl::calculate_handshake_hash(SHA256 &sha256, SHA384 &sha384)
+	{
+		if (security_parameters.prf_algorithm == cl_tls_prf_sha384)
+		{
+			Secret hash(SHA384::hash_size);
+			sha384.calculate();
+			sha384.get_hash(hash.get_data());
+			return hash;
+		}
+		else
+		{
+			Secret hash(SHA256::hash_size);
+			sha256.calculate();
+			sha256.get_hash(hash.get_data());
+			return hash;
+		}
 	}
 
 	DataBuffer TLSClient_Impl::decrypt_data(const void *data_ptr, unsigned int data_size)
 	{
+		if (security_parameters.record_iv_size > 0)
+		{
+			if (data_size < security_parameters.record_iv_size)
+				throw Exception("Invalid TLS record length");
+
+			memcpy(security_parameters.server_write_iv.get_data(), data_ptr, security_parameters.record_iv_size);
+			data_ptr = (const unsigned char *) data_ptr + security_parameters.record_iv_size;
+			data_size -= security_parameters.record_iv_size;
+		}
+
 		DataBuffer buffer;
 		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128)
 		{
@@ -1355,6 +1564,9 @@ namespace clan
 
 	DataBuffer TLSClient_Impl::decrypt_record(TLS_Record &record, const DataBuffer &record_data)
 	{
+		if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+			return decrypt_aead_record(record, record_data);
+
 		DataBuffer decrypted = decrypt_data(record_data.get_data(), record_data.get_size());
 
 		unsigned char *decrypted_data = (unsigned char *) decrypted.get_data();
@@ -1375,4 +1587,76 @@ namespace clan
 		decrypted.set_size(decoded_size);
 		return decrypted;
 	}
+
+	void TLSClient_Impl::send_aead_record(const void *data_ptr, unsigned int data_size)
+	{
+		// RFC 5288 (3) and RFC 5246 (6.2.3.3): The record is the explicit part of the nonce, the ciphertext and the tag.
+		// The ciphertext is written directly into the output buffer, so the record is processed in a single pass.
+		const unsigned char *record_ptr = (const unsigned char *) data_ptr;
+		const unsigned char *input_ptr = record_ptr + sizeof(TLS_Record);
+		unsigned int input_size = data_size - sizeof(TLS_Record);
+		unsigned int explicit_nonce_size = security_parameters.record_iv_size;
+		unsigned int new_length = explicit_nonce_size + input_size + AES128_GCM::tag_size;
+
+		int pos = send_out_data.get_size();
+		send_out_data.set_size(pos + sizeof(TLS_Record) + new_length);
+		unsigned char *output_ptr = (unsigned char *) send_out_data.get_data() + pos;
+
+		memcpy(output_ptr, record_ptr, sizeof(TLS_Record));
+		TLS_Record *output_record = (TLS_Record *) output_ptr;
+		output_record->length[0] = new_length >> 8;
+		output_record->length[1] = new_length;
+		output_ptr += sizeof(TLS_Record);
+
+		// The sequence number is unique per record, so it is used as the explicit nonce
+		set_sequence_number(output_ptr, security_parameters.write_sequence_number);
+
+		unsigned char nonce[AES128_GCM::iv_size];
+		memcpy(nonce, security_parameters.client_write_iv.get_data(), security_parameters.iv_size);
+		memcpy(nonce + security_parameters.iv_size, output_ptr, explicit_nonce_size);
+
+		// additional_data = seq_num + TLSCompressed.type + TLSCompressed.version + TLSCompressed.length
+		unsigned char additional_data[8 + sizeof(TLS_Record)];
+		set_sequence_number(additional_data, security_parameters.write_sequence_number);
+		memcpy(additional_data + 8, record_ptr, sizeof(TLS_Record));
+
+		client_write_gcm->set_iv(nonce, sizeof(nonce));
+		client_write_gcm->add_aad(additional_data, sizeof(additional_data));
+		client_write_gcm->process(input_ptr, output_ptr + explicit_nonce_size, input_size, false);
+		client_write_gcm->calculate();
+		client_write_gcm->get_tag(output_ptr + explicit_nonce_size + input_size);
+	}
+
+	DataBuffer TLSClient_Impl::decrypt_aead_record(const TLS_Record &record, const DataBuffer &record_data)
+	{
+		unsigned int explicit_nonce_size = security_parameters.record_iv_size;
+		if (record_data.get_size() < explicit_nonce_size + AES128_GCM::tag_size)
+			throw Exception("Invalid TLS record length");
+
+		const unsigned char *record_ptr = (const unsigned char *) record_data.get_data();
+		unsigned int plaintext_size = record_data.get_size() - explicit_nonce_size - AES128_GCM::tag_size;
+
+		unsigned char nonce[AES128_GCM::iv_size];
+		memcpy(nonce, security_parameters.server_write_iv.get_data(), security_parameters.iv_size);
+		memcpy(nonce + security_parameters.iv_size, record_ptr, explicit_nonce_size);
+
+		unsigned char additional_data[8 + sizeof(TLS_Record)];
+		set_sequence_number(additional_data, security_parameters.read_sequence_number);
+		additional_data[8] = record.type;
+		additional_data[9] = record.version.major;
+		additional_data[10] = record.version.minor;
+		additional_data[11] = plaintext_size >> 8;
+		additional_data[12] = plaintext_size;
+
+		DataBuffer plaintext(plaintext_size);
+		server_write_gcm->set_iv(nonce, sizeof(nonce));
+		server_write_gcm->add_aad(additional_data, sizeof(additional_data));
+		server_write_gcm->process(record_ptr + explicit_nonce_size, (unsigned char *) plaintext.get_data(), plaintext_size, true);
+		server_write_gcm->calculate();
+
+		if (!server_write_gcm->verify_tag(record_ptr + explicit_nonce_size + plaintext_size, AES128_GCM::tag_size))
+			throw Exception("TLS record authentication failed");
+
+		return plaintext;
+	}
 }
@@ -39,6 +39,8 @@
 
 namespace clan
 {
+	class AES_GCM_Impl;
+
 	enum TLS_ConnectionEnd
 	{
 		cl_tls_connection_server,
@@ -60,7 +62,15 @@ namespace clan
 	enum TLS_CipherType
 	{
 		cl_tls_cipher_type_stream,
-		cl_tls_cipher_type_block
+		cl_tls_cipher_type_block,
+		cl_tls_cipher_type_aead
+	};
+
+	enum TLS_PRFAlgorithm
+	{
+		cl_tls_prf_md5_sha1,	// TLS 1.0 and 1.1
+		cl_tls_prf_sha256,
+		cl_tls_prf_sha384
 	};
 
 	enum TLS_MACAlgorithm
@@ -168,6 +178,8 @@ namespace clan
 			key_size = 0;
 			key_material_length = 0;
 			iv_size = 0;
+			record_iv_size = 0;
+			prf_algorithm = cl_tls_prf_md5_sha1;
 			is_exportable = false;
 			mac_algorithm = cl_tls_mac_algorithm_null;
 			hash_size = 0;
@@ -194,6 +206,8 @@ namespace clan
 		uint8_t key_size;
 		uint8_t key_material_length;
 		uint8_t iv_size;
+		uint8_t record_iv_size;	// Explicit IV or nonce sent in front of every encrypted record
+		TLS_PRFAlgorithm prf_algorithm;
 		bool is_exportable;
 		TLS_MACAlgorithm mac_algorithm;
 		uint8_t hash_size;
@@ -292,6 +306,8 @@ namespace clan
 		void set_session_id(unsigned char *dest_ptr) const;
 		int get_compression_methods_length() const;
 		void set_compression_methods(unsigned char *dest_ptr) const;
+		int get_extensions_length() const;
+		void set_extensions(unsigned char *dest_ptr) const;
 		int get_cipher_suites_length() const;
 		void set_cipher_suites(unsigned char *dest_ptr) const;
 		void select_cipher_suite(uint8_t value1, uint8_t value2);
@@ -300,6 +316,7 @@ namespace clan
 		void set_server_public_key();
 		void PRF(void *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2);
 		void hash_handshake(const void *data_ptr, unsigned int data_size);
+		Secret calculate_handshake_hash(SHA256 &sha256, SHA384 &sha384);
 
 		DataBuffer decrypt_record(TLS_Record &record, const DataBuffer &record_data);
 		DataBuffer decrypt_data(const void *data_ptr, unsigned int data_size);
@@ -307,7 +324,11 @@ namespace clan
 		Secret calculate_mac(const void *data_ptr, unsigned int data_size, const void *data2_ptr, unsigned int data2_size, uint64_t sequence_number, const Secret &mac_secret);
 		DataBuffer encrypt_data(const void *data_ptr, unsigned int data_size, const void *mac_ptr, unsigned int mac_size);
 
+		void send_aead_record(const void *data_ptr, unsigned int data_size);
+		DataBuffer decrypt_aead_record(const TLS_Record &record, const DataBuffer &record_data);
+
 		static const unsigned int max_record_length = 2 << 14;	// RFC 2246 (6.2.1)
+		static const unsigned int max_plaintext_length = 1 << 14;	// RFC 2246 (6.2.1)
 		static const unsigned int max_handshake_length = 2 << 24;	// RFC 2246 (implied by length in7.4)
 
 		static const int desired_buffer_size = 64 * 1024;
@@ -333,6 +354,7 @@ namespace clan
 
 		TLS_SecurityParameters security_parameters;
 		TLS_ProtocolVersion protocol;
+		TLS_ProtocolVersion offered_protocol;	// Sent in the client hello, and used in the premaster secret
 
 		DataBuffer server_public_exponent;
 		DataBuffer server_public_modulus;
@@ -345,6 +367,13 @@ namespace clan
 		SHA1 client_handshake_sha1_hash;
 		MD5 server_handshake_md5_hash;
 		SHA1 server_handshake_sha1_hash;
+		SHA256 client_handshake_sha256_hash;
+		SHA384 client_handshake_sha384_hash;
+		SHA256 server_handshake_sha256_hash;
+		SHA384 server_handshake_sha384_hash;
+
+		std::shared_ptr<AES_GCM_Impl> client_write_gcm;
+		std::shared_ptr<AES_GCM_Impl> server_write_gcm;
 
 		std::vector<X509> certificate_chain;
 	};
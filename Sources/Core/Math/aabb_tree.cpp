@@ -0,0 +1,114 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/aabb_tree.h"
+#include "aabb_tree_impl.h"
+
+namespace clan
+{
+	AxisAlignedBoundingBoxTree::AxisAlignedBoundingBoxTree(float margin)
+		: impl(std::make_shared<AxisAlignedBoundingBoxTree_Impl>(margin))
+	{
+	}
+
+	AxisAlignedBoundingBoxTree::~AxisAlignedBoundingBoxTree()
+	{
+	}
+
+	int AxisAlignedBoundingBoxTree::get_proxy_count() const
+	{
+		return impl->proxy_count;
+	}
+
+	int AxisAlignedBoundingBoxTree::get_height() const
+	{
+		return impl->root != -1 ? impl->nodes[impl->root].height : 0;
+	}
+
+	const AxisAlignedBoundingBox &AxisAlignedBoundingBoxTree::get_box(int proxy) const
+	{
+		return impl->get_leaf(proxy).object_box;
+	}
+
+	const AxisAlignedBoundingBox &AxisAlignedBoundingBoxTree::get_fat_box(int proxy) const
+	{
+		return impl->get_leaf(proxy).box;
+	}
+
+	void *AxisAlignedBoundingBoxTree::get_data(int proxy) const
+	{
+		return impl->get_leaf(proxy).data;
+	}
+
+	int AxisAlignedBoundingBoxTree::insert(const AxisAlignedBoundingBox &box, void *data)
+	{
+		return impl->insert(box, data);
+	}
+
+	void AxisAlignedBoundingBoxTree::remove(int proxy)
+	{
+		impl->remove(proxy);
+	}
+
+	bool AxisAlignedBoundingBoxTree::move(int proxy, const AxisAlignedBoundingBox &box, const Vec3f &displacement)
+	{
+		return impl->move(proxy, box, displacement);
+	}
+
+	void AxisAlignedBoundingBoxTree::clear()
+	{
+		impl->clear();
+	}
+
+	void AxisAlignedBoundingBoxTree::rebuild()
+	{
+		impl->rebuild();
+	}
+
+	void AxisAlignedBoundingBoxTree::query(const AxisAlignedBoundingBox &box, std::vector<int> &result) const
+	{
+		impl->query(box, result);
+	}
+
+	void AxisAlignedBoundingBoxTree::query(const Vec3f &point, std::vector<int> &result) const
+	{
+		impl->query(point, result);
+	}
+
+	void AxisAlignedBoundingBoxTree::query(const FrustumPlanes &frustum, std::vector<int> &result) const
+	{
+		impl->query(frustum, result);
+	}
+
+	void AxisAlignedBoundingBoxTree::query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &result) const
+	{
+		impl->query_ray(ray_start, ray_end, result);
+	}
+}
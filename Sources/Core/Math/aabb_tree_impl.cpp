@@ -0,0 +1,586 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "aabb_tree_impl.h"
+#include "API/Core/Math/intersection_test.h"
+#include <algorithm>
+#include <limits>
+
+namespace clan
+{
+	AxisAlignedBoundingBoxTree_Impl::AxisAlignedBoundingBoxTree_Impl(float margin) : margin(margin)
+	{
+	}
+
+	const AxisAlignedBoundingBoxTree_Node &AxisAlignedBoundingBoxTree_Impl::get_leaf(int proxy) const
+	{
+		if (proxy < 0 || proxy >= (int)nodes.size() || nodes[proxy].height != 0)
+			throw Exception("Invalid AxisAlignedBoundingBoxTree proxy");
+		return nodes[proxy];
+	}
+
+	int AxisAlignedBoundingBoxTree_Impl::insert(const AxisAlignedBoundingBox &box, void *data)
+	{
+		int leaf = allocate_node();
+		AxisAlignedBoundingBoxTree_Node &node = nodes[leaf];
+		node.box = AxisAlignedBoundingBox(box.aabb_min - Vec3f(margin), box.aabb_max + Vec3f(margin));
+		node.object_box = box;
+		node.data = data;
+		insert_leaf(leaf);
+		proxy_count++;
+		return leaf;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::remove(int proxy)
+	{
+		get_leaf(proxy);
+		remove_leaf(proxy);
+		free_node(proxy);
+		proxy_count--;
+	}
+
+	bool AxisAlignedBoundingBoxTree_Impl::move(int proxy, const AxisAlignedBoundingBox &box, const Vec3f &displacement)
+	{
+		get_leaf(proxy);
+
+		AxisAlignedBoundingBoxTree_Node &node = nodes[proxy];
+		node.object_box = box;
+
+		AxisAlignedBoundingBox fat_box(box.aabb_min - Vec3f(margin), box.aabb_max + Vec3f(margin));
+		Vec3f stretch = displacement * 2.0f;
+		if (stretch.x < 0.0f) fat_box.aabb_min.x += stretch.x; else fat_box.aabb_max.x += stretch.x;
+		if (stretch.y < 0.0f) fat_box.aabb_min.y += stretch.y; else fat_box.aabb_max.y += stretch.y;
+		if (stretch.z < 0.0f) fat_box.aabb_min.z += stretch.z; else fat_box.aabb_max.z += stretch.z;
+
+		if (contains(node.box, box))
+		{
+			// Keep the old fat box unless it has grown much larger than needed, for example after the object stopped moving
+			AxisAlignedBoundingBox huge_box(fat_box.aabb_min - Vec3f(margin * 4.0f), fat_box.aabb_max + Vec3f(margin * 4.0f));
+			if (contains(huge_box, node.box))
+				return false;
+		}
+
+		remove_leaf(proxy);
+		node.box = fat_box;
+		insert_leaf(proxy);
+		return true;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::clear()
+	{
+		nodes.clear();
+		root = -1;
+		free_list = -1;
+		proxy_count = 0;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::rebuild()
+	{
+		if (root == -1)
+			return;
+
+		std::vector<int> leaves;
+		leaves.reserve(proxy_count);
+		for (int i = 0; i < (int)nodes.size(); i++)
+		{
+			if (nodes[i].height == 0)
+				leaves.push_back(i);
+			else if (nodes[i].height > 0)
+				free_node(i);
+		}
+
+		root = build_sah(leaves.data(), (int)leaves.size());
+		nodes[root].parent = -1;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::query(const AxisAlignedBoundingBox &box, std::vector<int> &result) const
+	{
+		find_leaves([&](const AxisAlignedBoundingBox &node_box) { return IntersectionTest::aabb(box, node_box) == IntersectionTest::overlap; }, result);
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::query(const Vec3f &point, std::vector<int> &result) const
+	{
+		find_leaves([&](const AxisAlignedBoundingBox &node_box)
+		{
+			return point.x >= node_box.aabb_min.x && point.y >= node_box.aabb_min.y && point.z >= node_box.aabb_min.z &&
+				point.x <= node_box.aabb_max.x && point.y <= node_box.aabb_max.y && point.z <= node_box.aabb_max.z;
+		}, result);
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &result) const
+	{
+		find_leaves([&](const AxisAlignedBoundingBox &node_box) { return IntersectionTest::ray_aabb(ray_start, ray_end, node_box) == IntersectionTest::overlap; }, result);
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::query(const FrustumPlanes &frustum, std::vector<int> &result) const
+	{
+		result.clear();
+		if (root == -1)
+			return;
+
+		// Each entry holds a node and a bit mask of the planes its parent was not completely inside of
+		std::vector<std::pair<int, int>> stack;
+		stack.reserve(64);
+		stack.push_back(std::make_pair(root, 63));
+		while (!stack.empty())
+		{
+			int index = stack.back().first;
+			int planes = stack.back().second;
+			stack.pop_back();
+
+			const AxisAlignedBoundingBoxTree_Node &node = nodes[index];
+			const AxisAlignedBoundingBox &box = node.is_leaf() ? node.object_box : node.box;
+			Vec3f center = box.center();
+			Vec3f extents = box.extents();
+
+			bool outside = false;
+			for (int i = 0; i < 6; i++)
+			{
+				if (planes & (1 << i))
+				{
+					const Vec4f &plane = frustum.planes[i];
+					float e = extents.x * std::abs(plane.x) + extents.y * std::abs(plane.y) + extents.z * std::abs(plane.z);
+					float s = center.x * plane.x + center.y * plane.y + center.z * plane.z + plane.w;
+					if (s + e < 0)
+					{
+						outside = true;
+						break;
+					}
+					else if (s - e > 0)
+					{
+						planes &= ~(1 << i);
+					}
+				}
+			}
+
+			if (outside)
+				continue;
+
+			if (node.is_leaf())
+				result.push_back(index);
+			else if (planes == 0)
+				add_subtree(index, result);
+			else
+			{
+				stack.push_back(std::make_pair(node.child1, planes));
+				stack.push_back(std::make_pair(node.child2, planes));
+			}
+		}
+	}
+
+	template<typename Test>
+	void AxisAlignedBoundingBoxTree_Impl::find_leaves(const Test &test, std::vector<int> &result) const
+	{
+		result.clear();
+		if (root == -1)
+			return;
+
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const AxisAlignedBoundingBoxTree_Node &node = nodes[index];
+			if (node.is_leaf())
+			{
+				if (test(node.object_box))
+					result.push_back(index);
+			}
+			else if (test(node.box))
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::add_subtree(int index, std::vector<int> &result) const
+	{
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(index);
+		while (!stack.empty())
+		{
+			const AxisAlignedBoundingBoxTree_Node &node = nodes[stack.back()];
+			if (node.is_leaf())
+				result.push_back(stack.back());
+			stack.pop_back();
+			if (!node.is_leaf())
+			{
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+
+	int AxisAlignedBoundingBoxTree_Impl::allocate_node()
+	{
+		int index;
+		if (free_list == -1)
+		{
+			index = (int)nodes.size();
+			nodes.push_back(AxisAlignedBoundingBoxTree_Node());
+		}
+		else
+		{
+			index = free_list;
+			free_list = nodes[index].parent;
+			nodes[index] = AxisAlignedBoundingBoxTree_Node();
+		}
+		nodes[index].height = 0;
+		return index;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::free_node(int index)
+	{
+		AxisAlignedBoundingBoxTree_Node &node = nodes[index];
+		node.parent = free_list;
+		node.child1 = -1;
+		node.child2 = -1;
+		node.height = -1;
+		node.data = nullptr;
+		free_list = index;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::insert_leaf(int leaf)
+	{
+		if (root == -1)
+		{
+			root = leaf;
+			nodes[leaf].parent = -1;
+			return;
+		}
+
+		int sibling = find_best_sibling(nodes[leaf].box);
+		int old_parent = nodes[sibling].parent;
+		int new_parent = allocate_node();
+
+		AxisAlignedBoundingBoxTree_Node &parent = nodes[new_parent];
+		parent.parent = old_parent;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+		parent.box = combine(nodes[sibling].box, nodes[leaf].box);
+		parent.height = nodes[sibling].height + 1;
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		if (old_parent == -1)
+			root = new_parent;
+		else if (nodes[old_parent].child1 == sibling)
+			nodes[old_parent].child1 = new_parent;
+		else
+			nodes[old_parent].child2 = new_parent;
+
+		refit_ancestors(new_parent, true);
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::remove_leaf(int leaf)
+	{
+		if (leaf == root)
+		{
+			root = -1;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grand_parent = nodes[parent].parent;
+		int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		free_node(parent);
+		nodes[sibling].parent = grand_parent;
+		if (grand_parent == -1)
+		{
+			root = sibling;
+		}
+		else
+		{
+			if (nodes[grand_parent].child1 == parent)
+				nodes[grand_parent].child1 = sibling;
+			else
+				nodes[grand_parent].child2 = sibling;
+			refit_ancestors(grand_parent, false);
+		}
+	}
+
+	int AxisAlignedBoundingBoxTree_Impl::find_best_sibling(const AxisAlignedBoundingBox &box) const
+	{
+		// Greedy descent towards the node where the new leaf adds the least surface area to the tree.
+		// The cost of a sibling is the area of the new parent plus the area every ancestor grows by.
+		float box_area = area(box);
+
+		int index = root;
+		float node_area = area(nodes[root].box);
+		float direct_cost = area(combine(box, nodes[root].box));
+		float inherited_cost = 0.0f;
+
+		int best = root;
+		float best_cost = direct_cost;
+
+		while (!nodes[index].is_leaf())
+		{
+			const AxisAlignedBoundingBoxTree_Node &node = nodes[index];
+
+			float cost = direct_cost + inherited_cost;
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best = index;
+			}
+
+			inherited_cost += direct_cost - node_area;
+
+			int children[2] = { node.child1, node.child2 };
+			float child_areas[2] = { 0.0f, 0.0f };
+			float child_direct_costs[2];
+			float lower_bounds[2] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+			for (int i = 0; i < 2; i++)
+			{
+				const AxisAlignedBoundingBoxTree_Node &child = nodes[children[i]];
+				child_direct_costs[i] = area(combine(box, child.box));
+				if (child.is_leaf())
+				{
+					float child_cost = child_direct_costs[i] + inherited_cost;
+					if (child_cost < best_cost)
+					{
+						best_cost = child_cost;
+						best = children[i];
+					}
+				}
+				else
+				{
+					// The best possible cost below the child is reached if the new leaf only grows the child
+					child_areas[i] = area(child.box);
+					lower_bounds[i] = inherited_cost + child_direct_costs[i] + std::min(box_area - child_areas[i], 0.0f);
+				}
+			}
+
+			if (best_cost <= lower_bounds[0] && best_cost <= lower_bounds[1])
+				break;
+
+			int next = lower_bounds[1] < lower_bounds[0] ? 1 : 0;
+			index = children[next];
+			node_area = child_areas[next];
+			direct_cost = child_direct_costs[next];
+		}
+		return best;
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::refit_ancestors(int index, bool rotate_nodes)
+	{
+		while (index != -1)
+		{
+			AxisAlignedBoundingBoxTree_Node &node = nodes[index];
+			node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+			node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+			if (rotate_nodes)
+				rotate(index);
+			index = nodes[index].parent;
+		}
+	}
+
+	void AxisAlignedBoundingBoxTree_Impl::rotate(int index)
+	{
+		/* Swap a child with a grandchild on the other side when it shrinks the surface area of the node between them:
+
+		         A                A
+		       /   \            /   \
+		      B     C    ->    F     C
+		           / \              / \
+		          F   G            B   G
+		*/
+
+		AxisAlignedBoundingBoxTree_Node &a = nodes[index];
+		if (a.height < 2)
+			return;
+
+		int b = a.child1;
+		int c = a.child2;
+		int best_child = -1, best_grandchild = -1;
+		float best_gain = 0.0f;
+
+		if (nodes[c].height > 0)
+		{
+			float c_area = area(nodes[c].box);
+			int f = nodes[c].child1, g = nodes[c].child2;
+			float gain_bf = c_area - area(combine(nodes[b].box, nodes[g].box));
+			float gain_bg = c_area - area(combine(nodes[b].box, nodes[f].box));
+			if (gain_bf > best_gain) { best_gain = gain_bf; best_child = b; best_grandchild = f; }
+			if (gain_bg > best_gain) { best_gain = gain_bg; best_child = b; best_grandchild = g; }
+		}
+
+		if (nodes[b].height > 0)
+		{
+			float b_area = area(nodes[b].box);
+			int d = nodes[b].child1, e = nodes[b].child2;
+			float gain_cd = b_area - area(combine(nodes[c].box, nodes[e].box));
+			float gain_ce = b_area - area(combine(nodes[c].box, nodes[d].box));
+			if (gain_cd > best_gain) { best_gain = gain_cd; best_child = c; best_grandchild = d; }
+			if (gain_ce > best_gain) { best_gain = gain_ce; best_child = c; best_grandchild = e; }
+		}
+
+		if (best_child == -1)
+			return;
+
+		int other = best_child == b ? c : b;
+		AxisAlignedBoundingBoxTree_Node &other_node = nodes[other];
+
+		if (a.child1 == best_child)
+			a.child1 = best_grandchild;
+		else
+			a.child2 = best_grandchild;
+
+		if (other_node.child1 == best_grandchild)
+			other_node.child1 = best_child;
+		else
+			other_node.child2 = best_child;
+
+		nodes[best_grandchild].parent = index;
+		nodes[best_child].parent = other;
+
+		other_node.box = combine(nodes[other_node.child1].box, nodes[other_node.child2].box);
+		other_node.height = 1 + std::max(nodes[other_node.child1].height, nodes[other_node.child2].height);
+		a.height = 1 + std::max(nodes[a.child1].height, nodes[a.child2].height);
+	}
+
+	int AxisAlignedBoundingBoxTree_Impl::build_sah(int *leaves, int count)
+	{
+		if (count == 1)
+			return leaves[0];
+
+		Vec3f centroid_min = nodes[leaves[0]].box.center();
+		Vec3f centroid_max = centroid_min;
+		for (int i = 1; i < count; i++)
+		{
+			Vec3f center = nodes[leaves[i]].box.center();
+			centroid_min = Vec3f(std::min(centroid_min.x, center.x), std::min(centroid_min.y, center.y), std::min(centroid_min.z, center.z));
+			centroid_max = Vec3f(std::max(centroid_max.x, center.x), std::max(centroid_max.y, center.y), std::max(centroid_max.z, center.z));
+		}
+
+		Vec3f size = centroid_max - centroid_min;
+		int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+		auto get_axis = [axis](const Vec3f &v) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); };
+		float axis_min = get_axis(centroid_min);
+		float axis_size = get_axis(size);
+
+		// Split in the middle if the centroids are all at the same place
+		int mid = count / 2;
+		if (axis_size > 0.0f)
+		{
+			// Binned surface area heuristic along the longest axis of the centroids
+			const int bin_count = 16;
+			int bin_sizes[bin_count] = {};
+			AxisAlignedBoundingBox bin_boxes[bin_count];
+			auto get_bin = [&](int leaf)
+			{
+				int bin = (int)((get_axis(nodes[leaf].box.center()) - axis_min) / axis_size * bin_count);
+				return std::min(bin, bin_count - 1);
+			};
+
+			for (int i = 0; i < count; i++)
+			{
+				int bin = get_bin(leaves[i]);
+				bin_boxes[bin] = bin_sizes[bin] == 0 ? nodes[leaves[i]].box : combine(bin_boxes[bin], nodes[leaves[i]].box);
+				bin_sizes[bin]++;
+			}
+
+			float right_costs[bin_count];
+			AxisAlignedBoundingBox right_box;
+			int right_size = 0;
+			for (int i = bin_count - 1; i > 0; i--)
+			{
+				if (bin_sizes[i] != 0)
+				{
+					right_box = right_size == 0 ? bin_boxes[i] : combine(right_box, bin_boxes[i]);
+					right_size += bin_sizes[i];
+				}
+				right_costs[i] = right_size != 0 ? area(right_box) * right_size : 0.0f;
+			}
+
+			int best_split = -1;
+			float best_cost = 0.0f;
+			AxisAlignedBoundingBox left_box;
+			int left_size = 0;
+			for (int i = 1; i < bin_count; i++)
+			{
+				if (bin_sizes[i - 1] != 0)
+				{
+					left_box = left_size == 0 ? bin_boxes[i - 1] : combine(left_box, bin_boxes[i - 1]);
+					left_size += bin_sizes[i - 1];
+				}
+				if (left_size == 0 || left_size == count)
+					continue;
+				float cost = area(left_box) * left_size + right_costs[i];
+				if (best_split == -1 || cost < best_cost)
+				{
+					best_split = i;
+					best_cost = cost;
+				}
+			}
+
+			if (best_split != -1)
+				mid = (int)(std::partition(leaves, leaves + count, [&](int leaf) { return get_bin(leaf) < best_split; }) - leaves);
+		}
+
+		int index = allocate_node();
+		int child1 = build_sah(leaves, mid);
+		int child2 = build_sah(leaves + mid, count - mid);
+
+		AxisAlignedBoundingBoxTree_Node &node = nodes[index];
+		node.child1 = child1;
+		node.child2 = child2;
+		node.box = combine(nodes[child1].box, nodes[child2].box);
+		node.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[child1].parent = index;
+		nodes[child2].parent = index;
+		return index;
+	}
+
+	float AxisAlignedBoundingBoxTree_Impl::area(const AxisAlignedBoundingBox &box)
+	{
+		Vec3f size = box.aabb_max - box.aabb_min;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	AxisAlignedBoundingBox AxisAlignedBoundingBoxTree_Impl::combine(const AxisAlignedBoundingBox &a, const AxisAlignedBoundingBox &b)
+	{
+		return AxisAlignedBoundingBox(
+			Vec3f(std::min(a.aabb_min.x, b.aabb_min.x), std::min(a.aabb_min.y, b.aabb_min.y), std::min(a.aabb_min.z, b.aabb_min.z)),
+			Vec3f(std::max(a.aabb_max.x, b.aabb_max.x), std::max(a.aabb_max.y, b.aabb_max.y), std::max(a.aabb_max.z, b.aabb_max.z)));
+	}
+
+	bool AxisAlignedBoundingBoxTree_Impl::contains(const AxisAlignedBoundingBox &outer, const AxisAlignedBoundingBox &inner)
+	{
+		return inner.aabb_min.x >= outer.aabb_min.x && inner.aabb_min.y >= outer.aabb_min.y && inner.aabb_min.z >= outer.aabb_min.z &&
+			inner.aabb_max.x <= outer.aabb_max.x && inner.aabb_max.y <= outer.aabb_max.y && inner.aabb_max.z <= outer.aabb_max.z;
+	}
+}
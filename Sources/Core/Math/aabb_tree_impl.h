@@ -0,0 +1,102 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/Math/aabb_tree.h"
+#include "API/Core/Math/aabb.h"
+#include "API/Core/Math/frustum_planes.h"
+
+namespace clan
+{
+	class AxisAlignedBoundingBoxTree_Node
+	{
+	public:
+		/// \brief Fat box of a leaf, or the union of the children of an inner node
+		AxisAlignedBoundingBox box;
+
+		/// \brief Exact box of the object stored in a leaf
+		AxisAlignedBoundingBox object_box;
+
+		void *data = nullptr;
+
+		/// \brief Parent node, or the next node in the free list
+		int parent = -1;
+		int child1 = -1;
+		int child2 = -1;
+
+		/// \brief 0 for leaves, -1 for free nodes
+		int height = -1;
+
+		bool is_leaf() const { return child1 == -1; }
+	};
+
+	class AxisAlignedBoundingBoxTree_Impl
+	{
+	public:
+		AxisAlignedBoundingBoxTree_Impl(float margin);
+
+		int insert(const AxisAlignedBoundingBox &box, void *data);
+		void remove(int proxy);
+		bool move(int proxy, const AxisAlignedBoundingBox &box, const Vec3f &displacement);
+		void clear();
+		void rebuild();
+
+		void query(const AxisAlignedBoundingBox &box, std::vector<int> &result) const;
+		void query(const Vec3f &point, std::vector<int> &result) const;
+		void query(const FrustumPlanes &frustum, std::vector<int> &result) const;
+		void query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &result) const;
+
+		const AxisAlignedBoundingBoxTree_Node &get_leaf(int proxy) const;
+
+		std::vector<AxisAlignedBoundingBoxTree_Node> nodes;
+		int root = -1;
+		int free_list = -1;
+		int proxy_count = 0;
+		float margin;
+
+	private:
+		int allocate_node();
+		void free_node(int index);
+		void insert_leaf(int leaf);
+		void remove_leaf(int leaf);
+		int find_best_sibling(const AxisAlignedBoundingBox &box) const;
+		void refit_ancestors(int index, bool rotate);
+		void rotate(int index);
+		int build_sah(int *leaves, int count);
+		void add_subtree(int index, std::vector<int> &result) const;
+
+		template<typename Test>
+		void find_leaves(const Test &test, std::vector<int> &result) const;
+
+		static float area(const AxisAlignedBoundingBox &box);
+		static AxisAlignedBoundingBox combine(const AxisAlignedBoundingBox &a, const AxisAlignedBoundingBox &b);
+		static bool contains(const AxisAlignedBoundingBox &outer, const AxisAlignedBoundingBox &inner);
+	};
+}
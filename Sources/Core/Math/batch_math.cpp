@@ -0,0 +1,596 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/batch_math.h"
+#include "API/Core/Math/aabb.h"
+#include "API/Core/Math/frustum_planes.h"
+#include "API/Core/System/cpu_features.h"
+#include <cmath>
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_BATCH_MATH_AVX
+#if defined(__GNUC__)
+#define CL_TARGET_AVX __attribute__((target("avx")))
+#else
+#define CL_TARGET_AVX
+#endif
+#endif
+#endif
+
+namespace clan
+{
+	/////////////////////////////////////////////////////////////////////////////
+	// SoA containers:
+
+	void AxisAlignedBoundingBoxSoA::resize(size_t size)
+	{
+		min_x.resize(size);
+		min_y.resize(size);
+		min_z.resize(size);
+		max_x.resize(size);
+		max_y.resize(size);
+		max_z.resize(size);
+	}
+
+	void AxisAlignedBoundingBoxSoA::clear()
+	{
+		min_x.clear();
+		min_y.clear();
+		min_z.clear();
+		max_x.clear();
+		max_y.clear();
+		max_z.clear();
+	}
+
+	void AxisAlignedBoundingBoxSoA::push_back(const AxisAlignedBoundingBox &box)
+	{
+		min_x.push_back(box.aabb_min.x);
+		min_y.push_back(box.aabb_min.y);
+		min_z.push_back(box.aabb_min.z);
+		max_x.push_back(box.aabb_max.x);
+		max_y.push_back(box.aabb_max.y);
+		max_z.push_back(box.aabb_max.z);
+	}
+
+	void AxisAlignedBoundingBoxSoA::set(size_t index, const AxisAlignedBoundingBox &box)
+	{
+		min_x[index] = box.aabb_min.x;
+		min_y[index] = box.aabb_min.y;
+		min_z[index] = box.aabb_min.z;
+		max_x[index] = box.aabb_max.x;
+		max_y[index] = box.aabb_max.y;
+		max_z[index] = box.aabb_max.z;
+	}
+
+	AxisAlignedBoundingBox AxisAlignedBoundingBoxSoA::get(size_t index) const
+	{
+		return AxisAlignedBoundingBox(Vec3f(min_x[index], min_y[index], min_z[index]), Vec3f(max_x[index], max_y[index], max_z[index]));
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// Kernels:
+
+	namespace
+	{
+		bool use_avx()
+		{
+#ifdef CL_BATCH_MATH_AVX
+			return CPUFeatures::get().has(System::avx);
+#else
+			return false;
+#endif
+		}
+
+		bool use_sse2()
+		{
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+			return CPUFeatures::get().has(System::sse2);
+#else
+			return false;
+#endif
+		}
+
+		void clear_mask(std::vector<uint32_t> &mask, size_t count)
+		{
+			mask.assign((count + 31) / 32, 0);
+		}
+
+		// Scalar versions. These are used on platforms without SSE2 and for the elements left over after the vector loops.
+
+		void transform_points4_scalar(const float *m, const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, float *out_w, size_t start, size_t end)
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				out_x[i] = m[0] * x[i] + m[4] * y[i] + m[8] * z[i] + m[12];
+				out_y[i] = m[1] * x[i] + m[5] * y[i] + m[9] * z[i] + m[13];
+				out_z[i] = m[2] * x[i] + m[6] * y[i] + m[10] * z[i] + m[14];
+				out_w[i] = m[3] * x[i] + m[7] * y[i] + m[11] * z[i] + m[15];
+			}
+		}
+
+		void transform_points3_scalar(const float *m, const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, size_t start, size_t end)
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				float px = x[i], py = y[i], pz = z[i];
+				float dx = px * m[0] + py * m[4] + pz * m[8] + m[12];
+				float dy = px * m[1] + py * m[5] + pz * m[9] + m[13];
+				float dz = px * m[2] + py * m[6] + pz * m[10] + m[14];
+				float w = px * m[3] + py * m[7] + pz * m[11] + m[15];
+				if (w != 0.0f)
+				{
+					dx /= w;
+					dy /= w;
+					dz /= w;
+				}
+				out_x[i] = dx;
+				out_y[i] = dy;
+				out_z[i] = dz;
+			}
+		}
+
+		void frustum_aabbs_scalar(const FrustumPlanes &frustum, const AxisAlignedBoundingBoxSoA &boxes, uint32_t *mask, size_t start, size_t end)
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				float center_x = (boxes.max_x[i] + boxes.min_x[i]) * 0.5f;
+				float center_y = (boxes.max_y[i] + boxes.min_y[i]) * 0.5f;
+				float center_z = (boxes.max_z[i] + boxes.min_z[i]) * 0.5f;
+				float extents_x = (boxes.max_x[i] - boxes.min_x[i]) * 0.5f;
+				float extents_y = (boxes.max_y[i] - boxes.min_y[i]) * 0.5f;
+				float extents_z = (boxes.max_z[i] - boxes.min_z[i]) * 0.5f;
+
+				bool visible = true;
+				for (const Vec4f &plane : frustum.planes)
+				{
+					float e = extents_x * std::abs(plane.x) + extents_y * std::abs(plane.y) + extents_z * std::abs(plane.z);
+					float s = center_x * plane.x + center_y * plane.y + center_z * plane.z + plane.w;
+					if (s + e < 0.0f)
+						visible = false;
+				}
+
+				if (visible)
+					mask[i >> 5] |= 1u << (i & 31);
+			}
+		}
+
+		void frustum_spheres_scalar(const FrustumPlanes &frustum, const float *plane_lengths, const SphereSoA &spheres, uint32_t *mask, size_t start, size_t end)
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				bool visible = true;
+				for (int j = 0; j < 6; j++)
+				{
+					const Vec4f &plane = frustum.planes[j];
+					float s = spheres.center.x[i] * plane.x + spheres.center.y[i] * plane.y + spheres.center.z[i] * plane.z + plane.w;
+					if (s + spheres.radius[i] * plane_lengths[j] < 0.0f)
+						visible = false;
+				}
+
+				if (visible)
+					mask[i >> 5] |= 1u << (i & 31);
+			}
+		}
+
+		void sphere_spheres_scalar(const Vec3f &center, float radius, const SphereSoA &spheres, uint32_t *mask, size_t start, size_t end)
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				float hx = center.x - spheres.center.x[i];
+				float hy = center.y - spheres.center.y[i];
+				float hz = center.z - spheres.center.z[i];
+				float square_distance = hx * hx + hy * hy + hz * hz;
+				float radius_sum = radius + spheres.radius[i];
+				if (!(square_distance > radius_sum * radius_sum))
+					mask[i >> 5] |= 1u << (i & 31);
+			}
+		}
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+
+		// SSE2 versions, four objects at a time. The operations are done in the same order as the scalar code
+		// so the results are identical.
+
+		size_t transform_points4_sse2(const float *m, const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, float *out_w, size_t count)
+		{
+			__m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]), m3 = _mm_set1_ps(m[3]);
+			__m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]);
+			__m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]), m11 = _mm_set1_ps(m[11]);
+			__m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]), m15 = _mm_set1_ps(m[15]);
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 px = _mm_loadu_ps(x + i);
+				__m128 py = _mm_loadu_ps(y + i);
+				__m128 pz = _mm_loadu_ps(z + i);
+				_mm_storeu_ps(out_x + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, px), _mm_mul_ps(m4, py)), _mm_mul_ps(m8, pz)), m12));
+				_mm_storeu_ps(out_y + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, px), _mm_mul_ps(m5, py)), _mm_mul_ps(m9, pz)), m13));
+				_mm_storeu_ps(out_z + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, px), _mm_mul_ps(m6, py)), _mm_mul_ps(m10, pz)), m14));
+				_mm_storeu_ps(out_w + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, px), _mm_mul_ps(m7, py)), _mm_mul_ps(m11, pz)), m15));
+			}
+			return i;
+		}
+
+		size_t transform_points3_sse2(const float *m, const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, size_t count)
+		{
+			__m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+			__m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+			__m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+			__m128 m3 = _mm_set1_ps(m[3]), m7 = _mm_set1_ps(m[7]), m11 = _mm_set1_ps(m[11]);
+			__m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]), m15 = _mm_set1_ps(m[15]);
+			__m128 zero = _mm_setzero_ps();
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 px = _mm_loadu_ps(x + i);
+				__m128 py = _mm_loadu_ps(y + i);
+				__m128 pz = _mm_loadu_ps(z + i);
+				__m128 dx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m0), _mm_mul_ps(py, m4)), _mm_mul_ps(pz, m8)), m12);
+				__m128 dy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m1), _mm_mul_ps(py, m5)), _mm_mul_ps(pz, m9)), m13);
+				__m128 dz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m2), _mm_mul_ps(py, m6)), _mm_mul_ps(pz, m10)), m14);
+				__m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m3), _mm_mul_ps(py, m7)), _mm_mul_ps(pz, m11)), m15);
+				__m128 nonzero = _mm_cmpneq_ps(w, zero);
+				_mm_storeu_ps(out_x + i, _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(dx, w)), _mm_andnot_ps(nonzero, dx)));
+				_mm_storeu_ps(out_y + i, _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(dy, w)), _mm_andnot_ps(nonzero, dy)));
+				_mm_storeu_ps(out_z + i, _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(dz, w)), _mm_andnot_ps(nonzero, dz)));
+			}
+			return i;
+		}
+
+		inline __m128 abs_ps(__m128 v)
+		{
+			return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+		}
+
+		size_t frustum_aabbs_sse2(const FrustumPlanes &frustum, const AxisAlignedBoundingBoxSoA &boxes, uint32_t *mask, size_t count)
+		{
+			__m128 half = _mm_set1_ps(0.5f);
+			__m128 zero = _mm_setzero_ps();
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 min_x = _mm_loadu_ps(boxes.min_x.data() + i), max_x = _mm_loadu_ps(boxes.max_x.data() + i);
+				__m128 min_y = _mm_loadu_ps(boxes.min_y.data() + i), max_y = _mm_loadu_ps(boxes.max_y.data() + i);
+				__m128 min_z = _mm_loadu_ps(boxes.min_z.data() + i), max_z = _mm_loadu_ps(boxes.max_z.data() + i);
+
+				__m128 center_x = _mm_mul_ps(_mm_add_ps(max_x, min_x), half);
+				__m128 center_y = _mm_mul_ps(_mm_add_ps(max_y, min_y), half);
+				__m128 center_z = _mm_mul_ps(_mm_add_ps(max_z, min_z), half);
+				__m128 extents_x = _mm_mul_ps(_mm_sub_ps(max_x, min_x), half);
+				__m128 extents_y = _mm_mul_ps(_mm_sub_ps(max_y, min_y), half);
+				__m128 extents_z = _mm_mul_ps(_mm_sub_ps(max_z, min_z), half);
+
+				__m128 outside = _mm_setzero_ps();
+				for (const Vec4f &plane : frustum.planes)
+				{
+					__m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extents_x, _mm_set1_ps(std::abs(plane.x))), _mm_mul_ps(extents_y, _mm_set1_ps(std::abs(plane.y)))), _mm_mul_ps(extents_z, _mm_set1_ps(std::abs(plane.z))));
+					__m128 s = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(center_x, _mm_set1_ps(plane.x)), _mm_mul_ps(center_y, _mm_set1_ps(plane.y))), _mm_mul_ps(center_z, _mm_set1_ps(plane.z))), _mm_set1_ps(plane.w));
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(s, e), zero));
+				}
+
+				uint32_t visible = (~_mm_movemask_ps(outside)) & 0xf;
+				mask[i >> 5] |= visible << (i & 31);
+			}
+			return i;
+		}
+
+		size_t frustum_spheres_sse2(const FrustumPlanes &frustum, const float *plane_lengths, const SphereSoA &spheres, uint32_t *mask, size_t count)
+		{
+			__m128 zero = _mm_setzero_ps();
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 center_x = _mm_loadu_ps(spheres.center.x.data() + i);
+				__m128 center_y = _mm_loadu_ps(spheres.center.y.data() + i);
+				__m128 center_z = _mm_loadu_ps(spheres.center.z.data() + i);
+				__m128 radius = _mm_loadu_ps(spheres.radius.data() + i);
+
+				__m128 outside = _mm_setzero_ps();
+				for (int j = 0; j < 6; j++)
+				{
+					const Vec4f &plane = frustum.planes[j];
+					__m128 s = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(center_x, _mm_set1_ps(plane.x)), _mm_mul_ps(center_y, _mm_set1_ps(plane.y))), _mm_mul_ps(center_z, _mm_set1_ps(plane.z))), _mm_set1_ps(plane.w));
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(s, _mm_mul_ps(radius, _mm_set1_ps(plane_lengths[j]))), zero));
+				}
+
+				uint32_t visible = (~_mm_movemask_ps(outside)) & 0xf;
+				mask[i >> 5] |= visible << (i & 31);
+			}
+			return i;
+		}
+
+		size_t sphere_spheres_sse2(const Vec3f &center, float radius, const SphereSoA &spheres, uint32_t *mask, size_t count)
+		{
+			__m128 cx = _mm_set1_ps(center.x);
+			__m128 cy = _mm_set1_ps(center.y);
+			__m128 cz = _mm_set1_ps(center.z);
+			__m128 r = _mm_set1_ps(radius);
+
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 hx = _mm_sub_ps(cx, _mm_loadu_ps(spheres.center.x.data() + i));
+				__m128 hy = _mm_sub_ps(cy, _mm_loadu_ps(spheres.center.y.data() + i));
+				__m128 hz = _mm_sub_ps(cz, _mm_loadu_ps(spheres.center.z.data() + i));
+				__m128 square_distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(hx, hx), _mm_mul_ps(hy, hy)), _mm_mul_ps(hz, hz));
+				__m128 radius_sum = _mm_add_ps(r, _mm_loadu_ps(spheres.radius.data() + i));
+
+				uint32_t overlap = (~_mm_movemask_ps(_mm_cmpgt_ps(square_distance, _mm_mul_ps(radius_sum, radius_sum)))) & 0xf;
+				mask[i >> 5] |= overlap << (i & 31);
+			}
+			return i;
+		}
+
+#endif
+
+#ifdef CL_BATCH_MATH_AVX
+
+		// AVX versions, eight objects at a time
+
+		CL_TARGET_AVX size_t transform_points4_avx(const float *m, const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, float *out_w, size_t count)
+		{
+			__m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]), m3 = _mm256_set1_ps(m[3]);
+			__m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]), m7 = _mm256_set1_ps(m[7]);
+			__m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]), m11 = _mm256_set1_ps(m[11]);
+			__m256 m12 = _mm256_set1_ps(m[12]), m13 = _mm256_set1_ps(m[13]), m14 = _mm256_set1_ps(m[14]), m15 = _mm256_set1_ps(m[15]);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 px = _mm256_loadu_ps(x + i);
+				__m256 py = _mm256_loadu_ps(y + i);
+				__m256 pz = _mm256_loadu_ps(z + i);
+				_mm256_storeu_ps(out_x + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, px), _mm256_mul_ps(m4, py)), _mm256_mul_ps(m8, pz)), m12));
+				_mm256_storeu_ps(out_y + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, px), _mm256_mul_ps(m5, py)), _mm256_mul_ps(m9, pz)), m13));
+				_mm256_storeu_ps(out_z + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, px), _mm256_mul_ps(m6, py)), _mm256_mul_ps(m10, pz)), m14));
+				_mm256_storeu_ps(out_w + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m3, px), _mm256_mul_ps(m7, py)), _mm256_mul_ps(m11, pz)), m15));
+			}
+			return i;
+		}
+
+		CL_TARGET_AVX size_t transform_points3_avx(const float *m, const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, size_t count)
+		{
+			__m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+			__m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]);
+			__m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]);
+			__m256 m3 = _mm256_set1_ps(m[3]), m7 = _mm256_set1_ps(m[7]), m11 = _mm256_set1_ps(m[11]);
+			__m256 m12 = _mm256_set1_ps(m[12]), m13 = _mm256_set1_ps(m[13]), m14 = _mm256_set1_ps(m[14]), m15 = _mm256_set1_ps(m[15]);
+			__m256 zero = _mm256_setzero_ps();
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 px = _mm256_loadu_ps(x + i);
+				__m256 py = _mm256_loadu_ps(y + i);
+				__m256 pz = _mm256_loadu_ps(z + i);
+				__m256 dx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m0), _mm256_mul_ps(py, m4)), _mm256_mul_ps(pz, m8)), m12);
+				__m256 dy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m1), _mm256_mul_ps(py, m5)), _mm256_mul_ps(pz, m9)), m13);
+				__m256 dz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m2), _mm256_mul_ps(py, m6)), _mm256_mul_ps(pz, m10)), m14);
+				__m256 w = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, m3), _mm256_mul_ps(py, m7)), _mm256_mul_ps(pz, m11)), m15);
+				__m256 nonzero = _mm256_cmp_ps(w, zero, _CMP_NEQ_UQ);
+				_mm256_storeu_ps(out_x + i, _mm256_blendv_ps(dx, _mm256_div_ps(dx, w), nonzero));
+				_mm256_storeu_ps(out_y + i, _mm256_blendv_ps(dy, _mm256_div_ps(dy, w), nonzero));
+				_mm256_storeu_ps(out_z + i, _mm256_blendv_ps(dz, _mm256_div_ps(dz, w), nonzero));
+			}
+			return i;
+		}
+
+		CL_TARGET_AVX size_t frustum_aabbs_avx(const FrustumPlanes &frustum, const AxisAlignedBoundingBoxSoA &boxes, uint32_t *mask, size_t count)
+		{
+			__m256 half = _mm256_set1_ps(0.5f);
+			__m256 zero = _mm256_setzero_ps();
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 min_x = _mm256_loadu_ps(boxes.min_x.data() + i), max_x = _mm256_loadu_ps(boxes.max_x.data() + i);
+				__m256 min_y = _mm256_loadu_ps(boxes.min_y.data() + i), max_y = _mm256_loadu_ps(boxes.max_y.data() + i);
+				__m256 min_z = _mm256_loadu_ps(boxes.min_z.data() + i), max_z = _mm256_loadu_ps(boxes.max_z.data() + i);
+
+				__m256 center_x = _mm256_mul_ps(_mm256_add_ps(max_x, min_x), half);
+				__m256 center_y = _mm256_mul_ps(_mm256_add_ps(max_y, min_y), half);
+				__m256 center_z = _mm256_mul_ps(_mm256_add_ps(max_z, min_z), half);
+				__m256 extents_x = _mm256_mul_ps(_mm256_sub_ps(max_x, min_x), half);
+				__m256 extents_y = _mm256_mul_ps(_mm256_sub_ps(max_y, min_y), half);
+				__m256 extents_z = _mm256_mul_ps(_mm256_sub_ps(max_z, min_z), half);
+
+				__m256 outside = _mm256_setzero_ps();
+				for (const Vec4f &plane : frustum.planes)
+				{
+					__m256 e = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extents_x, _mm256_set1_ps(std::abs(plane.x))), _mm256_mul_ps(extents_y, _mm256_set1_ps(std::abs(plane.y)))), _mm256_mul_ps(extents_z, _mm256_set1_ps(std::abs(plane.z))));
+					__m256 s = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(center_x, _mm256_set1_ps(plane.x)), _mm256_mul_ps(center_y, _mm256_set1_ps(plane.y))), _mm256_mul_ps(center_z, _mm256_set1_ps(plane.z))), _mm256_set1_ps(plane.w));
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(s, e), zero, _CMP_LT_OQ));
+				}
+
+				uint32_t visible = (~_mm256_movemask_ps(outside)) & 0xff;
+				mask[i >> 5] |= visible << (i & 31);
+			}
+			return i;
+		}
+
+		CL_TARGET_AVX size_t frustum_spheres_avx(const FrustumPlanes &frustum, const float *plane_lengths, const SphereSoA &spheres, uint32_t *mask, size_t count)
+		{
+			__m256 zero = _mm256_setzero_ps();
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 center_x = _mm256_loadu_ps(spheres.center.x.data() + i);
+				__m256 center_y = _mm256_loadu_ps(spheres.center.y.data() + i);
+				__m256 center_z = _mm256_loadu_ps(spheres.center.z.data() + i);
+				__m256 radius = _mm256_loadu_ps(spheres.radius.data() + i);
+
+				__m256 outside = _mm256_setzero_ps();
+				for (int j = 0; j < 6; j++)
+				{
+					const Vec4f &plane = frustum.planes[j];
+					__m256 s = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(center_x, _mm256_set1_ps(plane.x)), _mm256_mul_ps(center_y, _mm256_set1_ps(plane.y))), _mm256_mul_ps(center_z, _mm256_set1_ps(plane.z))), _mm256_set1_ps(plane.w));
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(s, _mm256_mul_ps(radius, _mm256_set1_ps(plane_lengths[j]))), zero, _CMP_LT_OQ));
+				}
+
+				uint32_t visible = (~_mm256_movemask_ps(outside)) & 0xff;
+				mask[i >> 5] |= visible << (i & 31);
+			}
+			return i;
+		}
+
+		CL_TARGET_AVX size_t sphere_spheres_avx(const Vec3f &center, float radius, const SphereSoA &spheres, uint32_t *mask, size_t count)
+		{
+			__m256 cx = _mm256_set1_ps(center.x);
+			__m256 cy = _mm256_set1_ps(center.y);
+			__m256 cz = _mm256_set1_ps(center.z);
+			__m256 r = _mm256_set1_ps(radius);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 hx = _mm256_sub_ps(cx, _mm256_loadu_ps(spheres.center.x.data() + i));
+				__m256 hy = _mm256_sub_ps(cy, _mm256_loadu_ps(spheres.center.y.data() + i));
+				__m256 hz = _mm256_sub_ps(cz, _mm256_loadu_ps(spheres.center.z.data() + i));
+				__m256 square_distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(hx, hx), _mm256_mul_ps(hy, hy)), _mm256_mul_ps(hz, hz));
+				__m256 radius_sum = _mm256_add_ps(r, _mm256_loadu_ps(spheres.radius.data() + i));
+
+				uint32_t overlap = (~_mm256_movemask_ps(_mm256_cmp_ps(square_distance, _mm256_mul_ps(radius_sum, radius_sum), _CMP_GT_OQ))) & 0xff;
+				mask[i >> 5] |= overlap << (i & 31);
+			}
+			return i;
+		}
+
+#endif
+	}
+
+	void BatchMath::transform_points(const Mat4f &matrix, const Vec3fSoA &points, Vec4fSoA &result)
+	{
+		size_t count = points.size();
+		result.resize(count);
+
+		const float *m = matrix.matrix;
+		const float *x = points.x.data(), *y = points.y.data(), *z = points.z.data();
+		float *out_x = result.x.data(), *out_y = result.y.data(), *out_z = result.z.data(), *out_w = result.w.data();
+
+		size_t done = 0;
+#ifdef CL_BATCH_MATH_AVX
+		if (use_avx())
+			done = transform_points4_avx(m, x, y, z, out_x, out_y, out_z, out_w, count);
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		if (done == 0 && use_sse2())
+			done = transform_points4_sse2(m, x, y, z, out_x, out_y, out_z, out_w, count);
+#endif
+		transform_points4_scalar(m, x, y, z, out_x, out_y, out_z, out_w, done, count);
+	}
+
+	void BatchMath::transform_points(const Mat4f &matrix, const Vec3fSoA &points, Vec3fSoA &result)
+	{
+		size_t count = points.size();
+		result.resize(count);
+
+		const float *m = matrix.matrix;
+		const float *x = points.x.data(), *y = points.y.data(), *z = points.z.data();
+		float *out_x = result.x.data(), *out_y = result.y.data(), *out_z = result.z.data();
+
+		size_t done = 0;
+#ifdef CL_BATCH_MATH_AVX
+		if (use_avx())
+			done = transform_points3_avx(m, x, y, z, out_x, out_y, out_z, count);
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		if (done == 0 && use_sse2())
+			done = transform_points3_sse2(m, x, y, z, out_x, out_y, out_z, count);
+#endif
+		transform_points3_scalar(m, x, y, z, out_x, out_y, out_z, done, count);
+	}
+
+	void BatchMath::frustum_aabbs(const FrustumPlanes &frustum, const AxisAlignedBoundingBoxSoA &boxes, std::vector<uint32_t> &result)
+	{
+		size_t count = boxes.size();
+		clear_mask(result, count);
+
+		size_t done = 0;
+#ifdef CL_BATCH_MATH_AVX
+		if (use_avx())
+			done = frustum_aabbs_avx(frustum, boxes, result.data(), count);
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		if (done == 0 && use_sse2())
+			done = frustum_aabbs_sse2(frustum, boxes, result.data(), count);
+#endif
+		frustum_aabbs_scalar(frustum, boxes, result.data(), done, count);
+	}
+
+	void BatchMath::frustum_spheres(const FrustumPlanes &frustum, const SphereSoA &spheres, std::vector<uint32_t> &result)
+	{
+		size_t count = spheres.size();
+		clear_mask(result, count);
+
+		// The planes are not necessarily normalized, so scale the radius by the length of the normal
+		float plane_lengths[6];
+		for (int j = 0; j < 6; j++)
+		{
+			const Vec4f &plane = frustum.planes[j];
+			plane_lengths[j] = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		}
+
+		size_t done = 0;
+#ifdef CL_BATCH_MATH_AVX
+		if (use_avx())
+			done = frustum_spheres_avx(frustum, plane_lengths, spheres, result.data(), count);
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		if (done == 0 && use_sse2())
+			done = frustum_spheres_sse2(frustum, plane_lengths, spheres, result.data(), count);
+#endif
+		frustum_spheres_scalar(frustum, plane_lengths, spheres, result.data(), done, count);
+	}
+
+	void BatchMath::sphere_spheres(const Vec3f &center, float radius, const SphereSoA &spheres, std::vector<uint32_t> &result)
+	{
+		size_t count = spheres.size();
+		clear_mask(result, count);
+
+		size_t done = 0;
+#ifdef CL_BATCH_MATH_AVX
+		if (use_avx())
+			done = sphere_spheres_avx(center, radius, spheres, result.data(), count);
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		if (done == 0 && use_sse2())
+			done = sphere_spheres_sse2(center, radius, spheres, result.data(), count);
+#endif
+		sphere_spheres_scalar(center, radius, spheres, result.data(), done, count);
+	}
+}
@@ -48,10 +48,251 @@
 #include "Core/precomp.h"
 #include "big_int_impl.h"
 #include "API/Core/Math/big_int.h"
+#include "API/Core/Math/cl_math.h"
 #include <cstdlib>
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 namespace clan
 {
+	namespace
+	{
+		// Multiplications of numbers with at least this many digits use Karatsuba instead of the schoolbook method
+		const unsigned int karatsuba_threshold = 48;
+
+		// Computes r = a * b, where r has room for na + nb digits
+		void schoolbook_mul(const uint32_t *a, unsigned int na, const uint32_t *b, unsigned int nb, uint32_t *r)
+		{
+			memset(r, 0, (na + nb) * sizeof(uint32_t));
+			for (unsigned int ix = 0; ix < nb; ix++)
+			{
+				if (b[ix] == 0)
+					continue;
+
+				uint64_t k = 0;
+				for (unsigned int jx = 0; jx < na; jx++)
+				{
+					uint64_t w = (uint64_t)b[ix] * (uint64_t)a[jx] + k + (uint64_t)r[ix + jx];
+					r[ix + jx] = (uint32_t)w;
+					k = w >> 32;
+				}
+				r[ix + na] = (uint32_t)k;
+			}
+		}
+
+		// Computes r = a + b with na >= nb, where r has room for na + 1 digits
+		void add_digits(const uint32_t *a, unsigned int na, const uint32_t *b, unsigned int nb, uint32_t *r)
+		{
+			uint64_t k = 0;
+			for (unsigned int ix = 0; ix < na; ix++)
+			{
+				k += (uint64_t)a[ix] + (ix < nb ? b[ix] : 0);
+				r[ix] = (uint32_t)k;
+				k >>= 32;
+			}
+			r[na] = (uint32_t)k;
+		}
+
+		// Computes a += b with na >= nb, where the result fits in na digits
+		void add_digits_in_place(uint32_t *a, unsigned int na, const uint32_t *b, unsigned int nb)
+		{
+			uint64_t k = 0;
+			unsigned int ix;
+			for (ix = 0; ix < nb; ix++)
+			{
+				k += (uint64_t)a[ix] + b[ix];
+				a[ix] = (uint32_t)k;
+				k >>= 32;
+			}
+			for (; k && ix < na; ix++)
+			{
+				k += a[ix];
+				a[ix] = (uint32_t)k;
+				k >>= 32;
+			}
+		}
+
+		// Computes a -= b with na >= nb, where a >= b
+		void sub_digits_in_place(uint32_t *a, unsigned int na, const uint32_t *b, unsigned int nb)
+		{
+			uint32_t borrow = 0;
+			unsigned int ix;
+			for (ix = 0; ix < nb; ix++)
+			{
+				uint64_t w = (uint64_t)a[ix] - b[ix] - borrow;
+				a[ix] = (uint32_t)w;
+				borrow = (uint32_t)(w >> 63);
+			}
+			for (; borrow && ix < na; ix++)
+			{
+				borrow = a[ix] == 0;
+				a[ix]--;
+			}
+		}
+
+		// Computes r = a * b for two n digit numbers, where r has room for 2 * n digits
+		//
+		// With a = a1 * B + a0 and b = b1 * B + b0, the middle term a1 * b0 + a0 * b1 is found
+		// as (a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1, so each level needs three multiplications instead of four.
+		void karatsuba_mul(const uint32_t *a, const uint32_t *b, unsigned int n, uint32_t *r)
+		{
+			if (n < karatsuba_threshold)
+			{
+				schoolbook_mul(a, n, b, n, r);
+				return;
+			}
+
+			unsigned int low = n / 2;
+			unsigned int high = n - low;
+
+			karatsuba_mul(a, b, low, r);	// z0 = a0 * b0
+			karatsuba_mul(a + low, b + low, high, r + 2 * low);	// z2 = a1 * b1
+
+			std::vector<uint32_t> temp(4 * (high + 1));
+			uint32_t *sum_a = temp.data();
+			uint32_t *sum_b = sum_a + high + 1;
+			uint32_t *z1 = sum_b + high + 1;
+
+			add_digits(a + low, high, a, low, sum_a);
+			add_digits(b + low, high, b, low, sum_b);
+			karatsuba_mul(sum_a, sum_b, high + 1, z1);
+			sub_digits_in_place(z1, 2 * (high + 1), r, 2 * low);
+			sub_digits_in_place(z1, 2 * (high + 1), r + 2 * low, 2 * high);
+			add_digits_in_place(r + low, 2 * n - low, z1, 2 * (high + 1));
+		}
+
+		// Computes (high, low) = a * b
+		inline uint64_t mul_64(uint64_t a, uint64_t b, uint64_t &high)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			return _umul128(a, b, &high);
+#elif defined(__SIZEOF_INT128__)
+			unsigned __int128 product = (unsigned __int128)a * b;
+			high = (uint64_t)(product >> 64);
+			return (uint64_t)product;
+#else
+			uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+			uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+			uint64_t low_low = a_low * b_low;
+			uint64_t low_high = a_low * b_high;
+			uint64_t high_low = a_high * b_low;
+			uint64_t middle = (low_low >> 32) + (uint32_t)low_high + (uint32_t)high_low;
+			high = a_high * b_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+			return (middle << 32) | (uint32_t)low_low;
+#endif
+		}
+
+		// Computes (carry, result) = a + b * c + carry, which cannot overflow 128 bits
+		inline uint64_t mul_add_64(uint64_t a, uint64_t b, uint64_t c, uint64_t &carry)
+		{
+#if defined(__SIZEOF_INT128__)
+			unsigned __int128 sum = (unsigned __int128)b * c + a + carry;
+			carry = (uint64_t)(sum >> 64);
+			return (uint64_t)sum;
+#else
+			uint64_t high;
+			uint64_t low = mul_64(b, c, high);
+			low += a;
+			high += low < a;
+			low += carry;
+			high += low < carry;
+			carry = high;
+			return low;
+#endif
+		}
+
+		// Montgomery arithmetic modulo an odd number, on 64-bit limbs
+		//
+		// Numbers are kept as x * R mod m, with R = 2^(64 * size). Multiplication then needs no division,
+		// as multiply() computes a * b / R mod m by adding multiples of m that clear the low limbs.
+		class MontgomeryModulus
+		{
+		public:
+			MontgomeryModulus(const uint32_t *modulus_digits, unsigned int modulus_digits_used) : size((modulus_digits_used + 1) / 2), modulus(size), temp(size + 2)
+			{
+				load(modulus_digits, modulus_digits_used, modulus.data());
+
+				// -m^-1 mod 2^64 by Newton's method. An odd m is its own inverse mod 2^3, and each step doubles the correct bits.
+				uint64_t inverse = modulus[0];
+				for (int i = 0; i < 5; i++)
+					inverse *= 2 - modulus[0] * inverse;
+				modulus_inverse = 0 - inverse;
+			}
+
+			void load(const uint32_t *digits, unsigned int digits_used, uint64_t *limbs) const
+			{
+				for (int i = 0; i < size; i++)
+				{
+					uint64_t low = (2 * i < (int)digits_used) ? digits[2 * i] : 0;
+					uint64_t high = (2 * i + 1 < (int)digits_used) ? digits[2 * i + 1] : 0;
+					limbs[i] = low | (high << 32);
+				}
+			}
+
+			void store(const uint64_t *limbs, uint32_t *digits) const
+			{
+				for (int i = 0; i < size; i++)
+				{
+					digits[2 * i] = (uint32_t)limbs[i];
+					digits[2 * i + 1] = (uint32_t)(limbs[i] >> 32);
+				}
+			}
+
+			// Computes result = a * b / R mod m, for a and b below m. The result may be the same as a or b.
+			void multiply(const uint64_t *a, const uint64_t *b, uint64_t *result)
+			{
+				// Coarsely Integrated Operand Scanning, from "Analyzing and Comparing Montgomery Multiplication Algorithms" by Koc, Acar and Kaliski
+				const int n = size;
+				const uint64_t *m = modulus.data();
+				const uint64_t m_inverse = modulus_inverse;
+				uint64_t *t = temp.data();
+				memset(t, 0, (n + 2) * sizeof(uint64_t));
+
+				for (int i = 0; i < n; i++)
+				{
+					uint64_t carry = 0;
+					const uint64_t b_i = b[i];
+					for (int j = 0; j < n; j++)
+						t[j] = mul_add_64(t[j], a[j], b_i, carry);
+					t[n] += carry;
+					t[n + 1] = t[n] < carry;
+
+					const uint64_t q = t[0] * m_inverse;
+					carry = 0;
+					mul_add_64(t[0], q, m[0], carry);
+					for (int j = 1; j < n; j++)
+						t[j - 1] = mul_add_64(t[j], q, m[j], carry);
+					t[n - 1] = t[n] + carry;
+					t[n] = t[n + 1] + (t[n - 1] < carry);
+				}
+
+				// t is now below 2m. Subtract m, and keep the difference unless it went negative, without branching on the value.
+				uint64_t borrow = 0;
+				for (int j = 0; j < n; j++)
+				{
+					uint64_t difference = t[j] - m[j];
+					uint64_t next_borrow = t[j] < m[j];
+					next_borrow |= difference < borrow;
+					result[j] = difference - borrow;
+					borrow = next_borrow;
+				}
+
+				uint64_t keep_mask = 0 - (borrow & (t[n] == 0));
+				for (int j = 0; j < n; j++)
+					result[j] = (t[j] & keep_mask) | (result[j] & ~keep_mask);
+			}
+
+			int size;
+			std::vector<uint64_t> modulus;
+			uint64_t modulus_inverse;
+
+		private:
+			std::vector<uint64_t> temp;
+		};
+	}
+
 	const int BigInt_Impl::default_allocated_precision = 64;
 
 	std::vector<uint32_t> BigInt_Impl::prime_tab;
@@ -1320,6 +1561,22 @@ namespace clan
 		const uint32_t *pb;
 		uint32_t *pt, *pbt;
 
+		// Large numbers of similar size are split, and multiplied using Karatsuba
+		unsigned int n = max(ua, ub);
+		if (ua >= karatsuba_threshold && ub >= karatsuba_threshold && min(ua, ub) * 2 >= n)
+		{
+			std::vector<uint32_t> padded(2 * n, 0);
+			memcpy(padded.data(), digits, ua * sizeof(uint32_t));
+			memcpy(padded.data() + n, b->digits, ub * sizeof(uint32_t));
+
+			BigInt_Impl tmp_impl(2 * n);
+			tmp_impl.digits_used = 2 * n;
+			karatsuba_mul(padded.data(), padded.data() + n, n, tmp_impl.digits);
+			tmp_impl.internal_clamp();
+			tmp_impl.internal_exch(this);
+			return;
+		}
+
 		BigInt_Impl tmp_impl(ua + ub);
 
 		// This has the effect of left-padding with zeroes...
@@ -1600,6 +1857,109 @@ namespace clan
 	}
 
 	void BigInt_Impl::exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	{
+		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
+			throw Exception("Divide by zero");
+
+		if (m->isodd() && m->internal_cmp_d(1) != 0)
+			internal_exptmod_montgomery(b, m, c);
+		else
+			internal_exptmod_barrett(b, m, c);
+	}
+
+	void BigInt_Impl::internal_exptmod_montgomery(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	{
+		MontgomeryModulus modulus(m->digits, m->digits_used);
+		int size = modulus.size;
+
+		BigInt_Impl x(*this);
+		x.mod(m, &x);
+
+		// R^2 mod m converts into Montgomery form, and 1 converts back out of it
+		BigInt_Impl r_squared;
+		r_squared.set((uint32_t) 1);
+		r_squared.internal_lshd(4 * size);
+		r_squared.mod(m, &r_squared);
+
+		std::vector<uint64_t> to_montgomery(size), from_montgomery(size, 0), base(size), result(size);
+		modulus.load(r_squared.digits, r_squared.digits_used, to_montgomery.data());
+		modulus.load(x.digits, x.digits_used, base.data());
+		from_montgomery[0] = 1;
+		modulus.multiply(base.data(), to_montgomery.data(), base.data());
+
+		int exponent_bits = b->significant_bits();
+		auto exponent_bit = [b](int bit) -> unsigned int
+		{
+			return (b->digits[bit / num_bits_in_digit] >> (bit % num_bits_in_digit)) & 1;
+		};
+
+		if (exponent_bits <= 64)
+		{
+			// Short exponents are public (such as 65537), so plain square-and-multiply is fine
+			result = base;
+			for (int bit = exponent_bits - 2; bit >= 0; bit--)
+			{
+				modulus.multiply(result.data(), result.data(), result.data());
+				if (exponent_bit(bit))
+					modulus.multiply(result.data(), base.data(), result.data());
+			}
+			if (b->cmp_z() == 0)
+				modulus.multiply(from_montgomery.data(), to_montgomery.data(), result.data());
+		}
+		else
+		{
+			// Fixed window exponentiation. Every window does the same squarings and one multiplication, and the
+			// whole table is read each time, so neither the sequence of operations nor the memory access depends on the exponent.
+			int window_bits = exponent_bits > 768 ? 5 : (exponent_bits > 256 ? 4 : 3);
+			int table_entries = 1 << window_bits;
+
+			std::vector<uint64_t> table(table_entries * size);
+			modulus.multiply(from_montgomery.data(), to_montgomery.data(), &table[0]);
+			for (int i = 1; i < table_entries; i++)
+				modulus.multiply(&table[(i - 1) * size], base.data(), &table[i * size]);
+
+			std::vector<uint64_t> selected(size);
+			int windows = (exponent_bits + window_bits - 1) / window_bits;
+			for (int window = windows - 1; window >= 0; window--)
+			{
+				unsigned int index = 0;
+				for (int bit = window_bits - 1; bit >= 0; bit--)
+				{
+					int exponent_bit_index = window * window_bits + bit;
+					index = (index << 1) | (exponent_bit_index < exponent_bits ? exponent_bit(exponent_bit_index) : 0);
+				}
+
+				memset(selected.data(), 0, size * sizeof(uint64_t));
+				for (int i = 0; i < table_entries; i++)
+				{
+					uint64_t mask = 0 - (uint64_t)((unsigned int)i == index);
+					for (int j = 0; j < size; j++)
+						selected[j] |= table[i * size + j] & mask;
+				}
+
+				if (window == windows - 1)
+				{
+					result = selected;
+				}
+				else
+				{
+					for (int i = 0; i < window_bits; i++)
+						modulus.multiply(result.data(), result.data(), result.data());
+					modulus.multiply(result.data(), selected.data(), result.data());
+				}
+			}
+		}
+
+		modulus.multiply(result.data(), from_montgomery.data(), result.data());
+
+		BigInt_Impl s(2 * size);
+		s.digits_used = 2 * size;
+		modulus.store(result.data(), s.digits);
+		s.internal_clamp();
+		s.internal_exch(c);
+	}
+
+	void BigInt_Impl::internal_exptmod_barrett(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
 	{
 		BigInt_Impl s, mu;
 		uint32_t d;
@@ -1608,9 +1968,6 @@ namespace clan
 		unsigned int  ub = b->digits_used;
 		unsigned int dig, bit;
 
-		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
-			throw Exception("Divide by zero");
-
 		BigInt_Impl x(*this);
 
 		x.mod(m, &x);
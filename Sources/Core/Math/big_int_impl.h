@@ -168,6 +168,12 @@ namespace clan
 		void internal_reduce(const BigInt_Impl *m, BigInt_Impl *mu);
 		void internal_sqr();
 
+		// Modular exponentiation in Montgomery form, for odd m
+		void internal_exptmod_montgomery(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const;
+
+		// Modular exponentiation using Barrett reduction, for any m
+		void internal_exptmod_barrett(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const;
+
 		bool digits_negative;	// True if the value is negative
 		unsigned int digits_alloc;		// How many digits allocated
 		unsigned int digits_used;		// How many digits used
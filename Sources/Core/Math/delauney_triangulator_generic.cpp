@@ -29,38 +29,248 @@
 #include "Core/precomp.h"
 #include "delauney_triangulator_generic.h"
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 namespace clan
 {
-	DelauneyTriangulator_Impl::DelauneyTriangulator_Impl()
+	/////////////////////////////////////////////////////////////////////////////
+	// Robust geometric predicates
+	//
+	// The predicates are first evaluated in double precision. If the result is too close to zero for its sign to be trusted,
+	// they are evaluated again exactly, using expansions (sums of non-overlapping doubles) as described by Jonathan Shewchuk
+	// in "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+
+	namespace
 	{
+		typedef std::vector<double> Expansion;
+
+		const double predicate_epsilon = DBL_EPSILON * 0.5;
+		const double orient_error_bound = (3.0 + 16.0 * predicate_epsilon) * predicate_epsilon;
+		const double incircle_error_bound = (10.0 + 96.0 * predicate_epsilon) * predicate_epsilon;
+
+		inline void two_sum(double a, double b, double &x, double &y)
+		{
+			x = a + b;
+			double b_virtual = x - a;
+			double a_virtual = x - b_virtual;
+			y = (a - a_virtual) + (b - b_virtual);
+		}
+
+		inline void two_product(double a, double b, double &x, double &y)
+		{
+			x = a * b;
+			y = std::fma(a, b, -x);
+		}
+
+		// Adds b to the expansion, keeping the components in increasing order of magnitude and dropping zeros.
+		Expansion grow_expansion(const Expansion &e, double b)
+		{
+			Expansion h;
+			h.reserve(e.size() + 1);
+			double q = b;
+			for (double component : e)
+			{
+				double sum, error;
+				two_sum(q, component, sum, error);
+				q = sum;
+				if (error != 0.0)
+					h.push_back(error);
+			}
+			if (q != 0.0 || h.empty())
+				h.push_back(q);
+			return h;
+		}
+
+		Expansion expansion_sum(const Expansion &e, const Expansion &f)
+		{
+			Expansion h = e;
+			for (double component : f)
+				h = grow_expansion(h, component);
+			return h;
+		}
+
+		Expansion expansion_product(const Expansion &e, const Expansion &f)
+		{
+			Expansion h(1, 0.0);
+			for (double b : f)
+			{
+				for (double a : e)
+				{
+					double product, error;
+					two_product(a, b, product, error);
+					h = grow_expansion(h, error);
+					h = grow_expansion(h, product);
+				}
+			}
+			return h;
+		}
+
+		Expansion expansion_negate(Expansion e)
+		{
+			for (double &component : e)
+				component = -component;
+			return e;
+		}
+
+		Expansion expansion_difference(double a, double b)
+		{
+			double x, y;
+			two_sum(a, -b, x, y);
+			return grow_expansion(Expansion(1, y), x);
+		}
+
+		// The largest component carries the sign of the expansion
+		inline double expansion_estimate_sign(const Expansion &e)
+		{
+			return e.back();
+		}
+
+		/// \brief Positive if a, b and c are in counter-clockwise order (y axis pointing up), negative if clockwise, zero if collinear.
+		double orient2d(double ax, double ay, double bx, double by, double cx, double cy)
+		{
+			double det_left = (ax - cx) * (by - cy);
+			double det_right = (ay - cy) * (bx - cx);
+			double det = det_left - det_right;
+
+			double det_sum = std::abs(det_left) + std::abs(det_right);
+			if (std::abs(det) >= orient_error_bound * det_sum)
+				return det;
+
+			Expansion left = expansion_product(expansion_difference(ax, cx), expansion_difference(by, cy));
+			Expansion right = expansion_product(expansion_difference(ay, cy), expansion_difference(bx, cx));
+			return expansion_estimate_sign(expansion_sum(left, expansion_negate(right)));
+		}
+
+		/// \brief Positive if d lies inside the circle through the counter-clockwise points a, b and c, negative if outside, zero if on it.
+		double incircle(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+		{
+			double adx = ax - dx;
+			double ady = ay - dy;
+			double bdx = bx - dx;
+			double bdy = by - dy;
+			double cdx = cx - dx;
+			double cdy = cy - dy;
+
+			double bdxcdy = bdx * cdy;
+			double cdxbdy = cdx * bdy;
+			double alift = adx * adx + ady * ady;
+
+			double cdxady = cdx * ady;
+			double adxcdy = adx * cdy;
+			double blift = bdx * bdx + bdy * bdy;
+
+			double adxbdy = adx * bdy;
+			double bdxady = bdx * ady;
+			double clift = cdx * cdx + cdy * cdy;
+
+			double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+
+			double permanent =
+				(std::abs(bdxcdy) + std::abs(cdxbdy)) * alift +
+				(std::abs(cdxady) + std::abs(adxcdy)) * blift +
+				(std::abs(adxbdy) + std::abs(bdxady)) * clift;
+			if (std::abs(det) > incircle_error_bound * permanent)
+				return det;
+
+			Expansion exact_adx = expansion_difference(ax, dx);
+			Expansion exact_ady = expansion_difference(ay, dy);
+			Expansion exact_bdx = expansion_difference(bx, dx);
+			Expansion exact_bdy = expansion_difference(by, dy);
+			Expansion exact_cdx = expansion_difference(cx, dx);
+			Expansion exact_cdy = expansion_difference(cy, dy);
+
+			Expansion exact_alift = expansion_sum(expansion_product(exact_adx, exact_adx), expansion_product(exact_ady, exact_ady));
+			Expansion exact_blift = expansion_sum(expansion_product(exact_bdx, exact_bdx), expansion_product(exact_bdy, exact_bdy));
+			Expansion exact_clift = expansion_sum(expansion_product(exact_cdx, exact_cdx), expansion_product(exact_cdy, exact_cdy));
+
+			Expansion bc = expansion_sum(expansion_product(exact_bdx, exact_cdy), expansion_negate(expansion_product(exact_cdx, exact_bdy)));
+			Expansion ca = expansion_sum(expansion_product(exact_cdx, exact_ady), expansion_negate(expansion_product(exact_adx, exact_cdy)));
+			Expansion ab = expansion_sum(expansion_product(exact_adx, exact_bdy), expansion_negate(expansion_product(exact_bdx, exact_ady)));
+
+			Expansion exact_det = expansion_sum(
+				expansion_sum(expansion_product(exact_alift, bc), expansion_product(exact_blift, ca)),
+				expansion_product(exact_clift, ab));
+			return expansion_estimate_sign(exact_det);
+		}
+
+		/// \brief Squared radius of the circle through a, b and c. Infinite or NaN for collinear points.
+		double circumradius2(double ax, double ay, double bx, double by, double cx, double cy)
+		{
+			double dx = bx - ax;
+			double dy = by - ay;
+			double ex = cx - ax;
+			double ey = cy - ay;
+
+			double bl = dx * dx + dy * dy;
+			double cl = ex * ex + ey * ey;
+			double d = 0.5 / (dx * ey - dy * ex);
+
+			double x = (ey * bl - dy * cl) * d;
+			double y = (dx * cl - ex * bl) * d;
+			return x * x + y * y;
+		}
+
+		void circumcenter(double ax, double ay, double bx, double by, double cx, double cy, double &out_x, double &out_y)
+		{
+			double dx = bx - ax;
+			double dy = by - ay;
+			double ex = cx - ax;
+			double ey = cy - ay;
+
+			double bl = dx * dx + dy * dy;
+			double cl = ex * ex + ey * ey;
+			double d = 0.5 / (dx * ey - dy * ex);
+
+			out_x = ax + (ey * bl - dy * cl) * d;
+			out_y = ay + (dx * cl - ex * bl) * d;
+		}
+
+		/// \brief Monotonic substitute for atan2, in the range [0,1)
+		inline double pseudo_angle(double dx, double dy)
+		{
+			double sum = std::abs(dx) + std::abs(dy);
+			if (sum == 0.0)
+				return 0.0;
+			double p = dx / sum;
+			return (dy > 0.0 ? 3.0 - p : 1.0 + p) * 0.25;
+		}
 	}
 
-	DelauneyTriangulator_Impl::~DelauneyTriangulator_Impl()
+	/////////////////////////////////////////////////////////////////////////////
+	// DelauneyTriangulator_Impl construction:
+
+	DelauneyTriangulator_Impl::DelauneyTriangulator_Impl() : hull_start(0), center_x(0.0), center_y(0.0)
 	{
 	}
 
-	void DelauneyTriangulator_Impl::triangulate()
+	DelauneyTriangulator_Impl::~DelauneyTriangulator_Impl()
 	{
-		// Order vertices:
+	}
 
-		std::vector<DelauneyTriangulator_Vertex *> vertices;
-		create_ordered_vertex_list(vertices);
+	/////////////////////////////////////////////////////////////////////////////
+	// DelauneyTriangulator_Impl operations:
 
-		// Calculate super triangle:
+	void DelauneyTriangulator_Impl::triangulate()
+	{
+		triangles.clear();
 
-		DelauneyTriangulator_Vertex super_A;
-		DelauneyTriangulator_Vertex super_B;
-		DelauneyTriangulator_Vertex super_C;
-		DelauneyTriangulator_Triangle super_triangle;
-		super_triangle.vertex_A = &super_A;
-		super_triangle.vertex_B = &super_B;
-		super_triangle.vertex_C = &super_C;
-		calculate_supertriangle(vertices, super_triangle);
+		// Order vertices and remove duplicates:
+		points.clear();
+		create_ordered_vertex_list(points);
 
 		// Perform delauney triangulation:
-
-		perform_delauney_triangulation(vertices, super_triangle, triangles);
+		if (points.size() >= 3)
+			perform_sweep();
+
+		points.clear();
+		triangle_vertices.clear();
+		halfedges.clear();
+		hull_prev.clear();
+		hull_next.clear();
+		hull_tri.clear();
+		hull_hash.clear();
+		edge_stack.clear();
 	}
 
 	struct CompareVertices
@@ -85,258 +295,358 @@ namespace clan
 		std::sort(vertices.begin(), vertices.end(), CompareVertices());
 
 		// Remove duplicates:
-		auto it = vertices.begin();
-		if (it == vertices.end()) return;
-		float last_x = (*it)->x;
-		float last_y = (*it)->y;
-		++it;
-		while (it != vertices.end())
+		auto last = std::unique(vertices.begin(), vertices.end(), [](DelauneyTriangulator_Vertex *a, DelauneyTriangulator_Vertex *b) { return a->x == b->x && a->y == b->y; });
+		vertices.erase(last, vertices.end());
+	}
+
+	bool DelauneyTriangulator_Impl::find_seed_triangle(int &i0, int &i1, int &i2)
+	{
+		int n = points.size();
+
+		float min_x = points[0]->x;
+		float max_x = points[0]->x;
+		float min_y = points[0]->y;
+		float max_y = points[0]->y;
+		for (int i = 1; i < n; i++)
+		{
+			min_x = std::min(min_x, points[i]->x);
+			max_x = std::max(max_x, points[i]->x);
+			min_y = std::min(min_y, points[i]->y);
+			max_y = std::max(max_y, points[i]->y);
+		}
+		double bounds_center_x = (min_x + (double)max_x) * 0.5;
+		double bounds_center_y = (min_y + (double)max_y) * 0.5;
+
+		// Pick the point closest to the center of the bounding box
+		double min_dist = DBL_MAX;
+		i0 = 0;
+		for (int i = 0; i < n; i++)
 		{
-			if (last_x == (*it)->x && last_y == (*it)->y)
+			double dx = points[i]->x - bounds_center_x;
+			double dy = points[i]->y - bounds_center_y;
+			double dist = dx * dx + dy * dy;
+			if (dist < min_dist)
 			{
-				it = vertices.erase(it);
+				i0 = i;
+				min_dist = dist;
 			}
-			else
+		}
+		double i0x = points[i0]->x;
+		double i0y = points[i0]->y;
+
+		// The point closest to it
+		min_dist = DBL_MAX;
+		i1 = -1;
+		for (int i = 0; i < n; i++)
+		{
+			if (i == i0)
+				continue;
+			double dx = points[i]->x - i0x;
+			double dy = points[i]->y - i0y;
+			double dist = dx * dx + dy * dy;
+			if (dist < min_dist)
 			{
-				last_x = (*it)->x;
-				last_y = (*it)->y;
-				++it;
+				i1 = i;
+				min_dist = dist;
 			}
 		}
+		double i1x = points[i1]->x;
+		double i1y = points[i1]->y;
+
+		// And the third point forming the smallest circumcircle with them
+		double min_radius = DBL_MAX;
+		i2 = -1;
+		for (int i = 0; i < n; i++)
+		{
+			if (i == i0 || i == i1)
+				continue;
+			double radius = circumradius2(i0x, i0y, i1x, i1y, points[i]->x, points[i]->y);
+			if (radius < min_radius)
+			{
+				i2 = i;
+				min_radius = radius;
+			}
+		}
+
+		// All points are collinear, so there are no triangles
+		if (i2 == -1 || orient2d(i0x, i0y, i1x, i1y, points[i2]->x, points[i2]->y) == 0.0)
+			return false;
+
+		// The triangulation is built with clockwise triangles
+		if (orient2d(i0x, i0y, i1x, i1y, points[i2]->x, points[i2]->y) > 0.0)
+			std::swap(i1, i2);
+
+		return true;
 	}
 
-	void DelauneyTriangulator_Impl::calculate_supertriangle(std::vector<DelauneyTriangulator_Vertex *> &vertices, DelauneyTriangulator_Triangle &super_triangle)
+	void DelauneyTriangulator_Impl::perform_sweep()
 	{
-		// Find min and max values:
+		int i0, i1, i2;
+		if (!find_seed_triangle(i0, i1, i2))
+			return;
 
-		float min_x = 0.0;
-		float max_x = 0.0;
-		float min_y = 0.0;
-		float max_y = 0.0;
-		bool first_point = true;
+		int n = points.size();
 
-		std::vector<DelauneyTriangulator_Vertex *>::size_type index_vertices, num_vertices;
-		num_vertices = vertices.size();
-		for (index_vertices = 0; index_vertices < num_vertices; index_vertices++)
+		std::vector<double> coords(n * 2);
+		for (int i = 0; i < n; i++)
+		{
+			coords[i * 2] = points[i]->x;
+			coords[i * 2 + 1] = points[i]->y;
+		}
+
+		circumcenter(coords[i0 * 2], coords[i0 * 2 + 1], coords[i1 * 2], coords[i1 * 2 + 1], coords[i2 * 2], coords[i2 * 2 + 1], center_x, center_y);
+
+		// Sort the points by distance from the seed triangle circumcenter
+		std::vector<double> dists(n);
+		std::vector<int> ids(n);
+		for (int i = 0; i < n; i++)
+		{
+			double dx = coords[i * 2] - center_x;
+			double dy = coords[i * 2 + 1] - center_y;
+			dists[i] = dx * dx + dy * dy;
+			ids[i] = i;
+		}
+		std::sort(ids.begin(), ids.end(), [&](int a, int b) { return dists[a] < dists[b]; });
+
+		// A planar triangulation of n points has at most 2n - 5 triangles
+		int max_triangles = std::max(2 * n - 5, 1);
+		triangle_vertices.clear();
+		halfedges.clear();
+		triangle_vertices.reserve(max_triangles * 3);
+		halfedges.reserve(max_triangles * 3);
+
+		// Set up the seed triangle as the starting hull
+		int hash_size = (int)std::ceil(std::sqrt((double)n));
+		hull_prev.assign(n, 0);
+		hull_next.assign(n, 0);
+		hull_tri.assign(n, 0);
+		hull_hash.assign(hash_size, -1);
+
+		hull_start = i0;
+		hull_next[i0] = hull_prev[i2] = i1;
+		hull_next[i1] = hull_prev[i0] = i2;
+		hull_next[i2] = hull_prev[i1] = i0;
+
+		hull_tri[i0] = 0;
+		hull_tri[i1] = 1;
+		hull_tri[i2] = 2;
+
+		hull_hash[hash_key(coords[i0 * 2], coords[i0 * 2 + 1])] = i0;
+		hull_hash[hash_key(coords[i1 * 2], coords[i1 * 2 + 1])] = i1;
+		hull_hash[hash_key(coords[i2 * 2], coords[i2 * 2 + 1])] = i2;
+
+		add_triangle(i0, i1, i2, -1, -1, -1);
+
+		for (int k = 0; k < n; k++)
 		{
-			DelauneyTriangulator_Vertex *cur_vertex = vertices[index_vertices];
+			int i = ids[k];
+			if (i == i0 || i == i1 || i == i2)
+				continue;
+
+			double x = coords[i * 2];
+			double y = coords[i * 2 + 1];
 
-			if (!first_point)
+			// Find a visible edge on the convex hull using the edge hash
+			int start = 0;
+			int key = hash_key(x, y);
+			for (int j = 0; j < hash_size; j++)
 			{
-				if (min_x > cur_vertex->x) min_x = cur_vertex->x;
-				if (max_x < cur_vertex->x) max_x = cur_vertex->x;
-				if (min_y > cur_vertex->y) min_y = cur_vertex->y;
-				if (max_y < cur_vertex->y) max_y = cur_vertex->y;
+				start = hull_hash[(key + j) % hash_size];
+				if (start != -1 && start != hull_next[start])
+					break;
 			}
-			else
+
+			start = hull_prev[start];
+			int e = start;
+			int q;
+			while (q = hull_next[e], orient2d(x, y, coords[e * 2], coords[e * 2 + 1], coords[q * 2], coords[q * 2 + 1]) <= 0.0)
 			{
-				first_point = false;
-				min_x = cur_vertex->x;
-				max_x = cur_vertex->x;
-				min_y = cur_vertex->y;
-				max_y = cur_vertex->y;
+				e = q;
+				if (e == start)
+				{
+					e = -1;
+					break;
+				}
 			}
-		}
 
-		// Setup super triangle based on min/max values:
+			// The point sees no hull edge. Only possible for degenerate input that slipped past the duplicate removal.
+			if (e == -1)
+				continue;
 
-		super_triangle.vertex_A->x = min_x - 1;
-		super_triangle.vertex_A->y = min_y - 1;
-		super_triangle.vertex_A->data = nullptr;
+			// Add the first triangle from the point
+			int t = add_triangle(e, i, hull_next[e], -1, -1, hull_tri[e]);
+
+			// Recursively flip triangles from the point until they satisfy the delauney condition
+			hull_tri[i] = legalize(t + 2);
+			hull_tri[e] = t;
+
+			// Walk forward through the hull, adding more triangles and flipping recursively
+			int next = hull_next[e];
+			while (q = hull_next[next], orient2d(x, y, coords[next * 2], coords[next * 2 + 1], coords[q * 2], coords[q * 2 + 1]) > 0.0)
+			{
+				t = add_triangle(next, i, q, hull_tri[i], -1, hull_tri[next]);
+				hull_tri[i] = legalize(t + 2);
+				hull_next[next] = next; // mark as removed
+				next = q;
+			}
+
+			// Walk backward from the other side, adding more triangles and flipping
+			if (e == start)
+			{
+				while (q = hull_prev[e], orient2d(x, y, coords[q * 2], coords[q * 2 + 1], coords[e * 2], coords[e * 2 + 1]) > 0.0)
+				{
+					t = add_triangle(q, i, e, -1, hull_tri[e], hull_tri[q]);
+					legalize(t + 2);
+					hull_tri[q] = t;
+					hull_next[e] = e; // mark as removed
+					e = q;
+				}
+			}
+
+			// Update the hull indices
+			hull_start = hull_prev[i] = e;
+			hull_next[e] = hull_prev[next] = i;
+			hull_next[i] = next;
+
+			// Save the two new edges in the hash table
+			hull_hash[hash_key(x, y)] = i;
+			hull_hash[hash_key(coords[e * 2], coords[e * 2 + 1])] = e;
+		}
 
-		super_triangle.vertex_B->x = max_x + (max_x - min_x) + 1;
-		super_triangle.vertex_B->y = min_y - 1;
-		super_triangle.vertex_B->data = nullptr;
+		std::vector<int>::size_type num_triangles = triangle_vertices.size() / 3;
+		triangles.reserve(num_triangles);
+		for (std::vector<int>::size_type index_triangles = 0; index_triangles < num_triangles; index_triangles++)
+		{
+			DelauneyTriangulator_Triangle triangle;
+			triangle.vertex_A = points[triangle_vertices[index_triangles * 3]];
+			triangle.vertex_B = points[triangle_vertices[index_triangles * 3 + 1]];
+			triangle.vertex_C = points[triangle_vertices[index_triangles * 3 + 2]];
+			triangles.push_back(triangle);
+		}
+	}
 
-		super_triangle.vertex_C->x = min_x - 1;
-		super_triangle.vertex_C->y = max_y + (max_y - min_y) + 1;
-		super_triangle.vertex_C->data = nullptr;
+	int DelauneyTriangulator_Impl::hash_key(double x, double y) const
+	{
+		int hash_size = hull_hash.size();
+		return (int)std::floor(pseudo_angle(x - center_x, y - center_y) * hash_size) % hash_size;
 	}
 
-	void DelauneyTriangulator_Impl::perform_delauney_triangulation(
-		const std::vector<DelauneyTriangulator_Vertex *> &vertices,
-		const DelauneyTriangulator_Triangle &super_triangle,
-		std::vector<DelauneyTriangulator_Triangle> &triangles)
+	int DelauneyTriangulator_Impl::add_triangle(int i0, int i1, int i2, int a, int b, int c)
 	{
-		/*
-			delauney triangulation algorithm:
-
-			subroutine triangulate
-			input : vertex list
-			output : triangle list
-			initialize the triangle list
-			determine the supertriangle
-			add supertriangle vertices to the end of the vertex list
-			add the supertriangle to the triangle list
-			for each sample point in the vertex list
-			initialize the edge buffer
-			for each triangle currently in the triangle list
-			calculate the triangle circumcircle center and radius
-			if the point lies in the triangle circumcircle then
-			add the three triangle edges to the edge buffer
-			remove the triangle from the triangle list
-			endif
-			endfor
-			delete all doubly specified edges from the edge buffer
-			this leaves the edges of the enclosing polygon only
-			add to the triangle list all triangles formed between the point
-			and the edges of the enclosing polygon
-			endfor
-			remove any triangles from the triangle list that use the supertriangle vertices
-			remove the supertriangle vertices from the vertex list
-			end
-
-			See http://astronomy.swin.edu.au/~pbourke/terrain/triangulate/ for more info
-			*/
-
-		// Reset triangle list.
-		triangles.clear();
+		int t = triangle_vertices.size();
 
-		// add supertriangle vertices to the end of the vertex list
-		triangles.push_back(super_triangle);
+		triangle_vertices.push_back(i0);
+		triangle_vertices.push_back(i1);
+		triangle_vertices.push_back(i2);
+		halfedges.push_back(-1);
+		halfedges.push_back(-1);
+		halfedges.push_back(-1);
 
-		// for each sample point in the vertex list:
-		std::vector<DelauneyTriangulator_Vertex *>::size_type index_vertices, num_vertices;
-		num_vertices = vertices.size();
-		for (index_vertices = 0; index_vertices < num_vertices; index_vertices++)
-		{
-			DelauneyTriangulator_Vertex *insertion_point = vertices[index_vertices];
+		link(t, a);
+		link(t + 1, b);
+		link(t + 2, c);
 
-			// Init edge buffer
-			typedef std::pair<DelauneyTriangulator_Vertex *, DelauneyTriangulator_Vertex *> DelauneyTriangulator_Triangle_Edge;
-			std::vector<DelauneyTriangulator_Triangle_Edge> edges;
+		return t;
+	}
 
-			// For each triangle currently in the triangle list
-			std::vector<DelauneyTriangulator_Triangle>::size_type index_triangles, num_triangles;
-			num_triangles = triangles.size();
-			for (index_triangles = 0; index_triangles < num_triangles; index_triangles++)
+	void DelauneyTriangulator_Impl::link(int a, int b)
+	{
+		halfedges[a] = b;
+		if (b != -1)
+			halfedges[b] = a;
+	}
+
+	int DelauneyTriangulator_Impl::legalize(int a)
+	{
+		/*
+			If the pair of triangles doesn't satisfy the delauney condition
+			(p1 is inside the circumcircle of [p0, pl, pr]), flip them,
+			then do the same check/flip for the new pair of triangles:
+
+			           pl                    pl
+			          /||\                  /  \
+			       al/ || \bl            al/    \a
+			        /  ||  \              /      \
+			       /  a||b  \    flip    /___ar___\
+			     p0\   ||   /p1   =>   p0\---bl---/p1
+			        \  ||  /              \      /
+			       ar\ || /br             b\    /br
+			          \||/                  \  /
+			           pr                    pr
+		*/
+
+		int ar = 0;
+		edge_stack.clear();
+
+		while (true)
+		{
+			int b = halfedges[a];
+			int a0 = a - a % 3;
+			ar = a0 + (a + 2) % 3;
+
+			if (b == -1) // convex hull edge
 			{
-				DelauneyTriangulator_Triangle &cur_triangle = triangles[index_triangles];
-
-				// todo: cache circumcenter in triangle?
-				DelauneyTriangulator_Vertex circumcenter = find_circumcenter(cur_triangle);
-				float radius_x = cur_triangle.vertex_A->x - circumcenter.x;
-				float radius_y = cur_triangle.vertex_A->y - circumcenter.y;
-				float radius2 = radius_x*radius_x + radius_y*radius_y;
-
-				// Check if the point lies in the triangle circumcircle:
-				float dist_x = insertion_point->x - circumcenter.x;
-				float dist_y = insertion_point->y - circumcenter.y;
-				float dist2 = dist_x*dist_x + dist_y*dist_y;
-				if (dist2 < radius2)
-				{
-					// Add triangle edges to edge buffer:
-					edges.push_back(DelauneyTriangulator_Triangle_Edge(cur_triangle.vertex_A, cur_triangle.vertex_B));
-					edges.push_back(DelauneyTriangulator_Triangle_Edge(cur_triangle.vertex_B, cur_triangle.vertex_C));
-					edges.push_back(DelauneyTriangulator_Triangle_Edge(cur_triangle.vertex_C, cur_triangle.vertex_A));
-
-					// Remove triange from triangle list:
-					triangles.erase(triangles.begin() + index_triangles);
-					index_triangles--;
-					num_triangles--;
-				}
+				if (edge_stack.empty())
+					break;
+				a = edge_stack.back();
+				edge_stack.pop_back();
+				continue;
 			}
 
-			// Delete all doubly specified edges from the edge buffer
-			// this leaves the edges of the enclosing polygon only
-			int index_edges1, index_edges2, num_edges; // intentionally integer to allow index to be negative when deleting index.
-			num_edges = (int)edges.size();
-			for (index_edges1 = 0; index_edges1 < num_edges; index_edges1++)
+			int b0 = b - b % 3;
+			int al = a0 + (a + 1) % 3;
+			int bl = b0 + (b + 2) % 3;
+
+			int p0 = triangle_vertices[ar];
+			int pr = triangle_vertices[a];
+			int pl = triangle_vertices[al];
+			int p1 = triangle_vertices[bl];
+
+			// The triangles are clockwise, so p1 is inside the circle when the determinant is negative
+			bool illegal = incircle(
+				points[p0]->x, points[p0]->y,
+				points[pr]->x, points[pr]->y,
+				points[pl]->x, points[pl]->y,
+				points[p1]->x, points[p1]->y) < 0.0;
+
+			if (illegal)
 			{
-				DelauneyTriangulator_Triangle_Edge &edge1 = edges[index_edges1];
-				for (index_edges2 = 0/*index_edges1+1*/; index_edges2 < num_edges; index_edges2++)
+				triangle_vertices[a] = p1;
+				triangle_vertices[b] = p0;
+
+				int hbl = halfedges[bl];
+
+				// Edge swapped on the other side of the hull (rare). Fix the half-edge reference.
+				if (hbl == -1)
 				{
-					if (index_edges1 == index_edges2) continue;
-					DelauneyTriangulator_Triangle_Edge &edge2 = edges[index_edges2];
-					if ((edge1.first == edge2.first && edge1.second == edge2.second) ||
-						(edge1.second == edge2.first && edge1.first == edge2.second))
+					int e = hull_start;
+					do
 					{
-						// Same edges, delete both:
-						if (index_edges1 < index_edges2)
-						{
-							edges.erase(edges.begin() + index_edges2);
-							edges.erase(edges.begin() + index_edges1);
-						}
-						else
+						if (hull_tri[e] == bl)
 						{
-							edges.erase(edges.begin() + index_edges1);
-							edges.erase(edges.begin() + index_edges2);
+							hull_tri[e] = a;
+							break;
 						}
-						num_edges -= 2;
-						index_edges1--;
-						break;
-					}
+						e = hull_prev[e];
+					} while (e != hull_start);
 				}
-			}
 
-			// add to the triangle list all triangles formed between the point 
-			// and the edges of the enclosing polygon
-			for (index_edges1 = 0; index_edges1 < num_edges; index_edges1++)
-			{
-				DelauneyTriangulator_Triangle triangle;
-				triangle.vertex_A = edges[index_edges1].first;
-				triangle.vertex_B = edges[index_edges1].second;
-				triangle.vertex_C = insertion_point;
-				triangles.push_back(triangle);
-			}
-		}
+				link(a, hbl);
+				link(b, halfedges[ar]);
+				link(ar, bl);
 
-		// remove any triangles from the triangle list that use the supertriangle vertices
-		std::vector<DelauneyTriangulator_Triangle>::size_type index_triangles, num_triangles;
-		num_triangles = triangles.size();
-		for (index_triangles = 0; index_triangles < num_triangles; index_triangles++)
-		{
-			DelauneyTriangulator_Triangle &cur_triangle = triangles[index_triangles];
-
-			if (
-				cur_triangle.vertex_A == super_triangle.vertex_A ||
-				cur_triangle.vertex_A == super_triangle.vertex_B ||
-				cur_triangle.vertex_A == super_triangle.vertex_C ||
-				cur_triangle.vertex_B == super_triangle.vertex_A ||
-				cur_triangle.vertex_B == super_triangle.vertex_B ||
-				cur_triangle.vertex_B == super_triangle.vertex_C ||
-				cur_triangle.vertex_C == super_triangle.vertex_A ||
-				cur_triangle.vertex_C == super_triangle.vertex_B ||
-				cur_triangle.vertex_C == super_triangle.vertex_C)
+				int br = b0 + (b + 1) % 3;
+				edge_stack.push_back(br);
+			}
+			else
 			{
-				// triangle share one or more points with supertriangle, remove it:
-				triangles.erase(triangles.begin() + index_triangles);
-				index_triangles--;
-				num_triangles--;
+				if (edge_stack.empty())
+					break;
+				a = edge_stack.back();
+				edge_stack.pop_back();
 			}
 		}
-	}
 
-	DelauneyTriangulator_Vertex DelauneyTriangulator_Impl::find_circumcenter(
-		const DelauneyTriangulator_Triangle &triangle)
-	{
-		// Subject 1.04: How do I generate a circle through three points?
-		// http://www.faqs.org/faqs/graphics/algorithms-faq/
-
-		float a_0 = triangle.vertex_A->x;
-		float a_1 = triangle.vertex_A->y;
-		float b_0 = triangle.vertex_B->x;
-		float b_1 = triangle.vertex_B->y;
-		float c_0 = triangle.vertex_C->x;
-		float c_1 = triangle.vertex_C->y;
-
-		float A = b_0 - a_0;
-		float B = b_1 - a_1;
-		float C = c_0 - a_0;
-		float D = c_1 - a_1;
-
-		float E = A*(a_0 + b_0) + B*(a_1 + b_1);
-		float F = C*(a_0 + c_0) + D*(a_1 + c_1);
-
-		float G = 2.0f*(A*(c_1 - b_1) - B*(c_0 - b_0));
-
-		float p_0 = (D*E - B*F) / G;
-		float p_1 = (A*F - C*E) / G;
-
-		DelauneyTriangulator_Vertex circumcenter;
-		circumcenter.data = nullptr;
-		circumcenter.x = p_0;
-		circumcenter.y = p_1;
-		return circumcenter;
+		return ar;
 	}
 }
@@ -32,6 +32,11 @@
 
 namespace clan
 {
+	/// \brief Sweep-hull delauney triangulation.
+	///
+	/// Vertices are inserted in order of distance from a seed triangle. Each new vertex is connected to the visible part of
+	/// the convex hull and edges are flipped until the delauney condition holds. The hull is found through a hash on the angle
+	/// around the seed, which makes the whole triangulation run in O(n log n) for typical input.
 	class DelauneyTriangulator_Impl
 	{
 	public:
@@ -46,16 +51,33 @@ namespace clan
 		void create_ordered_vertex_list(
 			std::vector<DelauneyTriangulator_Vertex *> &vertices);
 
-		void calculate_supertriangle(
-			std::vector<DelauneyTriangulator_Vertex *> &vertices,
-			DelauneyTriangulator_Triangle &super_triangle);
+	private:
+		bool find_seed_triangle(int &i0, int &i1, int &i2);
+		void perform_sweep();
 
-		void perform_delauney_triangulation(
-			const std::vector<DelauneyTriangulator_Vertex *> &vertices,
-			const DelauneyTriangulator_Triangle &super_triangle,
-			std::vector<DelauneyTriangulator_Triangle> &triangles);
+		int add_triangle(int i0, int i1, int i2, int a, int b, int c);
+		void link(int a, int b);
+		int legalize(int a);
+		int hash_key(double x, double y) const;
 
-		DelauneyTriangulator_Vertex find_circumcenter(
-			const DelauneyTriangulator_Triangle &triangle);
+		/// \brief Vertices being triangulated (sorted, without duplicates)
+		std::vector<DelauneyTriangulator_Vertex *> points;
+
+		/// \brief Vertex indices of the triangles, three per triangle
+		std::vector<int> triangle_vertices;
+
+		/// \brief Index of the opposite half-edge for each half-edge, or -1 on the hull
+		std::vector<int> halfedges;
+
+		std::vector<int> hull_prev;
+		std::vector<int> hull_next;
+		std::vector<int> hull_tri;
+		std::vector<int> hull_hash;
+		int hull_start;
+
+		std::vector<int> edge_stack;
+
+		double center_x;
+		double center_y;
 	};
 }
@@ -31,29 +31,24 @@
 #include "API/Core/Math/ear_clip_result.h"
 #include "API/Core/Math/point.h"
 #include "API/Core/Math/triangle_math.h"
-#include "API/Core/Math/line_math.h"
 #include "ear_clip_triangulator_impl.h"
+#include <algorithm>
 #include <cfloat>
 
 namespace clan
 {
+	// Polygons smaller than this are cheaper to test with a plain walk over the remaining vertices
+	static const std::vector<LinkedVertice *>::size_type z_order_min_vertices = 64;
+
 	EarClipTriangulator_Impl::EarClipTriangulator_Impl()
-		: orientation(cl_clockwise), vertex_count(0)
+		: orientation(cl_clockwise), ear_list_front(0), use_z_order(false), z_min_x(0), z_min_y(0), z_scale_x(0), z_scale_y(0), vertex_count(0)
 	{
 		target_array = &vertices;
 	}
 
 	EarClipTriangulator_Impl::~EarClipTriangulator_Impl()
 	{
-		for (auto & elem : vertices)
-		{
-			delete elem;
-		}
-
-		for (auto & elem : hole)
-		{
-			delete elem;
-		}
+		clear();
 	}
 
 	std::vector<Pointf> EarClipTriangulator_Impl::get_vertices()
@@ -96,14 +91,32 @@ namespace clan
 			delete elem;
 		}
 
+		for (auto & elem : hole)
+		{
+			delete elem;
+		}
+
+		for (auto & contour : pending_holes)
+		{
+			for (auto & elem : contour)
+			{
+				delete elem;
+			}
+		}
+
 		vertices.clear();
 		hole.clear();
+		pending_holes.clear();
 		ear_list.clear();
+		ear_list_front = 0;
+		target_array = &vertices;
 		vertex_count = 0;
 	}
 
 	EarClipResult EarClipTriangulator_Impl::triangulate()
 	{
+		merge_holes();
+
 		create_lists(true);
 
 		int num_triangles = vertices.size() - 2;
@@ -113,12 +126,10 @@ namespace clan
 
 		while (tri_count < num_triangles)
 		{
-			if (ear_list.empty()) // something went wrong, but lets not crash anyway. 
+			LinkedVertice *v = next_ear();
+			if (!v) // something went wrong, but lets not crash anyway. 
 				break;
 
-			LinkedVertice *v = ear_list.back();
-			ear_list.pop_back();
-
 			EarClipTriangulator_Triangle tri;
 
 			tri.x1 = v->x;
@@ -135,66 +146,31 @@ namespace clan
 			v->next->previous = v->previous;
 			v->previous->next = v->next;
 
+			if (use_z_order)
+				remove_from_z_order_index(v);
+
 			if (is_ear(*v->next))
 			{
 				if (v->next->is_ear == false) // not marked as an ear yet. Mark it, and add to the list.
-				{
-					v->next->is_ear = true;
-					ear_list.push_back(v->next);
-				}
+					add_ear(v->next);
 			}
 			else
 			{
 				if (v->next->is_ear == true) // Not an ear any more. Delete from ear list.
-				{
-					v->next->is_ear = false;
-
-					std::vector<LinkedVertice*>::iterator it;
-					for (it = ear_list.begin(); it != ear_list.end(); ++it)
-					{
-						if ((*it) == v->next)
-						{
-							ear_list.erase(it);
-							break;
-						}
-					}
-				}
+					remove_ear(v->next);
 			}
 
 			if (is_ear(*v->previous))
 			{
 				if (v->previous->is_ear == false) // not marked as an ear yet. Mark it, and add to the list.
-				{
-					v->previous->is_ear = true;
-					ear_list.push_back(v->previous);
-				}
+					add_ear(v->previous);
 			}
 			else
 			{
 				if (v->previous->is_ear == true) // Not an ear any more. Delete from ear list.
-				{
-					v->previous->is_ear = false;
-
-					std::vector<LinkedVertice*>::iterator it;
-					for (it = ear_list.begin(); it != ear_list.end(); ++it)
-					{
-						if ((*it) == v->previous)
-						{
-							ear_list.erase(it);
-							break;
-						}
-					}
-				}
+					remove_ear(v->previous);
 			}
 
-			/*		cl_write_console_line("Ear list:");
-					for( std::vector<LinkedVertice*>::iterator it = ear_list.begin(); it != ear_list.end(); ++it )
-					{
-					cl_write_console_line("    (%1,%2)", (*it)->x, (*it)->y );
-					}
-					cl_write_console_line("");
-					*/
-
 			tri_count++;
 
 		}
@@ -204,6 +180,45 @@ namespace clan
 		return result;
 	}
 
+	void EarClipTriangulator_Impl::add_ear(LinkedVertice *v)
+	{
+		v->is_ear = true;
+		EarListEntry entry = { v, v->ear_stamp };
+		ear_list.push_back(entry);
+	}
+
+	void EarClipTriangulator_Impl::remove_ear(LinkedVertice *v)
+	{
+		v->is_ear = false;
+		v->ear_stamp++;
+	}
+
+	LinkedVertice *EarClipTriangulator_Impl::next_ear()
+	{
+		// Vertices that stopped being ears are left in the list and skipped here
+		while (ear_list_front < ear_list.size())
+		{
+			EarListEntry entry;
+			if (use_z_order)
+			{
+				// Clip in the order the ears were found. Taking the newest ear first builds a fan
+				// of ever larger triangles, which defeats the z-order index.
+				entry = ear_list[ear_list_front++];
+			}
+			else
+			{
+				entry = ear_list.back();
+				ear_list.pop_back();
+			}
+
+			if (entry.vertex->is_ear && entry.vertex->ear_stamp == entry.stamp)
+			{
+				remove_ear(entry.vertex);
+				return entry.vertex;
+			}
+		}
+		return nullptr;
+	}
 
 	void EarClipTriangulator_Impl::begin_hole()
 	{
@@ -212,66 +227,89 @@ namespace clan
 
 	void EarClipTriangulator_Impl::end_hole()
 	{
-		create_lists(false);
-
 		target_array = &vertices;
 
-		// To be able to triangulate holes the inner and outer vertice arrays are connected
-		// so that there isn't actually any hole, just a single polygon with a small gap
-		// eliminating the hole.
-		//
-		// 1. find point on inner contour closest to a vertice on the outer contour.
-		//
-		// 2. Create bridge start and end points by offsetting the new vertices a bit along the edges to the next and prev vertices.
-		// 
+		// Holes are merged into the outer contour by triangulate(), once all of them are known
+		if (!hole.empty())
+			pending_holes.push_back(hole);
+		hole.clear();
+	}
 
-		LinkedVertice *outer_vertice = nullptr;
-		LinkedVertice *segment_start;
-		LinkedVertice *segment_end;
-		Pointf inner_point;
-		float inner_point_rel;
-		float distance = FLT_MAX;
+	void EarClipTriangulator_Impl::merge_holes()
+	{
+		if (pending_holes.empty() || vertices.size() < 3)
+			return;
 
-		for (auto & elem : vertices)
+		// Bridge the holes from left to right, so a bridge never has to cross a hole that is merged later.
+		std::vector<std::pair<float, std::vector<LinkedVertice *> *> > order;
+		for (auto & contour : pending_holes)
 		{
-			Pointf tmp_outer_point = Pointf(elem->x, elem->y);
+			float left = FLT_MAX;
+			for (auto & elem : contour)
+				left = std::min(left, elem->x);
+			order.push_back(std::make_pair(left, &contour));
+		}
+		std::stable_sort(order.begin(), order.end(), [](const std::pair<float, std::vector<LinkedVertice *> *> &a, const std::pair<float, std::vector<LinkedVertice *> *> &b) { return a.first < b.first; });
 
-			for (auto & _hole_cnt : hole)
+		for (auto & elem : order)
+		{
+			if (elem.second->size() < 3)
+			{
+				for (auto & vertex : *elem.second)
+					delete vertex;
+			}
+			else
 			{
+				merge_hole(*elem.second);
+			}
+		}
 
-				Pointf tmp_line_start(_hole_cnt->x, _hole_cnt->y);
-				Pointf tmp_line_end(_hole_cnt->next->x, _hole_cnt->next->y);
+		pending_holes.clear();
+	}
 
-				Pointf tmp_inner_point = LineMath::closest_point(tmp_outer_point, tmp_line_start, tmp_line_end);
+	void EarClipTriangulator_Impl::merge_hole(std::vector<LinkedVertice *> &hole_contour)
+	{
+		link_contour(vertices);
+		link_contour(hole_contour);
 
-				float tmp_distance = tmp_inner_point.distance(tmp_outer_point);
+		// To be able to triangulate holes the inner and outer vertice arrays are connected
+		// so that there isn't actually any hole, just a single polygon with a small gap
+		// eliminating the hole.
+		//
+		// 1. Cast a ray to the left from the leftmost hole vertex and pick a visible outer vertex near the hit.
+		//
+		// 2. Replace both ends of the bridge by two vertices offset a bit to each side of it.
+		//    Offsetting sideways (instead of along the old edges) keeps the two gap edges from crossing at sharp vertices.
 
-				if (tmp_distance < distance)
-				{
-					inner_point_rel = LineMath::closest_point_relative(tmp_outer_point, tmp_line_start, tmp_line_end);
-					distance = tmp_distance;
-					outer_vertice = elem;
-					inner_point = tmp_inner_point;
-					segment_start = _hole_cnt;
-					segment_end = _hole_cnt->next;
-				}
-			}
+		LinkedVertice *inner_vertice = hole_contour.front();
+		for (auto & elem : hole_contour)
+		{
+			if (elem->x < inner_vertice->x || (elem->x == inner_vertice->x && elem->y < inner_vertice->y))
+				inner_vertice = elem;
 		}
 
-		auto outer_bridge_start = new LinkedVertice();
-		auto outer_bridge_end = new LinkedVertice();
-		auto inner_bridge_start = new LinkedVertice();
-		auto inner_bridge_end = new LinkedVertice();
+		LinkedVertice *outer_vertice = find_hole_bridge(inner_vertice);
 
-		//  offset new points along old edges
-		Pointf outer_point(outer_vertice->x, outer_vertice->y);
+		float dir_x = inner_vertice->x - outer_vertice->x;
+		float dir_y = inner_vertice->y - outer_vertice->y;
+		float len = std::sqrt(dir_x*dir_x + dir_y*dir_y);
+		if (len == 0.0f)
+			throw Exception("Error: EarClipTriangulator: a hole touches the outer contour");
+		dir_x /= len;
+		dir_y /= len;
 
-		set_bridge_vertice_offset(outer_bridge_start, outer_point, 0.0, outer_vertice, outer_vertice->previous, 1);
-		set_bridge_vertice_offset(outer_bridge_end, outer_point, 0.0, outer_vertice, outer_vertice->next, 1);
-		set_bridge_vertice_offset(inner_bridge_start, inner_point, inner_point_rel, segment_start, segment_end, 1);
-		set_bridge_vertice_offset(inner_bridge_end, inner_point, inner_point_rel, segment_start, segment_end, -1);
+		// The side of the bridge the polygon continues on after the outer vertex
+		float side = (orientation == cl_clockwise) ? 1.0f : -1.0f;
+		float side_x = -dir_y * side;
+		float side_y = dir_x * side;
 
-		// update next pointers to ignore old vertices
+		// Changed from 0.01f to 0.001f (13 Jan 2009) to stop pixel sized gaps in a font [rombust]
+		const float offset = 0.001f;
+
+		auto outer_bridge_start = new LinkedVertice(outer_vertice->x + offset * (side_x + dir_x), outer_vertice->y + offset * (side_y + dir_y));
+		auto outer_bridge_end = new LinkedVertice(outer_vertice->x + offset * (dir_x - side_x), outer_vertice->y + offset * (dir_y - side_y));
+		auto inner_bridge_start = new LinkedVertice(inner_vertice->x + offset * (side_x - dir_x), inner_vertice->y + offset * (side_y - dir_y));
+		auto inner_bridge_end = new LinkedVertice(inner_vertice->x - offset * (side_x + dir_x), inner_vertice->y - offset * (side_y + dir_y));
 
 		// connections between inner and outer contours
 		outer_bridge_start->next = inner_bridge_start;
@@ -282,26 +320,11 @@ namespace clan
 		outer_vertice->previous->next = outer_bridge_start;
 
 		// connections between new and old vertices: inner contour
-		inner_bridge_start->next = segment_end;
-		segment_start->next = inner_bridge_end;
+		inner_bridge_start->next = inner_vertice->next;
+		inner_vertice->previous->next = inner_bridge_end;
 
 		delete outer_vertice;
-		outer_vertice = nullptr;
-
-		if (inner_point_rel == 0.0) // if split point is at line end, remove inner vertex
-		{
-			segment_start->previous->next = inner_bridge_end;
-			delete segment_start;
-			segment_start = nullptr;
-		}
-		if (inner_point_rel == 1.0) // if split point is at line end, remove inner vertex
-		{
-			inner_bridge_start->next = segment_end->next;
-			delete segment_end;
-			segment_end = nullptr;
-		}
-
-		hole.clear();
+		delete inner_vertice;
 
 		// rebuild the vector...
 		vertices.clear();
@@ -312,15 +335,88 @@ namespace clan
 			vertices.push_back(test);
 			test = test->next;
 		} while (test != inner_bridge_start);
+	}
+
+	LinkedVertice *EarClipTriangulator_Impl::find_hole_bridge(LinkedVertice *hole_vertex)
+	{
+		float hx = hole_vertex->x;
+		float hy = hole_vertex->y;
+
+		// Find the closest outer edge hit by a ray cast to the left. Its leftmost end point is the bridge candidate.
+		LinkedVertice *bridge = nullptr;
+		float qx = -FLT_MAX;
+		for (auto & p : vertices)
+		{
+			LinkedVertice *n = p->next;
+			if (n->y == p->y || hy < std::min(p->y, n->y) || hy > std::max(p->y, n->y))
+				continue;
+
+			float x = p->x + (hy - p->y) * (n->x - p->x) / (n->y - p->y);
+			if (x <= hx && x > qx)
+			{
+				qx = x;
+				bridge = p->x < n->x ? p : n;
+			}
+		}
+
+		if (!bridge)
+		{
+			// Hole is not inside the outer contour. Fall back to the closest vertex.
+			float distance = FLT_MAX;
+			for (auto & p : vertices)
+			{
+				float tmp_distance = (p->x - hx) * (p->x - hx) + (p->y - hy) * (p->y - hy);
+				if (tmp_distance < distance)
+				{
+					distance = tmp_distance;
+					bridge = p;
+				}
+			}
+			return bridge;
+		}
+
+		if (qx == hx)
+			return bridge;
+
+		// Other vertices inside the triangle spanned by the hole vertex, the hit point and the candidate may block the view.
+		// If so, pick the one with the smallest angle to the ray.
+		float mx = bridge->x;
+		float my = bridge->y;
+		if (my == hy)
+			return bridge;
+
+		Trianglef triangle(Pointf(hx, hy), Pointf(qx, hy), Pointf(mx, my));
+		float tan_min = std::abs(hy - my) / (hx - mx);
+
+		for (auto & p : vertices)
+		{
+			if (p == bridge || p->x < mx || p->x >= hx)
+				continue;
+
+			if (!triangle.point_inside(Pointf(p->x, p->y)))
+				continue;
+
+			float tan = std::abs(hy - p->y) / (hx - p->x);
+			if ((tan < tan_min || (tan == tan_min && p->x > bridge->x)) && is_locally_inside(*p, *hole_vertex))
+			{
+				bridge = p;
+				tan_min = tan;
+			}
+		}
+
+		return bridge;
+	}
 
-		// print the bridge start and end points:
-		/*	cl_write_console_line("outer_point: %1 %2", outer_point.x, outer_point.y );
-			cl_write_console_line("inner_point: %1 %2", inner_point.x, inner_point.y );
-			cl_write_console_line("inner_bridge_end: %1 %2", inner_bridge_end->x, inner_bridge_end->y );
-			cl_write_console_line("outer_bridge_end: %1 %2", outer_bridge_end->x, outer_bridge_end->y );
-			cl_write_console_line("inner_bridge_start: %1 %2", inner_bridge_start->x, inner_bridge_start->y );
-			cl_write_console_line("outer_bridge_start: %1 %2", outer_bridge_start->x, outer_bridge_start->y );
-			*/
+	bool EarClipTriangulator_Impl::is_locally_inside(const LinkedVertice &a, const LinkedVertice &b)
+	{
+		// Is b within the interior angle of the polygon at a?
+		float sign = (orientation == cl_clockwise) ? 1.0f : -1.0f;
+		float left_of_previous = sign * ((a.x - a.previous->x) * (b.y - a.previous->y) - (a.y - a.previous->y) * (b.x - a.previous->x));
+		float left_of_next = sign * ((a.next->x - a.x) * (b.y - a.y) - (a.next->y - a.y) * (b.x - a.x));
+
+		if (is_reflex(a))
+			return left_of_previous >= 0.0f || left_of_next >= 0.0f;
+		return left_of_previous >= 0.0f && left_of_next >= 0.0f;
 	}
 
 	PolygonOrientation EarClipTriangulator_Impl::calculate_polygon_orientation()
@@ -343,64 +439,135 @@ namespace clan
 		return cl_clockwise;
 	}
 
-	void EarClipTriangulator_Impl::create_lists(bool create_ear_list)
+	void EarClipTriangulator_Impl::link_contour(std::vector<LinkedVertice *> &contour)
 	{
-		int vert_size = vertices.size();
+		int size = contour.size();
 
-		for (int i = 0; i < vert_size; ++i)
+		for (int i = 0; i < size; ++i)
 		{
-			LinkedVertice *v = vertices[i];
+			LinkedVertice *v = contour[i];
 
 			if (i == 0)
-				v->previous = vertices.back();
+				v->previous = contour.back();
 			else
-				v->previous = vertices[i - 1];
+				v->previous = contour[i - 1];
 
-			if (i == (vert_size - 1))
-				v->next = vertices.front();
+			if (i == (size - 1))
+				v->next = contour.front();
 			else
-				v->next = vertices[i + 1];
+				v->next = contour[i + 1];
 		}
+	}
 
-		unsigned int hole_size = hole.size();
-
-		for (unsigned int j = 0; j < hole.size(); ++j)
-		{
-			if (j == 0)
-				hole[j]->previous = hole.back();
-			else
-				hole[j]->previous = hole[j - 1];
-
-			if (j == (hole_size - 1))
-				hole[j]->next = hole.front();
-			else
-				hole[j]->next = hole[j + 1];
-		}
+	void EarClipTriangulator_Impl::create_lists(bool create_ear_list)
+	{
+		link_contour(vertices);
+		link_contour(hole);
 
 		if (create_ear_list)
 		{
-			//		cl_write_console_line("Ear list:");
+			ear_list.clear();
+			ear_list_front = 0;
+
+			use_z_order = vertices.size() >= z_order_min_vertices;
+			if (use_z_order)
+				create_z_order_index();
 
 			for (auto & elem : vertices)
 			{
+				elem->is_ear = false;
 				if (is_ear(*(elem)))
-				{
-					ear_list.push_back((elem));
-					(elem)->is_ear = true;
+					add_ear(elem);
+			}
+		}
+	}
 
-					//				cl_write_console_line(string_format("    (%1,%2)", (*it)->x, (*it)->y ) );
-				}
+	void EarClipTriangulator_Impl::create_z_order_index()
+	{
+		float min_x = FLT_MAX, min_y = FLT_MAX;
+		float max_x = -FLT_MAX, max_y = -FLT_MAX;
+		for (auto & elem : vertices)
+		{
+			min_x = std::min(min_x, elem->x);
+			min_y = std::min(min_y, elem->y);
+			max_x = std::max(max_x, elem->x);
+			max_y = std::max(max_y, elem->y);
+		}
 
-			}
+		z_min_x = min_x;
+		z_min_y = min_y;
+		z_scale_x = (max_x > min_x) ? 65535.0f / (max_x - min_x) : 0.0f;
+		z_scale_y = (max_y > min_y) ? 65535.0f / (max_y - min_y) : 0.0f;
+
+		std::vector<LinkedVertice *> sorted = vertices;
+		for (auto & elem : sorted)
+			elem->z = z_order(elem->x, elem->y);
+		std::sort(sorted.begin(), sorted.end(), [](const LinkedVertice *a, const LinkedVertice *b) { return a->z < b->z; });
+
+		for (std::vector<LinkedVertice *>::size_type i = 0; i < sorted.size(); i++)
+		{
+			sorted[i]->previous_z = (i > 0) ? sorted[i - 1] : nullptr;
+			sorted[i]->next_z = (i + 1 < sorted.size()) ? sorted[i + 1] : nullptr;
 		}
 	}
 
+	void EarClipTriangulator_Impl::remove_from_z_order_index(LinkedVertice *v)
+	{
+		if (v->previous_z)
+			v->previous_z->next_z = v->next_z;
+		if (v->next_z)
+			v->next_z->previous_z = v->previous_z;
+		v->previous_z = nullptr;
+		v->next_z = nullptr;
+	}
+
+	unsigned int EarClipTriangulator_Impl::z_order(float x, float y) const
+	{
+		// Quantize to 16 bits per axis and interleave them into a Morton code.
+		// The quantization is monotonic, so a bounding box maps to a contiguous z range.
+		unsigned int qx = (unsigned int)std::min((x - z_min_x) * z_scale_x, 65535.0f);
+		unsigned int qy = (unsigned int)std::min((y - z_min_y) * z_scale_y, 65535.0f);
+
+		qx = (qx | (qx << 8)) & 0x00FF00FF;
+		qx = (qx | (qx << 4)) & 0x0F0F0F0F;
+		qx = (qx | (qx << 2)) & 0x33333333;
+		qx = (qx | (qx << 1)) & 0x55555555;
+
+		qy = (qy | (qy << 8)) & 0x00FF00FF;
+		qy = (qy | (qy << 4)) & 0x0F0F0F0F;
+		qy = (qy | (qy << 2)) & 0x33333333;
+		qy = (qy | (qy << 1)) & 0x55555555;
+
+		return qx | (qy << 1);
+	}
+
 	bool EarClipTriangulator_Impl::is_ear(const LinkedVertice &v)
 	{
 		if (is_reflex(v)) return false;
 
 		Trianglef triangle(Pointf(v.x, v.y), Pointf(v.next->x, v.next->y), Pointf(v.previous->x, v.previous->y));
 
+		if (use_z_order)
+		{
+			// Only vertices whose z value falls in the z range of the triangle bounds can be inside it
+			unsigned int min_z = z_order(std::min(v.x, std::min(v.next->x, v.previous->x)), std::min(v.y, std::min(v.next->y, v.previous->y)));
+			unsigned int max_z = z_order(std::max(v.x, std::max(v.next->x, v.previous->x)), std::max(v.y, std::max(v.next->y, v.previous->y)));
+
+			for (LinkedVertice *v_check = v.next_z; v_check && v_check->z <= max_z; v_check = v_check->next_z)
+			{
+				if (v_check != v.next && v_check != v.previous && triangle.point_inside(Pointf(v_check->x, v_check->y)))
+					return false;
+			}
+
+			for (LinkedVertice *v_check = v.previous_z; v_check && v_check->z >= min_z; v_check = v_check->previous_z)
+			{
+				if (v_check != v.next && v_check != v.previous && triangle.point_inside(Pointf(v_check->x, v_check->y)))
+					return false;
+			}
+
+			return true;
+		}
+
 		LinkedVertice *v_check = v.next->next;
 
 		while (v_check != v.previous)
@@ -444,61 +611,4 @@ namespace clan
 
 		return false;
 	}
-
-
-	void EarClipTriangulator_Impl::set_bridge_vertice_offset(
-		LinkedVertice *target,
-		Pointf split_point,
-		float split_point_rel,
-		LinkedVertice *segment_start,
-		LinkedVertice *segment_end,
-		int direction)
-	{
-		if (direction == -1 && split_point_rel == 0.0)
-		{
-			LinkedVertice *tmp = segment_start;
-			segment_start = segment_start->previous;
-			segment_end = tmp;
-		}
-		else if (direction == 1 && split_point_rel == 1.0)
-		{
-			segment_start = segment_end;
-			segment_end = segment_end->next;
-		}
-
-		while (segment_start->x == segment_end->x && segment_start->y == segment_end->y)
-		{
-			// Sometimes there are multiple points at exactly the same location. (Bug in font?)
-			if (direction == 1)
-			{
-				segment_start = segment_end;
-				segment_end = segment_end->next;
-			}
-			else
-			{
-				segment_end = segment_start;
-				segment_start = segment_start->previous;
-			}
-		}
-
-		float dir_x = direction * (segment_end->x - segment_start->x);
-		float dir_y = direction * (segment_end->y - segment_start->y);
-
-		// normalize the vector
-		float len = sqrt(dir_x*dir_x + dir_y*dir_y);
-
-		if (len != 0)  // if len is zero something is wrong (duplicated end points on cyclic curve?)
-		{
-			dir_x /= len;
-			dir_y /= len;
-		}
-		else
-		{
-			throw Exception("Error: EarClipTriangulator: division by zero in function set_bridge_vertice_offset. Duplicated end points on a cyclic curve?");
-		}
-
-		// Changed from 0.01f to 0.001f (13 Jan 2009) to stop pixel sized gaps in a font [rombust]
-		target->x = split_point.x + 0.001f * dir_x;
-		target->y = split_point.y + 0.001f * dir_y;
-	}
 }
@@ -35,12 +35,12 @@ namespace clan
 	class LinkedVertice
 	{
 	public:
-		LinkedVertice() : x(0), y(0), is_ear(0), previous(nullptr), next(nullptr)
+		LinkedVertice() : x(0), y(0), is_ear(0), previous(nullptr), next(nullptr), z(0), ear_stamp(0), previous_z(nullptr), next_z(nullptr)
 		{
 			return;
 		}
 
-		LinkedVertice(float x, float y) : x(x), y(y), is_ear(0), previous(nullptr), next(nullptr)
+		LinkedVertice(float x, float y) : x(x), y(y), is_ear(0), previous(nullptr), next(nullptr), z(0), ear_stamp(0), previous_z(nullptr), next_z(nullptr)
 		{
 			return;
 		}
@@ -49,6 +49,22 @@ namespace clan
 		bool is_ear;
 		LinkedVertice *previous;
 		LinkedVertice *next;
+
+		/// \brief Morton code of the vertex position, used by the z-order index
+		unsigned int z;
+
+		/// \brief Incremented every time the vertex leaves the ear list
+		unsigned int ear_stamp;
+
+		LinkedVertice *previous_z;
+		LinkedVertice *next_z;
+	};
+
+	/// \brief Ear list entry. Entries whose stamp no longer matches the vertex are stale and skipped.
+	struct EarListEntry
+	{
+		LinkedVertice *vertex;
+		unsigned int stamp;
 	};
 
 	class EarClipTriangulator_Impl
@@ -78,20 +94,34 @@ namespace clan
 		bool is_reflex(const LinkedVertice &v);
 		bool is_ear(const LinkedVertice &v);
 		void create_lists(bool create_ear_list);
+		void link_contour(std::vector<LinkedVertice *> &contour);
+
+		void add_ear(LinkedVertice *v);
+		void remove_ear(LinkedVertice *v);
+		LinkedVertice *next_ear();
+
+		/// \brief Sorts the vertices along a z-order curve so ear tests only visit vertices near the ear
+		void create_z_order_index();
+		void remove_from_z_order_index(LinkedVertice *v);
+		unsigned int z_order(float x, float y) const;
+
+		void merge_holes();
+		void merge_hole(std::vector<LinkedVertice *> &hole_contour);
+		LinkedVertice *find_hole_bridge(LinkedVertice *hole_vertex);
+		bool is_locally_inside(const LinkedVertice &a, const LinkedVertice &b);
 
-		void set_bridge_vertice_offset(
-			LinkedVertice *target,
-			Pointf split_point,
-			float split_point_rel,
-			LinkedVertice *segment_start,
-			LinkedVertice *segment_end,
-			int direction);
 		PolygonOrientation orientation;
 		std::vector<LinkedVertice *> vertices;
 		std::vector<LinkedVertice *> hole;
+		std::vector<std::vector<LinkedVertice *> > pending_holes;
 		std::vector<LinkedVertice *> *target_array;
 
-		std::vector<LinkedVertice *> ear_list;
+		std::vector<EarListEntry> ear_list;
+		std::vector<EarListEntry>::size_type ear_list_front;
+
+		bool use_z_order;
+		float z_min_x, z_min_y;
+		float z_scale_x, z_scale_y;
 
 		int vertex_count;
 	};
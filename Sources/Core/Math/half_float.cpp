@@ -2186,37 +2186,37 @@ namespace clan
 		1024,
 		1024,
 		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
 	};
 
 	unsigned short HalfFloat::base_table[512] =
@@ -3295,6 +3295,8 @@ namespace clan
 		offset_table[32] = 0;
 		for (int i = 1; i < 32; i++)
 			offset_table[i] = 1024;
+		for (int i = 33; i < 64; i++)
+			offset_table[i] = 1024;
 
 		for(unsigned int i=0; i<256; ++i)
 		{
@@ -0,0 +1,206 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/half_float.h"
+#include "API/Core/System/cpu_features.h"
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define CL_HALF_FLOAT_F16C
+#if defined(__GNUC__)
+#define CL_TARGET_F16C __attribute__((target("f16c")))
+#else
+#define CL_TARGET_F16C
+#endif
+#endif
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		// The kernels convert as many values as they can and return how many, leaving the rest to the scalar code
+
+		typedef size_t(*HalfToFloatKernel)(const unsigned short *input, float *output, size_t count);
+		typedef size_t(*FloatToHalfKernel)(const float *input, unsigned short *output, size_t count);
+
+#ifdef CL_HALF_FLOAT_F16C
+
+		CL_TARGET_F16C size_t half_to_float_f16c(const unsigned short *input, float *output, size_t count)
+		{
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+				_mm256_storeu_ps(output + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(input + i))));
+			return i;
+		}
+
+		CL_TARGET_F16C size_t float_to_half_f16c(const float *input, unsigned short *output, size_t count)
+		{
+			// Rounding towards zero makes F16C saturate too large numbers to 65504, where the tables return infinity
+			__m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+			__m256 overflow_limit = _mm256_set1_ps(65536.0f);
+			__m128i sign = _mm_set1_epi16((short)0x8000);
+			__m128i infinity = _mm_set1_epi16(0x7c00);
+
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256 value = _mm256_loadu_ps(input + i);
+				__m128i h = _mm256_cvtps_ph(value, _MM_FROUND_TO_ZERO);
+
+				__m256 is_overflow = _mm256_cmp_ps(_mm256_and_ps(value, abs_mask), overflow_limit, _CMP_GE_OQ);
+				__m128i overflow = _mm_packs_epi32(_mm_castps_si128(_mm256_castps256_ps128(is_overflow)), _mm_castps_si128(_mm256_extractf128_ps(is_overflow, 1)));
+				h = _mm_or_si128(_mm_andnot_si128(overflow, h), _mm_and_si128(overflow, _mm_or_si128(_mm_and_si128(h, sign), infinity)));
+
+				_mm_storeu_si128((__m128i*)(output + i), h);
+			}
+			return i;
+		}
+
+#endif
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+
+		// Table-free versions of the lookup tables in half_float.cpp, giving the same results bit for bit
+
+		inline __m128 half_to_float_sse2(__m128i h)
+		{
+			__m128i exponent_mask = _mm_set1_epi32(0x7c00 << 13);
+			__m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+			__m128i exponent = _mm_and_si128(o, exponent_mask);
+			o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+
+			// Infinity and NaN need another exponent adjustment
+			__m128i is_inf_nan = _mm_cmpeq_epi32(exponent, exponent_mask);
+			o = _mm_add_epi32(o, _mm_and_si128(is_inf_nan, _mm_set1_epi32((128 - 16) << 23)));
+
+			// Zero and denormals are renormalized by letting the FPU subtract the implicit leading one
+			__m128i is_denormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+			__m128i denormal = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23))));
+			o = _mm_or_si128(_mm_and_si128(is_denormal, denormal), _mm_andnot_si128(is_denormal, o));
+
+			o = _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+			return _mm_castsi128_ps(o);
+		}
+
+		inline __m128i float_to_half_sse2(__m128 value)
+		{
+			__m128i f = _mm_castps_si128(value);
+			__m128i sign = _mm_and_si128(f, _mm_set1_epi32(0x80000000));
+			f = _mm_xor_si128(f, sign);
+
+			// Normal halfs just lose mantissa precision
+			__m128i normal = _mm_srli_epi32(_mm_sub_epi32(f, _mm_set1_epi32(0x38000000)), 13);
+
+			// Denormal halfs count in steps of 2^-24, truncated
+			__m128i denormal = _mm_cvttps_epi32(_mm_mul_ps(_mm_castsi128_ps(f), _mm_set1_ps(16777216.0f)));
+
+			// Too large numbers become infinity. Infinity and NaN keep the top of their mantissa.
+			__m128i is_inf_nan = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x7f7fffff));
+			__m128i large = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(is_inf_nan, _mm_srli_epi32(_mm_and_si128(f, _mm_set1_epi32(0x007fffff)), 13)));
+
+			__m128i is_denormal = _mm_cmplt_epi32(f, _mm_set1_epi32(0x38800000));
+			__m128i is_large = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x477fffff));
+			__m128i h = _mm_or_si128(_mm_and_si128(is_denormal, denormal), _mm_andnot_si128(is_denormal, normal));
+			h = _mm_or_si128(_mm_and_si128(is_large, large), _mm_andnot_si128(is_large, h));
+			return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+		}
+
+		size_t half_to_float_sse2(const unsigned short *input, float *output, size_t count)
+		{
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i h = _mm_loadu_si128((const __m128i*)(input + i));
+				_mm_storeu_ps(output + i, half_to_float_sse2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+				_mm_storeu_ps(output + i + 4, half_to_float_sse2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+			}
+			return i;
+		}
+
+		size_t float_to_half_sse2(const float *input, unsigned short *output, size_t count)
+		{
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m128i low = float_to_half_sse2(_mm_loadu_ps(input + i));
+				__m128i high = float_to_half_sse2(_mm_loadu_ps(input + i + 4));
+
+				// Sign extend so the signed saturating pack keeps all 16 bits
+				low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+				high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+				_mm_storeu_si128((__m128i*)(output + i), _mm_packs_epi32(low, high));
+			}
+			return i;
+		}
+
+#endif
+
+		size_t half_to_float_none(const unsigned short *input, float *output, size_t count)
+		{
+			return 0;
+		}
+
+		size_t float_to_half_none(const float *input, unsigned short *output, size_t count)
+		{
+			return 0;
+		}
+	}
+
+	void HalfFloat::half_to_float(const unsigned short *input, float *output, size_t count)
+	{
+		static const CPUDispatch<HalfToFloatKernel> kernel({
+#ifdef CL_HALF_FLOAT_F16C
+			{ System::f16c, half_to_float_f16c },
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+			{ System::sse2, half_to_float_sse2 },
+#endif
+		}, half_to_float_none);
+		for (size_t i = kernel(input, output, count); i < count; i++)
+			output[i] = half_to_float(input[i]);
+	}
+
+	void HalfFloat::float_to_half(const float *input, unsigned short *output, size_t count)
+	{
+		static const CPUDispatch<FloatToHalfKernel> kernel({
+#ifdef CL_HALF_FLOAT_F16C
+			{ System::f16c, float_to_half_f16c },
+#endif
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+			{ System::sse2, float_to_half_sse2 },
+#endif
+		}, float_to_half_none);
+		for (size_t i = kernel(input, output, count); i < count; i++)
+			output[i] = float_to_half(input[i]);
+	}
+}
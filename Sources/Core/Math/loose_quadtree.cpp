@@ -0,0 +1,99 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/loose_quadtree.h"
+#include "loose_quadtree_impl.h"
+
+namespace clan
+{
+	LooseQuadtree::LooseQuadtree(const Rectf &bounds, int max_depth)
+		: impl(std::make_shared<LooseQuadtree_Impl>(bounds, max_depth))
+	{
+	}
+
+	LooseQuadtree::~LooseQuadtree()
+	{
+	}
+
+	Rectf LooseQuadtree::get_bounds() const
+	{
+		return impl->bounds;
+	}
+
+	int LooseQuadtree::get_proxy_count() const
+	{
+		return impl->proxy_count;
+	}
+
+	const Rectf &LooseQuadtree::get_rect(int proxy) const
+	{
+		return impl->get_object(proxy).rect;
+	}
+
+	void *LooseQuadtree::get_data(int proxy) const
+	{
+		return impl->get_object(proxy).data;
+	}
+
+	int LooseQuadtree::insert(const Rectf &rect, void *data)
+	{
+		return impl->insert(rect, data);
+	}
+
+	void LooseQuadtree::remove(int proxy)
+	{
+		impl->remove(proxy);
+	}
+
+	void LooseQuadtree::move(int proxy, const Rectf &rect)
+	{
+		impl->move(proxy, rect);
+	}
+
+	void LooseQuadtree::clear()
+	{
+		impl->clear();
+	}
+
+	void LooseQuadtree::query(const Rectf &rect, std::vector<int> &result) const
+	{
+		impl->query(rect, result);
+	}
+
+	void LooseQuadtree::query(const Pointf &point, std::vector<int> &result) const
+	{
+		impl->query(point, result);
+	}
+
+	void LooseQuadtree::query_ray(const Pointf &ray_start, const Pointf &ray_end, std::vector<int> &result) const
+	{
+		impl->query_ray(ray_start, ray_end, result);
+	}
+}
@@ -0,0 +1,272 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "loose_quadtree_impl.h"
+
+namespace clan
+{
+	LooseQuadtree_Impl::LooseQuadtree_Impl(const Rectf &bounds, int max_depth) : bounds(bounds), max_depth(max_depth)
+	{
+		if (max_depth < 0)
+			throw Exception("Invalid LooseQuadtree depth");
+		clear();
+	}
+
+	const LooseQuadtree_Object &LooseQuadtree_Impl::get_object(int proxy) const
+	{
+		if (proxy < 0 || proxy >= (int)objects.size() || objects[proxy].node == -1)
+			throw Exception("Invalid LooseQuadtree proxy");
+		return objects[proxy];
+	}
+
+	int LooseQuadtree_Impl::insert(const Rectf &rect, void *data)
+	{
+		int proxy;
+		if (free_list == -1)
+		{
+			proxy = (int)objects.size();
+			objects.push_back(LooseQuadtree_Object());
+		}
+		else
+		{
+			proxy = free_list;
+			free_list = objects[proxy].slot;
+		}
+
+		objects[proxy].rect = rect;
+		objects[proxy].data = data;
+		link_object(proxy, find_node(rect));
+		proxy_count++;
+		return proxy;
+	}
+
+	void LooseQuadtree_Impl::remove(int proxy)
+	{
+		get_object(proxy);
+		unlink_object(proxy);
+
+		LooseQuadtree_Object &object = objects[proxy];
+		object.node = -1;
+		object.slot = free_list;
+		object.data = nullptr;
+		free_list = proxy;
+		proxy_count--;
+	}
+
+	void LooseQuadtree_Impl::move(int proxy, const Rectf &rect)
+	{
+		get_object(proxy);
+
+		int node = find_node(rect);
+		objects[proxy].rect = rect;
+		if (objects[proxy].node != node)
+		{
+			unlink_object(proxy);
+			link_object(proxy, node);
+		}
+		else
+		{
+			nodes[node].objects[objects[proxy].slot].rect = rect;
+		}
+	}
+
+	void LooseQuadtree_Impl::clear()
+	{
+		nodes.clear();
+		objects.clear();
+		free_list = -1;
+		proxy_count = 0;
+
+		LooseQuadtree_Node root;
+		root.center_x = (bounds.left + bounds.right) * 0.5f;
+		root.center_y = (bounds.top + bounds.bottom) * 0.5f;
+		root.loose_bounds = Rectf(bounds).expand(bounds.get_width() * 0.5f, bounds.get_height() * 0.5f);
+		nodes.push_back(root);
+	}
+
+	void LooseQuadtree_Impl::query(const Rectf &rect, std::vector<int> &result) const
+	{
+		find_objects(
+			[&](const Rectf &loose_bounds) { return rect.left <= loose_bounds.right && rect.right >= loose_bounds.left && rect.top <= loose_bounds.bottom && rect.bottom >= loose_bounds.top; },
+			[&](const Rectf &object_rect) { return object_rect.is_overlapped(rect); },
+			result);
+	}
+
+	void LooseQuadtree_Impl::query(const Pointf &point, std::vector<int> &result) const
+	{
+		find_objects(
+			[&](const Rectf &loose_bounds) { return point.x >= loose_bounds.left && point.x <= loose_bounds.right && point.y >= loose_bounds.top && point.y <= loose_bounds.bottom; },
+			[&](const Rectf &object_rect) { return object_rect.contains(point); },
+			result);
+	}
+
+	void LooseQuadtree_Impl::query_ray(const Pointf &ray_start, const Pointf &ray_end, std::vector<int> &result) const
+	{
+		auto test = [&](const Rectf &rect) { return segment_rect(ray_start, ray_end, rect); };
+		find_objects(test, test, result);
+	}
+
+	template<typename NodeTest, typename ObjectTest>
+	void LooseQuadtree_Impl::find_objects(const NodeTest &node_test, const ObjectTest &object_test, std::vector<int> &result) const
+	{
+		result.clear();
+		if (nodes[0].subtree_count == 0)
+			return;
+
+		// The root node is always searched as it also holds the objects outside the bounds
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			const LooseQuadtree_Node &node = nodes[stack.back()];
+			stack.pop_back();
+
+			for (const LooseQuadtree_Entry &entry : node.objects)
+			{
+				if (object_test(entry.rect))
+					result.push_back(entry.proxy);
+			}
+
+			for (int child : node.children)
+			{
+				if (child != -1 && nodes[child].subtree_count != 0 && node_test(nodes[child].loose_bounds))
+					stack.push_back(child);
+			}
+		}
+	}
+
+	int LooseQuadtree_Impl::find_node(const Rectf &rect)
+	{
+		float center_x = (rect.left + rect.right) * 0.5f;
+		float center_y = (rect.top + rect.bottom) * 0.5f;
+		if (!(center_x >= bounds.left && center_x <= bounds.right && center_y >= bounds.top && center_y <= bounds.bottom))
+			return 0;
+
+		float width = rect.get_width();
+		float height = rect.get_height();
+
+		// An object fits in the loose bounds of a node if its center is in the node and it is no larger than the node
+		int node = 0;
+		Rectf cell = bounds;
+		for (int depth = 0; depth < max_depth; depth++)
+		{
+			float cell_width = cell.get_width() * 0.5f;
+			float cell_height = cell.get_height() * 0.5f;
+			if (width > cell_width || height > cell_height)
+				break;
+
+			float node_center_x = nodes[node].center_x;
+			float node_center_y = nodes[node].center_y;
+			int quadrant = (center_x >= node_center_x ? 1 : 0) + (center_y >= node_center_y ? 2 : 0);
+
+			cell = Rectf(
+				(quadrant & 1) ? node_center_x : cell.left,
+				(quadrant & 2) ? node_center_y : cell.top,
+				(quadrant & 1) ? cell.right : node_center_x,
+				(quadrant & 2) ? cell.bottom : node_center_y);
+
+			int child = nodes[node].children[quadrant];
+			if (child == -1)
+			{
+				LooseQuadtree_Node child_node;
+				child_node.parent = node;
+				child_node.center_x = (cell.left + cell.right) * 0.5f;
+				child_node.center_y = (cell.top + cell.bottom) * 0.5f;
+				child_node.loose_bounds = Rectf(cell).expand(cell_width * 0.5f, cell_height * 0.5f);
+
+				child = (int)nodes.size();
+				nodes.push_back(child_node);
+				nodes[node].children[quadrant] = child;
+			}
+			node = child;
+		}
+		return node;
+	}
+
+	void LooseQuadtree_Impl::link_object(int proxy, int node)
+	{
+		objects[proxy].node = node;
+		objects[proxy].slot = (int)nodes[node].objects.size();
+		nodes[node].objects.push_back(LooseQuadtree_Entry(objects[proxy].rect, proxy));
+
+		for (int index = node; index != -1; index = nodes[index].parent)
+			nodes[index].subtree_count++;
+	}
+
+	void LooseQuadtree_Impl::unlink_object(int proxy)
+	{
+		int node = objects[proxy].node;
+		int slot = objects[proxy].slot;
+
+		std::vector<LooseQuadtree_Entry> &node_objects = nodes[node].objects;
+		node_objects[slot] = node_objects.back();
+		objects[node_objects[slot].proxy].slot = slot;
+		node_objects.pop_back();
+
+		for (int index = node; index != -1; index = nodes[index].parent)
+			nodes[index].subtree_count--;
+	}
+
+	bool LooseQuadtree_Impl::segment_rect(const Pointf &start, const Pointf &end, const Rectf &rect)
+	{
+		// Liang-Barsky clipping of the segment against the rectangle
+		float t0 = 0.0f, t1 = 1.0f;
+		float dx = end.x - start.x;
+		float dy = end.y - start.y;
+		float p[4] = { -dx, dx, -dy, dy };
+		float q[4] = { start.x - rect.left, rect.right - start.x, start.y - rect.top, rect.bottom - start.y };
+		for (int i = 0; i < 4; i++)
+		{
+			if (p[i] == 0.0f)
+			{
+				if (q[i] < 0.0f)
+					return false;
+			}
+			else
+			{
+				float t = q[i] / p[i];
+				if (p[i] < 0.0f)
+				{
+					if (t > t1)
+						return false;
+					t0 = std::max(t0, t);
+				}
+				else
+				{
+					if (t < t0)
+						return false;
+					t1 = std::min(t1, t);
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/Math/loose_quadtree.h"
+
+namespace clan
+{
+	class LooseQuadtree_Entry
+	{
+	public:
+		LooseQuadtree_Entry(const Rectf &rect, int proxy) : rect(rect), proxy(proxy) {}
+
+		Rectf rect;
+		int proxy;
+	};
+
+	class LooseQuadtree_Node
+	{
+	public:
+		/// \brief Node area grown by half its size on every side
+		Rectf loose_bounds;
+
+		float center_x = 0.0f;
+		float center_y = 0.0f;
+
+		int parent = -1;
+		int children[4] = { -1, -1, -1, -1 };
+
+		/// \brief Objects stored in this node. Their rectangles are copied here so searching a node stays in one block of memory.
+		std::vector<LooseQuadtree_Entry> objects;
+
+		/// \brief Number of objects in this node and its children
+		int subtree_count = 0;
+	};
+
+	class LooseQuadtree_Object
+	{
+	public:
+		Rectf rect;
+		void *data = nullptr;
+
+		/// \brief Node holding the object, or -1 if the object is free
+		int node = -1;
+
+		/// \brief Position in the object list of the node, or the next object in the free list
+		int slot = -1;
+	};
+
+	class LooseQuadtree_Impl
+	{
+	public:
+		LooseQuadtree_Impl(const Rectf &bounds, int max_depth);
+
+		int insert(const Rectf &rect, void *data);
+		void remove(int proxy);
+		void move(int proxy, const Rectf &rect);
+		void clear();
+
+		void query(const Rectf &rect, std::vector<int> &result) const;
+		void query(const Pointf &point, std::vector<int> &result) const;
+		void query_ray(const Pointf &ray_start, const Pointf &ray_end, std::vector<int> &result) const;
+
+		const LooseQuadtree_Object &get_object(int proxy) const;
+
+		Rectf bounds;
+		int max_depth;
+		int proxy_count = 0;
+
+	private:
+		int find_node(const Rectf &rect);
+		void link_object(int proxy, int node);
+		void unlink_object(int proxy);
+
+		template<typename NodeTest, typename ObjectTest>
+		void find_objects(const NodeTest &node_test, const ObjectTest &object_test, std::vector<int> &result) const;
+
+		static bool segment_rect(const Pointf &start, const Pointf &end, const Rectf &rect);
+
+		std::vector<LooseQuadtree_Node> nodes;
+		std::vector<LooseQuadtree_Object> objects;
+		int free_list = -1;
+	};
+}
@@ -36,10 +36,11 @@ namespace clan
 	{
 	}
 
-	RectPacker::RectPacker(const Size &max_group_size, AllocationPolicy policy)
+	RectPacker::RectPacker(const Size &max_group_size, AllocationPolicy policy, PackingMethod method)
 		: impl(std::make_shared<RectPacker_Impl>(max_group_size))
 	{
 		set_allocation_policy(policy);
+		set_packing_method(method);
 	}
 
 	RectPacker::~RectPacker()
@@ -57,6 +58,11 @@ namespace clan
 		return impl->allocation_policy;
 	}
 
+	RectPacker::PackingMethod RectPacker::get_packing_method() const
+	{
+		return impl->packing_method;
+	}
+
 	Size RectPacker::get_max_group_size() const
 	{
 		return impl->max_group_size;
@@ -74,7 +80,7 @@ namespace clan
 
 	int RectPacker::get_group_count() const
 	{
-		return impl->root_nodes.size();
+		return impl->groups.size();
 	}
 
 	void RectPacker::set_allocation_policy(AllocationPolicy policy)
@@ -82,8 +88,30 @@ namespace clan
 		impl->allocation_policy = policy;
 	}
 
+	void RectPacker::set_packing_method(PackingMethod method)
+	{
+		impl->packing_method = method;
+	}
+
 	RectPacker::AllocatedRect RectPacker::add(const Size &size)
 	{
 		return impl->add_new_node(size);
 	}
+
+	std::vector<RectPacker::AllocatedRect> RectPacker::add_all(const std::vector<Size> &sizes, SortHeuristic heuristic)
+	{
+		return impl->add_all(sizes, heuristic);
+	}
+
+	void RectPacker::remove(const AllocatedRect &rect)
+	{
+		impl->remove(rect);
+	}
+
+	int64_t RectPacker::get_used_area(unsigned int group_index) const
+	{
+		if (group_index < impl->groups.size())
+			return impl->groups[group_index]->get_used_area();
+		return 0;
+	}
 }
@@ -0,0 +1,478 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+**    (if your name is missing here, please add it)
+*/
+
+#include "Core/precomp.h"
+#include "rect_packer_bin.h"
+#include <algorithm>
+
+namespace clan
+{
+	std::unique_ptr<RectPackerBin> RectPackerBin::create(RectPacker::PackingMethod method, const Rect &area)
+	{
+		switch (method)
+		{
+		case RectPacker::skyline_bottom_left:
+			return std::make_unique<RectPackerBin_Skyline>(area);
+		case RectPacker::max_rects:
+			return std::make_unique<RectPackerBin_MaxRects>(area);
+		case RectPacker::guillotine:
+		default:
+			return std::make_unique<RectPackerBin_Guillotine>(area);
+		}
+	}
+
+	bool RectPackerBin::insert(const Size &size, Rect &out_rect)
+	{
+		if (size.width <= 0 || size.height <= 0 || size.width > area.get_width() || size.height > area.get_height())
+			return false;
+
+		if (!allocate(size, out_rect))
+			return false;
+
+		allocated[std::make_pair(out_rect.left, out_rect.top)] = out_rect;
+		used_area += (int64_t)size.width * size.height;
+		return true;
+	}
+
+	bool RectPackerBin::remove(const Rect &rect)
+	{
+		auto it = allocated.find(std::make_pair(rect.left, rect.top));
+		if (it == allocated.end() || it->second != rect)
+			return false;
+
+		allocated.erase(it);
+		used_area -= (int64_t)rect.get_width() * rect.get_height();
+		free(rect);
+		return true;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// RectPackerBin_Guillotine:
+
+	RectPackerBin_Guillotine::RectPackerBin_Guillotine(const Rect &area) : RectPackerBin(area), root(area)
+	{
+	}
+
+	bool RectPackerBin_Guillotine::allocate(const Size &size, Rect &out_rect)
+	{
+		Node *node = root.insert(size);
+		if (!node)
+			return false;
+		out_rect = node->node_rect;
+		return true;
+	}
+
+	void RectPackerBin_Guillotine::free(const Rect &rect)
+	{
+		root.remove(rect);
+	}
+
+	RectPackerBin_Guillotine::Node *RectPackerBin_Guillotine::Node::insert(const Size &rect_size)
+	{
+		// If we're not a leaf
+		if (child[0])
+		{
+			// Try inserting into first child
+			Node *new_node = child[0]->insert(rect_size);
+			if (new_node != nullptr)
+				return new_node;
+
+			// No room, insert into second
+			return child[1]->insert(rect_size);
+		}
+
+		// If there's already a rect here, or we're too small, return
+		if (used || rect_size.width > node_rect.get_width() || rect_size.height > node_rect.get_height())
+			return nullptr;
+
+		// If we're just right, accept
+		if (rect_size.width == node_rect.get_width() && rect_size.height == node_rect.get_height())
+		{
+			used = true;
+			return this;
+		}
+
+		// Otherwise, decide which way to split
+		int dw = node_rect.get_width() - rect_size.width;
+		int dh = node_rect.get_height() - rect_size.height;
+
+		if (dw > dh)
+		{
+			child[0] = std::make_unique<Node>(Rect(node_rect.left, node_rect.top, node_rect.left + rect_size.width, node_rect.bottom));
+			child[1] = std::make_unique<Node>(Rect(node_rect.left + rect_size.width, node_rect.top, node_rect.right, node_rect.bottom));
+		}
+		else
+		{
+			child[0] = std::make_unique<Node>(Rect(node_rect.left, node_rect.top, node_rect.right, node_rect.top + rect_size.height));
+			child[1] = std::make_unique<Node>(Rect(node_rect.left, node_rect.top + rect_size.height, node_rect.right, node_rect.bottom));
+		}
+
+		// Insert into first child we created
+		return child[0]->insert(rect_size);
+	}
+
+	bool RectPackerBin_Guillotine::Node::remove(const Rect &rect)
+	{
+		if (!child[0])
+		{
+			if (!used || node_rect != rect)
+				return false;
+			used = false;
+			return true;
+		}
+
+		if (!node_rect.is_overlapped(rect) || !(child[0]->remove(rect) || child[1]->remove(rect)))
+			return false;
+
+		// Join the cut again when both sides are free, so the whole node can be reused for any size
+		if (child[0]->is_free_leaf() && child[1]->is_free_leaf())
+		{
+			child[0].reset();
+			child[1].reset();
+		}
+		return true;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// RectPackerBin_Skyline:
+
+	RectPackerBin_Skyline::RectPackerBin_Skyline(const Rect &area) : RectPackerBin(area)
+	{
+		skyline.push_back(Segment{ area.left, area.top, area.get_width() });
+	}
+
+	bool RectPackerBin_Skyline::allocate(const Size &size, Rect &out_rect)
+	{
+		// Space lost below the skyline, or freed by remove, is used first
+		if (allocate_free_rect(size, out_rect))
+			return true;
+
+		// Find the lowest position, preferring the narrower segment when tied (bottom-left rule)
+		size_t best_index = skyline.size();
+		int best_bottom = 0;
+		int best_width = 0;
+		int best_y = 0;
+		for (size_t i = 0; i < skyline.size(); i++)
+		{
+			int y;
+			if (fit(i, size, y))
+			{
+				int bottom = y + size.height;
+				if (best_index == skyline.size() || bottom < best_bottom || (bottom == best_bottom && skyline[i].width < best_width))
+				{
+					best_index = i;
+					best_bottom = bottom;
+					best_width = skyline[i].width;
+					best_y = y;
+				}
+			}
+		}
+
+		if (best_index == skyline.size())
+			return false;
+
+		out_rect = Rect(Point(skyline[best_index].x, best_y), size);
+		add_level(best_index, out_rect);
+		return true;
+	}
+
+	bool RectPackerBin_Skyline::fit(size_t index, const Size &size, int &out_y) const
+	{
+		int x = skyline[index].x;
+		if (x + size.width > area.right)
+			return false;
+
+		int width_left = size.width;
+		int y = skyline[index].y;
+		while (width_left > 0)
+		{
+			y = std::max(y, skyline[index].y);
+			if (y + size.height > area.bottom)
+				return false;
+			width_left -= skyline[index].width;
+			index++;
+		}
+		out_y = y;
+		return true;
+	}
+
+	void RectPackerBin_Skyline::add_level(size_t index, const Rect &rect)
+	{
+		// The segments covered by the new rect lose the space between them and the rect
+		for (size_t i = index; i < skyline.size() && skyline[i].x < rect.right; i++)
+		{
+			int right = std::min(skyline[i].x + skyline[i].width, rect.right);
+			if (skyline[i].y < rect.top)
+				add_free_rect(Rect(skyline[i].x, skyline[i].y, right, rect.top));
+		}
+
+		skyline.insert(skyline.begin() + index, Segment{ rect.left, rect.bottom, rect.get_width() });
+
+		// Shrink or remove the following segments that are now covered
+		for (size_t i = index + 1; i < skyline.size();)
+		{
+			Segment &segment = skyline[i];
+			int shrink = rect.right - segment.x;
+			if (shrink <= 0)
+				break;
+
+			if (shrink >= segment.width)
+			{
+				skyline.erase(skyline.begin() + i);
+			}
+			else
+			{
+				segment.x += shrink;
+				segment.width -= shrink;
+				break;
+			}
+		}
+
+		// Merge neighbours at the same height
+		for (size_t i = 0; i + 1 < skyline.size();)
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	bool RectPackerBin_Skyline::allocate_free_rect(const Size &size, Rect &out_rect)
+	{
+		// Best area fit
+		size_t best_index = free_rects.size();
+		int64_t best_area = 0;
+		for (size_t i = 0; i < free_rects.size(); i++)
+		{
+			const Rect &free_rect = free_rects[i];
+			if (size.width <= free_rect.get_width() && size.height <= free_rect.get_height())
+			{
+				int64_t free_area = (int64_t)free_rect.get_width() * free_rect.get_height();
+				if (best_index == free_rects.size() || free_area < best_area)
+				{
+					best_index = i;
+					best_area = free_area;
+				}
+			}
+		}
+
+		if (best_index == free_rects.size())
+			return false;
+
+		Rect free_rect = free_rects[best_index];
+		free_rects.erase(free_rects.begin() + best_index);
+		out_rect = Rect(free_rect.get_top_left(), size);
+
+		// Split the remaining L shape along the shorter leftover axis, keeping the larger piece whole
+		if (free_rect.get_width() - size.width > free_rect.get_height() - size.height)
+		{
+			add_free_rect(Rect(out_rect.right, free_rect.top, free_rect.right, free_rect.bottom));
+			add_free_rect(Rect(free_rect.left, out_rect.bottom, out_rect.right, free_rect.bottom));
+		}
+		else
+		{
+			add_free_rect(Rect(out_rect.right, free_rect.top, free_rect.right, out_rect.bottom));
+			add_free_rect(Rect(free_rect.left, out_rect.bottom, free_rect.right, free_rect.bottom));
+		}
+		return true;
+	}
+
+	void RectPackerBin_Skyline::add_free_rect(const Rect &rect)
+	{
+		if (rect.get_width() <= 0 || rect.get_height() <= 0)
+			return;
+
+		// Join with free rects sharing a whole edge, so freed neighbours can hold larger rects again
+		Rect merged = rect;
+		bool found = true;
+		while (found)
+		{
+			found = false;
+			for (size_t i = 0; i < free_rects.size(); i++)
+			{
+				const Rect &other = free_rects[i];
+				bool same_columns = other.left == merged.left && other.right == merged.right;
+				bool same_rows = other.top == merged.top && other.bottom == merged.bottom;
+				if ((same_columns && (other.bottom == merged.top || other.top == merged.bottom)) ||
+					(same_rows && (other.right == merged.left || other.left == merged.right)))
+				{
+					merged.bounding_rect(other);
+					free_rects.erase(free_rects.begin() + i);
+					found = true;
+					break;
+				}
+			}
+		}
+		free_rects.push_back(merged);
+	}
+
+	void RectPackerBin_Skyline::free(const Rect &rect)
+	{
+		add_free_rect(rect);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// RectPackerBin_MaxRects:
+
+	RectPackerBin_MaxRects::RectPackerBin_MaxRects(const Rect &area) : RectPackerBin(area)
+	{
+		free_rects.push_back(area);
+	}
+
+	bool RectPackerBin_MaxRects::allocate(const Size &size, Rect &out_rect)
+	{
+		// Best short side fit, ties broken by the long side
+		size_t best_index = free_rects.size();
+		int best_short_side = 0;
+		int best_long_side = 0;
+		for (size_t i = 0; i < free_rects.size(); i++)
+		{
+			const Rect &free_rect = free_rects[i];
+			if (size.width <= free_rect.get_width() && size.height <= free_rect.get_height())
+			{
+				int leftover_x = free_rect.get_width() - size.width;
+				int leftover_y = free_rect.get_height() - size.height;
+				int short_side = std::min(leftover_x, leftover_y);
+				int long_side = std::max(leftover_x, leftover_y);
+				if (best_index == free_rects.size() || short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side))
+				{
+					best_index = i;
+					best_short_side = short_side;
+					best_long_side = long_side;
+				}
+			}
+		}
+
+		if (best_index == free_rects.size())
+			return false;
+
+		out_rect = Rect(free_rects[best_index].get_top_left(), size);
+		split_free_rects(out_rect);
+		prune_free_rects();
+		return true;
+	}
+
+	void RectPackerBin_MaxRects::free(const Rect &rect)
+	{
+		free_rects.push_back(rect);
+		merge_free_rects();
+		prune_free_rects();
+	}
+
+	void RectPackerBin_MaxRects::split_free_rects(const Rect &used)
+	{
+		size_t count = free_rects.size();
+		for (size_t i = 0; i < count;)
+		{
+			Rect free_rect = free_rects[i];
+			if (!free_rect.is_overlapped(used))
+			{
+				i++;
+				continue;
+			}
+
+			// Replace the free rect by the maximal rects around the used rect
+			free_rects[i] = free_rects[count - 1];
+			free_rects[count - 1] = free_rects.back();
+			free_rects.pop_back();
+			count--;
+
+			if (used.left > free_rect.left)
+				free_rects.push_back(Rect(free_rect.left, free_rect.top, used.left, free_rect.bottom));
+			if (used.right < free_rect.right)
+				free_rects.push_back(Rect(used.right, free_rect.top, free_rect.right, free_rect.bottom));
+			if (used.top > free_rect.top)
+				free_rects.push_back(Rect(free_rect.left, free_rect.top, free_rect.right, used.top));
+			if (used.bottom < free_rect.bottom)
+				free_rects.push_back(Rect(free_rect.left, used.bottom, free_rect.right, free_rect.bottom));
+		}
+	}
+
+	void RectPackerBin_MaxRects::merge_free_rects()
+	{
+		// Join free rects sharing a whole edge, so a freed rect grows back into the free space around it
+		bool merged = true;
+		while (merged)
+		{
+			merged = false;
+			for (size_t i = 0; i < free_rects.size() && !merged; i++)
+			{
+				for (size_t j = i + 1; j < free_rects.size(); j++)
+				{
+					Rect &a = free_rects[i];
+					const Rect &b = free_rects[j];
+					bool same_columns = a.left == b.left && a.right == b.right;
+					bool same_rows = a.top == b.top && a.bottom == b.bottom;
+					if ((same_columns && a.top <= b.bottom && b.top <= a.bottom) ||
+						(same_rows && a.left <= b.right && b.left <= a.right))
+					{
+						a.bounding_rect(b);
+						free_rects.erase(free_rects.begin() + j);
+						merged = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	void RectPackerBin_MaxRects::prune_free_rects()
+	{
+		// Remove free rects contained in another free rect
+		for (size_t i = 0; i < free_rects.size(); i++)
+		{
+			for (size_t j = i + 1; j < free_rects.size();)
+			{
+				const Rect &a = free_rects[i];
+				const Rect &b = free_rects[j];
+				if (a.left <= b.left && a.top <= b.top && a.right >= b.right && a.bottom >= b.bottom)
+				{
+					free_rects.erase(free_rects.begin() + j);
+				}
+				else if (b.left <= a.left && b.top <= a.top && b.right >= a.right && b.bottom >= a.bottom)
+				{
+					free_rects[i] = free_rects[j];
+					free_rects.erase(free_rects.begin() + j);
+					j = i + 1;
+				}
+				else
+				{
+					j++;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,142 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Core/Math/rect_packer.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Allocates rects within a single area (a group of a RectPacker, or a texture of a TextureGroup)
+	class RectPackerBin
+	{
+	public:
+		RectPackerBin(const Rect &area) : area(area) { }
+		virtual ~RectPackerBin() { }
+
+		static std::unique_ptr<RectPackerBin> create(RectPacker::PackingMethod method, const Rect &area);
+
+		/// \brief Allocate a rect. Returns false if there is no space left for it
+		bool insert(const Size &size, Rect &out_rect);
+
+		/// \brief Free a rect allocated by insert, so the space can be reused. Returns false if the rect was not allocated here
+		bool remove(const Rect &rect);
+
+		const Rect &get_area() const { return area; }
+		int get_rect_count() const { return (int)allocated.size(); }
+		int64_t get_used_area() const { return used_area; }
+
+	protected:
+		virtual bool allocate(const Size &size, Rect &out_rect) = 0;
+		virtual void free(const Rect &rect) = 0;
+
+		Rect area;
+
+	private:
+		std::map<std::pair<int, int>, Rect> allocated;	// By top left corner
+		int64_t used_area = 0;
+	};
+
+	/// \brief Binary tree of guillotine cuts, each allocation splitting a free node in two
+	class RectPackerBin_Guillotine : public RectPackerBin
+	{
+	public:
+		RectPackerBin_Guillotine(const Rect &area);
+
+	protected:
+		bool allocate(const Size &size, Rect &out_rect) override;
+		void free(const Rect &rect) override;
+
+	private:
+		class Node
+		{
+		public:
+			Node(const Rect &rect) : node_rect(rect) { }
+
+			Node *insert(const Size &rect_size);
+			bool remove(const Rect &rect);
+			bool is_free_leaf() const { return !child[0] && !used; }
+
+			std::unique_ptr<Node> child[2];
+			Rect node_rect;
+			bool used = false;
+		};
+
+		Node root;
+	};
+
+	/// \brief Skyline bottom-left packing, with the space left below the skyline kept in a list of free rects
+	class RectPackerBin_Skyline : public RectPackerBin
+	{
+	public:
+		RectPackerBin_Skyline(const Rect &area);
+
+	protected:
+		bool allocate(const Size &size, Rect &out_rect) override;
+		void free(const Rect &rect) override;
+
+	private:
+		struct Segment
+		{
+			int x;
+			int y;
+			int width;
+		};
+
+		bool fit(size_t index, const Size &size, int &out_y) const;
+		void add_level(size_t index, const Rect &rect);
+		bool allocate_free_rect(const Size &size, Rect &out_rect);
+		void add_free_rect(const Rect &rect);
+
+		std::vector<Segment> skyline;
+		std::vector<Rect> free_rects;
+	};
+
+	/// \brief Maximal rectangles packing, placing each rect in the free rect that leaves the shortest side over
+	class RectPackerBin_MaxRects : public RectPackerBin
+	{
+	public:
+		RectPackerBin_MaxRects(const Rect &area);
+
+	protected:
+		bool allocate(const Size &size, Rect &out_rect) override;
+		void free(const Rect &rect) override;
+
+	private:
+		void split_free_rects(const Rect &used);
+		void merge_free_rects();
+		void prune_free_rects();
+
+		std::vector<Rect> free_rects;
+	};
+}
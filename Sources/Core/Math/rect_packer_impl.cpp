@@ -29,34 +29,26 @@
 #include "Core/precomp.h"
 #include "API/Core/Math/rect.h"
 #include "rect_packer_impl.h"
+#include <algorithm>
+#include <numeric>
+#include <thread>
 
 namespace clan
 {
 	RectPacker_Impl::RectPacker_Impl(const Size &max_group_size)
-		: active_root_node(nullptr), next_node_id(0), max_group_size(max_group_size)
+		: max_group_size(max_group_size)
 	{
 	}
 
 	RectPacker_Impl::~RectPacker_Impl()
 	{
-		std::vector<RootNode *>::size_type index, size;
-		size = root_nodes.size();
-		for (index = 0; index < size; ++index)
-		{
-			root_nodes[index]->node.clear();
-			delete root_nodes[index];
-		}
 	}
 
 	int RectPacker_Impl::get_total_rect_count() const
 	{
 		int count = 0;
-
-		std::vector<RootNode *>::size_type index, size;
-		size = root_nodes.size();
-		for (index = 0; index < size; ++index)
-			count += root_nodes[index]->node.get_rect_count();
-
+		for (const auto &group : groups)
+			count += group->get_rect_count();
 		return count;
 	}
 
@@ -64,51 +56,45 @@ namespace clan
 	{
 		int count = 0;
 
-		if (group_index < root_nodes.size())
-			count = root_nodes[group_index]->node.get_rect_count();
+		if (group_index < groups.size())
+			count = groups[group_index]->get_rect_count();
 
 		return count;
 	}
 
 	RectPacker::AllocatedRect RectPacker_Impl::add_new_node(const Size &rect_size)
 	{
+		if (rect_size.width <= 0 || rect_size.height <= 0)
+			throw Exception("Unable to pack rect into group: Width and height must be larger than zero");
+
 		// Try inserting in current active group
-		Node *node;
-		if (!active_root_node)
-		{
-			// Create an initial root, if it does not exist
-			node = nullptr;
-			next_node_id = 1;
-		}
-		else
-		{
-			node = active_root_node->node.insert(rect_size, next_node_id);
-		}
+		Rect rect;
+		int group_index = active_group;
+		bool found = group_index != -1 && groups[group_index]->insert(rect_size, rect);
 
-		if (node == nullptr) // Couldn't find a fit in current active group
+		if (!found) // Couldn't find a fit in current active group
 		{
-			if (allocation_policy == RectPacker::fail_if_full && root_nodes.size() > 0)
+			if (allocation_policy == RectPacker::fail_if_full && !groups.empty())
 			{
 				throw Exception("Unable to pack rect into group: full");
 			}
 
 			if (allocation_policy == RectPacker::search_previous_groups)
 			{
-				std::vector<RootNode *>::size_type index, size;
-				size = root_nodes.size();
-				for (index = 0; index < size; ++index)
+				for (group_index = 0; group_index < (int)groups.size(); ++group_index)
 				{
-					node = root_nodes[index]->node.insert(rect_size, next_node_id);
-					if (node)	// We found space in a previous group
+					found = groups[group_index]->insert(rect_size, rect);
+					if (found)	// We found space in a previous group
 						break;
 				}
 			}
 
-			if (node == nullptr) // Couldn't find a fit, so create a new group
+			if (!found) // Couldn't find a fit, so create a new group
 			{
 				if (rect_size.width <= max_group_size.width && rect_size.height <= max_group_size.height)
 				{
-					node = add_new_root()->node.insert(rect_size, next_node_id);
+					group_index = add_new_group();
+					found = groups[group_index]->insert(rect_size, rect);
 				}
 				else
 				{
@@ -116,131 +102,169 @@ namespace clan
 				}
 			}
 
-			if (node == nullptr)
+			if (!found)
 				throw Exception("Unable to pack rect into group: Unknown reason");
 		}
 
-		next_node_id++;
-
-		return RectPacker::AllocatedRect(active_root_node->group_id, node->node_rect);
+		return RectPacker::AllocatedRect(group_index, rect);
 	}
 
-	RectPacker_Impl::RootNode *RectPacker_Impl::add_new_root()
+	std::vector<RectPacker::AllocatedRect> RectPacker_Impl::add_all(const std::vector<Size> &sizes, RectPacker::SortHeuristic heuristic)
 	{
-		Node node(Rect(Point(0, 0), max_group_size));
+		// Check the sizes first, so that no groups are created for a set that cannot be packed
+		for (const Size &size : sizes)
+		{
+			if (size.width <= 0 || size.height <= 0)
+				throw Exception("Unable to pack rect into group: Width and height must be larger than zero");
+		}
 
-		active_root_node = new RootNode();
-		active_root_node->group_id = (int)root_nodes.size();
-		active_root_node->node = node;
+		if (heuristic != RectPacker::sort_best)
+			return add_sorted(sizes, sort_sizes(sizes, heuristic));
 
-		root_nodes.push_back(active_root_node);
+		struct Trial
+		{
+			std::vector<int> order;
+			std::unique_ptr<RectPacker_Impl> packer;
+			std::vector<RectPacker::AllocatedRect> allocations;
+			std::exception_ptr exception;
+		};
+
+		const RectPacker::SortHeuristic heuristics[] = { RectPacker::sort_area, RectPacker::sort_perimeter, RectPacker::sort_max_side, RectPacker::sort_height, RectPacker::sort_width };
+		const int num_heuristics = sizeof(heuristics) / sizeof(heuristics[0]);
+
+		// Pack each order into an empty packer of its own, so the trials can run in parallel
+		Trial trials[num_heuristics];
+		for (int i = 0; i < num_heuristics; i++)
+		{
+			Trial &trial = trials[i];
+			trial.order = sort_sizes(sizes, heuristics[i]);
+			trial.packer = std::make_unique<RectPacker_Impl>(max_group_size);
+			trial.packer->allocation_policy = allocation_policy;
+			trial.packer->packing_method = packing_method;
+		}
 
-		return active_root_node;
-	}
+		auto run_trials = [&](int first_trial, int trial_step)
+		{
+			for (int i = first_trial; i < num_heuristics; i += trial_step)
+			{
+				try
+				{
+					trials[i].allocations = trials[i].packer->add_sorted(sizes, trials[i].order);
+				}
+				catch (...)
+				{
+					trials[i].exception = std::current_exception();
+				}
+			}
+		};
 
-	/////////////////////////////////////////////////////////////////////////////
-	// RectPacker_Impl::Node:
+		// Starting threads costs more than packing a small set
+		int num_threads = std::min((int)std::thread::hardware_concurrency(), num_heuristics);
+		if ((int)sizes.size() < min_rects_for_threads)
+			num_threads = 1;
 
-	RectPacker_Impl::Node::Node()
-	{
-		child[0] = nullptr;
-		child[1] = nullptr;
+		std::vector<std::thread> threads;
+		for (int i = 1; i < num_threads; i++)
+			threads.push_back(std::thread(run_trials, i, num_threads));
+		run_trials(0, std::max(num_threads, 1));
 
-		id = 0;
-	}
+		for (auto &thread : threads)
+			thread.join();
 
-	RectPacker_Impl::Node::Node(const Rect &new_rect)
-	{
-		node_rect = new_rect;
+		Trial *best = nullptr;
+		for (auto &trial : trials)
+		{
+			if (!trial.exception && (!best || is_better_packing(trial.allocations, trial.packer->groups.size(), best->allocations, best->packer->groups.size())))
+				best = &trial;
+		}
 
-		child[0] = nullptr;
-		child[1] = nullptr;
+		if (!best)
+			std::rethrow_exception(trials[0].exception);
 
-		id = 0;
+		// Take over the groups of the winner when starting out empty. Otherwise redo its order on top of the existing groups
+		if (groups.empty())
+		{
+			groups = std::move(best->packer->groups);
+			active_group = best->packer->active_group;
+			return best->allocations;
+		}
+		else
+		{
+			return add_sorted(sizes, best->order);
+		}
 	}
 
-	RectPacker_Impl::Node::~Node()
+	std::vector<RectPacker::AllocatedRect> RectPacker_Impl::add_sorted(const std::vector<Size> &sizes, const std::vector<int> &order)
 	{
-		clear();
+		std::vector<RectPacker::AllocatedRect> allocations(sizes.size());
+		for (int index : order)
+			allocations[index] = add_new_node(sizes[index]);
+		return allocations;
 	}
 
-	int RectPacker_Impl::Node::get_rect_count() const
+	std::vector<int> RectPacker_Impl::sort_sizes(const std::vector<Size> &sizes, RectPacker::SortHeuristic heuristic)
 	{
-		int count = 0;
-
-		if (child[0])
-			count += child[0]->get_rect_count();
-		if (child[1])
-			count += child[1]->get_rect_count();
+		// Primary and secondary sort key for each heuristic. Larger keys are packed first
+		auto get_keys = [heuristic](const Size &size)
+		{
+			int64_t area = (int64_t)size.width * size.height;
+			int max_side = std::max(size.width, size.height);
+			int min_side = std::min(size.width, size.height);
+			switch (heuristic)
+			{
+			default:
+			case RectPacker::sort_area: return std::make_pair(area, (int64_t)max_side);
+			case RectPacker::sort_perimeter: return std::make_pair((int64_t)size.width + size.height, area);
+			case RectPacker::sort_max_side: return std::make_pair((int64_t)max_side, (int64_t)min_side);
+			case RectPacker::sort_height: return std::make_pair((int64_t)size.height, (int64_t)size.width);
+			case RectPacker::sort_width: return std::make_pair((int64_t)size.width, (int64_t)size.height);
+			}
+		};
 
-		if (id)
-			count++;
+		std::vector<std::pair<int64_t, int64_t>> keys;
+		keys.reserve(sizes.size());
+		for (const auto &size : sizes)
+			keys.push_back(get_keys(size));
 
-		return count;
+		std::vector<int> order(sizes.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a] > keys[b]; });
+		return order;
 	}
 
-	void RectPacker_Impl::Node::clear()
+	bool RectPacker_Impl::is_better_packing(const std::vector<RectPacker::AllocatedRect> &a, int a_groups, const std::vector<RectPacker::AllocatedRect> &b, int b_groups)
 	{
-		if (child[0])
-		{
-			delete child[0];
-			child[0] = nullptr;
-		}
-		if (child[1])
-		{
-			delete child[1];
-			child[1] = nullptr;
-		}
-		id = 0;
-	}
+		if (a_groups != b_groups)
+			return a_groups < b_groups;
 
-	RectPacker_Impl::Node *RectPacker_Impl::Node::insert(const Size &rect_size, int rect_id)
-	{
-		// If we're not a leaf
-		if (child[0] && child[1])
+		// Same group count. Prefer the packing whose last group has the smallest bounding box, as that is the one leaving most room to crop or fill
+		auto get_last_group_extent = [](const std::vector<RectPacker::AllocatedRect> &allocations, int last_group)
 		{
-			// Try inserting into first child
-			Node *new_node = child[0]->insert(rect_size, rect_id);
-			if (new_node != nullptr)
-				return new_node;
-
-			// No room, insert into second
-			return child[1]->insert(rect_size, rect_id);
-		}
-		else
-		{
-			// If there's already a rect here, return
-			if (id)
-				return nullptr;
-
-			// If we're too small, return
-			if (rect_size.width > node_rect.get_width() || rect_size.height > node_rect.get_height())
-				return nullptr;
-
-			// If we're just right, accept
-			if (rect_size.width == node_rect.get_width() && rect_size.height == node_rect.get_height())
+			Size extent;
+			for (const auto &allocation : allocations)
 			{
-				id = rect_id;
-				return this;
+				if (allocation.group_index == last_group)
+				{
+					extent.width = std::max(extent.width, allocation.rect.right);
+					extent.height = std::max(extent.height, allocation.rect.bottom);
+				}
 			}
+			return (int64_t)extent.width * extent.height;
+		};
 
-			// Otherwise, decide which way to split
-			int dw = node_rect.get_width() - rect_size.width;
-			int dh = node_rect.get_height() - rect_size.height;
+		return get_last_group_extent(a, a_groups - 1) < get_last_group_extent(b, b_groups - 1);
+	}
 
-			if (dw > dh)
-			{
-				child[0] = new Node(Rect(node_rect.left, node_rect.top, node_rect.left + rect_size.width, node_rect.bottom));
-				child[1] = new Node(Rect(node_rect.left + rect_size.width, node_rect.top, node_rect.right, node_rect.bottom));
-			}
-			else
-			{
-				child[0] = new Node(Rect(node_rect.left, node_rect.top, node_rect.right, node_rect.top + rect_size.height));
-				child[1] = new Node(Rect(node_rect.left, node_rect.top + rect_size.height, node_rect.right, node_rect.bottom));
-			}
+	void RectPacker_Impl::remove(const RectPacker::AllocatedRect &rect)
+	{
+		if (rect.group_index < 0 || rect.group_index >= (int)groups.size() || !groups[rect.group_index]->remove(rect.rect))
+			throw Exception("Cannot find the rect in the RectPacker");
+	}
 
-			// Insert into first child we created
-			return child[0]->insert(rect_size, rect_id);
-		}
+	int RectPacker_Impl::add_new_group()
+	{
+		groups.push_back(RectPackerBin::create(packing_method, Rect(Point(0, 0), max_group_size)));
+		active_group = (int)groups.size() - 1;
+		return active_group;
 	}
 }
@@ -29,38 +29,12 @@
 #pragma once
 
 #include "API/Core/Math/rect_packer.h"
+#include "rect_packer_bin.h"
 
 namespace clan
 {
 	class RectPacker_Impl
 	{
-	public:
-		class Node
-		{
-		public:
-			Node();
-			Node(const Rect &rect);
-			~Node();
-
-			int get_rect_count() const;
-
-			Node *insert(const Size &rect_size, int rect_id);
-
-			void clear();
-
-			Node *child[2];
-			Rect node_rect;
-
-			int id;
-		};
-
-		struct RootNode
-		{
-		public:
-			int group_id;
-			Node node;
-		};
-
 	public:
 		RectPacker_Impl(const Size &max_group_size);
 		~RectPacker_Impl();
@@ -69,15 +43,25 @@ namespace clan
 		int get_rect_count(unsigned int group_index) const;
 
 		RectPacker::AllocatedRect add_new_node(const Size &rect_size);
-		RootNode *add_new_root();
-
-		std::vector<RootNode *> root_nodes;
-		RootNode *active_root_node;
+		std::vector<RectPacker::AllocatedRect> add_all(const std::vector<Size> &sizes, RectPacker::SortHeuristic heuristic);
+		void remove(const RectPacker::AllocatedRect &rect);
+		int add_new_group();
 
-		int next_node_id;
+		std::vector<std::unique_ptr<RectPackerBin>> groups;
+		int active_group = -1;
 
 		RectPacker::AllocationPolicy allocation_policy;
+		RectPacker::PackingMethod packing_method = RectPacker::guillotine;
 
 		Size max_group_size;
+
+	private:
+		/// \brief Fewer rects than this are packed by add_all() without starting any threads
+		static const int min_rects_for_threads = 64;
+
+		std::vector<RectPacker::AllocatedRect> add_sorted(const std::vector<Size> &sizes, const std::vector<int> &order);
+
+		static std::vector<int> sort_sizes(const std::vector<Size> &sizes, RectPacker::SortHeuristic heuristic);
+		static bool is_better_packing(const std::vector<RectPacker::AllocatedRect> &a, int a_groups, const std::vector<RectPacker::AllocatedRect> &b, int b_groups);
 	};
 }
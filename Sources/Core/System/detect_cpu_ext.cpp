@@ -28,44 +28,33 @@
 
 #include "Core/precomp.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/cpu_features.h"
+
+#if (defined(WIN32) || defined(_WIN32) || defined(_WIN64)) && !defined __MINGW32__ && !defined(ARM_PLATFORM) && !defined(CL_ARM)
+#include <intrin.h>
+#endif
 
 namespace clan
 {
+	std::atomic<unsigned int> CPUFeatures::generation(0);
 
-#if defined(ARM_PLATFORM) || defined(CL_ARM) || defined(__sun) || defined(__riscv) || defined(__loongarch__)
-	bool System::detect_cpu_extension(CPU_ExtensionPPC ext)
+	CPUFeatures &CPUFeatures::instance()
 	{
-		throw ("Congratulations, you've just been selected to code this feature!");
+		static CPUFeatures features;
+		return features;
 	}
 
-	bool System::detect_cpu_extension(CPU_ExtensionX86 ext)
+	const CPUFeatures &CPUFeatures::get()
 	{
-		return false;
+		return instance();
 	}
-#else
-
-#if (defined(WIN32) || defined(_WIN32) || defined(_WIN64)) && !defined __MINGW32__
-#include <intrin.h>
-#endif
-#ifdef __GNUC__
-
-
-#ifdef __amd64__
-
-#define __cpuid(out, infoType)\
-	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
-#else
-
-#define __cpuid(out, infoType) \
-	asm volatile(	"pushl %%ebx \n" \
-			"cpuid \n" \
-			"movl %%ebx, %1 \n" \
-			"popl %%ebx" \
-		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
-
-#endif
 
-#endif
+	void CPUFeatures::set_disabled_extensions(unsigned long long disabled_mask)
+	{
+		CPUFeatures &features = instance();
+		features.extensions = features.detected & ~disabled_mask;
+		generation.fetch_add(1, std::memory_order_relaxed);
+	}
 
 	bool System::detect_cpu_extension(CPU_ExtensionPPC ext)
 	{
@@ -74,116 +63,117 @@ namespace clan
 
 	bool System::detect_cpu_extension(CPU_ExtensionX86 ext)
 	{
-		unsigned int cpuinfo[4] = { 0 };
-
-		if (ext == mmx)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[3] & (1 << 23)) != 0);
-		}
-		else if (ext == mmx_ex)
-		{
-			__cpuid((int*)cpuinfo, 0x80000000);
-			if (cpuinfo[0] < 0x80000001)
-				return false;
+		return CPUFeatures::get().has(ext);
+	}
 
-			__cpuid((int*)cpuinfo, 0x80000001);
-			return ((cpuinfo[3] & (1 << 22)) != 0);
-		}
-		else if (ext == _3d_now)
-		{
-			__cpuid((int*)cpuinfo, 0x80000000);
-			if (cpuinfo[0] < 0x80000001)
-				return false;
+#if defined(ARM_PLATFORM) || defined(CL_ARM) || defined(__sun) || defined(__riscv) || defined(__loongarch__)
 
-			__cpuid((int*)cpuinfo, 0x80000001);
-			return ((cpuinfo[3] & (1 << 31)) != 0);
-		}
-		else if (ext == _3d_now_ex)
-		{
-			__cpuid((int*)cpuinfo, 0x80000000);
-			if (cpuinfo[0] < 0x80000001)
-				return false;
+	CPUFeatures::CPUFeatures()
+	{
+	}
 
-			__cpuid((int*)cpuinfo, 0x80000001);
-			return ((cpuinfo[3] & (1 << 30)) != 0);
-		}
-		else if (ext == sse)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[3] & (1 << 25)) != 0);
-		}
-		else if (ext == sse2)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[3] & (1 << 26)) != 0);
-		}
-		else if (ext == sse3)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 0)) != 0);
-		}
-		else if (ext == ssse3)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 9)) != 0);
-		}
+#else
 
-		else if (ext == sse4_a)
-		{
-			__cpuid((int*)cpuinfo, 0x80000000);
-			if (cpuinfo[0] < 0x80000001)
-				return false;
+	static void cpuid(unsigned int out[4], unsigned int leaf, unsigned int subleaf = 0)
+	{
+#if (defined(WIN32) || defined(_WIN32) || defined(_WIN64)) && !defined __MINGW32__
+		__cpuidex((int*)out, leaf, subleaf);
+#elif defined __amd64__
+		asm("cpuid" : "=a" (out[0]), "=b" (out[1]), "=c" (out[2]), "=d" (out[3]) : "a" (leaf), "c" (subleaf));
+#else
+		asm volatile(	"pushl %%ebx \n"
+				"cpuid \n"
+				"movl %%ebx, %1 \n"
+				"popl %%ebx"
+			: "=a" (out[0]), "=r" (out[1]), "=c" (out[2]), "=d" (out[3]) : "a" (leaf), "c" (subleaf));
+#endif
+	}
 
-			__cpuid((int*)cpuinfo, 0x80000001);
-			return ((cpuinfo[2] & (1 << 6)) != 0);
-		}
-		else if (ext == sse4_1)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 19)) != 0);
-		}
-		else if (ext == sse4_2)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 20)) != 0);
-		}
-		else if (ext == xop)
-		{
-			__cpuid((int*)cpuinfo, 0x80000000);
-			if (cpuinfo[0] < 0x80000001)
-				return false;
+	static unsigned long long read_xcr0()
+	{
+#if (defined(WIN32) || defined(_WIN32) || defined(_WIN64)) && !defined __MINGW32__
+		return _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		asm volatile("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+		return ((unsigned long long)edx << 32) | eax;
+#endif
+	}
 
-			__cpuid((int*)cpuinfo, 0x80000001);
-			return ((cpuinfo[2] & (1 << 11)) != 0);
-		}
-		else if (ext == avx)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 28)) != 0);
-		}
-		else if (ext == aes)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 25)) != 0);
-		}
-		else if (ext == fma3)
-		{
-			__cpuid((int*)cpuinfo, 0x1);
-			return ((cpuinfo[2] & (1 << 12)) != 0);
-		}
-		else if (ext == fma4)
-		{
-			__cpuid((int*)cpuinfo, 0x80000000);
-			if (cpuinfo[0] < 0x80000001)
-				return false;
+	CPUFeatures::CPUFeatures()
+	{
+		unsigned int cpuinfo[4] = { 0 };
 
-			__cpuid((int*)cpuinfo, 0x80000001);
-			return ((cpuinfo[2] & (1 << 16)) != 0);
-		}
-		return false;
+		cpuid(cpuinfo, 0);
+		unsigned int max_leaf = cpuinfo[0];
+
+		cpuid(cpuinfo, 0x80000000);
+		unsigned int max_extended_leaf = cpuinfo[0];
+
+		unsigned int leaf1_ecx = 0, leaf1_edx = 0;
+		if (max_leaf >= 1)
+		{
+			cpuid(cpuinfo, 1);
+			leaf1_ecx = cpuinfo[2];
+			leaf1_edx = cpuinfo[3];
+		}
+
+		unsigned int leaf7_ebx = 0;
+		if (max_leaf >= 7)
+		{
+			cpuid(cpuinfo, 7, 0);
+			leaf7_ebx = cpuinfo[1];
+		}
+
+		unsigned int extended_ecx = 0, extended_edx = 0;
+		if (max_extended_leaf >= 0x80000001)
+		{
+			cpuid(cpuinfo, 0x80000001);
+			extended_ecx = cpuinfo[2];
+			extended_edx = cpuinfo[3];
+		}
+
+		// Instructions using the YMM and ZMM registers also need the operating system to save them on context switches
+		bool osxsave = (leaf1_ecx & (1 << 27)) != 0;
+		unsigned long long xcr0 = osxsave ? read_xcr0() : 0;
+		bool os_avx = (xcr0 & 0x6) == 0x6;
+		bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+		auto set = [&](System::CPU_ExtensionX86 ext, bool supported)
+		{
+			if (supported)
+				extensions |= mask(ext);
+		};
+
+		set(System::mmx, (leaf1_edx & (1 << 23)) != 0);
+		set(System::mmx_ex, (extended_edx & (1 << 22)) != 0);
+		set(System::_3d_now, (extended_edx & (1u << 31)) != 0);
+		set(System::_3d_now_ex, (extended_edx & (1 << 30)) != 0);
+		set(System::sse, (leaf1_edx & (1 << 25)) != 0);
+		set(System::sse2, (leaf1_edx & (1 << 26)) != 0);
+		set(System::sse3, (leaf1_ecx & (1 << 0)) != 0);
+		set(System::ssse3, (leaf1_ecx & (1 << 9)) != 0);
+		set(System::sse4_a, (extended_ecx & (1 << 6)) != 0);
+		set(System::sse4_1, (leaf1_ecx & (1 << 19)) != 0);
+		set(System::sse4_2, (leaf1_ecx & (1 << 20)) != 0);
+		set(System::xop, os_avx && (extended_ecx & (1 << 11)) != 0);
+		set(System::avx, os_avx && (leaf1_ecx & (1 << 28)) != 0);
+		set(System::aes, (leaf1_ecx & (1 << 25)) != 0);
+		set(System::fma3, os_avx && (leaf1_ecx & (1 << 12)) != 0);
+		set(System::fma4, os_avx && (extended_ecx & (1 << 16)) != 0);
+		set(System::f16c, os_avx && (leaf1_ecx & (1 << 29)) != 0);
+		set(System::avx2, os_avx && (leaf7_ebx & (1 << 5)) != 0);
+		set(System::avx512f, os_avx512 && (leaf7_ebx & (1 << 16)) != 0);
+		set(System::avx512bw, os_avx512 && (leaf7_ebx & (1 << 30)) != 0);
+		set(System::pclmul, (leaf1_ecx & (1 << 1)) != 0);
+		set(System::sha, (leaf7_ebx & (1 << 29)) != 0);
+		set(System::bmi1, (leaf7_ebx & (1 << 3)) != 0);
+		set(System::bmi2, (leaf7_ebx & (1 << 8)) != 0);
+		set(System::popcnt, (leaf1_ecx & (1 << 23)) != 0);
+		set(System::osxsave, osxsave);
+
+		detected = extensions;
 	}
 
 #endif
-
 }
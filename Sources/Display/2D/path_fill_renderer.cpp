@@ -203,7 +203,7 @@ namespace clan
 		instance_buffer.unlock();
 
 		int gpu_index;
-		VertexArrayVector<Vec4i> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
+		VertexArrayVector<Vec4i> gpu_vertices(batch_buffer->upload_vertices(gc, vertices.get_position() * sizeof(Vec4i), gpu_index));
 
 		if (prim_array[gpu_index].is_null())
 		{
@@ -211,8 +211,6 @@ namespace clan
 			prim_array[gpu_index].set_attributes(0, gpu_vertices);
 		}
 
-		gpu_vertices.upload_data(gc, 0, vertices.get_vertices(), vertices.get_position());
-
 		int block_y = (((mask_blocks.next_block-1) * mask_block_size) / mask_texture_size)* mask_block_size;
 		mask_texture.set_subimage(gc, 0, 0, mask_buffer, Rect(Point(0, 0), Size(mask_texture_size, block_y + mask_block_size)));
 
@@ -232,6 +230,7 @@ namespace clan
 		if (!current_texture.is_null())
 			gc.set_texture(2, current_texture);
 		gc.draw_primitives(PrimitivesType::triangles, vertices.get_position(), prim_array[gpu_index]);
+		batch_buffer->vertices_drawn(gc, gpu_index);
 		if (!current_texture.is_null())
 		{
 			gc.reset_texture(2);
@@ -266,7 +265,7 @@ namespace clan
 			instance_buffer.lock(gc, BufferAccess::write_discard);
 
 			instances.reset(gc, instance_buffer.get_data<Vec4f>(), instance_buffer_width * instance_buffer_height);
-			vertices.reset((Vec4i *)batch_buffer->buffer, max_vertices);
+			vertices.reset((Vec4i *)batch_buffer->get_vertex_data(gc), max_vertices);
 
 			mask_blocks.reset(mask_buffer.get_data_uint8(), mask_buffer.get_pitch());
 		}
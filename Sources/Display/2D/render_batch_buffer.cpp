@@ -32,6 +32,7 @@
 #include "sprite_impl.h"
 #include "API/Display/Render/blend_state_description.h"
 #include "API/Display/2D/canvas.h"
+#include "API/Display/TargetProviders/vertex_array_buffer_provider.h"
 
 namespace clan
 {
@@ -43,9 +44,22 @@ namespace clan
 		}
 	}
 
-	VertexArrayBuffer RenderBatchBuffer::get_vertex_buffer(GraphicContext &gc, int &out_index)
+	char *RenderBatchBuffer::get_vertex_data(GraphicContext &gc)
+	{
+		if (!current_vertex_data)
+		{
+			current_vertex_data = static_cast<char*>(vertex_buffers[current_vertex_buffer].get_provider()->map_stream(gc));
+			if (!current_vertex_data)
+				current_vertex_data = buffer;
+		}
+		return current_vertex_data;
+	}
+
+	VertexArrayBuffer RenderBatchBuffer::upload_vertices(GraphicContext &gc, int size, int &out_index)
 	{
 		out_index = current_vertex_buffer;
+		vertex_buffers[out_index].get_provider()->upload_stream(gc, get_vertex_data(gc), size);
+		current_vertex_data = nullptr;
 
 		current_vertex_buffer++;
 		if (current_vertex_buffer == num_vertex_buffers)
@@ -54,6 +68,11 @@ namespace clan
 		return vertex_buffers[out_index];
 	}
 
+	void RenderBatchBuffer::vertices_drawn(GraphicContext &gc, int index)
+	{
+		vertex_buffers[index].get_provider()->fence_stream(gc);
+	}
+
 	Texture2D RenderBatchBuffer::get_texture_rgba32f(GraphicContext &gc)
 	{
 		current_rgba32f_texture++;
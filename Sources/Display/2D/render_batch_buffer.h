@@ -43,7 +43,17 @@ namespace clan
 	public:
 		RenderBatchBuffer(GraphicContext &gc);
 
-		VertexArrayBuffer get_vertex_buffer(GraphicContext &gc, int &out_index);
+		/// Returns where the active batcher writes its vertices
+		///
+		/// This is mapped vertex buffer memory when the target supports it, otherwise the vertices are copied at upload_vertices()
+		char *get_vertex_data(GraphicContext &gc);
+
+		/// Makes the vertices written to get_vertex_data() available to the GPU and returns the buffer holding them
+		VertexArrayBuffer upload_vertices(GraphicContext &gc, int size, int &out_index);
+
+		/// Must be called after the draw commands using the vertices from upload_vertices() have been issued
+		void vertices_drawn(GraphicContext &gc, int index);
+
 		Texture2D get_texture_rgba32f(GraphicContext &gc);
 		Texture2D get_texture_r8(GraphicContext &gc);
 		TransferTexture get_transfer_rgba32f(GraphicContext &gc);
@@ -62,6 +72,7 @@ namespace clan
 	private:
 		VertexArrayBuffer vertex_buffers[num_vertex_buffers];
 		int current_vertex_buffer = 0;
+		char *current_vertex_data = nullptr;
 
 		Texture2D textures_rgba32f[num_rgba32f_buffers];
 		int current_rgba32f_texture = 0;
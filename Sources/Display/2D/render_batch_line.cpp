@@ -37,7 +37,6 @@ namespace clan
 	RenderBatchLine::RenderBatchLine(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
 		: batch_buffer(batch_buffer), position(0)
 	{
-		vertices = (LineVertex *)batch_buffer->buffer;
 	}
 
 	inline Vec4f RenderBatchLine::to_position(float x, float y) const
@@ -106,6 +105,7 @@ namespace clan
 			throw Exception("Too many vertices for RenderBatchLine");
 
 		canvas.set_batcher(this);
+		vertices = (LineVertex *)batch_buffer->get_vertex_data(canvas.get_gc());
 	}
 
 	void RenderBatchLine::flush(GraphicContext &gc)
@@ -115,7 +115,7 @@ namespace clan
 			gc.set_program_object(StandardProgram::color_only);
 
 			int gpu_index;
-			VertexArrayVector<LineVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
+			VertexArrayVector<LineVertex> gpu_vertices(batch_buffer->upload_vertices(gc, position * sizeof(LineVertex), gpu_index));
 
 			if (prim_array[gpu_index].is_null())
 			{
@@ -124,9 +124,8 @@ namespace clan
 				prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(LineVertex, color));
 			}
 
-			gpu_vertices.upload_data(gc, 0, vertices, position);
-
 			gc.draw_primitives(PrimitivesType::lines, position, prim_array[gpu_index]);
+			batch_buffer->vertices_drawn(gc, gpu_index);
 
 			gc.reset_program_object();
 
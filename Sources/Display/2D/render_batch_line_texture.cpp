@@ -37,7 +37,6 @@ namespace clan
 	RenderBatchLineTexture::RenderBatchLineTexture(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
 		: batch_buffer(batch_buffer)
 	{
-		vertices = (LineTextureVertex *)batch_buffer->buffer;
 	}
 
 	inline Vec4f RenderBatchLineTexture::to_position(float x, float y) const
@@ -91,6 +90,7 @@ namespace clan
 		current_texture = texture;
 
 		canvas.set_batcher(this);
+		vertices = (LineTextureVertex *)batch_buffer->get_vertex_data(canvas.get_gc());
 	}
 
 	void RenderBatchLineTexture::flush(GraphicContext &gc)
@@ -100,7 +100,7 @@ namespace clan
 			gc.set_program_object(StandardProgram::single_texture);
 
 			int gpu_index;
-			VertexArrayVector<LineTextureVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
+			VertexArrayVector<LineTextureVertex> gpu_vertices(batch_buffer->upload_vertices(gc, position * sizeof(LineTextureVertex), gpu_index));
 
 			if (prim_array[gpu_index].is_null())
 			{
@@ -110,12 +110,10 @@ namespace clan
 				prim_array[gpu_index].set_attributes(2, gpu_vertices, cl_offsetof(LineTextureVertex, texcoord));
 			}
 
-
-			gpu_vertices.upload_data(gc, 0, vertices, position);
-
 			gc.set_texture(0, current_texture);
 
 			gc.draw_primitives(PrimitivesType::lines, position, prim_array[gpu_index]);
+			batch_buffer->vertices_drawn(gc, gpu_index);
 
 			gc.reset_program_object();
 
@@ -58,7 +58,7 @@ namespace clan
 		void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
 
 		enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(LineTextureVertex) };
-		LineTextureVertex *vertices;
+		LineTextureVertex *vertices = nullptr;
 		RenderBatchBuffer *batch_buffer;
 
 		PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
@@ -37,7 +37,6 @@ namespace clan
 	RenderBatchPoint::RenderBatchPoint(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
 		: batch_buffer(batch_buffer)
 	{
-		vertices = (PointVertex *)batch_buffer->buffer;
 	}
 
 	void RenderBatchPoint::draw_point(Canvas &canvas, Vec2f *line_positions, const Vec4f &point_color, int num_vertices)
@@ -71,6 +70,7 @@ namespace clan
 			throw Exception("Too many vertices for RenderBatchPoint");
 
 		canvas.set_batcher(this);
+		vertices = (PointVertex *)batch_buffer->get_vertex_data(canvas.get_gc());
 	}
 
 	void RenderBatchPoint::flush(GraphicContext &gc)
@@ -80,7 +80,7 @@ namespace clan
 			gc.set_program_object(StandardProgram::color_only);
 
 			int gpu_index;
-			VertexArrayVector<PointVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
+			VertexArrayVector<PointVertex> gpu_vertices(batch_buffer->upload_vertices(gc, position * sizeof(PointVertex), gpu_index));
 
 			if (prim_array[gpu_index].is_null())
 			{
@@ -89,9 +89,8 @@ namespace clan
 				prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(PointVertex, color));
 			}
 
-			gpu_vertices.upload_data(gc, 0, vertices, position);
-
 			gc.draw_primitives(PrimitivesType::points, position, prim_array[gpu_index]);
+			batch_buffer->vertices_drawn(gc, gpu_index);
 
 			gc.reset_program_object();
 
@@ -33,6 +33,7 @@
 #include "API/Display/Render/blend_state_description.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Core/Math/quad.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -43,7 +44,6 @@ namespace clan
 	RenderBatchTriangle::RenderBatchTriangle(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
 		: batch_buffer(batch_buffer)
 	{
-		vertices = (SpriteVertex *)batch_buffer->buffer;
 	}
 
 	void RenderBatchTriangle::draw_sprite(Canvas &canvas, const Pointf texture_position[4], const Pointf dest_position[4], const Texture2D &texture, const Colorf &color)
@@ -187,8 +187,18 @@ namespace clan
 
 	void RenderBatchTriangle::draw_glyph_subpixel(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture)
 	{
-		int texindex = set_batcher_active(canvas, texture, true, color);
+		int texindex = set_batcher_active(canvas, texture, BatchProgram::glyph_subpixel, color);
+		add_glyph_quad(src, dest, StandardColorf::white(), texindex);
+	}
 
+	void RenderBatchTriangle::draw_glyph_distance_field(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture)
+	{
+		int texindex = set_batcher_active(canvas, texture, BatchProgram::glyph_distance_field);
+		add_glyph_quad(src, dest, color, texindex);
+	}
+
+	void RenderBatchTriangle::add_glyph_quad(const Rectf &src, const Rectf &dest, const Colorf &color, int texindex)
+	{
 		vertices[position + 0].position = to_position(dest.left, dest.top);
 		vertices[position + 1].position = to_position(dest.right, dest.top);
 		vertices[position + 2].position = to_position(dest.left, dest.bottom);
@@ -205,14 +215,65 @@ namespace clan
 		vertices[position + 3].texcoord = Vec2f(src_right, src_top);
 		vertices[position + 4].texcoord = Vec2f(src_right, src_bottom);
 		vertices[position + 5].texcoord = Vec2f(src_left, src_bottom);
+
 		for (int i = 0; i < 6; i++)
 		{
-			vertices[position + i].color = Vec4f(1.0f, 1.0f, 1.0f, 1.0f);
+			vertices[position + i].color = Vec4f(color.r, color.g, color.b, color.a);
 			vertices[position + i].texindex = texindex;
 		}
 		position += 6;
 	}
 
+	void RenderBatchTriangle::draw_glyph_run(Canvas &canvas, const Pointf &origin, const Colorf &color, BatchProgram program, const Texture2D &texture, const GlyphQuad *quads, int num_quads)
+	{
+		// Subpixel glyphs take the text color from the blend constant
+		Colorf batch_color = program == BatchProgram::glyph_subpixel ? color : StandardColorf::black();
+		Vec4f vertex_color = program == BatchProgram::glyph_subpixel ? Vec4f(1.0f) : Vec4f(color.r, color.g, color.b, color.a);
+
+		while (num_quads > 0)
+		{
+			int texindex = set_batcher_active(canvas, texture, program, batch_color);
+			int count = std::min(num_quads, (max_vertices - position) / 6);
+
+			// The transform is affine in x and y, so the corners are found by stepping along the transformed axes
+			Vec4f base = to_position(origin.x, origin.y);
+			const float *m = modelview_projection_matrix.matrix;
+			Vec4f axis_x(m[0], m[1], m[2], m[3]);
+			Vec4f axis_y(m[4], m[5], m[6], m[7]);
+
+			SpriteVertex *v = vertices + position;
+			for (int i = 0; i < count; i++, v += 6)
+			{
+				const GlyphQuad &quad = quads[i];
+				Vec4f top_left = base + axis_x * quad.dest.left + axis_y * quad.dest.top;
+				Vec4f top_right = top_left + axis_x * quad.dest.get_width();
+				Vec4f bottom_left = top_left + axis_y * quad.dest.get_height();
+				Vec4f bottom_right = top_right + axis_y * quad.dest.get_height();
+
+				v[0].position = top_left;
+				v[1].position = top_right;
+				v[2].position = bottom_left;
+				v[3].position = top_right;
+				v[4].position = bottom_right;
+				v[5].position = bottom_left;
+				v[0].texcoord = Vec2f(quad.texcoord.left, quad.texcoord.top);
+				v[1].texcoord = Vec2f(quad.texcoord.right, quad.texcoord.top);
+				v[2].texcoord = Vec2f(quad.texcoord.left, quad.texcoord.bottom);
+				v[3].texcoord = v[1].texcoord;
+				v[4].texcoord = Vec2f(quad.texcoord.right, quad.texcoord.bottom);
+				v[5].texcoord = v[2].texcoord;
+				for (int j = 0; j < 6; j++)
+				{
+					v[j].color = vertex_color;
+					v[j].texindex = texindex;
+				}
+			}
+			position += count * 6;
+			quads += count;
+			num_quads -= count;
+		}
+	}
+
 	void RenderBatchTriangle::fill(Canvas &canvas, float x1, float y1, float x2, float y2, const Colorf &color)
 	{
 		int texindex = set_batcher_active(canvas);
@@ -242,12 +303,12 @@ namespace clan
 	}
 
 
-	int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color)
+	int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, BatchProgram program, const Colorf &new_constant_color)
 	{
-		if (use_glyph_program != glyph_program || constant_color != new_constant_color)
+		if (current_program != program || constant_color != new_constant_color)
 		{
 			canvas.flush();
-			use_glyph_program = glyph_program;
+			current_program = program;
 			constant_color = new_constant_color;
 		}
 
@@ -276,29 +337,31 @@ namespace clan
 			tex_sizes[texindex] = Sizef((float)current_textures[texindex].get_width(), (float)current_textures[texindex].get_height());
 		}
 		canvas.set_batcher(this);
+		vertices = (SpriteVertex *)batch_buffer->get_vertex_data(canvas.get_gc());
 		return texindex;
 	}
 
 	int RenderBatchTriangle::set_batcher_active(Canvas &canvas)
 	{
-		if (use_glyph_program != false)
+		if (current_program != BatchProgram::sprite)
 		{
 			canvas.flush();
-			use_glyph_program = false;
+			current_program = BatchProgram::sprite;
 		}
 
 		if (position == 0 || position + 6 > max_vertices)
 			canvas.flush();
 		canvas.set_batcher(this);
+		vertices = (SpriteVertex *)batch_buffer->get_vertex_data(canvas.get_gc());
 		return RenderBatchTriangle::max_textures;
 	}
 
 	int RenderBatchTriangle::set_batcher_active(Canvas &canvas, int num_vertices)
 	{
-		if (use_glyph_program != false)
+		if (current_program != BatchProgram::sprite)
 		{
 			canvas.flush();
-			use_glyph_program = false;
+			current_program = BatchProgram::sprite;
 		}
 
 		if (position + num_vertices > max_vertices)
@@ -308,6 +371,7 @@ namespace clan
 			throw Exception("Too many vertices for RenderBatchTriangle");
 
 		canvas.set_batcher(this);
+		vertices = (SpriteVertex *)batch_buffer->get_vertex_data(canvas.get_gc());
 		return RenderBatchTriangle::max_textures;
 	}
 
@@ -315,10 +379,10 @@ namespace clan
 	{
 		if (position > 0)
 		{
-			gc.set_program_object(StandardProgram::sprite);
+			gc.set_program_object(current_program == BatchProgram::glyph_distance_field ? StandardProgram::distance_field_glyph : StandardProgram::sprite);
 
 			int gpu_index;
-			VertexArrayVector<SpriteVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
+			VertexArrayVector<SpriteVertex> gpu_vertices(batch_buffer->upload_vertices(gc, position * sizeof(SpriteVertex), gpu_index));
 
 			if (prim_array[gpu_index].is_null())
 			{
@@ -336,12 +400,10 @@ namespace clan
 				}
 			}
 
-			gpu_vertices.upload_data(gc, 0, vertices, position);
-
 			for (int i = 0; i < num_current_textures; i++)
 				gc.set_texture(i, current_textures[i]);
 
-			if (use_glyph_program)
+			if (current_program == BatchProgram::glyph_subpixel)
 			{
 				gc.set_blend_state(glyph_blend, constant_color);
 				gc.draw_primitives(PrimitivesType::triangles, position, prim_array[gpu_index]);
@@ -351,6 +413,7 @@ namespace clan
 			{
 				gc.draw_primitives(PrimitivesType::triangles, position, prim_array[gpu_index]);
 			}
+			batch_buffer->vertices_drawn(gc, gpu_index);
 
 			for (int i = 0; i < num_current_textures; i++)
 				gc.reset_texture(i);
@@ -50,12 +50,30 @@ namespace clan
 		void draw_image(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture);
 		void draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2D &texture);
 		void draw_glyph_subpixel(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture);
+		void draw_glyph_distance_field(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture);
 		void fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Vec4f *triangle_colors, int num_vertices);
 		void fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Colorf &color, int num_vertices);
 		void fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf &color);
 		void fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf *colors);
 		void fill(Canvas &canvas, float x1, float y1, float x2, float y2, const Colorf &color);
 
+		enum class BatchProgram
+		{
+			sprite,
+			glyph_subpixel,
+			glyph_distance_field
+		};
+
+		/// \brief Glyph rectangle relative to the origin of a glyph run, with texture coordinates in the 0-1 range
+		struct GlyphQuad
+		{
+			Rectf dest;
+			Rectf texcoord;
+		};
+
+		/// \brief Append glyphs sharing a texture, positioned relative to the origin
+		void draw_glyph_run(Canvas &canvas, const Pointf &origin, const Colorf &color, BatchProgram program, const Texture2D &texture, const GlyphQuad *quads, int num_quads);
+
 	public:
 		static int max_textures;	// For use by the GL1 target, so it can reduce the number of textures
 
@@ -68,7 +86,8 @@ namespace clan
 			int texindex;
 		};
 
-		int set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = StandardColorf::black());
+		int set_batcher_active(Canvas &canvas, const Texture2D &texture, BatchProgram program = BatchProgram::sprite, const Colorf &constant_color = StandardColorf::black());
+		void add_glyph_quad(const Rectf &src, const Rectf &dest, const Colorf &color, int texindex);
 		int set_batcher_active(Canvas &canvas);
 		int set_batcher_active(Canvas &canvas, int num_vertices);
 		void flush(GraphicContext &gc) override;
@@ -80,7 +99,7 @@ namespace clan
 		Mat4f modelview_projection_matrix;
 		int position = 0;
 		enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(SpriteVertex) };
-		SpriteVertex *vertices;
+		SpriteVertex *vertices = nullptr;
 
 		RenderBatchBuffer *batch_buffer;
 
@@ -91,7 +110,7 @@ namespace clan
 		Texture2D current_textures[max_number_of_texture_coords];
 		int num_current_textures = 0;
 		Sizef tex_sizes[max_number_of_texture_coords];
-		bool use_glyph_program = false;
+		BatchProgram current_program = BatchProgram::sprite;
 		Colorf constant_color;
 		BlendState glyph_blend;
 	};
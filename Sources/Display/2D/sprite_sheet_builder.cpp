@@ -0,0 +1,226 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/2D/sprite_sheet_builder.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/ImageProviders/png_provider.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/Text/string_help.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace clan
+{
+	class SpriteSheetBuilder_Impl
+	{
+	public:
+		Size page_size;
+		int padding = 1;
+		RectPacker::PackingMethod packing_method = RectPacker::max_rects;
+
+		std::vector<PixelBuffer> images;
+		std::vector<SpriteSheetBuilder::Frame> frames;
+		std::vector<PixelBuffer> pages;
+
+		static std::string get_page_resource_name(const std::string &page_filename_prefix, int page);
+		static std::string escape_xml(const std::string &text);
+	};
+
+	SpriteSheetBuilder::SpriteSheetBuilder()
+	{
+	}
+
+	SpriteSheetBuilder::SpriteSheetBuilder(const Size &page_size, int padding, RectPacker::PackingMethod packing_method)
+		: impl(std::make_shared<SpriteSheetBuilder_Impl>())
+	{
+		impl->page_size = page_size;
+		impl->padding = padding;
+		impl->packing_method = packing_method;
+	}
+
+	SpriteSheetBuilder::~SpriteSheetBuilder()
+	{
+	}
+
+	void SpriteSheetBuilder::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("SpriteSheetBuilder is null");
+	}
+
+	void SpriteSheetBuilder::add_frame(const std::string &sprite_name, const PixelBuffer &image)
+	{
+		image.throw_if_null();
+		if (image.is_gpu())
+			throw Exception("SpriteSheetBuilder only accepts images in system memory");
+
+		SpriteSheetBuilder::Frame frame;
+		frame.sprite_name = sprite_name;
+		frame.rect = Rect(Point(0, 0), image.get_size());
+
+		impl->images.push_back(image);
+		impl->frames.push_back(frame);
+	}
+
+	void SpriteSheetBuilder::build(RectPacker::SortHeuristic heuristic)
+	{
+		// Reserve the padding on the right and bottom of each frame. The page edge provides it on the left and top
+		std::vector<Size> sizes;
+		sizes.reserve(impl->images.size());
+		for (const auto &image : impl->images)
+			sizes.push_back(Size(image.get_width() + impl->padding, image.get_height() + impl->padding));
+
+		RectPacker packer(Size(impl->page_size.width + impl->padding, impl->page_size.height + impl->padding), RectPacker::search_previous_groups, impl->packing_method);
+		std::vector<RectPacker::AllocatedRect> allocations = packer.add_all(sizes, heuristic);
+
+		std::vector<Size> page_extents(packer.get_group_count());
+		for (size_t i = 0; i < allocations.size(); i++)
+		{
+			Frame &frame = impl->frames[i];
+			frame.page = allocations[i].group_index;
+			frame.rect = Rect(allocations[i].rect.get_top_left(), impl->images[i].get_size());
+
+			Size &extent = page_extents[frame.page];
+			extent.width = std::max(extent.width, frame.rect.right);
+			extent.height = std::max(extent.height, frame.rect.bottom);
+		}
+
+		impl->pages.clear();
+		for (const auto &extent : page_extents)
+		{
+			PixelBuffer page(extent.width, extent.height, TextureFormat::rgba8);
+			memset(page.get_data(), 0, page.get_data_size());
+			impl->pages.push_back(page);
+		}
+
+		for (size_t i = 0; i < impl->frames.size(); i++)
+		{
+			const PixelBuffer &image = impl->images[i];
+			impl->pages[impl->frames[i].page].set_subimage(image, impl->frames[i].rect.get_top_left(), Rect(Point(0, 0), image.get_size()));
+		}
+	}
+
+	std::vector<PixelBuffer> SpriteSheetBuilder::get_pages() const
+	{
+		return impl->pages;
+	}
+
+	std::vector<SpriteSheetBuilder::Frame> SpriteSheetBuilder::get_frames() const
+	{
+		return impl->frames;
+	}
+
+	std::string SpriteSheetBuilder::get_resource_description(const std::string &page_filename_prefix) const
+	{
+		// Frames of the same sprite are collected in the order they were added
+		std::vector<std::string> sprite_names;
+		std::map<std::string, std::vector<const Frame *>> sprite_frames;
+		for (const auto &frame : impl->frames)
+		{
+			auto &frames = sprite_frames[frame.sprite_name];
+			if (frames.empty())
+				sprite_names.push_back(frame.sprite_name);
+			frames.push_back(&frame);
+		}
+
+		std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<resources>\n";
+
+		// Each page is a texture resource of its own, which the sprites refer to. A display cache then loads every page only once
+		for (size_t i = 0; i < impl->pages.size(); i++)
+		{
+			std::string filename = page_filename_prefix + "_" + StringHelp::int_to_text(i) + ".png";
+			xml += "\t<texture name=\"" + SpriteSheetBuilder_Impl::escape_xml(SpriteSheetBuilder_Impl::get_page_resource_name(page_filename_prefix, (int)i)) + "\" ";
+			xml += "file=\"" + SpriteSheetBuilder_Impl::escape_xml(filename) + "\" />\n";
+		}
+
+		for (const auto &sprite_name : sprite_names)
+		{
+			xml += "\t<sprite name=\"" + SpriteSheetBuilder_Impl::escape_xml(sprite_name) + "\">\n";
+
+			// One image element per run of frames on the same page
+			const auto &frames = sprite_frames[sprite_name];
+			for (size_t i = 0; i < frames.size(); i++)
+			{
+				if (i == 0 || frames[i]->page != frames[i - 1]->page)
+				{
+					if (i != 0)
+						xml += "\t\t</image>\n";
+					xml += "\t\t<image texture=\"" + SpriteSheetBuilder_Impl::escape_xml(SpriteSheetBuilder_Impl::get_page_resource_name(page_filename_prefix, frames[i]->page)) + "\">\n";
+				}
+
+				const Rect &rect = frames[i]->rect;
+				xml += "\t\t\t<grid pos=\"" + StringHelp::int_to_text(rect.left) + "," + StringHelp::int_to_text(rect.top) + "\" ";
+				xml += "size=\"" + StringHelp::int_to_text(rect.get_width()) + "," + StringHelp::int_to_text(rect.get_height()) + "\" />\n";
+			}
+			if (!frames.empty())
+				xml += "\t\t</image>\n";
+
+			xml += "\t</sprite>\n";
+		}
+		xml += "</resources>\n";
+		return xml;
+	}
+
+	void SpriteSheetBuilder::save(const std::string &directory, const std::string &name) const
+	{
+		for (size_t i = 0; i < impl->pages.size(); i++)
+		{
+			std::string filename = name + "_" + StringHelp::int_to_text(i) + ".png";
+			PNGProvider::save(impl->pages[i], PathHelp::combine(directory, filename));
+		}
+
+		File::write_text(PathHelp::combine(directory, name + ".xml"), get_resource_description(name));
+	}
+
+	std::string SpriteSheetBuilder_Impl::get_page_resource_name(const std::string &page_filename_prefix, int page)
+	{
+		return page_filename_prefix + "_page_" + StringHelp::int_to_text(page);
+	}
+
+	std::string SpriteSheetBuilder_Impl::escape_xml(const std::string &text)
+	{
+		std::string result;
+		result.reserve(text.size());
+		for (char c : text)
+		{
+			switch (c)
+			{
+			case '&': result += "&amp;"; break;
+			case '<': result += "&lt;"; break;
+			case '>': result += "&gt;"; break;
+			case '"': result += "&quot;"; break;
+			default: result += c; break;
+			}
+		}
+		return result;
+	}
+}
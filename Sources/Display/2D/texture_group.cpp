@@ -37,8 +37,8 @@ namespace clan
 	{
 	}
 
-	TextureGroup::TextureGroup(const Size &texture_sizes)
-		: impl(std::make_shared<TextureGroup_Impl>(texture_sizes))
+	TextureGroup::TextureGroup(const Size &texture_sizes, RectPacker::PackingMethod packing_method)
+		: impl(std::make_shared<TextureGroup_Impl>(texture_sizes, packing_method))
 	{
 		set_texture_allocation_policy(create_new_texture);
 	}
@@ -73,6 +73,11 @@ namespace clan
 		return impl->texture_allocation_policy;
 	}
 
+	RectPacker::PackingMethod TextureGroup::get_packing_method() const
+	{
+		return impl->packing_method;
+	}
+
 	Size TextureGroup::get_texture_sizes() const
 	{
 		return impl->initial_texture_size;
@@ -98,6 +103,11 @@ namespace clan
 		impl->texture_allocation_policy = policy;
 	}
 
+	void TextureGroup::set_packing_method(RectPacker::PackingMethod packing_method)
+	{
+		impl->packing_method = packing_method;
+	}
+
 	void TextureGroup::insert_texture(Texture2D &texture, const Rect &texture_rect)
 	{
 		impl->insert_texture(texture, texture_rect);
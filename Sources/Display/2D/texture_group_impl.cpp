@@ -34,31 +34,20 @@
 
 namespace clan
 {
-	TextureGroup_Impl::TextureGroup_Impl(const Size &texture_sizes)
-		: initial_texture_size(texture_sizes), active_root(nullptr), next_id(0)
+	TextureGroup_Impl::TextureGroup_Impl(const Size &texture_sizes, RectPacker::PackingMethod packing_method)
+		: initial_texture_size(texture_sizes), packing_method(packing_method), active_root(nullptr)
 	{
 	}
 
 	TextureGroup_Impl::~TextureGroup_Impl()
 	{
-		std::vector<RootNode *>::size_type index, size;
-		size = root_nodes.size();
-		for (index = 0; index < size; ++index)
-		{
-			root_nodes[index]->node.clear();
-			delete root_nodes[index];
-		}
 	}
 
 	int TextureGroup_Impl::get_subtexture_count() const
 	{
 		int count = 0;
-
-		std::vector<RootNode *>::size_type index, size;
-		size = root_nodes.size();
-		for (index = 0; index < size; ++index)
-			count += root_nodes[index]->node.get_subtexture_count();
-
+		for (const auto &root : root_nodes)
+			count += root->bin->get_rect_count();
 		return count;
 	}
 
@@ -67,7 +56,7 @@ namespace clan
 		int count = 0;
 
 		if (texture_index < root_nodes.size())
-			count = root_nodes[texture_index]->node.get_subtexture_count();
+			count = root_nodes[texture_index]->bin->get_rect_count();
 
 		return count;
 	}
@@ -75,265 +64,108 @@ namespace clan
 	std::vector<Texture2D> TextureGroup_Impl::get_textures() const
 	{
 		std::vector<Texture2D> textures;
-
-		std::vector<RootNode *>::size_type index, size;
-		size = root_nodes.size();
-		for (index = 0; index < size; ++index)
-		{
-			textures.push_back(root_nodes[index]->texture);
-		}
-
+		for (const auto &root : root_nodes)
+			textures.push_back(root->texture);
 		return textures;
 	}
 
 	Subtexture TextureGroup_Impl::add_new_node(GraphicContext &context, const Size &texture_size)
 	{
+		if (texture_size.width <= 0 || texture_size.height <= 0)
+			throw Exception("Unable to pack Texture into TextureGroup: Width and height must be larger than zero");
+
 		// Try inserting in current active texture
-		Node *node;
-		if (!active_root)
-		{
-			// Create an initial root, if it does not exist
-			node = nullptr;
-			next_id = 1;
-		}
-		else
-		{
-			node = active_root->node.insert(texture_size, next_id);
-		}
+		Rect rect;
+		RootNode *root = active_root;
+		bool found = root && root->bin->insert(texture_size, rect);
 
-		if (node == nullptr) // Couldn't find a fit in current active texture
+		if (!found) // Couldn't find a fit in current active texture
 		{
 			// Search previous textures if policy says so
 			if (texture_allocation_policy == TextureGroup::search_previous_textures)
 			{
-				std::vector<RootNode *>::size_type index, size;
-				size = root_nodes.size();
-				for (index = 0; index < size; ++index)
+				for (const auto &previous_root : root_nodes)
 				{
-					node = root_nodes[index]->node.insert(texture_size, next_id);
-					if (node)	// We found space in a previous texture
+					found = previous_root->bin->insert(texture_size, rect);
+					if (found)	// We found space in a previous texture
+					{
+						root = previous_root.get();
 						break;
+					}
 				}
 			}
 
-			if (node == nullptr) // Couldn't find a fit, so create a new texture
+			if (!found) // Couldn't find a fit, so create a new texture
 			{
 				if (texture_size.width > initial_texture_size.width || texture_size.height > initial_texture_size.height)
 				{
 					// If the specified size is greater than the initial size,  then create a texture using the specified size
-					node = add_new_root(context, texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, texture_size);
 				}
 				else
 				{
-					node = add_new_root(context, initial_texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, initial_texture_size);
 				}
+				found = root->bin->insert(texture_size, rect);
 			}
 
-			if (node == nullptr)
+			if (!found)
 				throw Exception("Unable to pack Texture into TextureGroup");
 		}
 
-		next_id++;
-
-		return Subtexture(active_root->texture, node->image_rect);
+		return Subtexture(root->texture, rect);
 	}
 
 	TextureGroup_Impl::RootNode *TextureGroup_Impl::add_new_root(GraphicContext &context, const Size &texture_size)
 	{
-		Rect rect(Point(0, 0), texture_size);
-		Node node(rect);
+		auto root = std::make_unique<RootNode>();
+		root->texture = Texture2D(context, texture_size);
+		root->bin = RectPackerBin::create(packing_method, Rect(Point(0, 0), texture_size));
 
-		active_root = new RootNode();
-		active_root->texture = Texture2D(context, texture_size);
-		active_root->node = node;
-
-		root_nodes.push_back(active_root);
+		active_root = root.get();
+		root_nodes.push_back(std::move(root));
 
 		return active_root;
 	}
 
 	void TextureGroup_Impl::insert_texture(Texture2D &texture, const Rect &texture_rect)
 	{
-		Node node(texture_rect);
-
-		active_root = new RootNode();
-		active_root->texture = texture;
-		active_root->node = node;
+		auto root = std::make_unique<RootNode>();
+		root->texture = texture;
+		root->bin = RectPackerBin::create(packing_method, texture_rect);
 
-		root_nodes.push_back(active_root);
+		active_root = root.get();
+		root_nodes.push_back(std::move(root));
 	}
 
 	void TextureGroup_Impl::remove(Subtexture &subtexture)
 	{
 		// Find the texture
-		Node *node = nullptr;
 		Texture2D texture = subtexture.get_texture();
 		Rect rect = subtexture.get_geometry();
 
-		std::vector<RootNode *>::size_type index, size;
+		std::vector<std::unique_ptr<RootNode>>::size_type index, size;
 		size = root_nodes.size();
 		for (index = 0; index < size; ++index)
 		{
 			// Find a texture match
 			if (root_nodes[index]->texture == texture)
-			{
-				node = root_nodes[index]->node.find_image_rect(rect);
 				break;
-			}
-		}
-		if (node)
-		{
-			node->clear();
-			if (root_nodes[index]->node.get_subtexture_count() <= 0)
-			{
-				root_nodes[index]->node.clear();
-				delete root_nodes[index];
-				root_nodes.erase(root_nodes.begin() + index);
-			}
-			if (root_nodes.empty())
-			{
-				active_root = nullptr;
-			}
-			else
-			{
-				active_root = root_nodes.back();
-			}
-		}
-		else
-		{
-			throw Exception("Cannot find the Subtexture in the TextureGroup");
 		}
-	}
-
-	/////////////////////////////////////////////////////////////////////////////
-
-	TextureGroup_Impl::Node::Node()
-	{
-		child[0] = nullptr;
-		child[1] = nullptr;
-
-		id = 0;
-	}
-
-	TextureGroup_Impl::Node::Node(const Rect &new_rect)
-	{
-		node_rect = new_rect;
 
-		child[0] = nullptr;
-		child[1] = nullptr;
-
-		id = 0;
-	}
-
-	TextureGroup_Impl::Node::~Node()
-	{
-		clear();
-	}
-
-	int TextureGroup_Impl::Node::get_subtexture_count() const
-	{
-		int count = 0;
-
-		if (child[0])
-			count += child[0]->get_subtexture_count();
-		if (child[1])
-			count += child[1]->get_subtexture_count();
-
-		if (id)
-			count++;
-
-		return count;
-	}
+		if (index == size || !root_nodes[index]->bin->remove(rect))
+			throw Exception("Cannot find the Subtexture in the TextureGroup");
 
-	void TextureGroup_Impl::Node::clear()
-	{
-		if (child[0])
-		{
-			delete child[0];
-			child[0] = nullptr;
-		}
-		if (child[1])
-		{
-			delete child[1];
-			child[1] = nullptr;
-		}
-		id = 0;
-	}
+		if (root_nodes[index]->bin->get_rect_count() <= 0)
+			root_nodes.erase(root_nodes.begin() + index);
 
-	TextureGroup_Impl::Node *TextureGroup_Impl::Node::insert(const Size &texture_size, int texture_id)
-	{
-		// If we're not a leaf
-		if (child[0] && child[1])
+		if (root_nodes.empty())
 		{
-			// Try inserting into first child
-			Node *new_node = child[0]->insert(texture_size, texture_id);
-			if (new_node != nullptr)
-				return new_node;
-
-			// No room, insert into second
-			return child[1]->insert(texture_size, texture_id);
+			active_root = nullptr;
 		}
 		else
 		{
-			// If there's already a texture here, return
-			if (id)
-				return nullptr;
-
-			// If we're too small, return
-			if (texture_size.width > node_rect.get_width() || texture_size.height > node_rect.get_height())
-				return nullptr;
-
-			// If we're just right, accept
-			if (texture_size.width == node_rect.get_width() && texture_size.height == node_rect.get_height())
-			{
-				id = texture_id;
-				image_rect = node_rect;
-				return this;
-			}
-
-			// Otherwise, decide which way to split
-			int dw = node_rect.get_width() - texture_size.width;
-			int dh = node_rect.get_height() - texture_size.height;
-
-			if (dw > dh)
-			{
-				child[0] = new Node(Rect(node_rect.left, node_rect.top, node_rect.left + texture_size.width, node_rect.bottom));
-				child[1] = new Node(Rect(node_rect.left + texture_size.width, node_rect.top, node_rect.right, node_rect.bottom));
-			}
-			else
-			{
-				child[0] = new Node(Rect(node_rect.left, node_rect.top, node_rect.right, node_rect.top + texture_size.height));
-				child[1] = new Node(Rect(node_rect.left, node_rect.top + texture_size.height, node_rect.right, node_rect.bottom));
-			}
-
-			// Insert into first child we created
-			return child[0]->insert(texture_size, texture_id);
+			active_root = root_nodes.back().get();
 		}
 	}
-
-	TextureGroup_Impl::Node *TextureGroup_Impl::Node::find_image_rect(const Rect &new_rect)
-	{
-		// Check leaf
-		if (child[0])
-		{
-			Node *node = child[0]->find_image_rect(new_rect);
-			if (node)
-				return node;
-		}
-
-		if (child[1])
-		{
-			Node *node = child[1]->find_image_rect(new_rect);
-			if (node)
-				return node;
-		}
-
-		if (id == 0)
-			return nullptr;
-
-		if (image_rect == new_rect)
-			return this;
-
-		return nullptr;
-	}
 }
@@ -28,12 +28,24 @@
 
 #pragma once
 
+#include "Display/Font/text_layout_cache.h"
+
 namespace clan
 {
+	class GlyphRun_Impl;
+
 	class Font_Draw
 	{
 	public:
 		virtual GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) = 0;
-		virtual void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) = 0;
+
+		/// \brief Get the metrics without waiting for a glyph that is being rasterized in the background. Returns false if the glyph is not ready
+		virtual bool get_metrics_if_ready(Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics) { out_metrics = get_metrics(canvas, glyph); return true; }
+
+		virtual void draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing) = 0;
+		virtual void prewarm(Canvas &canvas, const std::string &charset) { }
+
+		/// \brief Resolve the glyph quads of a layout into the glyph run. Returns false if this drawing mode cannot use glyph runs
+		virtual bool build_glyph_run(Canvas &canvas, const TextLayout &layout, float line_spacing, float pixel_ratio, GlyphRun_Impl &run) { return false; }
 	};
 }
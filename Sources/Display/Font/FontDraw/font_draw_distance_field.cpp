@@ -0,0 +1,104 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Font/font.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Core/Text/utf8_reader.h"
+#include "Display/2D/canvas_impl.h"
+#include "Display/Font/FontEngine/font_engine.h"
+#include "font_draw_distance_field.h"
+#include "Display/Font/glyph_cache.h"
+#include "Display/Font/glyph_run_impl.h"
+
+namespace clan
+{
+	void Font_DrawDistanceField::init(GlyphCache *cache, FontEngine *engine, float new_scaled_height)
+	{
+		glyph_cache = cache;
+		font_engine = engine;
+		scaled_height = new_scaled_height;
+	}
+
+	GlyphMetrics Font_DrawDistanceField::get_metrics(Canvas &canvas, unsigned int glyph)
+	{
+		return glyph_cache->get_metrics(font_engine, canvas, glyph);
+	}
+
+	bool Font_DrawDistanceField::get_metrics_if_ready(Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics)
+	{
+		return glyph_cache->get_metrics_if_ready(font_engine, canvas, glyph, out_metrics);
+	}
+
+	void Font_DrawDistanceField::prewarm(Canvas &canvas, const std::string &charset)
+	{
+		glyph_cache->prewarm(canvas, font_engine, charset);
+	}
+
+	void Font_DrawDistanceField::draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing)
+	{
+		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
+
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
+		{
+			if (layout_glyph.glyph == '\n')
+				continue;
+
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
+			{
+				// The distance field is resolution independent, so the glyph is not grid fitted
+				float xp = (layout_glyph.pen.x + gptr->offset.x) * scaled_height + position.x;
+				float yp = (layout_glyph.line * line_spacing + layout_glyph.pen.y + gptr->offset.y) * scaled_height + position.y;
+
+				Rectf dest_size(Pointf(xp, yp), gptr->size * scaled_height);
+				batcher->draw_glyph_distance_field(canvas, gptr->geometry, dest_size, color, gptr->texture);
+			}
+		}
+	}
+
+	bool Font_DrawDistanceField::build_glyph_run(Canvas &canvas, const TextLayout &layout, float line_spacing, float pixel_ratio, GlyphRun_Impl &run)
+	{
+		run.program = RenderBatchTriangle::BatchProgram::glyph_distance_field;
+
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
+		{
+			if (layout_glyph.glyph == '\n')
+				continue;
+
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
+			{
+				float xp = (layout_glyph.pen.x + gptr->offset.x) * scaled_height;
+				float yp = (layout_glyph.line * line_spacing + layout_glyph.pen.y + gptr->offset.y) * scaled_height;
+				run.add_quad(gptr, Rectf(Pointf(xp, yp), gptr->size * scaled_height));
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,51 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "font_draw.h"
+
+namespace clan
+{
+	class Font_DrawDistanceField : public Font_Draw
+	{
+	public:
+		void init(GlyphCache *cache, FontEngine *engine, float new_scaled_height);
+
+		GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) override;
+		bool get_metrics_if_ready(Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics) override;
+		void draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing) override;
+		void prewarm(Canvas &canvas, const std::string &charset) override;
+		bool build_glyph_run(Canvas &canvas, const TextLayout &layout, float line_spacing, float pixel_ratio, GlyphRun_Impl &run) override;
+
+	private:
+		GlyphCache *glyph_cache = nullptr;
+		FontEngine *font_engine = nullptr;
+		float scaled_height = 1.0f;
+	};
+}
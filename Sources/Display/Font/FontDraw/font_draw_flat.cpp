@@ -43,6 +43,7 @@
 #include "Display/2D/sprite_impl.h"
 #include "font_draw_flat.h"
 #include "Display/Font/glyph_cache.h"
+#include "Display/Font/glyph_run_impl.h"
 #include "Display/Font/path_cache.h"
 
 namespace clan
@@ -58,40 +59,56 @@ namespace clan
 		return glyph_cache->get_metrics(font_engine, canvas, glyph);
 	}
 
-	void Font_DrawFlat::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
+	bool Font_DrawFlat::get_metrics_if_ready(Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics)
+	{
+		return glyph_cache->get_metrics_if_ready(font_engine, canvas, glyph, out_metrics);
+	}
+
+	void Font_DrawFlat::prewarm(Canvas &canvas, const std::string &charset)
+	{
+		glyph_cache->prewarm(canvas, font_engine, charset);
+	}
+
+	void Font_DrawFlat::draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
 		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
 
-		while (!reader.is_end())
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
 		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
+			if (layout_glyph.glyph == '\n')
+				continue;
 
-			if (glyph == '\n')
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
 			{
-				offset_x = 0;
-				offset_y += line_spacing;
-				continue;
+				float xp = layout_glyph.pen.x + position.x + gptr->offset.x;
+				float yp = layout_glyph.line * line_spacing + layout_glyph.pen.y + position.y + gptr->offset.y;
+				Pointf pos = canvas.grid_fit(Pointf(xp, yp));
+
+				Rectf dest_size(pos, gptr->size);
+				batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
 			}
+		}
+	}
 
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
-			if (gptr)
-			{
-				if (!gptr->texture.is_null())
-				{
-					float xp = offset_x + position.x + gptr->offset.x;
-					float yp = offset_y + position.y + gptr->offset.y;
-					Pointf pos = canvas.grid_fit(Pointf(xp, yp));
+	bool Font_DrawFlat::build_glyph_run(Canvas &canvas, const TextLayout &layout, float line_spacing, float pixel_ratio, GlyphRun_Impl &run)
+	{
+		run.program = RenderBatchTriangle::BatchProgram::sprite;
 
-					Rectf dest_size(pos, gptr->size);
-					batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
-				}
-				offset_x += gptr->metrics.advance.width;
-				offset_y += gptr->metrics.advance.height;
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
+		{
+			if (layout_glyph.glyph == '\n')
+				continue;
+
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
+			{
+				// Snap relative to the origin, which is grid fitted when drawn
+				float xp = std::round((layout_glyph.pen.x + gptr->offset.x) * pixel_ratio) / pixel_ratio;
+				float yp = std::round((layout_glyph.line * line_spacing + layout_glyph.pen.y + gptr->offset.y) * pixel_ratio) / pixel_ratio;
+				run.add_quad(gptr, Rectf(Pointf(xp, yp), gptr->size));
 			}
 		}
+		return true;
 	}
 }
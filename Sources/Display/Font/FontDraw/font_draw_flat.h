@@ -38,7 +38,10 @@ namespace clan
 		void init(GlyphCache *cache, FontEngine *engine);
 
 		GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) override;
-		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) override;
+		bool get_metrics_if_ready(Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics) override;
+		void draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing) override;
+		void prewarm(Canvas &canvas, const std::string &charset) override;
+		bool build_glyph_run(Canvas &canvas, const TextLayout &layout, float line_spacing, float pixel_ratio, GlyphRun_Impl &run) override;
 
 	private:
 		GlyphCache *glyph_cache = nullptr;
@@ -59,12 +59,8 @@ namespace clan
 		return path_cache->get_metrics(font_engine, canvas, glyph);
 	}
 
-	void Font_DrawPath::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
+	void Font_DrawPath::draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
-
 		clan::TransformState original_transform(&canvas);
 
 		float pixel_ratio = canvas.get_pixel_ratio();
@@ -73,27 +69,19 @@ namespace clan
 		float scaled_pixel_ratio = scaled_height / pixel_ratio;
 		clan::Mat4f scale_matrix = clan::Mat4f::scale(scaled_pixel_ratio, scaled_pixel_ratio, scaled_pixel_ratio);
 		Brush brush(color);
-		Sizef advance;
 
-		while (!reader.is_end())
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
 		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				offset_x = 0;
-				offset_y += line_spacing * scaled_height;
+			if (layout_glyph.glyph == '\n')
 				continue;
-			}
 
-			canvas.set_transform(original_transform.matrix * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
-			Font_PathGlyph *gptr = path_cache->get_glyph(canvas, font_engine, glyph);
+			Font_PathGlyph *gptr = path_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
 			if (gptr)
 			{
+				float offset_x = layout_glyph.pen.x * scaled_height;
+				float offset_y = (layout_glyph.line * line_spacing + layout_glyph.pen.y) * scaled_height;
+				canvas.set_transform(original_transform.matrix * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
 				gptr->path.fill(canvas, brush);
-				offset_x += gptr->metrics.advance.width * scaled_height;
-				offset_y += gptr->metrics.advance.height * scaled_height;
 			}
 		}
 	}
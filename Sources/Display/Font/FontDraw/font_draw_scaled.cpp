@@ -43,6 +43,7 @@
 #include "Display/2D/sprite_impl.h"
 #include "font_draw_scaled.h"
 #include "Display/Font/glyph_cache.h"
+#include "Display/Font/glyph_run_impl.h"
 #include "Display/Font/path_cache.h"
 
 namespace clan
@@ -59,45 +60,62 @@ namespace clan
 		return glyph_cache->get_metrics(font_engine, canvas, glyph);
 	}
 
-	void Font_DrawScaled::draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing)
+	bool Font_DrawScaled::get_metrics_if_ready(Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics)
+	{
+		return glyph_cache->get_metrics_if_ready(font_engine, canvas, glyph, out_metrics);
+	}
+
+	void Font_DrawScaled::prewarm(Canvas &canvas, const std::string &charset)
+	{
+		glyph_cache->prewarm(canvas, font_engine, charset);
+	}
+
+	void Font_DrawScaled::draw_text(Canvas &canvas, const Pointf &position, const TextLayout &layout, const Colorf &color, float line_spacing)
 	{
-		float offset_x = 0;
-		float offset_y = 0;
-		UTF8_Reader reader(text.data(), text.length());
 		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
 
 		const Mat4f original_transform = canvas.get_transform();
 		clan::Mat4f scale_matrix = clan::Mat4f::scale(scaled_height, scaled_height, scaled_height);
-		Sizef advance;
 
-		while (!reader.is_end())
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
 		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				offset_x = 0;
-				offset_y += line_spacing * scaled_height;
+			if (layout_glyph.glyph == '\n')
 				continue;
-			}
 
-			canvas.set_transform(original_transform * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
-			if (gptr)
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
 			{
-				if (!gptr->texture.is_null())
-				{
-					float xp = gptr->offset.x;
-					float yp = gptr->offset.y;
+				float offset_x = layout_glyph.pen.x * scaled_height;
+				float offset_y = (layout_glyph.line * line_spacing + layout_glyph.pen.y) * scaled_height;
+				canvas.set_transform(original_transform * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
+
+				float xp = gptr->offset.x;
+				float yp = gptr->offset.y;
 
-					Rectf dest_size(xp, yp, gptr->size);
-					batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
-				}
-				offset_x += gptr->metrics.advance.width * scaled_height;
-				offset_y += gptr->metrics.advance.height * scaled_height;
+				Rectf dest_size(xp, yp, gptr->size);
+				batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
 			}
 		}
 		canvas.set_transform(original_transform);
 	}
+
+	bool Font_DrawScaled::build_glyph_run(Canvas &canvas, const TextLayout &layout, float line_spacing, float pixel_ratio, GlyphRun_Impl &run)
+	{
+		run.program = RenderBatchTriangle::BatchProgram::sprite;
+
+		for (const TextLayoutGlyph &layout_glyph : layout.glyphs)
+		{
+			if (layout_glyph.glyph == '\n')
+				continue;
+
+			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, layout_glyph.glyph);
+			if (gptr && !gptr->texture.is_null())
+			{
+				float xp = (layout_glyph.pen.x + gptr->offset.x) * scaled_height;
+				float yp = (layout_glyph.line * line_spacing + layout_glyph.pen.y + gptr->offset.y) * scaled_height;
+				run.add_quad(gptr, Rectf(Pointf(xp, yp), gptr->size * scaled_height));
+			}
+		}
+		return true;
+	}
 }
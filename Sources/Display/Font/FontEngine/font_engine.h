@@ -83,5 +83,8 @@ namespace clan
 		virtual const FontDescription &get_desc() const = 0;
 		virtual void load_glyph_path(unsigned int glyph_index, Path &out_path, GlyphMetrics &out_metrics) = 0;
 		virtual FontHandle *get_handle() { return nullptr; }
+
+		// Creates an independent engine for the same font, so glyphs can be rasterized on another thread. Returns null if not supported
+		virtual std::unique_ptr<FontEngine> create_worker_engine() { return nullptr; }
 	};
 }
@@ -36,6 +36,7 @@
 #include "font_engine_freetype.h"
 #include "API/Core/IOData/iodevice.h"
 #include "API/Display/2D/path.h"
+#include <mutex>
 
 namespace clan
 {
@@ -51,6 +52,9 @@ public:
 
 public:
 	FT_Library library;
+
+	// Faces can be used by different threads, but creating and destroying them must be serialized
+	std::mutex face_mutex;
 };
 
 FontEngine_Freetype_Library::FontEngine_Freetype_Library()
@@ -93,7 +97,11 @@ FontEngine_Freetype::FontEngine_Freetype(const FontDescription &description, Dat
 
 	FontEngine_Freetype_Library &library = FontEngine_Freetype_Library::instance();
 
-	FT_Error error = FT_New_Memory_Face( library.library, (FT_Byte*)data_buffer.get_data(), data_buffer.get_size(), 0, &face);
+	FT_Error error;
+	{
+		std::lock_guard<std::mutex> lock(library.face_mutex);
+		error = FT_New_Memory_Face( library.library, (FT_Byte*)data_buffer.get_data(), data_buffer.get_size(), 0, &face);
+	}
 
 	if ( error == FT_Err_Unknown_File_Format )
 	{
@@ -116,10 +124,16 @@ FontEngine_Freetype::~FontEngine_Freetype()
 {
 	if (face)
 	{
+		std::lock_guard<std::mutex> lock(FontEngine_Freetype_Library::instance().face_mutex);
 		FT_Done_Face(face);
 	}
 }
 
+std::unique_ptr<FontEngine> FontEngine_Freetype::create_worker_engine()
+{
+	return std::make_unique<FontEngine_Freetype>(font_description, data_buffer, pixel_ratio);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // FontEngine_Freetype Attributes:
 
@@ -90,6 +90,8 @@ public:
 public:
 	void load_glyph_path(unsigned int glyph_index, Path &out_path, GlyphMetrics &out_metrics) override;
 
+	std::unique_ptr<FontEngine> create_worker_engine() override;
+
 /// \}
 /// \name Implementation
 /// \{
@@ -140,6 +140,18 @@ namespace clan
 			impl->set_scalable(height_threshold);
 	}
 
+	void Font::prewarm(Canvas &canvas, const std::string &charset)
+	{
+		if (impl)
+			impl->prewarm(canvas, charset);
+	}
+
+	void Font::set_distance_field(bool enable)
+	{
+		if (impl)
+			impl->set_distance_field(enable);
+	}
+
 	GlyphMetrics Font::get_metrics(Canvas &canvas, unsigned int glyph) const
 	{
 		if (impl)
@@ -313,5 +325,13 @@ namespace clan
 		return FontDescription();
 	}
 
+	GlyphAtlasStatistics Font::get_glyph_atlas_statistics() const
+	{
+		if (impl)
+			return impl->get_glyph_atlas_statistics();
+
+		return GlyphAtlasStatistics();
+	}
+
 
 }
@@ -55,6 +55,60 @@ namespace clan
 		return impl->get_family_name();
 	}
 
+	size_t FontFamily::get_glyph_atlas_budget() const
+	{
+		throw_if_null();
+		return impl->get_glyph_atlas()->get_budget();
+	}
+
+	GlyphAtlasStatistics FontFamily::get_glyph_atlas_statistics() const
+	{
+		throw_if_null();
+		return impl->get_glyph_atlas()->get_statistics();
+	}
+
+	void FontFamily::set_glyph_atlas_budget(size_t bytes)
+	{
+		throw_if_null();
+		impl->get_glyph_atlas()->set_budget(bytes);
+	}
+
+	size_t FontFamily::get_text_layout_cache_budget() const
+	{
+		throw_if_null();
+		return impl->get_text_layout_cache().get_budget();
+	}
+
+	void FontFamily::set_text_layout_cache_budget(size_t bytes)
+	{
+		throw_if_null();
+		impl->get_text_layout_cache().set_budget(bytes);
+	}
+
+	void FontFamily::set_background_rasterization(bool enable)
+	{
+		throw_if_null();
+		impl->set_background_rasterization(enable);
+	}
+
+	void FontFamily::set_glyph_disk_cache(const std::string &directory)
+	{
+		throw_if_null();
+		impl->set_glyph_disk_cache(directory);
+	}
+
+	void FontFamily::save_glyph_disk_cache()
+	{
+		throw_if_null();
+		impl->save_glyph_disk_cache();
+	}
+
+	void FontFamily::set_glyph_atlas_compaction_threshold(float fraction)
+	{
+		throw_if_null();
+		impl->get_glyph_atlas()->set_compaction_threshold(fraction);
+	}
+
 	void FontFamily::add(const std::string &typeface_name, float height)
 	{
 		throw_if_null();
@@ -41,8 +41,11 @@
 #include "API/Display/2D/path.h"
 #include "API/Display/Resources/display_cache.h"
 #include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/directory.h"
+#include "API/Core/Crypto/sha1.h"
 #include "Display/2D/canvas_impl.h"
 #include "Display/2D/sprite_impl.h"
+#include "glyph_disk_cache.h"
 
 #ifdef WIN32
 #include "FontEngine/font_engine_win32.h"
@@ -76,14 +79,84 @@ namespace clan
 		FontMetrics font_metrics;
 	};
 
-	FontFamily_Impl::FontFamily_Impl(const std::string &family_name, const TextureGroup &new_texture_group) : family_name(family_name), texture_group(new_texture_group)
+	FontFamily_Impl::FontFamily_Impl(const std::string &family_name, const TextureGroup &new_texture_group) : family_name(family_name)
 	{
+		Size page_size = new_texture_group.is_null() ? Size(256, 256) : new_texture_group.get_texture_sizes();
+		glyph_atlas = std::make_shared<GlyphAtlas>(page_size);
 	}
 
 	FontFamily_Impl::~FontFamily_Impl()
 	{
 	}
 
+	void FontFamily_Impl::set_glyph_caches(Font_Cache &cache)
+	{
+		cache.glyph_cache->set_atlas(glyph_atlas);
+		cache.distance_field_cache->set_atlas(glyph_atlas);
+		cache.distance_field_cache->set_distance_field(distance_field_spread);
+		cache.glyph_cache->set_background_rasterization(background_rasterization);
+		cache.distance_field_cache->set_background_rasterization(background_rasterization);
+		set_disk_cache(cache, *cache.glyph_cache, 0);
+		set_disk_cache(cache, *cache.distance_field_cache, distance_field_spread);
+	}
+
+	void FontFamily_Impl::set_disk_cache(Font_Cache &cache, GlyphCache &glyph_cache, int spread)
+	{
+		if (glyph_disk_cache_directory.empty() || (cache.font_data.is_null() && cache.font_name.empty()))
+		{
+			glyph_cache.set_disk_cache(nullptr);
+			return;
+		}
+
+		std::string filename = GlyphDiskCache::get_filename(glyph_disk_cache_directory, get_font_hash(cache), cache.engine->get_desc(), cache.pixel_ratio, spread);
+		if (!glyph_cache.get_disk_cache() || glyph_cache.get_disk_cache()->get_filename() != filename)
+			glyph_cache.set_disk_cache(std::make_shared<GlyphDiskCache>(filename));
+	}
+
+	std::string FontFamily_Impl::get_font_hash(const Font_Cache &cache)
+	{
+		if (cache.font_data.is_null())
+			return "typeface:" + cache.font_name;
+
+		std::string &hash = font_hashes[cache.font_data.get_data()];
+		if (hash.empty())
+		{
+			SHA1 sha1;
+			sha1.add(cache.font_data);
+			sha1.calculate();
+			hash = sha1.get_hash();
+		}
+		return hash;
+	}
+
+	void FontFamily_Impl::set_glyph_disk_cache(const std::string &directory)
+	{
+		if (!directory.empty())
+			Directory::create(directory, true);
+
+		glyph_disk_cache_directory = directory;
+		for (auto &cache : font_cache)
+			set_glyph_caches(cache);
+	}
+
+	void FontFamily_Impl::save_glyph_disk_cache()
+	{
+		for (auto &cache : font_cache)
+		{
+			if (cache.glyph_cache->get_disk_cache())
+				cache.glyph_cache->get_disk_cache()->save();
+			if (cache.distance_field_cache->get_disk_cache())
+				cache.distance_field_cache->get_disk_cache()->save();
+		}
+	}
+
+	void FontFamily_Impl::set_background_rasterization(bool enable)
+	{
+		background_rasterization = enable;
+		for (auto &cache : font_cache)
+			set_glyph_caches(cache);
+	}
+
 	void FontFamily_Impl::add(const FontDescription &desc, DataBuffer &font_databuffer)
 	{
 		FontFamily_Definition definition;
@@ -112,8 +185,9 @@ namespace clan
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Freetype>(desc, font_databuffer, pixel_ratio);
 		font_cache.push_back(Font_Cache(engine));
 #endif
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
 		font_cache.back().pixel_ratio = pixel_ratio;
+		font_cache.back().font_data = font_databuffer;
+		set_glyph_caches(font_cache.back());
 	}
 
 	void FontFamily_Impl::font_face_load(const FontDescription &desc, const std::string &typeface_name, float pixel_ratio)
@@ -121,13 +195,15 @@ namespace clan
 #if defined(WIN32)
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Win32>(desc, typeface_name, pixel_ratio);
 		font_cache.push_back(Font_Cache(engine));
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
 		font_cache.back().pixel_ratio = pixel_ratio;
+		font_cache.back().font_name = typeface_name;
+		set_glyph_caches(font_cache.back());
 #elif defined(__APPLE__)
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Cocoa>(desc, typeface_name, pixel_ratio);
 		font_cache.push_back(Font_Cache(engine));
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
 		font_cache.back().pixel_ratio = pixel_ratio;
+		font_cache.back().font_name = typeface_name;
+		set_glyph_caches(font_cache.back());
 #elif defined(__ANDROID__)
 		throw Exception("automatic typeface to ttf file selection is not supported on android");
 #else
@@ -135,13 +211,18 @@ namespace clan
 		// Obtain the best matching font file from fontconfig.
 		FontConfig &fc = FontConfig::instance();
 		std::string font_file_path = fc.match_font(typeface_name, desc);
-		std::string path = PathHelp::get_fullpath(font_file_path, PathHelp::path_type_file);
-		auto filename = PathHelp::get_filename(font_file_path, PathHelp::path_type_file);
-		auto fs = FileSystem(path);
-		IODevice file = fs.open_file(filename);
-		DataBuffer font_databuffer;
-		font_databuffer.set_size(file.get_size());
-		file.read(font_databuffer.get_data(), font_databuffer.get_size());
+
+		// Keep the file, so other sizes share the data (and its hash for the glyph disk cache)
+		DataBuffer &font_databuffer = typeface_files[font_file_path];
+		if (font_databuffer.is_null())
+		{
+			std::string path = PathHelp::get_fullpath(font_file_path, PathHelp::path_type_file);
+			auto filename = PathHelp::get_filename(font_file_path, PathHelp::path_type_file);
+			auto fs = FileSystem(path);
+			IODevice file = fs.open_file(filename);
+			font_databuffer.set_size(file.get_size());
+			file.read(font_databuffer.get_data(), font_databuffer.get_size());
+		}
 		font_face_load(desc, font_databuffer, pixel_ratio);
 #endif
 	}
@@ -226,6 +307,7 @@ namespace clan
 		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Sprite>(desc, font_metrics);
 		Font_Cache sprite_engine(engine);
 		font_cache.push_back(sprite_engine);
+		set_glyph_caches(sprite_engine);
 		GlyphCache *glyph_cache = sprite_engine.glyph_cache.get();
 
 		// Setup char to glyph map:
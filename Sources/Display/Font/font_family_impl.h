@@ -37,6 +37,8 @@
 #include <list>
 #include <map>
 #include "glyph_cache.h"
+#include "glyph_atlas.h"
+#include "text_layout_cache.h"
 #include "path_cache.h"
 
 namespace clan
@@ -47,11 +49,14 @@ namespace clan
 	{
 	public:
 		Font_Cache() {}
-		Font_Cache(std::shared_ptr<FontEngine> &new_engine) : engine(new_engine), glyph_cache(std::make_shared<GlyphCache>()), path_cache(std::make_shared<PathCache>()) {}
+		Font_Cache(std::shared_ptr<FontEngine> &new_engine) : engine(new_engine), glyph_cache(std::make_shared<GlyphCache>()), distance_field_cache(std::make_shared<GlyphCache>()), path_cache(std::make_shared<PathCache>()) {}
 		std::shared_ptr<FontEngine> engine;
 		std::shared_ptr<GlyphCache> glyph_cache;
+		std::shared_ptr<GlyphCache> distance_field_cache;	// Glyphs stored as signed distance fields
 		std::shared_ptr<PathCache> path_cache;
 		float pixel_ratio = 1.0f;	// The pixel ratio this font was created for.
+		DataBuffer font_data;		// Font file the engine was created from, used to find the glyph disk cache
+		std::string font_name;		// Typeface name, if the platform font engine was created from a name instead
 	};
 
 	class FontFamily_Definition
@@ -81,13 +86,33 @@ namespace clan
 		// Find font and copy it using the revised description
 		Font_Cache copy_font(const FontDescription &desc, float pixel_ratio);
 
+		GlyphAtlas *get_glyph_atlas() { return glyph_atlas.get(); }
+		TextLayoutCache &get_text_layout_cache() { return text_layout_cache; }
+
+		void set_background_rasterization(bool enable);
+
+		void set_glyph_disk_cache(const std::string &directory);
+		void save_glyph_disk_cache();
+
+		// Spread in pixels of the distance field glyphs, at the reference height
+		static const int distance_field_spread = 6;
+
 	private:
+		void set_glyph_caches(Font_Cache &cache);
+		void set_disk_cache(Font_Cache &cache, GlyphCache &glyph_cache, int spread);
+		std::string get_font_hash(const Font_Cache &cache);
 		void font_face_load(const FontDescription &desc, const std::string &typeface_name, float pixel_ratio);
 		void font_face_load(const FontDescription &desc, DataBuffer &font_databuffer, float pixel_ratio);
 
 		std::string family_name;
-		TextureGroup texture_group;		// Shared texture group between glyph cache's
+		std::shared_ptr<GlyphAtlas> glyph_atlas;		// Shared glyph textures between glyph cache's
+		TextLayoutCache text_layout_cache;				// Layouts of recently measured and drawn text, shared between the fonts of the family
 		std::vector<Font_Cache> font_cache;
 		std::vector<FontFamily_Definition> font_definitions;
+		bool background_rasterization = false;
+
+		std::string glyph_disk_cache_directory;
+		std::map<const void *, std::string> font_hashes;		// Hash of each font file, by data pointer
+		std::map<std::string, DataBuffer> typeface_files;		// Font files found by fontconfig, by path
 	};
 }
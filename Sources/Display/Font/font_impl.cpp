@@ -44,9 +44,12 @@
 #include "Display/2D/canvas_impl.h"
 #include "Display/Font/FontEngine/font_engine.h"
 #include "Display/2D/sprite_impl.h"
+#include "glyph_run_impl.h"
 
 namespace clan
 {
+	const float Font_Impl::distance_field_reference_height = 64.0f;
+
 	Font_Impl::Font_Impl(FontFamily &new_font_family, const FontDescription &description)
 	{
 		new_font_family.throw_if_null();
@@ -65,9 +68,14 @@ namespace clan
 
 		if ((!font_engine) || (pixel_ratio != selected_pixel_ratio))
 		{
+			// Distance field glyphs need the shader from the standard programs
+			bool distance_field = selected_distance_field && canvas.get_gc().get_shader_language() == ShaderLanguage::glsl;
+
 			// Copy the required font, setting a scalable font size
 			FontDescription new_selected = selected_description.clone();
-			if (selected_description.get_height() >= selected_height_threshold)
+			if (distance_field)
+				new_selected.set_height(distance_field_reference_height);	// All sizes are drawn from the same glyphs
+			else if (selected_description.get_height() >= selected_height_threshold)
 				new_selected.set_height(256.0f);	// A reasonable scalable size
 
 			selected_pixel_ratio = pixel_ratio;
@@ -82,9 +90,13 @@ namespace clan
 
 			const FontMetrics &metrics = font_engine->get_metrics();
 
+			// Sprite fonts cannot rasterize distance fields
+			if (!font_engine->is_automatic_recreation_allowed())
+				distance_field = false;
+
 			// Determine if pathfont method is required. TODO: This feels a bit hacky
 			selected_pathfont = font_engine->is_automatic_recreation_allowed();
-			if (selected_description.get_height() < selected_height_threshold)
+			if (selected_description.get_height() < selected_height_threshold || distance_field)
 				selected_pathfont = false;
 
 			// Deterimine if font scaling is required
@@ -96,13 +108,21 @@ namespace clan
 				scaled_height = 1.0f;
 
 			// Deterimine the correct drawing engine
-			if (selected_pathfont)
+			if (distance_field)
+			{
+				font_draw_distance_field.init(font_cache.distance_field_cache.get(), font_engine, scaled_height);
+				font_draw = &font_draw_distance_field;
+				layout_metrics_source = font_cache.distance_field_cache.get();
+			}
+			else if (selected_pathfont)
 			{
 				font_draw_path.init(path_cache, font_engine, scaled_height);
 				font_draw = &font_draw_path;
+				layout_metrics_source = path_cache;
 			}
 			else if (scaled_height == 1.0f)
 			{
+				layout_metrics_source = glyph_cache;
 				if (font_engine->get_desc().get_subpixel())
 				{
 					font_draw_subpixel.init(glyph_cache, font_engine);
@@ -118,6 +138,7 @@ namespace clan
 			{
 				font_draw_scaled.init(glyph_cache, font_engine, scaled_height);
 				font_draw = &font_draw_scaled;
+				layout_metrics_source = glyph_cache;
 			}
 
 			selected_metrics = FontMetrics(
@@ -129,6 +150,8 @@ namespace clan
 				selected_line_height,	// Do not scale the line height
 				pixel_ratio
 				);
+
+			font_selection++;
 		}
 	}
 
@@ -136,54 +159,97 @@ namespace clan
 	{
 	}
 
-	int Font_Impl::get_character_index(Canvas &canvas, const std::string &text, const Pointf &point)
+	std::shared_ptr<const TextLayout> Font_Impl::get_layout(Canvas &canvas, const std::string &text, bool wait)
 	{
-		select_font_family(canvas);
+		TextLayoutCache &cache = font_family.impl->get_text_layout_cache();
 
-		float dest_x = 0;
-		float dest_y = 0;
+		TextLayoutKey key;
+		key.text = text;
+		key.metrics_source = layout_metrics_source;
+		key.pixel_ratio = selected_pixel_ratio;
+		key.line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 
-		int character_counter = 0;
+		std::shared_ptr<const TextLayout> cached_layout = cache.find(key);
+		if (cached_layout)
+			return cached_layout;
 
-		float font_height = selected_metrics.get_height();
-		float font_ascent = selected_metrics.get_ascent();
-		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
+		auto layout = std::make_shared<TextLayout>();
+		layout->glyphs.reserve(text.length());
 
-		//TODO: Fix me, so we do not need to line split
+		Pointf pen;
+		unsigned int line = 0;
+		bool first_char = true;
 
-		std::vector<std::string> lines = StringHelp::split_text(text, "\n", false);
-		for (std::vector<std::string>::size_type i = 0; i < lines.size(); i++)
+		UTF8_Reader reader(text.data(), text.length());
+		while (!reader.is_end())
 		{
-			float xpos = dest_x;
-			float ypos = dest_y;
+			TextLayoutGlyph layout_glyph;
+			layout_glyph.glyph = reader.get_char();
+			layout_glyph.byte_offset = reader.get_position();
+			layout_glyph.line = line;
+			layout_glyph.pen = pen;
+			reader.next();
 
-			std::string &textline = lines[i];
-			std::string::size_type string_length = textline.length();
+			if (layout_glyph.glyph == '\n')
+			{
+				layout->glyphs.push_back(layout_glyph);
+				layout->advance.width = 0;
+				layout->advance.height += key.line_spacing;
+				pen = Pointf();
+				line++;
+				continue;
+			}
 
-			// Scan the string
+			if (wait)
+				layout_glyph.metrics = font_draw->get_metrics(canvas, layout_glyph.glyph);
+			else if (!font_draw->get_metrics_if_ready(canvas, layout_glyph.glyph, layout_glyph.metrics))
+				layout->complete = false;
 
-			UTF8_Reader reader(textline.data(), textline.length());
-			while (!reader.is_end())
+			const GlyphMetrics &metrics = layout_glyph.metrics;
+			Rectf glyph_bbox(Pointf(metrics.bbox_offset.x + layout->advance.width, metrics.bbox_offset.y + layout->advance.height), metrics.bbox_size);
+			if (first_char)
 			{
-				unsigned int glyph = reader.get_char();
-				std::string::size_type glyph_pos = reader.get_position();
-				reader.next();
+				layout->bbox = glyph_bbox;
+				first_char = false;
+			}
+			else
+			{
+				layout->bbox.bounding_rect(glyph_bbox);
+			}
 
-				GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
+			layout->advance += metrics.advance;
+			pen.x += metrics.advance.width;
+			pen.y += metrics.advance.height;
 
-				Rectf position(xpos, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
-				if (position.contains(point))
-				{
-					return glyph_pos + character_counter;
-				}
+			layout->glyphs.push_back(layout_glyph);
+		}
 
-				xpos += metrics.advance.width;
-				ypos += metrics.advance.height;
-			}
+		if (layout->complete)
+			cache.insert(key, layout);
+		return layout;
+	}
 
-			dest_y += line_spacing;
+	int Font_Impl::get_character_index(Canvas &canvas, const std::string &text, const Pointf &point)
+	{
+		select_font_family(canvas);
+		std::shared_ptr<const TextLayout> layout = get_layout(canvas, text, true);
 
-			character_counter += string_length + 1;		// (Including the '\n')
+		float font_height = selected_metrics.get_height();
+		float font_ascent = selected_metrics.get_ascent();
+		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
+
+		for (const TextLayoutGlyph &layout_glyph : layout->glyphs)
+		{
+			if (layout_glyph.glyph == '\n')
+				continue;
+
+			const GlyphMetrics &metrics = layout_glyph.metrics;
+			float ypos = layout_glyph.line * line_spacing + layout_glyph.pen.y;
+			Rectf position(layout_glyph.pen.x, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
+			if (position.contains(point))
+			{
+				return layout_glyph.byte_offset;
+			}
 		}
 		return -1;	// Not found
 	}
@@ -191,45 +257,26 @@ namespace clan
 	std::vector<Rectf> Font_Impl::get_character_indices(Canvas &canvas, const std::string &text)
 	{
 		select_font_family(canvas);
-		std::vector<Rectf> index_store;
+		std::shared_ptr<const TextLayout> layout = get_layout(canvas, text, true);
 
-		float dest_x = 0;
-		float dest_y = 0;
+		std::vector<Rectf> index_store;
+		index_store.reserve(layout->glyphs.size());
 
 		float font_height = selected_metrics.get_height();
 		float font_ascent = selected_metrics.get_ascent();
 		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 
-		//TODO: Fix me, so we do not need to line split
-
-		std::vector<std::string> lines = StringHelp::split_text(text, "\n", false);
-		for (std::vector<std::string>::size_type i = 0; i < lines.size(); i++)
+		for (const TextLayoutGlyph &layout_glyph : layout->glyphs)
 		{
-			float xpos = dest_x;
-			float ypos = dest_y;
-
-			std::string &textline = lines[i];
-
-			// Scan the string
-
-			UTF8_Reader reader(textline.data(), textline.length());
-			while (!reader.is_end())
+			if (layout_glyph.glyph == '\n')
 			{
-				unsigned int glyph = reader.get_char();
-				reader.next();
-
-				GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
-
-				Rectf position(xpos, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height));
-				index_store.push_back(position);
-				xpos += metrics.advance.width;
-				ypos += metrics.advance.height;
+				index_store.push_back(Rect());	// Store the '\n' as a empty rect
+				continue;
 			}
 
-			dest_y += line_spacing;
-
-			if (i != lines.size() - 1)
-				index_store.push_back(Rect());	// Store the '\n' as a empty rect
+			const GlyphMetrics &metrics = layout_glyph.metrics;
+			float ypos = layout_glyph.line * line_spacing + layout_glyph.pen.y;
+			index_store.push_back(Rectf(layout_glyph.pen.x, ypos - font_ascent, Sizef(metrics.advance.width, metrics.advance.height + font_height)));
 		}
 		return index_store;
 	}
@@ -260,7 +307,59 @@ namespace clan
 
 		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 		Pointf pos = canvas.grid_fit(position);
-		font_draw->draw_text(canvas, pos, text, color, line_spacing);
+		std::shared_ptr<const TextLayout> layout = get_layout(canvas, text, false);
+		font_draw->draw_text(canvas, pos, *layout, color, line_spacing);
+	}
+
+	void Font_Impl::draw_glyph_run(Canvas &canvas, const Pointf &position, const Colorf &color, GlyphRun_Impl &run)
+	{
+		select_font_family(canvas);
+
+		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
+		GlyphAtlas *atlas = font_family.impl->get_glyph_atlas();
+
+		if (!run.is_resolved(font_draw, font_selection, selected_pixel_ratio, scaled_height, line_spacing, atlas->get_generation()))
+		{
+			run.clear();
+
+			uint64_t generation = atlas->get_generation();
+			std::shared_ptr<const TextLayout> layout = get_layout(canvas, run.text, false);
+			bool supported = font_draw->build_glyph_run(canvas, *layout, line_spacing, selected_pixel_ratio, run);
+
+			// Adding glyphs may have moved the glyphs resolved before them, in which case the run is resolved again next time
+			bool atlas_unchanged = atlas->get_generation() == generation;
+			run.drawable = supported && atlas_unchanged;
+			run.resolved = atlas_unchanged && layout->complete;
+			run.font_draw = font_draw;
+			run.font_selection = font_selection;
+			run.pixel_ratio = selected_pixel_ratio;
+			run.scaled_height = scaled_height;
+			run.line_spacing = line_spacing;
+			run.atlas_generation = generation;
+		}
+
+		Pointf pos = canvas.grid_fit(position);
+		if (run.drawable)
+		{
+			// Keep the glyphs of the run from looking unused to the atlas eviction and compaction
+			for (Font_TextureGlyph *glyph : run.glyphs)
+				atlas->touch(glyph);
+
+			RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
+			for (const GlyphRun_Impl::Segment &segment : run.segments)
+				batcher->draw_glyph_run(canvas, pos, color, run.program, segment.texture, run.quads.data() + segment.first_quad, segment.num_quads);
+		}
+		else
+		{
+			std::shared_ptr<const TextLayout> layout = get_layout(canvas, run.text, false);
+			font_draw->draw_text(canvas, pos, *layout, color, line_spacing);
+		}
+	}
+
+	void Font_Impl::prewarm(Canvas &canvas, const std::string &charset)
+	{
+		select_font_family(canvas);
+		font_draw->prewarm(canvas, charset);
 	}
 
 	GlyphMetrics Font_Impl::get_metrics(Canvas &canvas, unsigned int glyph)
@@ -277,51 +376,12 @@ namespace clan
 	GlyphMetrics Font_Impl::measure_text(Canvas &canvas, const std::string &string)
 	{
 		select_font_family(canvas);
-		GlyphMetrics total_metrics;
-
-		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
-		bool first_char = true;
-		Rectf text_bbox;
-
-		UTF8_Reader reader(string.data(), string.length());
-		while (!reader.is_end())
-		{
-			unsigned int glyph = reader.get_char();
-			reader.next();
-
-			if (glyph == '\n')
-			{
-				total_metrics.advance.width = 0;
-				total_metrics.advance.height += line_spacing;
-				continue;
-			}
-
-			GlyphMetrics metrics = font_draw->get_metrics(canvas, glyph);
-
-			metrics.bbox_offset.x += total_metrics.advance.width;
-			metrics.bbox_offset.y += total_metrics.advance.height;
-
-			if (first_char)
-			{
-				text_bbox = Rectf(metrics.bbox_offset, metrics.bbox_size);
-				first_char = false;
-			}
-			else
-			{
-				Rectf glyph_bbox(metrics.bbox_offset, metrics.bbox_size);
-				text_bbox.bounding_rect(glyph_bbox);
-			}
-
-			total_metrics.advance += metrics.advance;
-		}
-
-		total_metrics.bbox_offset = text_bbox.get_top_left();
-		total_metrics.bbox_size = text_bbox.get_size();
-
-		total_metrics.advance *= scaled_height;
-		total_metrics.bbox_offset *= scaled_height;
-		total_metrics.bbox_size *= scaled_height;
+		std::shared_ptr<const TextLayout> layout = get_layout(canvas, string, true);
 
+		GlyphMetrics total_metrics;
+		total_metrics.advance = layout->advance * scaled_height;
+		total_metrics.bbox_offset = layout->bbox.get_top_left() * scaled_height;
+		total_metrics.bbox_size = layout->bbox.get_size() * scaled_height;
 		return total_metrics;
 	}
 
@@ -364,6 +424,15 @@ namespace clan
 		// (Don't need to reset the font engine)
 	}
 
+	void Font_Impl::set_distance_field(bool enable)
+	{
+		if (selected_distance_field != enable)
+		{
+			selected_distance_field = enable;
+			font_engine = nullptr;
+		}
+	}
+
 	FontDescription Font_Impl::get_description() const
 	{
 		return selected_description.clone();
@@ -45,12 +45,14 @@
 #include "FontDraw/font_draw_flat.h"
 #include "FontDraw/font_draw_path.h"
 #include "FontDraw/font_draw_scaled.h"
+#include "FontDraw/font_draw_distance_field.h"
 
 namespace clan
 {
 	class FontEngine;
 	class XMLResourceNode;
 	class DomElement;
+	class GlyphRun_Impl;
 
 	class Font_Impl
 	{
@@ -62,6 +64,8 @@ namespace clan
 
 		FontDescription get_description() const;
 
+		GlyphAtlasStatistics get_glyph_atlas_statistics() const { return font_family.get_glyph_atlas_statistics(); }
+
 		int get_character_index(Canvas &canvas, const std::string &text, const Pointf &point);
 		std::vector<Rectf> get_character_indices(Canvas &canvas, const std::string &text);
 
@@ -71,6 +75,10 @@ namespace clan
 
 		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color);
 
+		void prewarm(Canvas &canvas, const std::string &charset);
+
+		void draw_glyph_run(Canvas &canvas, const Pointf &position, const Colorf &color, GlyphRun_Impl &run);
+
 		void get_glyph_path(Canvas &canvas, unsigned int glyph_index, Path &out_path, GlyphMetrics &out_metrics);
 
 		void set_height(float value);
@@ -78,28 +86,40 @@ namespace clan
 		void set_line_height(float height);
 		void set_style(FontStyle setting);
 		void set_scalable(float height_threshold);
+		void set_distance_field(bool enable);
 		FontHandle *get_handle(Canvas &canvas);
 
 	private:
 		void select_font_family(Canvas &canvas);
 
+		/// \brief Returns the layout of the text for the selected font, from the text layout cache of the font family if possible
+		///
+		/// If wait is false, glyphs being rasterized in the background get empty metrics and the layout is not cached.
+		std::shared_ptr<const TextLayout> get_layout(Canvas &canvas, const std::string &text, bool wait);
+
 		FontDescription selected_description;
 		float selected_line_height = 0.0f;
 		float selected_pixel_ratio = 1.0f;
 		float scaled_height = 1.0f;
 		float selected_height_threshold = 64.0f;		// Values greater or equal to this value can be drawn scaled
 		bool selected_pathfont = false;
+		bool selected_distance_field = false;
+
+		static const float distance_field_reference_height;	// Height the distance field glyphs are rasterized at
 
 		FontMetrics selected_metrics;
 
 		FontEngine *font_engine = nullptr;	// If null, use select_font_family() to update
+		uint64_t font_selection = 0;		// Incremented whenever select_font_family() picks the font engine and drawing method again
 		FontFamily font_family;
 
 		Font_Draw *font_draw = nullptr;
+		const void *layout_metrics_source = nullptr;	// Cache providing the glyph metrics of font_draw
 
 		Font_DrawSubPixel font_draw_subpixel;
 		Font_DrawFlat font_draw_flat;
 		Font_DrawScaled font_draw_scaled;
 		Font_DrawPath font_draw_path;
+		Font_DrawDistanceField font_draw_distance_field;
 	};
 }
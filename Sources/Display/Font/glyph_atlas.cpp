@@ -0,0 +1,335 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "glyph_atlas.h"
+#include "glyph_cache.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/Render/graphic_context.h"
+#include <algorithm>
+
+namespace clan
+{
+	bool GlyphAtlasPage::allocate(const Size &size, Rect &out_rect)
+	{
+		if (size.width > page_size.width || size.height > page_size.height)
+			return false;
+
+		// Use the lowest shelf that fits, as long as it does not waste too much height
+		Shelf *best_shelf = nullptr;
+		for (auto &shelf : shelves)
+		{
+			if (shelf.height < size.height || shelf.height > size.height + size.height / 4 + 1)
+				continue;
+			if (shelf.next_x + size.width > page_size.width)
+				continue;
+			if (!best_shelf || shelf.height < best_shelf->height)
+				best_shelf = &shelf;
+		}
+
+		if (!best_shelf)
+		{
+			if (next_shelf_y + size.height > page_size.height)
+				return false;
+
+			shelves.push_back({ next_shelf_y, size.height, 0 });
+			next_shelf_y += size.height;
+			best_shelf = &shelves.back();
+		}
+
+		out_rect = Rect(Point(best_shelf->next_x, best_shelf->y), size);
+		best_shelf->next_x += size.width;
+		allocated_area += size.width * size.height;
+		return true;
+	}
+
+	void GlyphAtlasPage::reset()
+	{
+		shelves.clear();
+		next_shelf_y = 0;
+		glyphs.clear();
+		allocated_area = 0;
+		last_used = 0;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	GlyphAtlas::GlyphAtlas(const Size &page_size) : page_size(page_size)
+	{
+	}
+
+	GlyphAtlas::~GlyphAtlas()
+	{
+	}
+
+	GlyphAtlasStatistics GlyphAtlas::get_statistics() const
+	{
+		GlyphAtlasStatistics stats;
+		stats.hits = hits;
+		stats.misses = misses;
+		stats.page_count = (int)pages.size();
+		stats.evicted_pages = evicted_pages;
+		stats.compactions = compactions;
+
+		int64_t allocated_area = 0;
+		int64_t total_area = 0;
+		for (const auto &page : pages)
+		{
+			stats.glyph_count += (int)page->glyphs.size();
+			stats.bytes += page->get_bytes();
+			allocated_area += page->allocated_area;
+			total_area += (int64_t)page->page_size.width * page->page_size.height;
+		}
+		if (total_area > 0)
+			stats.occupancy = (float)((double)allocated_area / total_area);
+
+		return stats;
+	}
+
+	void GlyphAtlas::touch(Font_TextureGlyph *glyph)
+	{
+		glyph->last_used = ++tick;
+		if (glyph->atlas_page)
+			glyph->atlas_page->last_used = glyph->last_used;
+	}
+
+	void GlyphAtlas::insert(Canvas &canvas, Font_TextureGlyph *glyph, const PixelBuffer &image, int border_size)
+	{
+		GlyphAtlasPage *page = nullptr;
+		Rect rect;
+		allocate(canvas, image.get_size(), page, rect);
+
+		GraphicContext gc = canvas.get_gc();
+		page->texture.set_subimage(gc, rect.left, rect.top, image, image.get_size());
+
+		glyph->texture = page->texture;
+		glyph->geometry = Rect(rect.left + border_size, rect.top + border_size, rect.right - border_size, rect.bottom - border_size);
+		glyph->atlas_page = page;
+		glyph->atlas_rect = rect;
+		page->glyphs.push_back(glyph);
+		touch(glyph);
+	}
+
+	void GlyphAtlas::remove_cache(GlyphCache *cache)
+	{
+		for (auto &page : pages)
+		{
+			auto it = std::remove_if(page->glyphs.begin(), page->glyphs.end(), [&](Font_TextureGlyph *glyph)
+			{
+				if (glyph->cache != cache)
+					return false;
+				page->allocated_area -= glyph->atlas_rect.get_width() * glyph->atlas_rect.get_height();
+				return true;
+			});
+			page->glyphs.erase(it, page->glyphs.end());
+		}
+	}
+
+	bool GlyphAtlas::allocate(Canvas &canvas, const Size &size, GlyphAtlasPage *&out_page, Rect &out_rect)
+	{
+		if (allocate_in_pages(size, out_page, out_rect))
+			return true;
+
+		Size new_page_size(std::max(page_size.width, size.width), std::max(page_size.height, size.height));
+		size_t new_page_bytes = (size_t)new_page_size.width * new_page_size.height * 4;
+
+		if (budget != 0 && !pages.empty() && get_bytes() + new_page_bytes > budget)
+		{
+			reclaim(canvas);
+			if (allocate_in_pages(size, out_page, out_rect))
+				return true;
+
+			// Not enough room for this glyph. Drop the least recently used pages until a new page fits the budget
+			while (!pages.empty() && get_bytes() + new_page_bytes > budget)
+			{
+				auto it = std::min_element(pages.begin(), pages.end(), [](const std::unique_ptr<GlyphAtlasPage> &a, const std::unique_ptr<GlyphAtlasPage> &b) { return a->last_used < b->last_used; });
+				evict_page(it - pages.begin());
+				pages.erase(it);
+			}
+		}
+
+		out_page = add_page(canvas, new_page_size);
+		return out_page->allocate(size, out_rect);
+	}
+
+	bool GlyphAtlas::allocate_in_pages(const Size &size, GlyphAtlasPage *&out_page, Rect &out_rect)
+	{
+		for (auto &page : pages)
+		{
+			if (page->allocate(size, out_rect))
+			{
+				out_page = page.get();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	GlyphAtlasPage *GlyphAtlas::add_page(Canvas &canvas, const Size &size)
+	{
+		GraphicContext gc = canvas.get_gc();
+		auto page = std::make_unique<GlyphAtlasPage>();
+		page->page_size = size;
+		page->texture = Texture2D(gc, size);
+		pages.push_back(std::move(page));
+		return pages.back().get();
+	}
+
+	size_t GlyphAtlas::get_bytes() const
+	{
+		size_t bytes = 0;
+		for (const auto &page : pages)
+			bytes += page->get_bytes();
+		return bytes;
+	}
+
+	void GlyphAtlas::reclaim(Canvas &canvas)
+	{
+		// Text already batched may still refer to the pages about to be overwritten
+		canvas.flush();
+
+		// Glyphs removed by the previous reclaim are no longer referenced by anyone checking the generation
+		retired_glyphs.clear();
+
+		int64_t allocated_area = 0;
+		int64_t live_area = 0;
+		for (const auto &page : pages)
+		{
+			allocated_area += page->allocated_area;
+			for (Font_TextureGlyph *glyph : page->glyphs)
+			{
+				if (glyph->last_used > reclaim_tick)
+					live_area += glyph->atlas_rect.get_width() * glyph->atlas_rect.get_height();
+			}
+		}
+
+		float fragmentation = allocated_area > 0 ? 1.0f - (float)((double)live_area / allocated_area) : 0.0f;
+		if (fragmentation > compaction_threshold)
+		{
+			compact(canvas);
+		}
+		else if (!pages.empty())
+		{
+			auto it = std::min_element(pages.begin(), pages.end(), [](const std::unique_ptr<GlyphAtlasPage> &a, const std::unique_ptr<GlyphAtlasPage> &b) { return a->last_used < b->last_used; });
+			evict_page(it - pages.begin());
+		}
+
+		reclaim_tick = tick;
+	}
+
+	void GlyphAtlas::compact(Canvas &canvas)
+	{
+		GraphicContext gc = canvas.get_gc();
+
+		struct LiveGlyph
+		{
+			Font_TextureGlyph *glyph;
+			PixelBuffer image;
+		};
+		std::vector<LiveGlyph> live_glyphs;
+
+		// Keep the glyphs used since the last reclaim, with a copy of the page they live in
+		for (auto &page : pages)
+		{
+			PixelBuffer image;
+			for (Font_TextureGlyph *glyph : page->glyphs)
+			{
+				if (glyph->last_used > reclaim_tick)
+				{
+					if (image.is_null())
+						image = page->texture.get_pixeldata(gc, TextureFormat::rgba8);
+					live_glyphs.push_back({ glyph, image });
+				}
+				else
+				{
+					remove_glyph(glyph);
+				}
+			}
+		}
+
+		// Re-pack into fresh pages. The old pages are released once every live glyph has been copied out of them
+		std::vector<std::unique_ptr<GlyphAtlasPage>> old_pages;
+		old_pages.swap(pages);
+
+		std::sort(live_glyphs.begin(), live_glyphs.end(), [](const LiveGlyph &a, const LiveGlyph &b) { return a.glyph->atlas_rect.get_height() > b.glyph->atlas_rect.get_height(); });
+
+		for (auto &live : live_glyphs)
+		{
+			Font_TextureGlyph *glyph = live.glyph;
+			Rect old_rect = glyph->atlas_rect;
+
+			GlyphAtlasPage *page = nullptr;
+			Rect rect;
+			if (!allocate_in_pages(old_rect.get_size(), page, rect))
+			{
+				Size new_page_size(std::max(page_size.width, old_rect.get_width()), std::max(page_size.height, old_rect.get_height()));
+				size_t new_page_bytes = (size_t)new_page_size.width * new_page_size.height * 4;
+				if (budget != 0 && get_bytes() + new_page_bytes > budget)
+				{
+					remove_glyph(glyph);
+					continue;
+				}
+				page = add_page(canvas, new_page_size);
+				page->allocate(old_rect.get_size(), rect);
+			}
+
+			page->texture.set_subimage(gc, rect.left, rect.top, live.image, old_rect);
+
+			glyph->texture = page->texture;
+			glyph->geometry.translate(rect.left - old_rect.left, rect.top - old_rect.top);
+			glyph->atlas_page = page;
+			glyph->atlas_rect = rect;
+			page->glyphs.push_back(glyph);
+			page->last_used = std::max(page->last_used, glyph->last_used);
+		}
+
+		compactions++;
+		generation++;
+	}
+
+	void GlyphAtlas::evict_page(size_t index)
+	{
+		GlyphAtlasPage *page = pages[index].get();
+		for (Font_TextureGlyph *glyph : page->glyphs)
+			remove_glyph(glyph);
+		page->reset();
+		evicted_pages++;
+		generation++;
+	}
+
+	void GlyphAtlas::remove_glyph(Font_TextureGlyph *glyph)
+	{
+		// Keep the glyph alive for anyone still holding a pointer to it, but let go of the page texture
+		std::unique_ptr<Font_TextureGlyph> retired = glyph->cache->remove_glyph(glyph);
+		retired->texture = Texture2D();
+		retired->atlas_page = nullptr;
+		retired->cache = nullptr;
+		retired_glyphs.push_back(std::move(retired));
+	}
+}
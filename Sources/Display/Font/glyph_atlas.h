@@ -0,0 +1,135 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Display/Font/font_family.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Core/Math/rect.h"
+#include <vector>
+#include <memory>
+
+namespace clan
+{
+	class Canvas;
+	class PixelBuffer;
+	class GlyphCache;
+	class Font_TextureGlyph;
+
+	/// \brief Texture page of a glyph atlas, packed in shelves (rows of glyphs sharing a height)
+	class GlyphAtlasPage
+	{
+	public:
+		struct Shelf
+		{
+			int y;
+			int height;
+			int next_x;
+		};
+
+		bool allocate(const Size &size, Rect &out_rect);
+		void reset();
+		size_t get_bytes() const { return (size_t)page_size.width * page_size.height * 4; }
+
+		Texture2D texture;
+		Size page_size;
+		std::vector<Shelf> shelves;
+		int next_shelf_y = 0;
+
+		std::vector<Font_TextureGlyph *> glyphs;
+		int allocated_area = 0;
+		uint64_t last_used = 0;
+	};
+
+	/// \brief Glyph texture storage shared by all glyph caches of a font family
+	///
+	/// The atlas allocates glyphs into texture pages. When a budget is set and the atlas is full, it either re-packs
+	/// the glyphs used since the previous reclaim into fresh pages, when enough of the allocated space is held by
+	/// glyphs that went unused, or evicts the least recently used page. Evicted glyphs are removed from their glyph
+	/// cache and get rasterized again on their next use.
+	///
+	/// A glyph pointer returned by GlyphCache::get_glyph() stays valid until the generation changes twice: evicted
+	/// glyphs are kept, with a null texture, until the next reclaim. Code holding glyph pointers beyond that must
+	/// compare get_generation() and fetch the glyphs again.
+	class GlyphAtlas
+	{
+	public:
+		GlyphAtlas(const Size &page_size);
+		~GlyphAtlas();
+
+		void set_budget(size_t bytes) { budget = bytes; }
+		size_t get_budget() const { return budget; }
+
+		void set_compaction_threshold(float value) { compaction_threshold = value; }
+		float get_compaction_threshold() const { return compaction_threshold; }
+
+		GlyphAtlasStatistics get_statistics() const;
+
+		/// \brief Incremented whenever glyphs are moved or removed, invalidating any copies of their texture coordinates or glyph pointers
+		uint64_t get_generation() const { return generation; }
+
+		void add_hit() { hits++; }
+		void add_miss() { misses++; }
+
+		/// \brief Mark the glyph as used
+		void touch(Font_TextureGlyph *glyph);
+
+		/// \brief Store the image of a glyph in the atlas, setting its texture and geometry
+		void insert(Canvas &canvas, Font_TextureGlyph *glyph, const PixelBuffer &image, int border_size);
+
+		/// \brief Remove all glyphs of a glyph cache that is being destroyed
+		void remove_cache(GlyphCache *cache);
+
+	private:
+		bool allocate(Canvas &canvas, const Size &size, GlyphAtlasPage *&out_page, Rect &out_rect);
+		bool allocate_in_pages(const Size &size, GlyphAtlasPage *&out_page, Rect &out_rect);
+		GlyphAtlasPage *add_page(Canvas &canvas, const Size &size);
+		size_t get_bytes() const;
+
+		void reclaim(Canvas &canvas);
+		void compact(Canvas &canvas);
+		void evict_page(size_t index);
+		void remove_glyph(Font_TextureGlyph *glyph);
+
+		Size page_size;
+		std::vector<std::unique_ptr<GlyphAtlasPage>> pages;
+		std::vector<std::unique_ptr<Font_TextureGlyph>> retired_glyphs;	// Glyphs removed since the previous reclaim
+
+		size_t budget = 0;
+		float compaction_threshold = 0.5f;
+
+		uint64_t tick = 0;
+		uint64_t reclaim_tick = 0;
+		uint64_t generation = 0;
+
+		int64_t hits = 0;
+		int64_t misses = 0;
+		int evicted_pages = 0;
+		int compactions = 0;
+	};
+}
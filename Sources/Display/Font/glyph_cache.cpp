@@ -29,6 +29,10 @@
 
 #include "Display/precomp.h"
 #include "glyph_cache.h"
+#include "glyph_atlas.h"
+#include "glyph_distance_field.h"
+#include "glyph_rasterizer.h"
+#include "glyph_disk_cache.h"
 #include "FontEngine/font_engine.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Display/Image/pixel_buffer_help.h"
@@ -56,41 +60,182 @@ namespace clan
 
 	GlyphCache::~GlyphCache()
 	{
+		if (atlas)
+			atlas->remove_cache(this);
 	}
 
-	Font_TextureGlyph *GlyphCache::get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph)
+	Font_TextureGlyph *GlyphCache::get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph, bool wait)
 	{
-		auto size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		if (rasterizer && rasterizer->has_completed())
+			insert_completed_glyphs(canvas);
+
+		Font_TextureGlyph *font_glyph = find_glyph(glyph);
+		if (font_glyph)
+		{
+			if (atlas)
+			{
+				atlas->add_hit();
+				atlas->touch(font_glyph);
+			}
+			return font_glyph;
+		}
+
+		if (disk_cache && insert_disk_cached_glyph(canvas, glyph))
+		{
+			if (atlas)
+				atlas->add_miss();
+			return find_glyph(glyph);
+		}
+
+		if (!wait && background_rasterization && get_rasterizer(font_engine))
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			// Draw nothing until a worker thread has rasterized the glyph
+			if (pending_glyphs.insert(glyph).second)
+			{
+				if (atlas)
+					atlas->add_miss();
+				rasterizer->request(font_engine, glyph);
+			}
+			return nullptr;
 		}
 
+		if (atlas)
+			atlas->add_miss();
+
 		// If glyph does not exist, create one automatically
 		FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
 		if (pb.glyph)	// Ignore invalid glyphs
 			insert_glyph(canvas, pb);
 
-		// Search for the glyph again
-		size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		// The font engine may return a different glyph than requested
+		return find_glyph(glyph);
+	}
+
+	Font_TextureGlyph *GlyphCache::find_glyph(unsigned int glyph) const
+	{
+		if (glyph <= 0xffff)
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			const GlyphPage *page = bmp_pages[glyph >> 8].get();
+			return page ? page->glyphs[glyph & 0xff] : nullptr;
 		}
 
-		return nullptr;
+		auto it = other_glyphs.find(glyph);
+		return it != other_glyphs.end() ? it->second : nullptr;
 	}
 
-	void GlyphCache::set_texture_group(TextureGroup &new_texture_group)
+	void GlyphCache::add_glyph(std::unique_ptr<Font_TextureGlyph> font_glyph)
 	{
-		texture_group = new_texture_group;
+		unsigned int glyph = font_glyph->glyph;
+		Font_TextureGlyph *ptr = font_glyph.get();
+		ptr->cache = this;
+		ptr->list_index = glyph_list.size();
+		glyph_list.push_back(std::move(font_glyph));
+
+		// The first glyph inserted for a character wins, as with the original linear search
+		if (glyph <= 0xffff)
+		{
+			std::unique_ptr<GlyphPage> &page = bmp_pages[glyph >> 8];
+			if (!page)
+				page = std::make_unique<GlyphPage>();
+			if (!page->glyphs[glyph & 0xff])
+				page->glyphs[glyph & 0xff] = ptr;
+		}
+		else
+		{
+			other_glyphs.insert(std::make_pair(glyph, ptr));
+		}
+	}
+
+	std::unique_ptr<Font_TextureGlyph> GlyphCache::remove_glyph(Font_TextureGlyph *font_glyph)
+	{
+		unsigned int glyph = font_glyph->glyph;
+		if (glyph <= 0xffff)
+		{
+			GlyphPage *page = bmp_pages[glyph >> 8].get();
+			if (page && page->glyphs[glyph & 0xff] == font_glyph)
+				page->glyphs[glyph & 0xff] = nullptr;
+		}
+		else
+		{
+			auto it = other_glyphs.find(glyph);
+			if (it != other_glyphs.end() && it->second == font_glyph)
+				other_glyphs.erase(it);
+		}
+
+		size_t index = font_glyph->list_index;
+		if (index + 1 != glyph_list.size())
+		{
+			std::swap(glyph_list[index], glyph_list.back());
+			glyph_list[index]->list_index = index;
+		}
+		std::unique_ptr<Font_TextureGlyph> removed = std::move(glyph_list.back());
+		glyph_list.pop_back();
+		return removed;
+	}
+
+	void GlyphCache::prewarm(Canvas &canvas, FontEngine *font_engine, const std::string &charset)
+	{
+		if (rasterizer && rasterizer->has_completed())
+			insert_completed_glyphs(canvas);
+
+		UTF8_Reader reader(charset.data(), charset.length());
+		while (!reader.is_end())
+		{
+			unsigned int glyph = reader.get_char();
+			reader.next();
+
+			if (find_glyph(glyph) || insert_disk_cached_glyph(canvas, glyph))
+				continue;
+
+			if (get_rasterizer(font_engine))
+			{
+				if (pending_glyphs.insert(glyph).second)
+					rasterizer->request(font_engine, glyph);
+			}
+			else
+			{
+				FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
+				if (pb.glyph)
+					insert_glyph(canvas, pb);
+			}
+		}
+	}
+
+	GlyphRasterizer *GlyphCache::get_rasterizer(FontEngine *font_engine)
+	{
+		if (!rasterizer_created)
+		{
+			rasterizer_created = true;
+			rasterizer = std::make_unique<GlyphRasterizer>(font_engine, distance_field_spread);
+			if (!rasterizer->is_supported())
+				rasterizer.reset();
+		}
+		return rasterizer.get();
+	}
+
+	void GlyphCache::insert_completed_glyphs(Canvas &canvas)
+	{
+		for (auto &completed : rasterizer->take_completed())
+		{
+			FontPixelBuffer &pb = completed.second;
+			if (!pb.glyph)
+				continue;	// Invalid glyphs stay pending, so they are not requested again
+
+			pending_glyphs.erase(completed.first);
+			if (!find_glyph(pb.glyph))	// The glyph may have been rasterized in the meantime for get_metrics()
+				insert_prepared_glyph(canvas, pb);
+		}
+	}
+
+	void GlyphCache::set_atlas(const std::shared_ptr<GlyphAtlas> &new_atlas)
+	{
+		atlas = new_atlas;
 	}
 
 	GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, Canvas &canvas, unsigned int glyph)
 	{
-		Font_TextureGlyph *gptr = get_glyph(canvas, font_engine, glyph);
+		// Layout needs the real metrics, so do not wait for background rasterization here
+		Font_TextureGlyph *gptr = get_glyph(canvas, font_engine, glyph, true);
 		if (gptr)
 		{
 			return gptr->metrics;
@@ -98,8 +243,57 @@ namespace clan
 		return GlyphMetrics();
 	}
 
+	bool GlyphCache::get_metrics_if_ready(FontEngine *font_engine, Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics)
+	{
+		Font_TextureGlyph *gptr = get_glyph(canvas, font_engine, glyph);
+		if (gptr)
+		{
+			out_metrics = gptr->metrics;
+			return true;
+		}
+		out_metrics = GlyphMetrics();
+		return pending_glyphs.find(glyph) == pending_glyphs.end();
+	}
+
 	void GlyphCache::insert_glyph(Canvas &canvas, FontPixelBuffer &pb)
 	{
+		prepare_glyph(pb, distance_field_spread);
+		insert_prepared_glyph(canvas, pb);
+	}
+
+	void GlyphCache::prepare_glyph(FontPixelBuffer &pb, int distance_field_spread)
+	{
+		if (pb.empty_buffer || distance_field_spread <= 0)
+			return;
+
+		PixelBuffer field = GlyphDistanceField::create(pb.buffer, pb.buffer_rect, distance_field_spread);
+
+		// Extend the glyph quad by the spread, converted to device independent pixels
+		Sizef pixel_size(1.0f, 1.0f);
+		if (pb.buffer_rect.get_width() > 0 && pb.buffer_rect.get_height() > 0)
+			pixel_size = Sizef(pb.size.width / pb.buffer_rect.get_width(), pb.size.height / pb.buffer_rect.get_height());
+		pb.offset.x -= distance_field_spread * pixel_size.width;
+		pb.offset.y -= distance_field_spread * pixel_size.height;
+		pb.size = Sizef(field.get_width() * pixel_size.width, field.get_height() * pixel_size.height);
+
+		pb.buffer = field;
+		pb.buffer_rect = field.get_size();
+	}
+
+	bool GlyphCache::insert_disk_cached_glyph(Canvas &canvas, unsigned int glyph)
+	{
+		FontPixelBuffer pb;
+		if (!disk_cache || !disk_cache->find(glyph, pb))
+			return false;
+		insert_prepared_glyph(canvas, pb);
+		return true;
+	}
+
+	void GlyphCache::insert_prepared_glyph(Canvas &canvas, FontPixelBuffer &pb)
+	{
+		if (disk_cache)
+			disk_cache->add(pb);
+
 		auto font_glyph = std::make_unique<Font_TextureGlyph>();
 
 		font_glyph->glyph = pb.glyph;
@@ -109,15 +303,11 @@ namespace clan
 		if (!pb.empty_buffer)
 		{
 			PixelBuffer buffer_with_border = PixelBufferHelp::add_border(pb.buffer, glyph_border_size, pb.buffer_rect);
-			GraphicContext gc = canvas.get_gc();
-			Subtexture sub_texture = texture_group.add(gc, buffer_with_border.get_size());
-			font_glyph->texture = sub_texture.get_texture();
-			font_glyph->geometry = Rect(sub_texture.get_geometry().left + glyph_border_size, sub_texture.get_geometry().top + glyph_border_size, pb.buffer_rect.get_size());
+			atlas->insert(canvas, font_glyph.get(), buffer_with_border, glyph_border_size);
 			font_glyph->size = pb.size;
-			sub_texture.get_texture().set_subimage(gc, sub_texture.get_geometry().left, sub_texture.get_geometry().top, buffer_with_border, buffer_with_border.get_size());
 		}
 
-		glyph_list.push_back(std::move(font_glyph));
+		add_glyph(std::move(font_glyph));
 	}
 
 	void GlyphCache::insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics)
@@ -135,6 +325,6 @@ namespace clan
 			font_glyph->geometry = sub_texture.get_geometry();
 		}
 
-		glyph_list.push_back(std::move(font_glyph));
+		add_glyph(std::move(font_glyph));
 	}
 }
@@ -37,6 +37,8 @@
 #include "API/Display/Render/texture_2d.h"
 #include <list>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace clan
 {
@@ -48,6 +50,11 @@ namespace clan
 	class FontPixelBuffer;
 	class Path;
 	class RenderBatchTriangle;
+	class GlyphCache;
+	class GlyphAtlas;
+	class GlyphAtlasPage;
+	class GlyphRasterizer;
+	class GlyphDiskCache;
 
 	/// \brief Font texture format (holds a pixel buffer containing a glyph)
 	class Font_TextureGlyph
@@ -76,6 +83,21 @@ namespace clan
 		Sizef size;
 
 		GlyphMetrics metrics;
+
+		/// \brief Glyph cache owning this glyph
+		GlyphCache *cache = nullptr;
+
+		/// \brief Index of this glyph in the glyph list of its cache
+		size_t list_index = 0;
+
+		/// \brief Atlas page holding the glyph image, or null if the texture is not owned by the atlas
+		GlyphAtlasPage *atlas_page = nullptr;
+
+		/// \brief Area allocated in the atlas page (including the border)
+		Rect atlas_rect;
+
+		/// \brief Atlas use counter value when the glyph was last used
+		uint64_t last_used = 0;
 	};
 
 	class GlyphCache
@@ -85,18 +107,67 @@ namespace clan
 		virtual ~GlyphCache();
 
 		/// \brief Get a glyph. Returns NULL if the glyph was not found
-		Font_TextureGlyph *get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph);
+		///
+		/// With background rasterization, missing glyphs are queued for the worker threads and NULL is returned,
+		/// unless wait is true.
+		Font_TextureGlyph *get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph, bool wait = false);
 
 		GlyphMetrics get_metrics(FontEngine *font_engine, Canvas &canvas, unsigned int glyph);
 
+		/// \brief Get the metrics of a glyph, unless it is queued for background rasterization. Returns false if the glyph is not ready
+		bool get_metrics_if_ready(FontEngine *font_engine, Canvas &canvas, unsigned int glyph, GlyphMetrics &out_metrics);
+
 		void insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics);
 		void insert_glyph(Canvas &canvas, FontPixelBuffer &pb);
 
-		void set_texture_group(TextureGroup &new_texture_group);
+		/// \brief Rasterize the glyphs of the charset that are not cached yet, on worker threads if the font engine supports it
+		void prewarm(Canvas &canvas, FontEngine *font_engine, const std::string &charset);
+
+		/// \brief Rasterize missing glyphs on worker threads instead of while drawing
+		void set_background_rasterization(bool enable) { background_rasterization = enable; }
+
+		/// \brief Convert a rasterized glyph to the format stored by a glyph cache (may be called from any thread)
+		static void prepare_glyph(FontPixelBuffer &pb, int distance_field_spread);
+
+		void set_atlas(const std::shared_ptr<GlyphAtlas> &new_atlas);
+
+		/// \brief Load missing glyphs from the disk cache before rasterizing them, and add rasterized glyphs to it
+		void set_disk_cache(const std::shared_ptr<GlyphDiskCache> &new_disk_cache) { disk_cache = new_disk_cache; }
+		GlyphDiskCache *get_disk_cache() const { return disk_cache.get(); }
+
+		/// \brief Store glyphs as signed distance fields covering spread pixels on each side of the outline (0 = coverage bitmaps)
+		void set_distance_field(int spread) { distance_field_spread = spread; }
+
+		/// \brief Remove a glyph evicted from the atlas, handing its ownership to the caller
+		std::unique_ptr<Font_TextureGlyph> remove_glyph(Font_TextureGlyph *font_glyph);
 
 	private:
+		Font_TextureGlyph *find_glyph(unsigned int glyph) const;
+		void insert_prepared_glyph(Canvas &canvas, FontPixelBuffer &pb);
+		bool insert_disk_cached_glyph(Canvas &canvas, unsigned int glyph);
+		GlyphRasterizer *get_rasterizer(FontEngine *font_engine);
+		void insert_completed_glyphs(Canvas &canvas);
+		void add_glyph(std::unique_ptr<Font_TextureGlyph> font_glyph);
+
 		std::vector<std::unique_ptr<Font_TextureGlyph>> glyph_list;
-		TextureGroup texture_group;
+		std::shared_ptr<GlyphAtlas> atlas;
+		std::shared_ptr<GlyphDiskCache> disk_cache;
+		int distance_field_spread = 0;
+
+		bool background_rasterization = false;
+		bool rasterizer_created = false;
+		std::unique_ptr<GlyphRasterizer> rasterizer;
+		std::unordered_set<unsigned int> pending_glyphs;
+
+		/// \brief Direct lookup table for the basic multilingual plane, allocated one page of 256 glyphs at a time
+		struct GlyphPage
+		{
+			Font_TextureGlyph *glyphs[256] = {};
+		};
+		std::unique_ptr<GlyphPage> bmp_pages[256];
+
+		/// \brief Lookup for glyphs outside the basic multilingual plane
+		std::unordered_map<unsigned int, Font_TextureGlyph *> other_glyphs;
 
 		static const int glyph_border_size = 1;
 	};
@@ -0,0 +1,198 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "glyph_disk_cache.h"
+#include "API/Display/Font/font_description.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/memory_device.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/Crypto/sha1.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Core/Text/string_help.h"
+
+namespace clan
+{
+	GlyphDiskCache::GlyphDiskCache(const std::string &filename) : filename(filename)
+	{
+		load();
+	}
+
+	GlyphDiskCache::~GlyphDiskCache()
+	{
+		try
+		{
+			save();
+		}
+		catch (const Exception &)
+		{
+			// The cache is only an optimization, failing to write it must not stop the application
+		}
+	}
+
+	std::string GlyphDiskCache::get_filename(const std::string &directory, const std::string &font_hash, const FontDescription &desc, float pixel_ratio, int distance_field_spread)
+	{
+		std::string key = string_format("%1 %2 %3 %4 %5 %6 %7",
+			font_hash,
+			StringHelp::float_to_text(desc.get_height()),
+			(int)desc.get_weight(),
+			(int)desc.get_style(),
+			(desc.get_subpixel() ? 1 : 0) + (desc.get_anti_alias() ? 2 : 0),
+			StringHelp::float_to_text(pixel_ratio),
+			distance_field_spread);
+
+		SHA1 sha1;
+		sha1.add(key.data(), (int)key.length());
+		sha1.calculate();
+		return PathHelp::combine(directory, sha1.get_hash() + ".glyphs");
+	}
+
+	bool GlyphDiskCache::find(unsigned int glyph, FontPixelBuffer &out_glyph) const
+	{
+		auto it = glyphs.find(glyph);
+		if (it == glyphs.end())
+			return false;
+
+		out_glyph = it->second;
+		return true;
+	}
+
+	void GlyphDiskCache::add(const FontPixelBuffer &glyph)
+	{
+		if (!glyph.glyph || glyphs.find(glyph.glyph) != glyphs.end())
+			return;
+
+		FontPixelBuffer stored = glyph;
+		if (!glyph.empty_buffer)
+		{
+			// Only keep the part of the buffer used by the glyph
+			stored.buffer = glyph.buffer.copy(glyph.buffer_rect);
+			stored.buffer_rect = Rect(0, 0, glyph.buffer_rect.get_width(), glyph.buffer_rect.get_height());
+		}
+		glyphs[glyph.glyph] = stored;
+		modified = true;
+	}
+
+	void GlyphDiskCache::save()
+	{
+		if (!modified)
+			return;
+
+		MemoryDevice device;
+		device.write_uint32(file_magic);
+		device.write_uint32(file_version);
+		device.write_uint32((uint32_t)glyphs.size());
+		for (const auto &it : glyphs)
+		{
+			const FontPixelBuffer &pb = it.second;
+			device.write_uint32(pb.glyph);
+			device.write_float(pb.offset.x);
+			device.write_float(pb.offset.y);
+			device.write_float(pb.size.width);
+			device.write_float(pb.size.height);
+			device.write_float(pb.metrics.bbox_offset.x);
+			device.write_float(pb.metrics.bbox_offset.y);
+			device.write_float(pb.metrics.bbox_size.width);
+			device.write_float(pb.metrics.bbox_size.height);
+			device.write_float(pb.metrics.advance.width);
+			device.write_float(pb.metrics.advance.height);
+			device.write_uint8(pb.empty_buffer ? 1 : 0);
+			if (!pb.empty_buffer)
+			{
+				int width = pb.buffer.get_width();
+				int height = pb.buffer.get_height();
+				device.write_uint32((uint32_t)pb.buffer.get_format());
+				device.write_int32(width);
+				device.write_int32(height);
+				int line_size = width * pb.buffer.get_bytes_per_pixel();
+				for (int y = 0; y < height; y++)
+					device.write(pb.buffer.get_line(y), line_size);
+			}
+		}
+
+		File::write_bytes(filename, device.get_data());
+		modified = false;
+	}
+
+	void GlyphDiskCache::load()
+	{
+		if (!FileHelp::file_exists(filename))
+			return;
+
+		try
+		{
+			DataBuffer data = File::read_bytes(filename);
+			MemoryDevice device(data);
+			if (device.read_uint32() != file_magic || device.read_uint32() != file_version)
+				return;
+
+			uint32_t count = device.read_uint32();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				FontPixelBuffer pb;
+				pb.glyph = device.read_uint32();
+				pb.offset.x = device.read_float();
+				pb.offset.y = device.read_float();
+				pb.size.width = device.read_float();
+				pb.size.height = device.read_float();
+				pb.metrics.bbox_offset.x = device.read_float();
+				pb.metrics.bbox_offset.y = device.read_float();
+				pb.metrics.bbox_size.width = device.read_float();
+				pb.metrics.bbox_size.height = device.read_float();
+				pb.metrics.advance.width = device.read_float();
+				pb.metrics.advance.height = device.read_float();
+				pb.empty_buffer = device.read_uint8() != 0;
+				if (!pb.empty_buffer)
+				{
+					TextureFormat format = (TextureFormat)device.read_uint32();
+					int width = device.read_int32();
+					int height = device.read_int32();
+					if (width <= 0 || height <= 0 || width > 4096 || height > 4096)
+						throw Exception("Invalid glyph size");
+					pb.buffer = PixelBuffer(width, height, format);
+					int line_size = width * pb.buffer.get_bytes_per_pixel();
+					for (int y = 0; y < height; y++)
+					{
+						if (device.read(pb.buffer.get_line(y), line_size) != (size_t)line_size)
+							throw Exception("Glyph cache file is truncated");
+					}
+					pb.buffer_rect = Rect(0, 0, width, height);
+				}
+				glyphs[pb.glyph] = pb;
+			}
+		}
+		catch (const Exception &)
+		{
+			// A damaged cache file is ignored and replaced when the cache is saved
+			glyphs.clear();
+			modified = true;
+		}
+	}
+}
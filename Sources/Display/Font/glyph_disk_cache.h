@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "FontEngine/font_engine.h"
+#include <string>
+#include <unordered_map>
+
+namespace clan
+{
+	class FontDescription;
+
+	/// \brief Rasterized glyphs of one font, stored in a file so they do not have to be rasterized again on the next run
+	///
+	/// The glyphs are stored as prepared for the glyph cache (after any distance field conversion), together with their metrics.
+	/// The file is loaded when the cache is created and written by save() if glyphs were added.
+	class GlyphDiskCache
+	{
+	public:
+		GlyphDiskCache(const std::string &filename);
+		~GlyphDiskCache();
+
+		/// \brief Returns the name of the cache file for a font
+		///
+		/// \param directory = Cache directory
+		/// \param font_hash = Hash of the font file (or typeface name, if the platform font engine loads the font by name)
+		/// \param desc = Font settings the glyphs were rasterized with
+		/// \param pixel_ratio = Pixel ratio the glyphs were rasterized for
+		/// \param distance_field_spread = Spread of distance field glyphs, 0 for coverage glyphs
+		static std::string get_filename(const std::string &directory, const std::string &font_hash, const FontDescription &desc, float pixel_ratio, int distance_field_spread);
+
+		const std::string &get_filename() const { return filename; }
+
+		/// \brief Find a glyph. Returns false if it is not in the cache
+		bool find(unsigned int glyph, FontPixelBuffer &out_glyph) const;
+
+		/// \brief Add a glyph, unless it is already in the cache
+		void add(const FontPixelBuffer &glyph);
+
+		/// \brief Write the cache file if glyphs were added since it was loaded or saved
+		void save();
+
+	private:
+		void load();
+
+		std::string filename;
+		std::unordered_map<unsigned int, FontPixelBuffer> glyphs;
+		bool modified = false;
+
+		static const uint32_t file_magic = 0x43474c43;	// "CLGC"
+		static const uint32_t file_version = 1;
+	};
+}
@@ -0,0 +1,152 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "glyph_distance_field.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Core/Math/rect.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace clan
+{
+	namespace
+	{
+		const double distance_infinity = 1e20;
+
+		// Squared euclidean distance transform of a sampled function in one dimension (Felzenszwalb and Huttenlocher)
+		void distance_transform_1d(const double *f, double *d, int n, std::vector<int> &v, std::vector<double> &z)
+		{
+			int k = 0;
+			v[0] = 0;
+			z[0] = -distance_infinity;
+			z[1] = distance_infinity;
+			for (int q = 1; q < n; q++)
+			{
+				double s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+				while (s <= z[k])
+				{
+					k--;
+					s = ((f[q] + (double)q * q) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+				}
+				k++;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = distance_infinity;
+			}
+
+			k = 0;
+			for (int q = 0; q < n; q++)
+			{
+				while (z[k + 1] < q)
+					k++;
+				d[q] = (double)(q - v[k]) * (q - v[k]) + f[v[k]];
+			}
+		}
+
+		// Replaces grid with the squared distance from each cell to the nearest cell holding zero
+		void distance_transform_2d(std::vector<double> &grid, int width, int height)
+		{
+			int size = std::max(width, height);
+			std::vector<double> f(size), d(size), z(size + 1);
+			std::vector<int> v(size);
+
+			for (int x = 0; x < width; x++)
+			{
+				for (int y = 0; y < height; y++)
+					f[y] = grid[y * width + x];
+				distance_transform_1d(f.data(), d.data(), height, v, z);
+				for (int y = 0; y < height; y++)
+					grid[y * width + x] = d[y];
+			}
+
+			for (int y = 0; y < height; y++)
+			{
+				distance_transform_1d(&grid[y * width], d.data(), width, v, z);
+				std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+			}
+		}
+	}
+
+	PixelBuffer GlyphDistanceField::create(const PixelBuffer &coverage, const Rect &rect, int spread)
+	{
+		PixelBuffer source = coverage.get_format() == TextureFormat::rgba8 ? coverage : coverage.to_format(TextureFormat::rgba8);
+
+		int width = rect.get_width() + spread * 2;
+		int height = rect.get_height() + spread * 2;
+
+		// Coverage of the padded area, 0-255
+		std::vector<unsigned char> alpha(width * height, 0);
+		for (int y = 0; y < rect.get_height(); y++)
+		{
+			const unsigned char *src = source.get_data_uint8() + (rect.top + y) * source.get_pitch() + rect.left * 4;
+			unsigned char *dest = &alpha[(y + spread) * width + spread];
+			for (int x = 0; x < rect.get_width(); x++)
+				dest[x] = std::max(std::max(src[x * 4 + 0], src[x * 4 + 1]), std::max(src[x * 4 + 2], src[x * 4 + 3]));
+		}
+
+		std::vector<double> outside(width * height);	// Squared distance to the nearest pixel inside the glyph
+		std::vector<double> inside(width * height);		// Squared distance to the nearest pixel outside the glyph
+		for (int i = 0; i < width * height; i++)
+		{
+			bool is_inside = alpha[i] >= 128;
+			outside[i] = is_inside ? 0.0 : distance_infinity;
+			inside[i] = is_inside ? distance_infinity : 0.0;
+		}
+		distance_transform_2d(outside, width, height);
+		distance_transform_2d(inside, width, height);
+
+		PixelBuffer field(width, height, TextureFormat::rgba8);
+		for (int y = 0; y < height; y++)
+		{
+			unsigned char *dest = field.get_data_uint8() + y * field.get_pitch();
+			for (int x = 0; x < width; x++)
+			{
+				int i = y * width + x;
+
+				// The outline runs halfway between the pixel centers, or through the pixel for partial coverage
+				double distance;
+				if (alpha[i] > 0 && alpha[i] < 255 && (inside[i] <= 1.0 && outside[i] <= 1.0))
+					distance = alpha[i] / 255.0 - 0.5;
+				else if (alpha[i] >= 128)
+					distance = std::sqrt(inside[i]) - 0.5;
+				else
+					distance = 0.5 - std::sqrt(outside[i]);
+
+				double value = 0.5 + distance / (2.0 * spread);
+				unsigned char v = (unsigned char)(std::min(std::max(value, 0.0), 1.0) * 255.0 + 0.5);
+				dest[x * 4 + 0] = v;
+				dest[x * 4 + 1] = v;
+				dest[x * 4 + 2] = v;
+				dest[x * 4 + 3] = v;
+			}
+		}
+		return field;
+	}
+}
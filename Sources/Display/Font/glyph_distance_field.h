@@ -0,0 +1,51 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+namespace clan
+{
+	class PixelBuffer;
+	class Rect;
+
+	/// \brief Converts glyph coverage bitmaps into signed distance fields
+	class GlyphDistanceField
+	{
+	public:
+		/// \brief Create a distance field image from the coverage of a glyph
+		///
+		/// The returned rgba8 image is the glyph area extended by spread pixels on each side. All channels hold the
+		/// distance to the glyph outline, mapped so that 0.5 is on the outline, 1.0 is spread pixels inside and 0.0
+		/// is spread pixels outside.
+		///
+		/// \param coverage = Glyph image. The highest channel value of each pixel is used as coverage
+		/// \param rect = Area of the glyph within the image
+		/// \param spread = Distance in pixels covered by the field, on either side of the outline
+		static PixelBuffer create(const PixelBuffer &coverage, const Rect &rect, int spread);
+	};
+}
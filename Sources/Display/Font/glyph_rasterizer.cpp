@@ -0,0 +1,222 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "glyph_rasterizer.h"
+#include "glyph_cache.h"
+#include <algorithm>
+#include <deque>
+#include <thread>
+
+namespace clan
+{
+	/// \brief Worker threads shared by the glyph rasterizers of all fonts
+	///
+	/// The pool exists while any rasterizer uses it, so no threads are left running when no fonts need them.
+	class GlyphRasterizerPool
+	{
+	public:
+		GlyphRasterizerPool();
+		~GlyphRasterizerPool();
+
+		static std::shared_ptr<GlyphRasterizerPool> get();
+
+		int get_thread_count() const { return (int)threads.size(); }
+
+		void queue(GlyphRasterizer *rasterizer, unsigned int glyph);
+
+		/// \brief Removes the queued glyphs of the rasterizer and waits until no thread is working for it
+		void cancel(GlyphRasterizer *rasterizer);
+
+	private:
+		void worker_main();
+
+		std::vector<std::thread> threads;
+
+		std::mutex mutex;
+		std::condition_variable worker_event;
+		std::condition_variable idle_event;
+		bool stop_flag = false;
+		std::deque<std::pair<GlyphRasterizer *, unsigned int>> requests;
+		std::vector<GlyphRasterizer *> active_rasterizers;
+
+		static std::mutex instance_mutex;
+		static std::weak_ptr<GlyphRasterizerPool> instance;
+	};
+
+	std::mutex GlyphRasterizerPool::instance_mutex;
+	std::weak_ptr<GlyphRasterizerPool> GlyphRasterizerPool::instance;
+
+	GlyphRasterizerPool::GlyphRasterizerPool()
+	{
+		int num_threads = std::max(1, std::min(4, (int)std::thread::hardware_concurrency() - 1));
+		for (int i = 0; i < num_threads; i++)
+			threads.push_back(std::thread(&GlyphRasterizerPool::worker_main, this));
+	}
+
+	GlyphRasterizerPool::~GlyphRasterizerPool()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		lock.unlock();
+		worker_event.notify_all();
+
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	std::shared_ptr<GlyphRasterizerPool> GlyphRasterizerPool::get()
+	{
+		std::unique_lock<std::mutex> lock(instance_mutex);
+		std::shared_ptr<GlyphRasterizerPool> pool = instance.lock();
+		if (!pool)
+		{
+			pool = std::make_shared<GlyphRasterizerPool>();
+			instance = pool;
+		}
+		return pool;
+	}
+
+	void GlyphRasterizerPool::queue(GlyphRasterizer *rasterizer, unsigned int glyph)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		requests.push_back(std::make_pair(rasterizer, glyph));
+		lock.unlock();
+		worker_event.notify_one();
+	}
+
+	void GlyphRasterizerPool::cancel(GlyphRasterizer *rasterizer)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		requests.erase(std::remove_if(requests.begin(), requests.end(), [&](const std::pair<GlyphRasterizer *, unsigned int> &request) { return request.first == rasterizer; }), requests.end());
+		idle_event.wait(lock, [&]() { return std::find(active_rasterizers.begin(), active_rasterizers.end(), rasterizer) == active_rasterizers.end(); });
+	}
+
+	void GlyphRasterizerPool::worker_main()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			worker_event.wait(lock, [&]() { return stop_flag || !requests.empty(); });
+			if (stop_flag)
+				break;
+
+			GlyphRasterizer *rasterizer = requests.front().first;
+			unsigned int glyph = requests.front().second;
+			requests.pop_front();
+			active_rasterizers.push_back(rasterizer);
+			lock.unlock();
+
+			rasterizer->rasterize(glyph);
+
+			lock.lock();
+			active_rasterizers.erase(std::find(active_rasterizers.begin(), active_rasterizers.end(), rasterizer));
+			lock.unlock();
+			idle_event.notify_all();
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	GlyphRasterizer::GlyphRasterizer(FontEngine *engine, int distance_field_spread) : distance_field_spread(distance_field_spread), completed_count(0)
+	{
+		std::unique_ptr<FontEngine> worker_engine = engine->create_worker_engine();
+		if (worker_engine)
+		{
+			idle_engines.push_back(worker_engine.get());
+			worker_engines.push_back(std::move(worker_engine));
+			pool = GlyphRasterizerPool::get();
+		}
+	}
+
+	GlyphRasterizer::~GlyphRasterizer()
+	{
+		if (pool)
+			pool->cancel(this);
+	}
+
+	void GlyphRasterizer::request(FontEngine *engine, unsigned int glyph)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		outstanding_requests++;
+
+		// Keep an engine for every glyph the pool can work on at the same time. Engines are created here, as
+		// the font engine they are created from belongs to this thread.
+		if ((int)worker_engines.size() < std::min(outstanding_requests, pool->get_thread_count()))
+		{
+			std::unique_ptr<FontEngine> worker_engine = engine->create_worker_engine();
+			if (worker_engine)
+			{
+				idle_engines.push_back(worker_engine.get());
+				worker_engines.push_back(std::move(worker_engine));
+			}
+		}
+		lock.unlock();
+
+		pool->queue(this, glyph);
+	}
+
+	std::vector<std::pair<unsigned int, FontPixelBuffer>> GlyphRasterizer::take_completed()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		std::vector<std::pair<unsigned int, FontPixelBuffer>> glyphs;
+		glyphs.swap(completed);
+		completed_count = 0;
+		return glyphs;
+	}
+
+	void GlyphRasterizer::rasterize(unsigned int glyph)
+	{
+		// There is normally an idle engine. If creating an extra one failed, wait for another thread to finish with its engine.
+		std::unique_lock<std::mutex> lock(mutex);
+		engine_event.wait(lock, [&]() { return !idle_engines.empty(); });
+		FontEngine *engine = idle_engines.back();
+		idle_engines.pop_back();
+		lock.unlock();
+
+		FontPixelBuffer pb;
+		try
+		{
+			pb = engine->get_font_glyph(glyph);
+			if (pb.glyph)
+				GlyphCache::prepare_glyph(pb, distance_field_spread);
+		}
+		catch (...)
+		{
+			pb = FontPixelBuffer();
+		}
+
+		lock.lock();
+		idle_engines.push_back(engine);
+		outstanding_requests--;
+		completed.push_back(std::make_pair(glyph, std::move(pb)));
+		completed_count++;
+		lock.unlock();
+		engine_event.notify_one();
+	}
+}
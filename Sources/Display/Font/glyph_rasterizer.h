@@ -0,0 +1,89 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "FontEngine/font_engine.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace clan
+{
+	class GlyphRasterizerPool;
+
+	/// \brief Rasterizes the glyphs of one font on the worker threads shared by all glyph caches
+	///
+	/// Each glyph being rasterized at the same time needs its own font engine, so worker engines are created
+	/// as needed, up to one per thread in the pool.
+	class GlyphRasterizer
+	{
+	public:
+		/// \brief Creates the first worker engine. The rasterizer is not supported if the font engine cannot create worker engines
+		///
+		/// \param engine = Font engine the worker engines are created from
+		/// \param distance_field_spread = Spread passed to GlyphCache::prepare_glyph
+		GlyphRasterizer(FontEngine *engine, int distance_field_spread);
+
+		/// \brief Cancels the queued glyphs and waits for the ones being rasterized
+		~GlyphRasterizer();
+
+		/// \brief Returns true if glyphs can be rasterized in the background
+		bool is_supported() const { return !worker_engines.empty(); }
+
+		/// \brief Queue a glyph for rasterization
+		///
+		/// \param engine = Font engine more worker engines are created from, if needed
+		/// \param glyph = Glyph to rasterize
+		void request(FontEngine *engine, unsigned int glyph);
+
+		/// \brief Returns true if rasterized glyphs are waiting to be collected
+		bool has_completed() const { return completed_count.load() > 0; }
+
+		/// \brief Collect the requested glyphs with their images. The glyph of an invalid image is 0
+		std::vector<std::pair<unsigned int, FontPixelBuffer>> take_completed();
+
+	private:
+		void rasterize(unsigned int glyph);
+
+		int distance_field_spread;
+		std::shared_ptr<GlyphRasterizerPool> pool;
+
+		std::mutex mutex;
+		std::condition_variable engine_event;
+		std::vector<std::unique_ptr<FontEngine>> worker_engines;
+		std::vector<FontEngine *> idle_engines;
+		int outstanding_requests = 0;
+		std::vector<std::pair<unsigned int, FontPixelBuffer>> completed;
+		std::atomic<int> completed_count;
+
+		friend class GlyphRasterizerPool;
+	};
+}
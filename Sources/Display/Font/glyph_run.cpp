@@ -0,0 +1,101 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Font/glyph_run.h"
+#include "API/Display/2D/canvas.h"
+#include "glyph_run_impl.h"
+#include "font_impl.h"
+#include "glyph_cache.h"
+
+namespace clan
+{
+	GlyphRun::GlyphRun()
+	{
+	}
+
+	GlyphRun::GlyphRun(const Font &font, const std::string &text)
+	{
+		font.throw_if_null();
+		impl = std::make_shared<GlyphRun_Impl>(font, text);
+	}
+
+	void GlyphRun::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("GlyphRun is null");
+	}
+
+	Font GlyphRun::get_font() const
+	{
+		throw_if_null();
+		return impl->font;
+	}
+
+	const std::string &GlyphRun::get_text() const
+	{
+		throw_if_null();
+		return impl->text;
+	}
+
+	void GlyphRun::draw(Canvas &canvas, const Pointf &position, const Colorf &color)
+	{
+		throw_if_null();
+		impl->font.impl->draw_glyph_run(canvas, position, color, *impl);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	void GlyphRun_Impl::clear()
+	{
+		quads.clear();
+		segments.clear();
+		glyphs.clear();
+		resolved = false;
+		drawable = false;
+	}
+
+	void GlyphRun_Impl::add_quad(Font_TextureGlyph *glyph, const Rectf &dest)
+	{
+		const Texture2D &texture = glyph->texture;
+		const Rect &src = glyph->geometry;
+		if (segments.empty() || segments.back().texture != texture)
+			segments.push_back(Segment{ texture, (int)quads.size(), 0 });
+
+		float width = (float)texture.get_width();
+		float height = (float)texture.get_height();
+
+		RenderBatchTriangle::GlyphQuad quad;
+		quad.dest = dest;
+		quad.texcoord = Rectf(src.left / width, src.top / height, src.right / width, src.bottom / height);
+		quads.push_back(quad);
+		segments.back().num_quads++;
+		glyphs.push_back(glyph);
+	}
+}
@@ -0,0 +1,85 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Display/Font/font.h"
+#include "API/Display/Render/texture_2d.h"
+#include "Display/2D/render_batch_triangle.h"
+#include <vector>
+
+namespace clan
+{
+	class Font_Draw;
+	class Font_TextureGlyph;
+
+	class GlyphRun_Impl
+	{
+	public:
+		/// \brief Glyph quads sharing a texture
+		struct Segment
+		{
+			Texture2D texture;
+			int first_quad;
+			int num_quads;
+		};
+
+		GlyphRun_Impl(const Font &font, const std::string &text) : font(font), text(text) { }
+
+		/// \brief Returns true if the quads were resolved for the given font state and can be drawn again
+		bool is_resolved(const Font_Draw *current_font_draw, uint64_t current_font_selection, float current_pixel_ratio, float current_scaled_height, float current_line_spacing, uint64_t current_atlas_generation) const
+		{
+			return resolved && font_draw == current_font_draw && font_selection == current_font_selection && pixel_ratio == current_pixel_ratio &&
+				scaled_height == current_scaled_height && line_spacing == current_line_spacing && atlas_generation == current_atlas_generation;
+		}
+
+		void clear();
+
+		/// \brief Add a glyph, with the destination relative to the origin of the run
+		void add_quad(Font_TextureGlyph *glyph, const Rectf &dest);
+
+		Font font;
+		std::string text;
+
+		RenderBatchTriangle::BatchProgram program = RenderBatchTriangle::BatchProgram::sprite;
+		std::vector<RenderBatchTriangle::GlyphQuad> quads;
+		std::vector<Segment> segments;
+		std::vector<Font_TextureGlyph *> glyphs;	// Marked as used in the atlas whenever the quads are drawn
+
+		bool resolved = false;		// The quads can be reused while the font state below is unchanged
+		bool drawable = false;		// The quads are valid for the current atlas. If false, the text is drawn by the font instead
+
+		const Font_Draw *font_draw = nullptr;
+		uint64_t font_selection = 0;
+		float pixel_ratio = 0.0f;
+		float scaled_height = 0.0f;
+		float line_spacing = 0.0f;
+		uint64_t atlas_generation = 0;
+	};
+}
@@ -0,0 +1,100 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "text_layout_cache.h"
+#include <functional>
+
+namespace clan
+{
+	size_t TextLayoutKeyHash::operator()(const TextLayoutKey &key) const
+	{
+		size_t hash = std::hash<std::string>()(key.text);
+		hash ^= std::hash<const void *>()(key.metrics_source) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(key.pixel_ratio) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(key.line_spacing) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	std::shared_ptr<const TextLayout> TextLayoutCache::find(const TextLayoutKey &key)
+	{
+		auto it = lookup.find(key);
+		if (it == lookup.end())
+			return nullptr;
+
+		entries.splice(entries.begin(), entries, it->second);
+		return it->second->layout;
+	}
+
+	void TextLayoutCache::insert(const TextLayoutKey &key, const std::shared_ptr<const TextLayout> &layout)
+	{
+		// Key text is stored twice, in the entry and in the lookup
+		size_t bytes = layout->get_bytes() + key.text.capacity() * 2 + sizeof(Entry) * 2;
+		if (bytes > budget)
+			return;
+
+		auto it = lookup.find(key);
+		if (it != lookup.end())
+		{
+			used_bytes -= it->second->bytes;
+			entries.erase(it->second);
+			lookup.erase(it);
+		}
+
+		trim(budget - bytes);
+
+		entries.push_front(Entry{ key, layout, bytes });
+		lookup[key] = entries.begin();
+		used_bytes += bytes;
+	}
+
+	void TextLayoutCache::set_budget(size_t bytes)
+	{
+		budget = bytes;
+		trim(budget);
+	}
+
+	void TextLayoutCache::clear()
+	{
+		lookup.clear();
+		entries.clear();
+		used_bytes = 0;
+	}
+
+	void TextLayoutCache::trim(size_t max_bytes)
+	{
+		while (used_bytes > max_bytes && !entries.empty())
+		{
+			Entry &entry = entries.back();
+			used_bytes -= entry.bytes;
+			lookup.erase(entry.key);
+			entries.pop_back();
+		}
+	}
+}
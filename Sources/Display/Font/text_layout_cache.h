@@ -0,0 +1,119 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#pragma once
+
+#include "API/Display/Font/glyph_metrics.h"
+#include "API/Core/Math/rect.h"
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace clan
+{
+	/// \brief Position and metrics of a glyph in a text layout
+	struct TextLayoutGlyph
+	{
+		unsigned int glyph = 0;
+		unsigned int byte_offset = 0;	// Position of the character in the UTF-8 text
+		unsigned int line = 0;
+		Pointf pen;						// Pen position within the line, before the glyph is drawn
+		GlyphMetrics metrics;
+	};
+
+	/// \brief Result of decoding and measuring a string once, in the units of the font engine
+	///
+	/// Line feeds are kept as glyphs with empty metrics, so the glyph list has one entry per character.
+	class TextLayout
+	{
+	public:
+		std::vector<TextLayoutGlyph> glyphs;
+		Sizef advance;					// Advance of the whole text, using the line spacing of the key
+		Rectf bbox;
+		bool complete = true;			// False if some glyph metrics were not available yet (background rasterization)
+
+		size_t get_bytes() const { return sizeof(TextLayout) + glyphs.capacity() * sizeof(TextLayoutGlyph); }
+	};
+
+	/// \brief Identifies a text layout: the text, the source of its glyph metrics, pixel ratio and line spacing
+	struct TextLayoutKey
+	{
+		std::string text;
+		const void *metrics_source = nullptr;	// Glyph or path cache the metrics were taken from
+		float pixel_ratio = 1.0f;
+		float line_spacing = 0.0f;
+
+		bool operator==(const TextLayoutKey &other) const
+		{
+			return metrics_source == other.metrics_source && pixel_ratio == other.pixel_ratio && line_spacing == other.line_spacing && text == other.text;
+		}
+	};
+
+	struct TextLayoutKeyHash
+	{
+		size_t operator()(const TextLayoutKey &key) const;
+	};
+
+	/// \brief Least recently used cache of text layouts, shared by the fonts of a font family
+	///
+	/// Measuring, hit testing and drawing the same string reuse one layout instead of decoding the text
+	/// and looking up every glyph again.
+	class TextLayoutCache
+	{
+	public:
+		/// \brief Returns the cached layout, or null
+		std::shared_ptr<const TextLayout> find(const TextLayoutKey &key);
+
+		/// \brief Store a layout, evicting the least recently used layouts to stay within the budget
+		void insert(const TextLayoutKey &key, const std::shared_ptr<const TextLayout> &layout);
+
+		void set_budget(size_t bytes);
+		size_t get_budget() const { return budget; }
+		size_t get_bytes() const { return used_bytes; }
+
+		void clear();
+
+	private:
+		struct Entry
+		{
+			TextLayoutKey key;
+			std::shared_ptr<const TextLayout> layout;
+			size_t bytes;
+		};
+
+		void trim(size_t max_bytes);
+
+		std::list<Entry> entries;		// Most recently used first
+		std::unordered_map<TextLayoutKey, std::list<Entry>::iterator, TextLayoutKeyHash> lookup;
+		size_t budget = 1024 * 1024;
+		size_t used_bytes = 0;
+	};
+}
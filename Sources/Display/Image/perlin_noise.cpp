@@ -28,7 +28,16 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Image/perlin_noise.h"
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
 
 // This perlin noise code is based from ideas from numerious sources, including
 // The original perlin noise example code
@@ -56,40 +65,44 @@ namespace clan
 	class PerlinNoise_PixelWriter
 	{
 	public:
-		virtual void line_end() = 0;
-		virtual void write_pixel(float value) = 0;
+		virtual ~PerlinNoise_PixelWriter() {}
+
+		/// \brief Writes a row of noise values. Rows may be written from several threads at once
+		virtual void write_row(int y, const float *values, int count) = 0;
+
+	protected:
+		static int to_color(float value)
+		{
+			int color = (int)((value*128.0f) + 128.0f);
+			if (color > 255)
+				color = 255;
+			if (color < 0)
+				color = 0;
+			return color;
+		}
 	};
 
 	class PerlinNoise_PixelWriter_RGBA8 : public PerlinNoise_PixelWriter
 	{
 	public:
 		PerlinNoise_PixelWriter_RGBA8(PixelBuffer &pbuff)
-			: pitch(pbuff.get_pitch() / pbuff.get_bytes_per_pixel()),
-			current_ptr((uint32_t *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
-		{
-		}
-
-		void line_end() override
+			: pitch(pbuff.get_pitch()),
+			data((uint8_t *)pbuff.get_data())
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
 		}
 
-		void write_pixel(float value) override
+		void write_row(int y, const float *values, int count) override
 		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
-
-			*(current_ptr++) = color << 24 | color << 16 | color << 8 | color;
+			uint32_t *current_ptr = (uint32_t *)(data + y * pitch);
+			for (int x = 0; x < count; x++)
+			{
+				int color = to_color(values[x]);
+				*(current_ptr++) = color << 24 | color << 16 | color << 8 | color;
+			}
 		}
 	private:
 		int pitch;
-		uint32_t *current_ptr;
-		uint32_t *line_start_ptr;
+		uint8_t *data;
 	};
 
 	class PerlinNoise_PixelWriter_RGB8 : public PerlinNoise_PixelWriter
@@ -97,33 +110,24 @@ namespace clan
 	public:
 		PerlinNoise_PixelWriter_RGB8(PixelBuffer &pbuff)
 			: pitch(pbuff.get_pitch()),
-			current_ptr((uint8_t *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
+			data((uint8_t *)pbuff.get_data())
 		{
 		}
 
-		void line_end() override
+		void write_row(int y, const float *values, int count) override
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
-		}
-
-		void write_pixel(float value) override
-		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
-
-			*(current_ptr++) = color;
-			*(current_ptr++) = color;
-			*(current_ptr++) = color;
+			uint8_t *current_ptr = data + y * pitch;
+			for (int x = 0; x < count; x++)
+			{
+				int color = to_color(values[x]);
+				*(current_ptr++) = color;
+				*(current_ptr++) = color;
+				*(current_ptr++) = color;
+			}
 		}
 	private:
 		int pitch;
-		uint8_t *current_ptr;
-		uint8_t *line_start_ptr;
+		uint8_t *data;
 	};
 
 	class PerlinNoise_PixelWriter_R8 : public PerlinNoise_PixelWriter
@@ -131,57 +135,37 @@ namespace clan
 	public:
 		PerlinNoise_PixelWriter_R8(PixelBuffer &pbuff)
 			: pitch(pbuff.get_pitch()),
-			current_ptr((uint8_t *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
+			data((uint8_t *)pbuff.get_data())
 		{
 		}
 
-		void line_end() override
+		void write_row(int y, const float *values, int count) override
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
-		}
-
-		void write_pixel(float value) override
-		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
-
-			*(current_ptr++) = color;
+			uint8_t *current_ptr = data + y * pitch;
+			for (int x = 0; x < count; x++)
+				*(current_ptr++) = to_color(values[x]);
 		}
 	private:
 		int pitch;
-		uint8_t *current_ptr;
-		uint8_t *line_start_ptr;
+		uint8_t *data;
 	};
 
 	class PerlinNoise_PixelWriter_R32f : public PerlinNoise_PixelWriter
 	{
 	public:
 		PerlinNoise_PixelWriter_R32f(PixelBuffer &pbuff)
-			: pitch(pbuff.get_pitch() / sizeof(float)),
-			current_ptr((float *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
-		{
-		}
-
-		void line_end() override
+			: pitch(pbuff.get_pitch()),
+			data((uint8_t *)pbuff.get_data())
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
 		}
 
-		void write_pixel(float value) override
+		void write_row(int y, const float *values, int count) override
 		{
-			*(current_ptr++) = value;
+			memcpy(data + y * pitch, values, count * sizeof(float));
 		}
 	private:
 		int pitch;
-		float *current_ptr;
-		float *line_start_ptr;
+		uint8_t *data;
 	};
 
 	class PerlinNoise_Impl
@@ -198,6 +182,9 @@ namespace clan
 		PixelBuffer create_noise2d(float start_x, float end_x, float start_y, float end_y);
 		PixelBuffer create_noise1d(float start_x, float end_x);
 
+		PixelBuffer create_simplex_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position);
+		PixelBuffer create_simplex_noise2d(float start_x, float end_x, float start_y, float end_y);
+
 	public:
 		TextureFormat texture_format = TextureFormat::rgb8;
 		float amplitude = 1.0f;
@@ -206,10 +193,15 @@ namespace clan
 		int octaves = 1;
 
 	private:
-		void create_noise4d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position);
-		void create_noise3d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position);
-		void create_noise2d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y);
-		void create_noise1d(PerlinNoise_PixelWriter &writer, float start_x, float end_x);
+		typedef std::function<void(int y, float *row)> RowFunction;
+
+		PixelBuffer create_pixel_buffer(const RowFunction &create_row);
+		void create_rows(PerlinNoise_PixelWriter &writer, const RowFunction &create_row);
+
+		void create_noise4d_row(float *row, float start_x, float size_x, float value_y, float value_z, float value_w);
+		void create_noise3d_row(float *row, float start_x, float size_x, float value_y, float value_z);
+		void create_noise2d_row(float *row, float start_x, float size_x, float value_y);
+		void create_noise1d_row(float *row, float start_x, float size_x);
 
 		inline float gradient_1d(int permutation_value, float x);
 		inline float gradient_2d(int permutation_value, float x, float y);
@@ -221,12 +213,28 @@ namespace clan
 		float noise_3d(float x, float y, float z);
 		float noise_4d(float x, float y, float z, float w);
 
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		inline __m128i permutation_lookup(__m128i index) const;
+
+		__m128 noise_1d(__m128 x);
+		__m128 noise_2d(__m128 x, float y);
+		__m128 noise_3d(__m128 x, float y, float z);
+		__m128 noise_4d(__m128 x, float y, float z, float w);
+#endif
+
+		inline float simplex_gradient_2d(int permutation_value, float x, float y);
+		inline float simplex_gradient_3d(int permutation_value, float x, float y, float z);
+
+		float simplex_noise_2d(float x, float y);
+		float simplex_noise_3d(float x, float y, float z);
+
 		void setup();
 
 		bool permutation_table_set = false;
 
 		unsigned char permutation_table[permutation_table_size * 2];	// Table duplicated at permutation_table_size
 
+		static const int min_pixels_per_thread = 128 * 128;
 	};
 
 	PerlinNoise::PerlinNoise() : impl(std::make_shared<PerlinNoise_Impl>())
@@ -262,6 +270,16 @@ namespace clan
 		return impl->create_noise4d(start_x, end_x, start_y, end_y, z_position, w_position);
 	}
 
+	PixelBuffer PerlinNoise::create_simplex_noise2d(float start_x, float end_x, float start_y, float end_y)
+	{
+		return impl->create_simplex_noise2d(start_x, end_x, start_y, end_y);
+	}
+
+	PixelBuffer PerlinNoise::create_simplex_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
+	{
+		return impl->create_simplex_noise3d(start_x, end_x, start_y, end_y, z_position);
+	}
+
 	Size PerlinNoise::get_size() const
 	{
 		return Size(impl->width, impl->height);
@@ -627,6 +645,389 @@ namespace clan
 		return (cl_lerp(s, n0, n1));
 	}
 
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+
+	// The SSE versions evaluate four samples at once, with the same operations in the same order as
+	// the scalar versions above, so both produce identical results
+
+	namespace
+	{
+		inline __m128 perlin_s_curve(__m128 t)
+		{
+			__m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+			__m128 poly = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+			return _mm_mul_ps(t3, poly);
+		}
+
+		inline __m128 perlin_lerp(__m128 t, __m128 a, __m128 b)
+		{
+			return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+		}
+
+		// Same as cl_floor_to_int: truncate, then subtract one from values not above zero
+		inline __m128i perlin_floor_to_int(__m128 value)
+		{
+			__m128i not_positive = _mm_castps_si128(_mm_cmple_ps(value, _mm_setzero_ps()));
+			return _mm_add_epi32(_mm_cvttps_epi32(value), not_positive);
+		}
+
+		inline __m128i perlin_bit_set(__m128i value, int bit)
+		{
+			__m128i mask = _mm_set1_epi32(bit);
+			return _mm_cmpeq_epi32(_mm_and_si128(value, mask), mask);
+		}
+
+		inline __m128 perlin_select(__m128i condition, __m128 if_true, __m128 if_false)
+		{
+			__m128 mask = _mm_castsi128_ps(condition);
+			return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+		}
+
+		inline __m128 perlin_negate_if(__m128i condition, __m128 value)
+		{
+			return _mm_xor_ps(value, _mm_and_ps(_mm_castsi128_ps(condition), _mm_set1_ps(-0.0f)));
+		}
+
+		inline __m128 perlin_gradient_1d(__m128i permutation_value, __m128 x)
+		{
+			__m128 gradient = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(1), _mm_and_si128(permutation_value, _mm_set1_epi32(7))));
+			return _mm_mul_ps(perlin_negate_if(perlin_bit_set(permutation_value, 8), gradient), x);
+		}
+
+		inline __m128 perlin_gradient_2d(__m128i permutation_value, __m128 x, __m128 y)
+		{
+			__m128i swap = perlin_bit_set(permutation_value, 4);
+			__m128 u = perlin_negate_if(perlin_bit_set(permutation_value, 1), perlin_select(swap, y, x));
+			__m128 v = perlin_negate_if(perlin_bit_set(permutation_value, 2), perlin_select(swap, x, y));
+			return _mm_add_ps(u, _mm_mul_ps(_mm_set1_ps(2.0f), v));
+		}
+
+		inline __m128 perlin_gradient_3d(__m128i permutation_value, __m128 x, __m128 y, __m128 z)
+		{
+			__m128i bit8 = perlin_bit_set(permutation_value, 8);
+			__m128 u = perlin_select(bit8, y, x);
+			__m128 v = perlin_select(perlin_bit_set(permutation_value, 4), perlin_select(bit8, x, z), y);
+			u = perlin_negate_if(perlin_bit_set(permutation_value, 1), u);
+			v = perlin_negate_if(perlin_bit_set(permutation_value, 2), v);
+			return _mm_add_ps(u, v);
+		}
+
+		inline __m128 perlin_gradient_4d(__m128i permutation_value, __m128 x, __m128 y, __m128 z, __m128 t)
+		{
+			permutation_value = _mm_and_si128(permutation_value, _mm_set1_epi32(31));
+			__m128 u = perlin_select(_mm_cmplt_epi32(permutation_value, _mm_set1_epi32(24)), x, y);
+			__m128 v = perlin_select(_mm_cmplt_epi32(permutation_value, _mm_set1_epi32(16)), y, z);
+			__m128 w = perlin_select(_mm_cmplt_epi32(permutation_value, _mm_set1_epi32(8)), z, t);
+			u = perlin_negate_if(perlin_bit_set(permutation_value, 1), u);
+			v = perlin_negate_if(perlin_bit_set(permutation_value, 2), v);
+			w = perlin_negate_if(perlin_bit_set(permutation_value, 4), w);
+			return _mm_add_ps(_mm_add_ps(u, v), w);
+		}
+	}
+
+	__m128i PerlinNoise_Impl::permutation_lookup(__m128i index) const
+	{
+		// SSE2 has no gather. The table is only 512 bytes, so four scalar loads from L1 are cheap
+		alignas(16) int32_t indexes[4];
+		_mm_store_si128((__m128i *)indexes, index);
+		return _mm_setr_epi32(permutation_table[indexes[0]], permutation_table[indexes[1]], permutation_table[indexes[2]], permutation_table[indexes[3]]);
+	}
+
+	__m128 PerlinNoise_Impl::noise_1d(__m128 x)
+	{
+		__m128i period_mask = _mm_set1_epi32(cl_period_mask_x);
+
+		__m128i ix0 = perlin_floor_to_int(x);
+		__m128 fx0 = _mm_sub_ps(x, _mm_cvtepi32_ps(ix0));
+		__m128 fx1 = _mm_sub_ps(fx0, _mm_set1_ps(1.0f));
+		__m128i ix1 = _mm_and_si128(_mm_add_epi32(ix0, _mm_set1_epi32(1)), period_mask);
+		ix0 = _mm_and_si128(ix0, period_mask);
+
+		__m128 s = perlin_s_curve(fx0);
+
+		__m128 n0 = perlin_gradient_1d(permutation_lookup(ix0), fx0);
+		__m128 n1 = perlin_gradient_1d(permutation_lookup(ix1), fx1);
+		return perlin_lerp(s, n0, n1);
+	}
+
+	__m128 PerlinNoise_Impl::noise_2d(__m128 x, float y)
+	{
+		__m128i period_mask = _mm_set1_epi32(permutation_table_mask);
+
+		__m128i ix0 = perlin_floor_to_int(x);
+		__m128 fx0 = _mm_sub_ps(x, _mm_cvtepi32_ps(ix0));
+		__m128 fx1 = _mm_sub_ps(fx0, _mm_set1_ps(1.0f));
+		__m128i ix1 = _mm_and_si128(_mm_add_epi32(ix0, _mm_set1_epi32(1)), period_mask);
+		ix0 = _mm_and_si128(ix0, period_mask);
+		__m128 s = perlin_s_curve(fx0);
+
+		// y is the same for all lanes, so only the x corners need a lookup per lane
+		int iy0 = cl_floor_to_int(y);
+		float fy0 = y - iy0;
+		float fy1 = fy0 - 1.0f;
+		int iy1 = (iy0 + 1) & cl_period_mask_y;
+		iy0 = iy0 & cl_period_mask_y;
+		__m128 t = _mm_set1_ps(cl_s_curve(fy0));
+
+		__m128i py0 = _mm_set1_epi32(permutation_table[iy0]);
+		__m128i py1 = _mm_set1_epi32(permutation_table[iy1]);
+		__m128 vfy0 = _mm_set1_ps(fy0);
+		__m128 vfy1 = _mm_set1_ps(fy1);
+
+		__m128 nx0 = perlin_gradient_2d(permutation_lookup(_mm_add_epi32(ix0, py0)), fx0, vfy0);
+		__m128 nx1 = perlin_gradient_2d(permutation_lookup(_mm_add_epi32(ix0, py1)), fx0, vfy1);
+		__m128 n0 = perlin_lerp(t, nx0, nx1);
+
+		nx0 = perlin_gradient_2d(permutation_lookup(_mm_add_epi32(ix1, py0)), fx1, vfy0);
+		nx1 = perlin_gradient_2d(permutation_lookup(_mm_add_epi32(ix1, py1)), fx1, vfy1);
+		__m128 n1 = perlin_lerp(t, nx0, nx1);
+
+		return perlin_lerp(s, n0, n1);
+	}
+
+	__m128 PerlinNoise_Impl::noise_3d(__m128 x, float y, float z)
+	{
+		__m128i period_mask = _mm_set1_epi32(permutation_table_mask);
+
+		__m128i ix[2];
+		__m128 fx[2];
+		ix[0] = perlin_floor_to_int(x);
+		fx[0] = _mm_sub_ps(x, _mm_cvtepi32_ps(ix[0]));
+		fx[1] = _mm_sub_ps(fx[0], _mm_set1_ps(1.0f));
+		ix[1] = _mm_and_si128(_mm_add_epi32(ix[0], _mm_set1_epi32(1)), period_mask);
+		ix[0] = _mm_and_si128(ix[0], period_mask);
+		__m128 s = perlin_s_curve(fx[0]);
+
+		// y and z are the same for all lanes, so only the x corners need a lookup per lane
+		int iy[2], iz[2];
+		float fy[2], fz[2];
+		iy[0] = cl_floor_to_int(y);
+		iz[0] = cl_floor_to_int(z);
+		fy[0] = y - iy[0];
+		fz[0] = z - iz[0];
+		fy[1] = fy[0] - 1.0f;
+		fz[1] = fz[0] - 1.0f;
+		iy[1] = (iy[0] + 1) & cl_period_mask_y;
+		iz[1] = (iz[0] + 1) & cl_period_mask_z;
+		iy[0] = iy[0] & cl_period_mask_y;
+		iz[0] = iz[0] & cl_period_mask_z;
+		__m128 r = _mm_set1_ps(cl_s_curve(fz[0]));
+		__m128 t = _mm_set1_ps(cl_s_curve(fy[0]));
+
+		__m128 n[2];
+		for (int xi = 0; xi < 2; xi++)
+		{
+			__m128 nx[2];
+			for (int yi = 0; yi < 2; yi++)
+			{
+				__m128i pyz0 = _mm_set1_epi32(permutation_table[iy[yi] + permutation_table[iz[0]]]);
+				__m128i pyz1 = _mm_set1_epi32(permutation_table[iy[yi] + permutation_table[iz[1]]]);
+				__m128 nxy0 = perlin_gradient_3d(permutation_lookup(_mm_add_epi32(ix[xi], pyz0)), fx[xi], _mm_set1_ps(fy[yi]), _mm_set1_ps(fz[0]));
+				__m128 nxy1 = perlin_gradient_3d(permutation_lookup(_mm_add_epi32(ix[xi], pyz1)), fx[xi], _mm_set1_ps(fy[yi]), _mm_set1_ps(fz[1]));
+				nx[yi] = perlin_lerp(r, nxy0, nxy1);
+			}
+			n[xi] = perlin_lerp(t, nx[0], nx[1]);
+		}
+
+		return perlin_lerp(s, n[0], n[1]);
+	}
+
+	__m128 PerlinNoise_Impl::noise_4d(__m128 x, float y, float z, float w)
+	{
+		__m128i period_mask = _mm_set1_epi32(permutation_table_mask);
+
+		__m128i ix[2];
+		__m128 fx[2];
+		ix[0] = perlin_floor_to_int(x);
+		fx[0] = _mm_sub_ps(x, _mm_cvtepi32_ps(ix[0]));
+		fx[1] = _mm_sub_ps(fx[0], _mm_set1_ps(1.0f));
+		ix[1] = _mm_and_si128(_mm_add_epi32(ix[0], _mm_set1_epi32(1)), period_mask);
+		ix[0] = _mm_and_si128(ix[0], period_mask);
+		__m128 s = perlin_s_curve(fx[0]);
+
+		// y, z and w are the same for all lanes, so only the x corners need a lookup per lane
+		int iy[2], iz[2], iw[2];
+		float fy[2], fz[2], fw[2];
+		iy[0] = cl_floor_to_int(y);
+		iz[0] = cl_floor_to_int(z);
+		iw[0] = cl_floor_to_int(w);
+		fy[0] = y - iy[0];
+		fz[0] = z - iz[0];
+		fw[0] = w - iw[0];
+		fy[1] = fy[0] - 1.0f;
+		fz[1] = fz[0] - 1.0f;
+		fw[1] = fw[0] - 1.0f;
+		iy[1] = (iy[0] + 1) & cl_period_mask_y;
+		iz[1] = (iz[0] + 1) & cl_period_mask_z;
+		iw[1] = (iw[0] + 1) & cl_period_mask_w;
+		iy[0] = iy[0] & cl_period_mask_y;
+		iz[0] = iz[0] & cl_period_mask_z;
+		iw[0] = iw[0] & cl_period_mask_w;
+		__m128 q = _mm_set1_ps(cl_s_curve(fw[0]));
+		__m128 r = _mm_set1_ps(cl_s_curve(fz[0]));
+		__m128 t = _mm_set1_ps(cl_s_curve(fy[0]));
+
+		__m128 n[2];
+		for (int xi = 0; xi < 2; xi++)
+		{
+			__m128 nx[2];
+			for (int yi = 0; yi < 2; yi++)
+			{
+				__m128 nxy[2];
+				for (int zi = 0; zi < 2; zi++)
+				{
+					__m128i pyzw0 = _mm_set1_epi32(permutation_table[iy[yi] + permutation_table[iz[zi] + permutation_table[iw[0]]]]);
+					__m128i pyzw1 = _mm_set1_epi32(permutation_table[iy[yi] + permutation_table[iz[zi] + permutation_table[iw[1]]]]);
+					__m128 nxyz0 = perlin_gradient_4d(permutation_lookup(_mm_add_epi32(ix[xi], pyzw0)), fx[xi], _mm_set1_ps(fy[yi]), _mm_set1_ps(fz[zi]), _mm_set1_ps(fw[0]));
+					__m128 nxyz1 = perlin_gradient_4d(permutation_lookup(_mm_add_epi32(ix[xi], pyzw1)), fx[xi], _mm_set1_ps(fy[yi]), _mm_set1_ps(fz[zi]), _mm_set1_ps(fw[1]));
+					nxy[zi] = perlin_lerp(q, nxyz0, nxyz1);
+				}
+				nx[yi] = perlin_lerp(r, nxy[0], nxy[1]);
+			}
+			n[xi] = perlin_lerp(t, nx[0], nx[1]);
+		}
+
+		return perlin_lerp(s, n[0], n[1]);
+	}
+
+#endif
+
+	// Simplex noise, following Stefan Gustavson's "Simplex noise demystified" and his SimplexNoise1234 class.
+	// It uses the same permutation table as the perlin noise
+
+	float PerlinNoise_Impl::simplex_gradient_2d(int permutation_value, float x, float y)
+	{
+		permutation_value = permutation_value & 7;	// Convert low 3 bits of hash code into 8 gradient directions
+		float u = permutation_value < 4 ? x : y;
+		float v = permutation_value < 4 ? y : x;
+		return ((permutation_value & 1) ? -u : u) + ((permutation_value & 2) ? -2.0f * v : 2.0f * v);
+	}
+
+	float PerlinNoise_Impl::simplex_gradient_3d(int permutation_value, float x, float y, float z)
+	{
+		permutation_value = permutation_value & 15;	// Convert low 4 bits of hash code into 12 gradient directions
+		float u = permutation_value < 8 ? x : y;
+		float v = permutation_value < 4 ? y : (permutation_value == 12 || permutation_value == 14) ? x : z;
+		return ((permutation_value & 1) ? -u : u) + ((permutation_value & 2) ? -v : v);
+	}
+
+	float PerlinNoise_Impl::simplex_noise_2d(float x, float y)
+	{
+		const float F2 = 0.366025403f;	// 0.5*(sqrt(3.0)-1.0)
+		const float G2 = 0.211324865f;	// (3.0-sqrt(3.0))/6.0
+
+		// Skew the input space to find the simplex cell
+		float s = (x + y) * F2;
+		float xs = x + s;
+		float ys = y + s;
+		int i = cl_floor_to_int(xs);
+		int j = cl_floor_to_int(ys);
+
+		// Unskew the cell origin back to x,y space
+		float t = (float)(i + j) * G2;
+		float x0 = x - (i - t);
+		float y0 = y - (j - t);
+
+		// Find which of the two triangles in the cell we are in
+		int i1 = x0 > y0 ? 1 : 0;
+		int j1 = x0 > y0 ? 0 : 1;
+
+		float x1 = x0 - i1 + G2;
+		float y1 = y0 - j1 + G2;
+		float x2 = x0 - 1.0f + 2.0f * G2;
+		float y2 = y0 - 1.0f + 2.0f * G2;
+
+		int ii = i & permutation_table_mask;
+		int jj = j & permutation_table_mask;
+
+		// Corners further away than the kernel radius contribute zero
+		float t0 = std::max(0.5f - x0 * x0 - y0 * y0, 0.0f);
+		t0 *= t0;
+		float n0 = t0 * t0 * simplex_gradient_2d(permutation_table[ii + permutation_table[jj]], x0, y0);
+
+		float t1 = std::max(0.5f - x1 * x1 - y1 * y1, 0.0f);
+		t1 *= t1;
+		float n1 = t1 * t1 * simplex_gradient_2d(permutation_table[ii + i1 + permutation_table[jj + j1]], x1, y1);
+
+		float t2 = std::max(0.5f - x2 * x2 - y2 * y2, 0.0f);
+		t2 *= t2;
+		float n2 = t2 * t2 * simplex_gradient_2d(permutation_table[ii + 1 + permutation_table[jj + 1]], x2, y2);
+
+		// Scale the result to cover the same range as the perlin noise
+		return 40.0f * (n0 + n1 + n2);
+	}
+
+	float PerlinNoise_Impl::simplex_noise_3d(float x, float y, float z)
+	{
+		const float F3 = 1.0f / 3.0f;
+		const float G3 = 1.0f / 6.0f;
+
+		// Skew the input space to find the simplex cell
+		float s = (x + y + z) * F3;
+		float xs = x + s;
+		float ys = y + s;
+		float zs = z + s;
+		int i = cl_floor_to_int(xs);
+		int j = cl_floor_to_int(ys);
+		int k = cl_floor_to_int(zs);
+
+		// Unskew the cell origin back to x,y,z space
+		float t = (float)(i + j + k) * G3;
+		float x0 = x - (i - t);
+		float y0 = y - (j - t);
+		float z0 = z - (k - t);
+
+		// Find which of the six tetrahedra in the cell we are in
+		int i1, j1, k1;
+		int i2, j2, k2;
+		if (x0 >= y0)
+		{
+			if (y0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+			else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+			else { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+		}
+		else
+		{
+			if (y0 < z0) { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+			else if (x0 < z0) { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+			else { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+		}
+
+		float x1 = x0 - i1 + G3;
+		float y1 = y0 - j1 + G3;
+		float z1 = z0 - k1 + G3;
+		float x2 = x0 - i2 + 2.0f * G3;
+		float y2 = y0 - j2 + 2.0f * G3;
+		float z2 = z0 - k2 + 2.0f * G3;
+		float x3 = x0 - 1.0f + 3.0f * G3;
+		float y3 = y0 - 1.0f + 3.0f * G3;
+		float z3 = z0 - 1.0f + 3.0f * G3;
+
+		int ii = i & permutation_table_mask;
+		int jj = j & permutation_table_mask;
+		int kk = k & permutation_table_mask;
+
+		// Corners further away than the kernel radius contribute zero
+		float t0 = std::max(0.6f - x0 * x0 - y0 * y0 - z0 * z0, 0.0f);
+		t0 *= t0;
+		float n0 = t0 * t0 * simplex_gradient_3d(permutation_table[ii + permutation_table[jj + permutation_table[kk]]], x0, y0, z0);
+
+		float t1 = std::max(0.6f - x1 * x1 - y1 * y1 - z1 * z1, 0.0f);
+		t1 *= t1;
+		float n1 = t1 * t1 * simplex_gradient_3d(permutation_table[ii + i1 + permutation_table[jj + j1 + permutation_table[kk + k1]]], x1, y1, z1);
+
+		float t2 = std::max(0.6f - x2 * x2 - y2 * y2 - z2 * z2, 0.0f);
+		t2 *= t2;
+		float n2 = t2 * t2 * simplex_gradient_3d(permutation_table[ii + i2 + permutation_table[jj + j2 + permutation_table[kk + k2]]], x2, y2, z2);
+
+		float t3 = std::max(0.6f - x3 * x3 - y3 * y3 - z3 * z3, 0.0f);
+		t3 *= t3;
+		float n3 = t3 * t3 * simplex_gradient_3d(permutation_table[ii + 1 + permutation_table[jj + 1 + permutation_table[kk + 1]]], x3, y3, z3);
+
+		// Scale the result to cover the same range as the perlin noise
+		return 32.0f * (n0 + n1 + n2 + n3);
+	}
+
 	void PerlinNoise_Impl::set_permutations(const unsigned char *table, unsigned int size)
 	{
 		if ((size == 0) || (table == nullptr))
@@ -670,7 +1071,7 @@ namespace clan
 		}
 	}
 
-	PixelBuffer PerlinNoise_Impl::create_noise2d(float start_x, float end_x, float start_y, float end_y)
+	PixelBuffer PerlinNoise_Impl::create_pixel_buffer(const RowFunction &create_row)
 	{
 		setup();
 
@@ -678,173 +1079,153 @@ namespace clan
 		{
 			PixelBuffer pbuff(width, height, texture_format);
 			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
+			create_rows(writer, create_row);
 			return pbuff;
 		}
 		if (texture_format == TextureFormat::rgb8)
 		{
 			PixelBuffer pbuff(width, height, texture_format);
 			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
+			create_rows(writer, create_row);
 			return pbuff;
 		}
 		if (texture_format == TextureFormat::r8)
 		{
 			PixelBuffer pbuff(width, height, texture_format);
 			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
+			create_rows(writer, create_row);
 			return pbuff;
 		}
 		if (texture_format == TextureFormat::r32f)
 		{
 			PixelBuffer pbuff(width, height, texture_format);
 			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
+			create_rows(writer, create_row);
 			return pbuff;
 		}
 
 		throw Exception("texture format is not supported");
-
 	}
 
-	void PerlinNoise_Impl::create_noise2d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y)
+	void PerlinNoise_Impl::create_rows(PerlinNoise_PixelWriter &writer, const RowFunction &create_row)
 	{
-		float size_x = end_x - start_x;
-		float size_y = end_y - start_y;
-		float fheight = (float)height;
-		float fwidth = (float)width;
-
-		for (int y = 0; y < height; y++)
+		auto create_row_range = [&](int start_y, int end_y)
 		{
-			for (int x = 0; x < width; x++)
+			std::vector<float> row(width);
+			for (int y = start_y; y < end_y; y++)
 			{
-				float result = 0.0f;
-				float current_amplitude = amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-
-				for (int i = 0; i < octaves; i++)
-				{
-					result += current_amplitude * noise_2d(value_x, value_y);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
-
-				writer.write_pixel(result);
+				create_row(y, row.data());
+				writer.write_row(y, row.data(), width);
 			}
-			writer.line_end();
+		};
+
+		// Every row is independent, so large images are split into bands of rows, one per core
+		int num_threads = std::min((int)std::thread::hardware_concurrency(), (int)((int64_t)width * height / min_pixels_per_thread));
+		num_threads = std::min(num_threads, height);
+		if (num_threads <= 1)
+		{
+			create_row_range(0, height);
+			return;
 		}
+
+		int rows_per_thread = (height + num_threads - 1) / num_threads;
+		std::vector<std::thread> threads;
+		for (int start_y = rows_per_thread; start_y < height; start_y += rows_per_thread)
+			threads.push_back(std::thread(create_row_range, start_y, std::min(start_y + rows_per_thread, height)));
+
+		create_row_range(0, rows_per_thread);
+
+		for (auto &thread : threads)
+			thread.join();
 	}
 
 	PixelBuffer PerlinNoise_Impl::create_noise1d(float start_x, float end_x)
 	{
 		setup();
 
-		if (texture_format == TextureFormat::rgba8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (texture_format == TextureFormat::rgb8)
+		// 1D noise does not depend on y, so every row is a copy of the first
+		std::vector<float> first_row(width);
+		create_noise1d_row(first_row.data(), start_x, end_x - start_x);
+
+		return create_pixel_buffer([&](int y, float *row)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (texture_format == TextureFormat::r8)
+			std::copy(first_row.begin(), first_row.end(), row);
+		});
+	}
+
+	PixelBuffer PerlinNoise_Impl::create_noise2d(float start_x, float end_x, float start_y, float end_y)
+	{
+		float size_x = end_x - start_x;
+		float size_y = end_y - start_y;
+		float fheight = (float)height;
+
+		return create_pixel_buffer([&](int y, float *row)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (texture_format == TextureFormat::r32f)
+			create_noise2d_row(row, start_x, size_x, start_y + (((float)y) * size_y) / fheight);
+		});
+	}
+
+	PixelBuffer PerlinNoise_Impl::create_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
+	{
+		float size_x = end_x - start_x;
+		float size_y = end_y - start_y;
+		float fheight = (float)height;
+
+		return create_pixel_buffer([&](int y, float *row)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
+			create_noise3d_row(row, start_x, size_x, start_y + (((float)y) * size_y) / fheight, z_position);
+		});
+	}
 
-		throw Exception("texture format is not supported");
+	PixelBuffer PerlinNoise_Impl::create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	{
+		float size_x = end_x - start_x;
+		float size_y = end_y - start_y;
+		float fheight = (float)height;
 
+		return create_pixel_buffer([&](int y, float *row)
+		{
+			create_noise4d_row(row, start_x, size_x, start_y + (((float)y) * size_y) / fheight, z_position, w_position);
+		});
 	}
 
-	void PerlinNoise_Impl::create_noise1d(PerlinNoise_PixelWriter &writer, float start_x, float end_x)
+	PixelBuffer PerlinNoise_Impl::create_simplex_noise2d(float start_x, float end_x, float start_y, float end_y)
 	{
 		float size_x = end_x - start_x;
+		float size_y = end_y - start_y;
+		float fheight = (float)height;
 		float fwidth = (float)width;
 
-		for (int y = 0; y < height; y++)
+		return create_pixel_buffer([&](int y, float *row)
 		{
 			for (int x = 0; x < width; x++)
 			{
 				float result = 0.0f;
 				float current_amplitude = amplitude;
 				float value_x = start_x + (((float)x) * size_x) / fwidth;
+				float value_y = start_y + (((float)y) * size_y) / fheight;
 
 				for (int i = 0; i < octaves; i++)
 				{
-					result += current_amplitude * noise_1d(value_x);
+					result += current_amplitude * simplex_noise_2d(value_x, value_y);
 					value_x *= 2.0f;
+					value_y *= 2.0f;
 					current_amplitude *= 0.5f;
 				}
 
-				writer.write_pixel(result);
+				row[x] = result;
 			}
-			writer.line_end();
-		}
-	}
-
-	PixelBuffer PerlinNoise_Impl::create_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
-	{
-		setup();
-
-		if (texture_format == TextureFormat::rgba8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (texture_format == TextureFormat::rgb8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (texture_format == TextureFormat::r8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (texture_format == TextureFormat::r32f)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-
-		throw Exception("sized format is not supported");
-
+		});
 	}
 
-	void PerlinNoise_Impl::create_noise3d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position)
+	PixelBuffer PerlinNoise_Impl::create_simplex_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
 	{
 		float size_x = end_x - start_x;
 		float size_y = end_y - start_y;
 		float fheight = (float)height;
 		float fwidth = (float)width;
 
-		for (int y = 0; y < height; y++)
+		return create_pixel_buffer([&](int y, float *row)
 		{
 			for (int x = 0; x < width; x++)
 			{
@@ -856,87 +1237,199 @@ namespace clan
 
 				for (int i = 0; i < octaves; i++)
 				{
-					result += current_amplitude * noise_3d(value_x, value_y, value_z);
+					result += current_amplitude * simplex_noise_3d(value_x, value_y, value_z);
 					value_x *= 2.0f;
 					value_y *= 2.0f;
 					value_z *= 2.0f;
 					current_amplitude *= 0.5f;
 				}
 
-				writer.write_pixel(result);
+				row[x] = result;
 			}
-			writer.line_end();
-		}
+		});
 	}
 
-	PixelBuffer PerlinNoise_Impl::create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	void PerlinNoise_Impl::create_noise1d_row(float *row, float start_x, float size_x)
 	{
-		setup();
+		float fwidth = (float)width;
+		int x = 0;
 
-		if (texture_format == TextureFormat::rgba8)
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		for (; x + 4 <= width; x += 4)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
+			__m128 result = _mm_setzero_ps();
+			float current_amplitude = amplitude;
+			__m128 value_x = _mm_add_ps(_mm_set1_ps(start_x), _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3)), _mm_set1_ps(size_x)), _mm_set1_ps(fwidth)));
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(current_amplitude), noise_1d(value_x)));
+				value_x = _mm_mul_ps(value_x, _mm_set1_ps(2.0f));
+				current_amplitude *= 0.5f;
+			}
+
+			_mm_storeu_ps(row + x, result);
 		}
-		if (texture_format == TextureFormat::rgb8)
+#endif
+
+		for (; x < width; x++)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
+			float result = 0.0f;
+			float current_amplitude = amplitude;
+			float value_x = start_x + (((float)x) * size_x) / fwidth;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result += current_amplitude * noise_1d(value_x);
+				value_x *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			row[x] = result;
 		}
-		if (texture_format == TextureFormat::r8)
+	}
+
+	void PerlinNoise_Impl::create_noise2d_row(float *row, float start_x, float size_x, float start_value_y)
+	{
+		float fwidth = (float)width;
+		int x = 0;
+
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		for (; x + 4 <= width; x += 4)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
+			__m128 result = _mm_setzero_ps();
+			float current_amplitude = amplitude;
+			__m128 value_x = _mm_add_ps(_mm_set1_ps(start_x), _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3)), _mm_set1_ps(size_x)), _mm_set1_ps(fwidth)));
+			float value_y = start_value_y;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(current_amplitude), noise_2d(value_x, value_y)));
+				value_x = _mm_mul_ps(value_x, _mm_set1_ps(2.0f));
+				value_y *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			_mm_storeu_ps(row + x, result);
 		}
-		if (texture_format == TextureFormat::r32f)
+#endif
+
+		for (; x < width; x++)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
+			float result = 0.0f;
+			float current_amplitude = amplitude;
+			float value_x = start_x + (((float)x) * size_x) / fwidth;
+			float value_y = start_value_y;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result += current_amplitude * noise_2d(value_x, value_y);
+				value_x *= 2.0f;
+				value_y *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			row[x] = result;
 		}
+	}
 
-		throw Exception("sized format is not supported");
+	void PerlinNoise_Impl::create_noise3d_row(float *row, float start_x, float size_x, float start_value_y, float start_value_z)
+	{
+		float fwidth = (float)width;
+		int x = 0;
 
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128 result = _mm_setzero_ps();
+			float current_amplitude = amplitude;
+			__m128 value_x = _mm_add_ps(_mm_set1_ps(start_x), _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3)), _mm_set1_ps(size_x)), _mm_set1_ps(fwidth)));
+			float value_y = start_value_y;
+			float value_z = start_value_z;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(current_amplitude), noise_3d(value_x, value_y, value_z)));
+				value_x = _mm_mul_ps(value_x, _mm_set1_ps(2.0f));
+				value_y *= 2.0f;
+				value_z *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			_mm_storeu_ps(row + x, result);
+		}
+#endif
+
+		for (; x < width; x++)
+		{
+			float result = 0.0f;
+			float current_amplitude = amplitude;
+			float value_x = start_x + (((float)x) * size_x) / fwidth;
+			float value_y = start_value_y;
+			float value_z = start_value_z;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result += current_amplitude * noise_3d(value_x, value_y, value_z);
+				value_x *= 2.0f;
+				value_y *= 2.0f;
+				value_z *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			row[x] = result;
+		}
 	}
 
-	void PerlinNoise_Impl::create_noise4d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
+	void PerlinNoise_Impl::create_noise4d_row(float *row, float start_x, float size_x, float start_value_y, float start_value_z, float start_value_w)
 	{
-		float size_x = end_x - start_x;
-		float size_y = end_y - start_y;
-		float fheight = (float)height;
 		float fwidth = (float)width;
+		int x = 0;
 
-		for (int y = 0; y < height; y++)
+#if defined __SSE2__ && ! defined CL_DISABLE_SSE2
+		for (; x + 4 <= width; x += 4)
 		{
-			for (int x = 0; x < width; x++)
+			__m128 result = _mm_setzero_ps();
+			float current_amplitude = amplitude;
+			__m128 value_x = _mm_add_ps(_mm_set1_ps(start_x), _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3)), _mm_set1_ps(size_x)), _mm_set1_ps(fwidth)));
+			float value_y = start_value_y;
+			float value_z = start_value_z;
+			float value_w = start_value_w;
+
+			for (int i = 0; i < octaves; i++)
 			{
-				float result = 0.0f;
-				float current_amplitude = amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-				float value_z = z_position;
-				float value_w = w_position;
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(current_amplitude), noise_4d(value_x, value_y, value_z, value_w)));
+				value_x = _mm_mul_ps(value_x, _mm_set1_ps(2.0f));
+				value_y *= 2.0f;
+				value_z *= 2.0f;
+				value_w *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
 
-				for (int i = 0; i < octaves; i++)
-				{
-					result += current_amplitude * noise_4d(value_x, value_y, value_z, value_w);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					value_z *= 2.0f;
-					value_w *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
+			_mm_storeu_ps(row + x, result);
+		}
+#endif
 
-				writer.write_pixel(result);
+		for (; x < width; x++)
+		{
+			float result = 0.0f;
+			float current_amplitude = amplitude;
+			float value_x = start_x + (((float)x) * size_x) / fwidth;
+			float value_y = start_value_y;
+			float value_z = start_value_z;
+			float value_w = start_value_w;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result += current_amplitude * noise_4d(value_x, value_y, value_z, value_w);
+				value_x *= 2.0f;
+				value_y *= 2.0f;
+				value_z *= 2.0f;
+				value_w *= 2.0f;
+				current_amplitude *= 0.5f;
 			}
-			writer.line_end();
+
+			row[x] = result;
 		}
 	}
 }
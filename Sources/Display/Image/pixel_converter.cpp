@@ -30,7 +30,7 @@
 #include "Display/precomp.h"
 #include "API/Display/Image/pixel_converter.h"
 #include "API/Core/System/databuffer.h"
-#include "API/Core/System/system.h"
+#include "API/Core/System/cpu_features.h"
 #include "pixel_converter_impl.h"
 #include "pixel_reader_cast.h"
 #include "pixel_reader_half_float.h"
@@ -133,8 +133,9 @@ namespace clan
 
 	void PixelConverter::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height)
 	{
-		bool sse2 = System::detect_cpu_extension(System::sse2);
-		bool sse4 = System::detect_cpu_extension(System::sse4_1);
+		const CPUFeatures &cpu = CPUFeatures::get();
+		bool sse2 = cpu.has(System::sse2);
+		bool sse4 = cpu.has(System::sse4_1);
 
 		std::unique_ptr<PixelReader> reader = impl->create_reader(input_format, sse2);
 		std::unique_ptr<PixelWriter> writer = impl->create_writer(output_format, sse2, sse4);
@@ -38,11 +38,7 @@ namespace clan
 	public:
 		void read(const void *input, Vec4f *output, int num_pixels) override
 		{
-			const Vec4hf *d = static_cast<const Vec4hf *>(input);
-			for (int i = 0; i < num_pixels; i++)
-			{
-				output[i] = Vec4f(d[i]);
-			}
+			HalfFloat::half_to_float(static_cast<const unsigned short *>(input), reinterpret_cast<float*>(output), num_pixels * 4);
 		}
 	};
 
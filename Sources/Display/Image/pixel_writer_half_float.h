@@ -38,11 +38,7 @@ namespace clan
 	public:
 		void write(void *output, Vec4f *input, int num_pixels) override
 		{
-			Vec4hf *d = static_cast<Vec4hf *>(output);
-			for (int i = 0; i < num_pixels; i++)
-			{
-				d[i] = Vec4hf(input[i]);
-			}
+			HalfFloat::float_to_half(reinterpret_cast<const float*>(input), static_cast<unsigned short *>(output), num_pixels * 4);
 		}
 	};
 
@@ -0,0 +1,275 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/async_texture_loader.h"
+#include "API/Display/Render/transfer_texture.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/ImageProviders/provider_factory.h"
+#include "API/Core/IOData/file_system.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/system.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+
+namespace clan
+{
+	class AsyncTexture
+	{
+	public:
+		std::string filename;
+		FileSystem fs;
+		ImageImportDescription import_desc;
+		Resource<Texture> resource;
+
+		PixelBuffer image;
+		std::string error;
+
+		// The GPU may still be reading a transfer texture a couple of frames after the upload was issued.
+		// Cycling through several lets each slice be written without waiting for that.
+		static const int transfer_count = 3;
+
+		Texture2D texture;
+		TransferTexture transfers[transfer_count];
+		int rows_per_slice = 0;
+		int next_row = 0;
+		int next_slice = 0;
+	};
+
+	class AsyncTextureLoader_Impl
+	{
+	public:
+		AsyncTextureLoader_Impl(GraphicContext &gc, int upload_budget);
+
+		void queue(const std::shared_ptr<AsyncTexture> &texture);
+		void decode_completed(const std::shared_ptr<AsyncTexture> &texture);
+		void upload(GraphicContext &gc, int64_t budget);
+
+		WorkQueue work_queue;
+		std::deque<std::shared_ptr<AsyncTexture>> upload_queue;
+		int pending_count = 0;
+		int upload_budget;
+		Texture2D placeholder;
+		Signal<void(const std::string &, const std::string &)> sig_load_failed;
+	};
+
+	class AsyncTextureDecodeItem : public WorkItem
+	{
+	public:
+		AsyncTextureDecodeItem(AsyncTextureLoader_Impl *loader, const std::shared_ptr<AsyncTexture> &texture) : loader(loader), texture(texture) { }
+
+		void process_work() override
+		{
+			try
+			{
+				PixelBuffer image = ImageProviderFactory::load(texture->filename, texture->fs, std::string());
+				image = texture->import_desc.process(image);
+
+				// The upload copies whole rows into the transfer texture, so the rows must be tightly packed RGBA
+				if (image.get_format() != TextureFormat::rgba8 || image.get_pitch() != image.get_width() * 4)
+					image = image.to_format(TextureFormat::rgba8);
+
+				texture->image = image;
+			}
+			catch (const Exception &e)
+			{
+				texture->error = e.message;
+			}
+		}
+
+		void work_completed() override
+		{
+			loader->decode_completed(texture);
+		}
+
+	private:
+		AsyncTextureLoader_Impl *loader;
+		std::shared_ptr<AsyncTexture> texture;
+	};
+
+	AsyncTextureLoader::AsyncTextureLoader()
+	{
+	}
+
+	AsyncTextureLoader::AsyncTextureLoader(GraphicContext &gc, int upload_bytes_per_frame)
+		: impl(std::make_shared<AsyncTextureLoader_Impl>(gc, upload_bytes_per_frame))
+	{
+	}
+
+	AsyncTextureLoader::~AsyncTextureLoader()
+	{
+	}
+
+	void AsyncTextureLoader::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("AsyncTextureLoader is null");
+	}
+
+	int AsyncTextureLoader::get_upload_budget() const
+	{
+		return impl->upload_budget;
+	}
+
+	int AsyncTextureLoader::get_pending_count() const
+	{
+		return impl->pending_count;
+	}
+
+	Texture2D AsyncTextureLoader::get_placeholder() const
+	{
+		return impl->placeholder;
+	}
+
+	Signal<void(const std::string &, const std::string &)> &AsyncTextureLoader::sig_load_failed()
+	{
+		return impl->sig_load_failed;
+	}
+
+	void AsyncTextureLoader::set_upload_budget(int upload_bytes_per_frame)
+	{
+		impl->upload_budget = upload_bytes_per_frame;
+	}
+
+	void AsyncTextureLoader::set_placeholder(const Texture2D &texture)
+	{
+		impl->placeholder = texture;
+	}
+
+	Resource<Texture> AsyncTextureLoader::load(const std::string &filename, const FileSystem &fs, const ImageImportDescription &import_desc)
+	{
+		auto texture = std::make_shared<AsyncTexture>();
+		texture->filename = filename;
+		texture->fs = fs;
+		texture->import_desc = import_desc;
+		texture->resource = Resource<Texture>(impl->placeholder);
+		impl->queue(texture);
+		return texture->resource;
+	}
+
+	Resource<Texture> AsyncTextureLoader::load(const std::string &fullname, const ImageImportDescription &import_desc)
+	{
+		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
+		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
+		return load(filename, FileSystem(path), import_desc);
+	}
+
+	void AsyncTextureLoader::update(GraphicContext &gc)
+	{
+		impl->work_queue.process_work_completed();
+		impl->upload(gc, std::max(impl->upload_budget, 1));
+	}
+
+	void AsyncTextureLoader::finish(GraphicContext &gc)
+	{
+		while (true)
+		{
+			impl->work_queue.process_work_completed();
+			impl->upload(gc, INT64_MAX);
+			if (impl->pending_count == 0)
+				break;
+			System::sleep(1);
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	AsyncTextureLoader_Impl::AsyncTextureLoader_Impl(GraphicContext &gc, int upload_budget)
+		: upload_budget(upload_budget)
+	{
+		PixelBuffer transparent(1, 1, TextureFormat::rgba8);
+		*transparent.get_data_uint32() = 0;
+		placeholder = Texture2D(gc, transparent);
+	}
+
+	void AsyncTextureLoader_Impl::queue(const std::shared_ptr<AsyncTexture> &texture)
+	{
+		pending_count++;
+		work_queue.queue(new AsyncTextureDecodeItem(this, texture));
+	}
+
+	void AsyncTextureLoader_Impl::decode_completed(const std::shared_ptr<AsyncTexture> &texture)
+	{
+		if (texture->image.is_null())
+		{
+			pending_count--;
+			sig_load_failed(texture->filename, texture->error);
+			return;
+		}
+		upload_queue.push_back(texture);
+	}
+
+	void AsyncTextureLoader_Impl::upload(GraphicContext &gc, int64_t budget)
+	{
+		// Slices are sized from the whole per frame budget, so at most one slice of a texture is uploaded per frame.
+		// A slice that does not fit in what is left of the budget waits for the next frame.
+		int64_t slice_budget = std::max(upload_budget, 1);
+
+		bool slice_uploaded = false;
+		while (!upload_queue.empty())
+		{
+			AsyncTexture &pending = *upload_queue.front();
+			int width = pending.image.get_width();
+			int height = pending.image.get_height();
+			int pitch = pending.image.get_pitch();
+
+			if (pending.texture.is_null())
+			{
+				pending.texture = Texture2D(gc, width, height, pending.import_desc.is_srgb() ? TextureFormat::srgb8_alpha8 : TextureFormat::rgba8);
+				pending.texture.set_pixel_ratio(pending.image.get_pixel_ratio());
+				pending.rows_per_slice = (int)std::max(std::min(slice_budget / pitch, (int64_t)height), (int64_t)1);
+			}
+
+			int rows = std::min(pending.rows_per_slice, height - pending.next_row);
+			int64_t slice_bytes = (int64_t)rows * pitch;
+			if (slice_uploaded && slice_bytes > budget)
+				break;
+
+			TransferTexture &transfer = pending.transfers[pending.next_slice % AsyncTexture::transfer_count];
+			if (transfer.is_null())
+				transfer = TransferTexture(gc, width, pending.rows_per_slice, PixelBufferDirection::data_to_gpu, TextureFormat::rgba8);
+
+			transfer.upload_data(gc, Rect(0, 0, width, rows), pending.image.get_line(pending.next_row));
+			pending.texture.set_subimage(gc, Point(0, pending.next_row), transfer, Rect(0, 0, width, rows), 0);
+			pending.next_row += rows;
+			pending.next_slice++;
+			budget -= slice_bytes;
+			slice_uploaded = true;
+
+			if (pending.next_row == height)
+			{
+				// OpenGL executes the uploads before any later draw call, so the texture can be used right away
+				pending.resource.set(pending.texture);
+				upload_queue.pop_front();
+				pending_count--;
+			}
+		}
+	}
+}
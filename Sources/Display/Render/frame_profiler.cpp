@@ -0,0 +1,326 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/frame_profiler.h"
+#include "API/Display/Render/timer_query.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Core/JSON/json_value.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/exception.h"
+#include <deque>
+
+namespace clan
+{
+	class FrameProfilerEntry
+	{
+	public:
+		FrameProfilerScope scope;
+		TimerQuery begin_query;
+		TimerQuery end_query;
+	};
+
+	class FrameProfilerFrame
+	{
+	public:
+		int number = 0;
+		uint64_t cpu_begin = 0;
+		uint64_t cpu_end = 0;
+		bool ended = false;
+		bool resolved = false;
+
+		TimerQuery begin_query;
+		uint64_t gpu_begin = 0;
+
+		std::vector<FrameProfilerEntry> entries;
+	};
+
+	class FrameProfiler_Impl
+	{
+	public:
+		TimerQuery alloc_query(GraphicContext &gc);
+		void free_query(TimerQuery &query);
+
+		bool try_resolve(FrameProfilerFrame &frame);
+		void resolve_frames();
+
+		bool gpu_timing = false;
+		size_t max_frames = 256;
+		int next_frame_number = 0;
+
+		std::deque<FrameProfilerFrame> frames;
+		std::vector<size_t> open_scopes;
+		std::vector<TimerQuery> free_queries;
+	};
+
+	FrameProfiler::FrameProfiler()
+	{
+	}
+
+	FrameProfiler::FrameProfiler(GraphicContext &gc, int max_frames) : impl(std::make_shared<FrameProfiler_Impl>())
+	{
+		if (max_frames < 1)
+			throw Exception("FrameProfiler must keep at least one frame");
+
+		impl->max_frames = max_frames;
+		impl->gpu_timing = TimerQuery::is_supported(gc);
+	}
+
+	FrameProfiler::~FrameProfiler()
+	{
+	}
+
+	void FrameProfiler::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("FrameProfiler is null");
+	}
+
+	bool FrameProfiler::is_gpu_timing_supported() const
+	{
+		return impl->gpu_timing;
+	}
+
+	std::vector<FrameProfilerScope> FrameProfiler::get_scopes() const
+	{
+		std::vector<FrameProfilerScope> scopes;
+		for (const auto &frame : impl->frames)
+		{
+			if (!frame.ended)
+				continue;
+			for (const auto &entry : frame.entries)
+				scopes.push_back(entry.scope);
+		}
+		return scopes;
+	}
+
+	std::string FrameProfiler::to_chrome_trace() const
+	{
+		JsonValue events = JsonValue::array();
+
+		const char *thread_names[] = { "CPU", "GPU" };
+		for (int tid = 1; tid <= 2; tid++)
+		{
+			JsonValue meta = JsonValue::object();
+			meta["name"] = JsonValue::string("thread_name");
+			meta["ph"] = JsonValue::string("M");
+			meta["pid"] = JsonValue::number(1);
+			meta["tid"] = JsonValue::number(tid);
+			meta["args"] = JsonValue::object();
+			meta["args"]["name"] = JsonValue::string(thread_names[tid - 1]);
+			events.items().push_back(meta);
+		}
+
+		uint64_t trace_start = 0;
+		for (const auto &frame : impl->frames)
+		{
+			if (frame.ended)
+			{
+				trace_start = frame.cpu_begin;
+				break;
+			}
+		}
+
+		auto add_event = [&](const std::string &name, int tid, double begin, double end, int frame_number)
+		{
+			JsonValue event = JsonValue::object();
+			event["name"] = JsonValue::string(name);
+			event["ph"] = JsonValue::string("X");
+			event["pid"] = JsonValue::number(1);
+			event["tid"] = JsonValue::number(tid);
+			event["ts"] = JsonValue::number(begin);
+			event["dur"] = JsonValue::number(end > begin ? end - begin : 0.0);
+			event["args"] = JsonValue::object();
+			event["args"]["frame"] = JsonValue::number(frame_number);
+			events.items().push_back(event);
+		};
+
+		for (const auto &frame : impl->frames)
+		{
+			if (!frame.ended)
+				continue;
+
+			double frame_start = (double)(frame.cpu_begin - trace_start);
+			add_event("Frame", 1, frame_start, (double)(frame.cpu_end - trace_start), frame.number);
+
+			for (const auto &entry : frame.entries)
+			{
+				const FrameProfilerScope &scope = entry.scope;
+				add_event(scope.name, 1, (double)(scope.cpu_begin - trace_start), (double)(scope.cpu_end - trace_start), frame.number);
+
+				// GPU clock is unrelated to the CPU clock. Place GPU events relative to the start of their frame.
+				if (scope.gpu_valid)
+				{
+					double gpu_begin = frame_start + (double)(int64_t)(scope.gpu_begin - frame.gpu_begin) / 1000.0;
+					double gpu_end = frame_start + (double)(int64_t)(scope.gpu_end - frame.gpu_begin) / 1000.0;
+					add_event(scope.name, 2, gpu_begin, gpu_end, frame.number);
+				}
+			}
+		}
+
+		JsonValue trace = JsonValue::object();
+		trace["traceEvents"] = events;
+		trace["displayTimeUnit"] = JsonValue::string("ms");
+		return trace.to_json();
+	}
+
+	void FrameProfiler::save_chrome_trace(const std::string &filename) const
+	{
+		File::write_text(filename, to_chrome_trace());
+	}
+
+	void FrameProfiler::begin_frame(GraphicContext &gc)
+	{
+		if (!impl->frames.empty() && !impl->frames.back().ended)
+			throw Exception("FrameProfiler::begin_frame called twice without end_frame");
+
+		while (impl->frames.size() >= impl->max_frames)
+			impl->frames.pop_front();
+
+		impl->frames.emplace_back();
+		FrameProfilerFrame &frame = impl->frames.back();
+		frame.number = impl->next_frame_number++;
+		frame.cpu_begin = System::get_microseconds();
+		if (impl->gpu_timing)
+		{
+			frame.begin_query = impl->alloc_query(gc);
+			frame.begin_query.timestamp();
+		}
+	}
+
+	void FrameProfiler::end_frame(GraphicContext &gc)
+	{
+		if (impl->frames.empty() || impl->frames.back().ended)
+			throw Exception("FrameProfiler::end_frame called without begin_frame");
+		if (!impl->open_scopes.empty())
+			throw Exception("FrameProfiler::end_frame called with open scope " + impl->frames.back().entries[impl->open_scopes.back()].scope.name);
+
+		FrameProfilerFrame &frame = impl->frames.back();
+		frame.cpu_end = System::get_microseconds();
+		frame.ended = true;
+		if (!impl->gpu_timing)
+			frame.resolved = true;
+
+		impl->resolve_frames();
+	}
+
+	void FrameProfiler::begin_scope(GraphicContext &gc, const std::string &name)
+	{
+		if (impl->frames.empty() || impl->frames.back().ended)
+			throw Exception("FrameProfiler::begin_scope called outside a frame");
+
+		FrameProfilerFrame &frame = impl->frames.back();
+
+		FrameProfilerEntry entry;
+		entry.scope.name = name;
+		entry.scope.frame = frame.number;
+		entry.scope.depth = (int)impl->open_scopes.size();
+		if (impl->gpu_timing)
+		{
+			entry.begin_query = impl->alloc_query(gc);
+			entry.begin_query.timestamp();
+		}
+		entry.scope.cpu_begin = System::get_microseconds();
+
+		impl->open_scopes.push_back(frame.entries.size());
+		frame.entries.push_back(std::move(entry));
+	}
+
+	void FrameProfiler::end_scope(GraphicContext &gc)
+	{
+		if (impl->open_scopes.empty())
+			throw Exception("FrameProfiler::end_scope called without begin_scope");
+
+		FrameProfilerEntry &entry = impl->frames.back().entries[impl->open_scopes.back()];
+		impl->open_scopes.pop_back();
+
+		entry.scope.cpu_end = System::get_microseconds();
+		if (impl->gpu_timing)
+		{
+			entry.end_query = impl->alloc_query(gc);
+			entry.end_query.timestamp();
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	TimerQuery FrameProfiler_Impl::alloc_query(GraphicContext &gc)
+	{
+		if (free_queries.empty())
+			return TimerQuery(gc);
+
+		TimerQuery query = free_queries.back();
+		free_queries.pop_back();
+		return query;
+	}
+
+	void FrameProfiler_Impl::free_query(TimerQuery &query)
+	{
+		if (query)
+			free_queries.push_back(query);
+		query = TimerQuery();
+	}
+
+	bool FrameProfiler_Impl::try_resolve(FrameProfilerFrame &frame)
+	{
+		if (!frame.begin_query.is_result_ready())
+			return false;
+		for (auto &entry : frame.entries)
+		{
+			if (!entry.end_query.is_result_ready())
+				return false;
+		}
+
+		frame.gpu_begin = frame.begin_query.get_result();
+		free_query(frame.begin_query);
+
+		for (auto &entry : frame.entries)
+		{
+			entry.scope.gpu_begin = entry.begin_query.get_result();
+			entry.scope.gpu_end = entry.end_query.get_result();
+			entry.scope.gpu_valid = true;
+			free_query(entry.begin_query);
+			free_query(entry.end_query);
+		}
+
+		frame.resolved = true;
+		return true;
+	}
+
+	void FrameProfiler_Impl::resolve_frames()
+	{
+		for (auto &frame : frames)
+		{
+			if (!frame.ended)
+				break;
+			if (!frame.resolved && !try_resolve(frame))
+				break;
+		}
+	}
+}
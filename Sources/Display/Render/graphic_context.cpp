@@ -182,6 +182,11 @@ namespace clan
 		return impl->graphic_screen->get_provider()->get_max_texture_size();
 	}
 
+	GraphicContextStatistics GraphicContext::get_frame_statistics() const
+	{
+		return impl->graphic_screen->get_provider()->get_frame_statistics();
+	}
+
 	GraphicContextProvider *GraphicContext::get_provider()
 	{
 		if (impl)
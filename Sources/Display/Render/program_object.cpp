@@ -35,18 +35,44 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 #include "API/Display/TargetProviders/program_object_provider.h"
+#include "API/Display/TargetProviders/shader_object_provider.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/directory.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/Crypto/sha1.h"
+#include <mutex>
 
 namespace clan
 {
 	class ProgramObject_Impl
 	{
 	public:
+		bool compile_shaders();
+		std::string get_binary_cache_filename() const;
+		bool load_binary(const std::string &filename);
+		void save_binary(const std::string &filename);
+
 		std::unique_ptr<ProgramObjectProvider> provider;
+
+		/// \brief Attribute and frag data bindings, as they are part of the binary cache key
+		std::string bindings;
+
+		/// \brief Info log of the shaders that failed to compile during link
+		std::string compile_log;
+
+		static std::mutex binary_cache_mutex;
+		static std::string binary_cache_directory;
+		static const char binary_cache_magic[4];
 	};
 
+	std::mutex ProgramObject_Impl::binary_cache_mutex;
+	std::string ProgramObject_Impl::binary_cache_directory;
+	const char ProgramObject_Impl::binary_cache_magic[4] = { 'C', 'L', 'P', 'B' };
+
 	ProgramObject::ProgramObject()
 	{
 	}
@@ -235,6 +261,18 @@ namespace clan
 		return program_object;
 	}
 
+	void ProgramObject::set_binary_cache_directory(const std::string &cache_directory)
+	{
+		std::lock_guard<std::mutex> lock(ProgramObject_Impl::binary_cache_mutex);
+		ProgramObject_Impl::binary_cache_directory = cache_directory;
+	}
+
+	std::string ProgramObject::get_binary_cache_directory()
+	{
+		std::lock_guard<std::mutex> lock(ProgramObject_Impl::binary_cache_mutex);
+		return ProgramObject_Impl::binary_cache_directory;
+	}
+
 	ProgramObject::~ProgramObject()
 	{
 	}
@@ -264,6 +302,8 @@ namespace clan
 
 	std::string ProgramObject::get_info_log() const
 	{
+		if (!impl->compile_log.empty())
+			return impl->compile_log;
 		return impl->provider->get_info_log();
 	}
 
@@ -329,17 +369,37 @@ namespace clan
 	void ProgramObject::bind_attribute_location(int index, const std::string &name)
 	{
 		impl->provider->bind_attribute_location(index, name);
+		impl->bindings += string_format("attribute %1 %2\n", index, name);
 	}
 
 	void ProgramObject::bind_frag_data_location(int color_number, const std::string &name)
 	{
 		impl->provider->bind_frag_data_location(color_number, name);
+		impl->bindings += string_format("frag_data %1 %2\n", color_number, name);
 	}
 
 	bool ProgramObject::link()
 	{
+		impl->compile_log.clear();
+
+		std::string cache_filename = impl->get_binary_cache_filename();
+		if (!cache_filename.empty())
+		{
+			if (impl->load_binary(cache_filename))
+				return true;
+			impl->provider->set_binary_retrievable_hint();
+		}
+
+		if (!impl->compile_shaders())
+			return false;
+
 		impl->provider->link();
-		return impl->provider->get_link_status();
+		if (!impl->provider->get_link_status())
+			return false;
+
+		if (!cache_filename.empty())
+			impl->save_binary(cache_filename);
+		return true;
 	}
 
 	bool ProgramObject::validate()
@@ -422,4 +482,93 @@ namespace clan
 	{
 		impl->provider->set_storage_buffer_index(block_index, bind_index);
 	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	bool ProgramObject_Impl::compile_shaders()
+	{
+		bool compiled = true;
+		for (auto &shader : provider->get_shaders())
+		{
+			if (!shader.is_null() && !shader.get_provider()->get_compile_status() && !shader.compile())
+			{
+				compile_log += shader.get_info_log();
+				compiled = false;
+			}
+		}
+		return compiled;
+	}
+
+	std::string ProgramObject_Impl::get_binary_cache_filename() const
+	{
+		std::string cache_directory = ProgramObject::get_binary_cache_directory();
+		if (cache_directory.empty())
+			return std::string();
+
+		std::string driver_id = provider->get_binary_driver_id();
+		if (driver_id.empty())
+			return std::string();
+
+		SHA1 sha1;
+		sha1.add(driver_id.data(), driver_id.length());
+		for (auto &shader : provider->get_shaders())
+		{
+			if (shader.is_null())
+				continue;
+			std::string header = string_format("\nshader %1\n", (int)shader.get_shader_type());
+			std::string source = shader.get_shader_source();
+			sha1.add(header.data(), header.length());
+			sha1.add(source.data(), source.length());
+		}
+		sha1.add(bindings.data(), bindings.length());
+		sha1.calculate();
+
+		return PathHelp::combine(cache_directory, sha1.get_hash() + ".bin");
+	}
+
+	bool ProgramObject_Impl::load_binary(const std::string &filename)
+	{
+		if (!FileHelp::file_exists(filename))
+			return false;
+
+		try
+		{
+			DataBuffer data = File::read_bytes(filename);
+			const size_t header_size = sizeof(binary_cache_magic) + sizeof(unsigned int);
+			if (data.get_size() <= header_size || memcmp(data.get_data(), binary_cache_magic, sizeof(binary_cache_magic)) != 0)
+				return false;
+
+			unsigned int format = 0;
+			memcpy(&format, data.get_data() + sizeof(binary_cache_magic), sizeof(unsigned int));
+			return provider->load_program_binary(format, DataBuffer(data, header_size, data.get_size() - header_size));
+		}
+		catch (const Exception &)
+		{
+			return false;
+		}
+	}
+
+	void ProgramObject_Impl::save_binary(const std::string &filename)
+	{
+		unsigned int format = 0;
+		DataBuffer binary;
+		if (!provider->get_program_binary(format, binary))
+			return;
+
+		const size_t header_size = sizeof(binary_cache_magic) + sizeof(unsigned int);
+		DataBuffer data(header_size + binary.get_size());
+		memcpy(data.get_data(), binary_cache_magic, sizeof(binary_cache_magic));
+		memcpy(data.get_data() + sizeof(binary_cache_magic), &format, sizeof(unsigned int));
+		memcpy(data.get_data() + header_size, binary.get_data(), binary.get_size());
+
+		// The cache is only an optimization, so failing to write it is not an error
+		try
+		{
+			Directory::create(ProgramObject::get_binary_cache_directory(), true);
+			File::write_bytes(filename, data);
+		}
+		catch (const Exception &)
+		{
+		}
+	}
 }
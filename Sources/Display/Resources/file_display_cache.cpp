@@ -91,11 +91,20 @@ namespace clan
 		if (it != textures.end())
 			return it->second;
 
-		Resource<Texture> texture = Texture2D(gc, id, doc.get_file_system());
+		Resource<Texture> texture;
+		if (texture_loader)
+			texture = texture_loader.load(id, doc.get_file_system());
+		else
+			texture = Texture2D(gc, id, doc.get_file_system());
 		textures[id] = texture;
 		return texture;
 	}
 
+	void FileDisplayCache::set_texture_loader(const AsyncTextureLoader &loader)
+	{
+		texture_loader = loader;
+	}
+
 	Resource<Font> FileDisplayCache::get_font(Canvas &canvas, const std::string &family_name, const FontDescription &desc)
 	{
 		auto it = fonts.find(family_name);
@@ -31,6 +31,7 @@
 
 #include "API/Display/Resources/display_cache.h"
 #include "API/Core/Resources/file_resource_document.h"
+#include "API/Display/Render/async_texture_loader.h"
 
 namespace clan
 {
@@ -46,9 +47,11 @@ namespace clan
 		Resource<Image> get_image(Canvas &canvas, const std::string &id) override;
 		Resource<Texture> get_texture(GraphicContext &gc, const std::string &id) override;
 		Resource<Font> get_font(Canvas &canvas, const std::string &family_name, const FontDescription &desc) override;
+		void set_texture_loader(const AsyncTextureLoader &loader) override;
 
 	private:
 		FileResourceDocument doc;
+		AsyncTextureLoader texture_loader;
 
 		std::map<std::string, Resource<Sprite> > sprites;
 		std::map<std::string, Resource<Image> > images;
@@ -44,6 +44,7 @@
 #include "API/Display/Render/texture.h"
 #include "API/Display/Render/texture_2d.h"
 #include "API/Display/Render/shader_object.h"
+#include "API/Display/TargetProviders/shader_object_provider.h"
 #include "API/Core/Text/string_format.h"
 #include "shader_effect_description_impl.h"
 #include <map>
@@ -56,6 +57,7 @@ namespace clan
 		ShaderEffect_Impl(GraphicContext &gc) : program(gc) { }
 
 		static std::string add_defines(GraphicContext &gc, const std::string * const code, const ShaderEffectDescription_Impl *description);
+		static std::string get_shader_type_name(ShaderType type);
 
 		void create_shaders(GraphicContext &gc, const ShaderEffectDescription_Impl *description);
 		void create_primitives_array(GraphicContext &gc, const ShaderEffectDescription_Impl *description);
@@ -260,6 +262,17 @@ namespace clan
 		return prefix + code[static_cast<int>(gc.get_shader_language())];
 	}
 
+	std::string ShaderEffect_Impl::get_shader_type_name(ShaderType type)
+	{
+		switch (type)
+		{
+		case ShaderType::vertex: return "vertex";
+		case ShaderType::fragment: return "fragment";
+		case ShaderType::compute: return "compute";
+		default: return "unknown";
+		}
+	}
+
 	void ShaderEffect_Impl::create_shaders(GraphicContext &gc, const ShaderEffectDescription_Impl *description)
 	{
 		std::string vertex_shader_code = add_defines(gc, description->vertex_shader_code, description);
@@ -269,24 +282,18 @@ namespace clan
 		if (!vertex_shader_code.empty())
 		{
 			ShaderObject vertex_shader(gc, ShaderType::vertex, vertex_shader_code);
-			if (!vertex_shader.compile())
-				throw Exception(string_format("Unable to compile vertex shader: %1", vertex_shader.get_info_log()));
 			program.attach(vertex_shader);
 		}
 
 		if (!fragment_shader_code.empty())
 		{
 			ShaderObject fragment_shader(gc, ShaderType::fragment, fragment_shader_code);
-			if (!fragment_shader.compile())
-				throw Exception(string_format("Unable to compile fragment shader: %1", fragment_shader.get_info_log()));
 			program.attach(fragment_shader);
 		}
 
 		if (!compute_shader_code.empty())
 		{
 			ShaderObject compute_shader(gc, ShaderType::compute, compute_shader_code);
-			if (!compute_shader.compile())
-				throw Exception(string_format("Unable to compile compute shader: %1", compute_shader.get_info_log()));
 			program.attach(compute_shader);
 		}
 
@@ -302,8 +309,16 @@ namespace clan
 			program.bind_frag_data_location(index++, elem.first);
 		}
 
+		// Shaders are compiled by link(), unless it finds the program in the binary cache
 		if (!program.link())
+		{
+			for (auto &shader : program.get_shaders())
+			{
+				if (!shader.get_provider()->get_compile_status())
+					throw Exception(string_format("Unable to compile %1 shader: %2", get_shader_type_name(shader.get_shader_type()), shader.get_info_log()));
+			}
 			throw Exception(string_format("Link failed: %1", program.get_info_log()));
+		}
 
 		index = 0;
 		for (auto it = description->uniform_buffers.begin(); it != description->uniform_buffers.end(); ++it, index++)
@@ -454,6 +454,7 @@ namespace clan
 	{
 		impl->sig_window_flip();
 		impl->provider->flip(interval);
+		impl->provider->get_gc().get_provider()->end_statistics_frame();
 	}
 
 	void DisplayWindow::show_cursor()
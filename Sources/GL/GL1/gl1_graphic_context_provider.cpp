@@ -332,7 +332,10 @@ namespace clan
 			{
 				selected_state.rasterizer.set(gl1_state->desc);
 				set_active();
-				framebuffer_bound ? framebuffer_provider->set_state(selected_state.rasterizer) : selected_state.rasterizer.apply();
+				if (framebuffer_bound)
+					framebuffer_provider->set_state(selected_state.rasterizer);
+				else
+					selected_state.rasterizer.apply();
 
 				scissor_enabled = gl1_state->desc.get_enable_scissor();
 			}
@@ -349,7 +352,10 @@ namespace clan
 			{
 				selected_state.blend.set(gl1_state->desc, blend_color);
 				set_active();
-				framebuffer_bound ? framebuffer_provider->set_state(selected_state.blend) : selected_state.blend.apply();
+				if (framebuffer_bound)
+					framebuffer_provider->set_state(selected_state.blend);
+				else
+					selected_state.blend.apply();
 			}
 		}
 	}
@@ -363,7 +369,10 @@ namespace clan
 			{
 				selected_state.depth_stencil.set(gl1_state->desc);
 				set_active();
-				framebuffer_bound ? framebuffer_provider->set_state(selected_state.depth_stencil) : selected_state.depth_stencil.apply();
+				if (framebuffer_bound)
+					framebuffer_provider->set_state(selected_state.depth_stencil);
+				else
+					selected_state.depth_stencil.apply();
 			}
 		}
 	}
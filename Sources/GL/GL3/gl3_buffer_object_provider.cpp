@@ -74,6 +74,7 @@ namespace clan
 		binding = new_binding;
 		target = new_target;
 		buffer_size = new_size;
+		buffer_usage = usage;
 
 		OpenGL::set_active();
 
@@ -85,6 +86,37 @@ namespace clan
 		glBindBuffer(target, last_buffer);
 	}
 
+	void GL3BufferObjectProvider::create_persistent(const void *data, int new_size, BufferUsage usage, GLenum new_binding, GLenum new_target)
+	{
+		throw_if_disposed();
+
+		OpenGL::set_active();
+
+#ifndef CLANLIB_OPENGL_ES3
+		if (glBufferStorage)
+		{
+			binding = new_binding;
+			target = new_target;
+			buffer_size = new_size;
+			buffer_usage = usage;
+
+			GLint last_buffer = 0;
+			if (binding)
+				glGetIntegerv(binding, &last_buffer);
+			glBindBuffer(target, handle);
+
+			// GL_DYNAMIC_STORAGE_BIT keeps upload_data() working on the immutable storage
+			glBufferStorage(target, buffer_size, data, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_DYNAMIC_STORAGE_BIT);
+			persistent_data_ptr = glMapBufferRange(target, 0, buffer_size, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+
+			glBindBuffer(target, last_buffer);
+			return;
+		}
+#endif
+
+		create(data, new_size, usage, new_binding, new_target);
+	}
+
 	void *GL3BufferObjectProvider::get_data()
 	{
 		if (data_ptr == nullptr)
@@ -97,6 +129,14 @@ namespace clan
 		throw_if_disposed();
 		lock_gc = gc;
 		OpenGL::set_active(lock_gc);
+
+		if (persistent_data_ptr)
+		{
+			wait_for_fence(gc);
+			data_ptr = persistent_data_ptr;
+			return;
+		}
+
 		GLint last_buffer = 0;
 		if (binding)
 			glGetIntegerv(binding, &last_buffer);
@@ -113,6 +153,13 @@ namespace clan
 	void GL3BufferObjectProvider::unlock()
 	{
 		throw_if_disposed();
+		if (persistent_data_ptr)
+		{
+			data_ptr = nullptr;
+			lock_gc = GraphicContext();
+			return;
+		}
+
 		OpenGL::set_active(lock_gc);
 		GLint last_buffer = 0;
 		if (binding)
@@ -140,16 +187,7 @@ namespace clan
 		// Maybe an interpretation of:
 		// If any rendering in the pipeline makes reference to data in the buffer object being updated by glBufferSubData, especially from the specific region being updated, that rendering must drain from the pipeline before the data store can be updated.
 		// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glBufferSubData.xhtml
-		if (fence_object)
-		{
-			GLenum result = glClientWaitSync(fence_object, GL_SYNC_FLUSH_COMMANDS_BIT, 5000000000);
-			if (result == GL_TIMEOUT_EXPIRED)
-			{
-				throw clan::Exception("OpenGL Buffer 5 second timeout expired");
-			}
-			glDeleteSync(fence_object);
-			fence_object = 0;
-		}
+		wait_for_fence(gc);
 
 		glBufferSubData(target, offset, size, data);
 
@@ -191,4 +229,77 @@ namespace clan
 		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 		glBindBuffer(GL_COPY_READ_BUFFER, 0);
 	}
+
+	void *GL3BufferObjectProvider::map_stream(GraphicContext &gc)
+	{
+		throw_if_disposed();
+		if (!persistent_data_ptr)
+			return nullptr;
+
+		OpenGL::set_active(gc);
+		wait_for_fence(gc);
+		return persistent_data_ptr;
+	}
+
+	void GL3BufferObjectProvider::upload_stream(GraphicContext &gc, const void *data, int size)
+	{
+		throw_if_disposed();
+		OpenGL::set_active(gc);
+
+		if (persistent_data_ptr)
+		{
+			// The mapping is coherent, so vertices written through map_stream() need no further work
+			if (data != persistent_data_ptr)
+			{
+				wait_for_fence(gc);
+				memcpy(persistent_data_ptr, data, size);
+			}
+		}
+		else
+		{
+			GLint last_buffer = 0;
+			if (binding)
+				glGetIntegerv(binding, &last_buffer);
+			glBindBuffer(target, handle);
+
+			// Orphan the old storage so the driver does not have to wait for draws still using it
+			glBufferData(target, buffer_size, nullptr, OpenGL::to_enum(buffer_usage));
+			glBufferSubData(target, 0, size, data);
+
+			glBindBuffer(target, last_buffer);
+		}
+
+		gc.get_provider()->get_current_statistics().bytes_uploaded += size;
+	}
+
+	void GL3BufferObjectProvider::fence_stream(GraphicContext &gc)
+	{
+		throw_if_disposed();
+		if (!persistent_data_ptr || !glFenceSync)
+			return;
+
+		OpenGL::set_active(gc);
+		if (fence_object)
+			glDeleteSync(fence_object);
+		fence_object = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	void GL3BufferObjectProvider::wait_for_fence(GraphicContext &gc)
+	{
+		if (!fence_object)
+			return;
+
+		GLenum result = glClientWaitSync(fence_object, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			gc.get_provider()->get_current_statistics().upload_stalls++;
+			result = glClientWaitSync(fence_object, GL_SYNC_FLUSH_COMMANDS_BIT, 5000000000);
+			if (result == GL_TIMEOUT_EXPIRED)
+			{
+				throw clan::Exception("OpenGL Buffer 5 second timeout expired");
+			}
+		}
+		glDeleteSync(fence_object);
+		fence_object = 0;
+	}
 }
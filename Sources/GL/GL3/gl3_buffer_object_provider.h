@@ -47,6 +47,11 @@ namespace clan
 		~GL3BufferObjectProvider();
 		void create(const void *data, int new_size, BufferUsage usage, GLenum new_binding, GLenum new_target);
 
+		/// \brief Creates a buffer that stays mapped for writing while the GPU draws from it
+		///
+		/// Falls back to create() if the driver does not support glBufferStorage.
+		void create_persistent(const void *data, int new_size, BufferUsage usage, GLenum new_binding, GLenum new_target);
+
 		void *get_data();
 
 		GLuint get_handle() const { return handle; }
@@ -61,16 +66,23 @@ namespace clan
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 		void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 
+		void *map_stream(GraphicContext &gc);
+		void upload_stream(GraphicContext &gc, const void *data, int size);
+		void fence_stream(GraphicContext &gc);
+
 	private:
 		void on_dispose() override;
+		void wait_for_fence(GraphicContext &gc);
 
 		GLuint handle;
 		GLenum binding;
 		GLenum target;
 
 		int buffer_size = 0;
+		BufferUsage buffer_usage = BufferUsage::static_draw;
 
 		void *data_ptr;
+		void *persistent_data_ptr = nullptr;
 		GraphicContext lock_gc;
 		CLsync fence_object = 0;
 	};
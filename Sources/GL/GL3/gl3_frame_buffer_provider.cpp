@@ -72,6 +72,7 @@ namespace clan
 		{
 			OpenGL::set_active(gc_provider);
 			glDeleteFramebuffers(1, &handle);
+			GL3GraphicContextProvider::invalidate_state_caches();
 			handle = 0;
 		}
 
@@ -358,6 +359,9 @@ namespace clan
 	FrameBufferStateTracker::FrameBufferStateTracker(FrameBufferBindTarget target, GLuint handle, GL3GraphicContextProvider *gc_provider)
 		: bind_target(target), last_bound(0), handle_and_bound_equal(false)
 	{
+		// Attachment changes affect the draw buffers selected when the frame buffer is bound
+		GL3GraphicContextProvider::invalidate_state_caches();
+
 		OpenGL::set_active(gc_provider);
 		if (bind_target == FrameBufferBindTarget::draw)
 		{
@@ -34,6 +34,7 @@
 #include "GL/precomp.h"
 #include "gl3_graphic_context_provider.h"
 #include "gl3_occlusion_query_provider.h"
+#include "gl3_timer_query_provider.h"
 #include "gl3_texture_provider.h"
 #include "gl3_program_object_provider.h"
 #include "gl3_shader_object_provider.h"
@@ -82,6 +83,8 @@
 
 namespace clan
 {
+	std::atomic_int GL3GraphicContextProvider::state_cache_generation(0);
+
 	GL3GraphicContextProvider::GL3GraphicContextProvider(const OpenGLWindowProvider * const render_window)
 		: render_window(render_window), framebuffer_bound(false), opengl_version_major(0), shader_version_major(0), scissor_enabled(false)
 	{
@@ -297,6 +300,28 @@ namespace clan
 		return std::make_unique<GL3OcclusionQueryProvider>(this);
 	}
 
+	std::unique_ptr<TimerQueryProvider> GL3GraphicContextProvider::alloc_timer_query()
+	{
+		if (!is_timer_query_supported())
+			return nullptr;
+		return std::make_unique<GL3TimerQueryProvider>(this);
+	}
+
+	bool GL3GraphicContextProvider::is_timer_query_supported()
+	{
+#ifdef CLANLIB_OPENGL_ES3
+		return false;
+#else
+		if (!timer_query_support_known)
+		{
+			OpenGL::set_active(this);
+			timer_query_supported = glQueryCounter != nullptr && glGetQueryObjectui64v != nullptr;
+			timer_query_support_known = true;
+		}
+		return timer_query_supported;
+#endif
+	}
+
 	std::unique_ptr<ProgramObjectProvider> GL3GraphicContextProvider::alloc_program_object()
 	{
 		return std::make_unique<GL3ProgramObjectProvider>();
@@ -381,7 +406,8 @@ namespace clan
 			{
 				selected_rasterizer_state.set(gl3_state->desc);
 				OpenGL::set_active(this);
-				selected_rasterizer_state.apply();
+				if (count_state_change(selected_rasterizer_state.apply()))
+					state_cache.scissor_enabled = -1;	// apply() may have disabled the scissor test
 				scissor_enabled = gl3_state->desc.get_enable_scissor();
 			}
 		}
@@ -396,7 +422,7 @@ namespace clan
 			{
 				selected_blend_state.set(gl3_state->desc, blend_color);
 				OpenGL::set_active(this);
-				selected_blend_state.apply();
+				count_state_change(selected_blend_state.apply());
 			}
 		}
 	}
@@ -410,7 +436,7 @@ namespace clan
 			{
 				selected_depth_stencil_state.set(gl3_state->desc);
 				OpenGL::set_active(this);
-				selected_depth_stencil_state.apply();
+				count_state_change(selected_depth_stencil_state.apply());
 			}
 		}
 	}
@@ -470,19 +496,10 @@ namespace clan
 	{
 		OpenGL::set_active(this);
 
-		if (glActiveTexture != nullptr)
-		{
-			glActiveTexture(GL_TEXTURE0 + unit_index);
-		}
-		else if (unit_index > 0)
-		{
-			return;
-		}
-
 		if (!texture.is_null())
 		{
 			GL3TextureProvider *provider = static_cast<GL3TextureProvider *>(texture.get_provider());
-			glBindTexture(provider->get_texture_type(), provider->get_handle());
+			bind_texture(unit_index, provider->get_texture_type(), provider->get_handle());
 		}
 	}
 
@@ -490,16 +507,54 @@ namespace clan
 	{
 		OpenGL::set_active(this);
 
-		if (glActiveTexture != nullptr)
+		// Set the texture to the default state
+		bind_texture(unit_index, GL_TEXTURE_2D, 0);
+	}
+
+	void GL3GraphicContextProvider::bind_texture(int unit_index, GLenum target, GLuint handle)
+	{
+		if (glActiveTexture == nullptr && unit_index > 0)
+			return;
+
+		validate_state_cache();
+		if (unit_index >= (int)state_cache.textures.size())
+			state_cache.textures.resize(unit_index + 1);
+
+		StateCache::TextureBinding &binding = state_cache.textures[unit_index];
+		if (!count_state_change(binding.target != target || binding.handle != handle))
+			return;
+
+		if (glActiveTexture != nullptr && state_cache.active_texture_unit != unit_index)
 		{
 			glActiveTexture(GL_TEXTURE0 + unit_index);
+			state_cache.active_texture_unit = unit_index;
 		}
-		else if (unit_index > 0)
+
+		// Only the last target bound is tracked per unit, so switching target always rebinds
+		glBindTexture(target, handle);
+		binding.target = target;
+		binding.handle = handle;
+	}
+
+	void GL3GraphicContextProvider::invalidate_texture_bindings(GLuint handle)
+	{
+		std::unique_ptr<std::unique_lock<std::recursive_mutex>> mutex_section;
+		std::vector<GraphicContextProvider*> &gc_providers = SharedGCData::get_gc_providers(mutex_section);
+		for (GraphicContextProvider *provider : gc_providers)
 		{
-			return;
+			GL3GraphicContextProvider *gc_provider = dynamic_cast<GL3GraphicContextProvider *>(provider);
+			if (gc_provider)
+				gc_provider->forget_texture(handle);
+		}
+	}
+
+	void GL3GraphicContextProvider::forget_texture(GLuint handle)
+	{
+		for (StateCache::TextureBinding &binding : state_cache.textures)
+		{
+			if (binding.handle == handle)
+				binding.handle = StateCache::unknown;
 		}
-		// Set the texture to the default state
-		glBindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	void GL3GraphicContextProvider::set_image_texture(int unit_index, const Texture &texture)
@@ -538,10 +593,19 @@ namespace clan
 			throw Exception("FrameBuffer objects cannot be shared between multiple GraphicContext objects");
 
 		OpenGL::set_active(this);
+		validate_state_cache();
 
-		draw_buffer_provider->bind_framebuffer(true);
-		if (draw_buffer_provider != read_buffer_provider)		// You cannot read and write to the same framebuffer
-			read_buffer_provider->bind_framebuffer(false);
+		GLuint draw_handle = draw_buffer_provider->get_handle();
+		GLuint read_handle = read_buffer_provider->get_handle();
+		if (count_state_change(state_cache.draw_framebuffer != draw_handle || state_cache.read_framebuffer != read_handle))
+		{
+			draw_buffer_provider->bind_framebuffer(true);
+			if (draw_buffer_provider != read_buffer_provider)		// You cannot read and write to the same framebuffer
+				read_buffer_provider->bind_framebuffer(false);
+
+			state_cache.draw_framebuffer = draw_handle;
+			state_cache.read_framebuffer = read_handle;
+		}
 
 		// Check for framebuffer completeness
 		draw_buffer_provider->check_framebuffer_complete();
@@ -554,6 +618,13 @@ namespace clan
 	void GL3GraphicContextProvider::reset_frame_buffer()
 	{
 		OpenGL::set_active(this);
+		validate_state_cache();
+
+		if (!count_state_change(state_cache.draw_framebuffer != 0 || state_cache.read_framebuffer != 0))
+		{
+			framebuffer_bound = false;
+			return;
+		}
 
 		// To do: move this to OpenGLWindowProvider abstraction (some targets doesn't have a default frame buffer)
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -571,6 +642,8 @@ namespace clan
 			glReadBuffer(GL_FRONT);
 		}
 #endif
+		state_cache.draw_framebuffer = 0;
+		state_cache.read_framebuffer = 0;
 		framebuffer_bound = false;
 
 	}
@@ -586,18 +659,25 @@ namespace clan
 		if (glUseProgram == nullptr)
 			return;
 
-		if (program.is_null())
-			glUseProgram(0);
-		else
+		GLuint handle = program.is_null() ? 0 : program.get_handle();
+
+		validate_state_cache();
+		if (count_state_change(state_cache.program != handle))
 		{
-			glUseProgram(program.get_handle());
+			glUseProgram(handle);
+			state_cache.program = handle;
 		}
 	}
 
 	void GL3GraphicContextProvider::reset_program_object()
 	{
 		OpenGL::set_active(this);
-		glUseProgram(0);
+		validate_state_cache();
+		if (count_state_change(state_cache.program != 0))
+		{
+			glUseProgram(0);
+			state_cache.program = 0;
+		}
 	}
 
 	bool GL3GraphicContextProvider::is_primitives_array_owner(const PrimitivesArray &prim_array)
@@ -611,9 +691,9 @@ namespace clan
 
 	void GL3GraphicContextProvider::draw_primitives(PrimitivesType type, int num_vertices, const PrimitivesArray &primitives_array)
 	{
+		// The vertex array is left bound. The state cache makes rebinding it for the next draw free.
 		set_primitives_array(primitives_array);
 		draw_primitives_array(type, 0, num_vertices);
-		reset_primitives_array();
 	}
 
 	void GL3GraphicContextProvider::set_primitives_array(const PrimitivesArray &primitives_array)
@@ -621,7 +701,12 @@ namespace clan
 		GL3PrimitivesArrayProvider *prim_array = static_cast<GL3PrimitivesArrayProvider *>(primitives_array.get_provider());
 
 		OpenGL::set_active(this);
-		glBindVertexArray(prim_array->handle);
+		validate_state_cache();
+		if (count_state_change(state_cache.vertex_array != prim_array->handle))
+		{
+			glBindVertexArray(prim_array->handle);
+			state_cache.vertex_array = prim_array->handle;
+		}
 	}
 
 	void GL3GraphicContextProvider::draw_primitives_array(PrimitivesType type, int offset, int num_vertices)
@@ -690,7 +775,12 @@ namespace clan
 	void GL3GraphicContextProvider::reset_primitives_array()
 	{
 		OpenGL::set_active(this);
-		glBindVertexArray(0);
+		validate_state_cache();
+		if (count_state_change(state_cache.vertex_array != 0))
+		{
+			glBindVertexArray(0);
+			state_cache.vertex_array = 0;
+		}
 	}
 
 	void GL3GraphicContextProvider::set_scissor(const Rect &rect)
@@ -700,18 +790,34 @@ namespace clan
 		if (!scissor_enabled)
 			throw Exception("RasterizerState must be set with enable_scissor() for clipping to work");
 
-		glEnable(GL_SCISSOR_TEST);
-		glScissor(
-			rect.left,
-			rect.top,
-			rect.get_width(),
-			rect.get_height());
+		validate_state_cache();
+		if (count_state_change(state_cache.scissor_enabled != 1))
+		{
+			glEnable(GL_SCISSOR_TEST);
+			state_cache.scissor_enabled = 1;
+		}
+
+		if (count_state_change(!state_cache.scissor_known || state_cache.scissor != rect))
+		{
+			glScissor(
+				rect.left,
+				rect.top,
+				rect.get_width(),
+				rect.get_height());
+			state_cache.scissor_known = true;
+			state_cache.scissor = rect;
+		}
 	}
 
 	void GL3GraphicContextProvider::reset_scissor()
 	{
 		OpenGL::set_active(this);
-		glDisable(GL_SCISSOR_TEST);
+		validate_state_cache();
+		if (count_state_change(state_cache.scissor_enabled != 0))
+		{
+			glDisable(GL_SCISSOR_TEST);
+			state_cache.scissor_enabled = 0;
+		}
 	}
 
 	void GL3GraphicContextProvider::dispatch(int x, int y, int z)
@@ -760,11 +866,15 @@ namespace clan
 	void GL3GraphicContextProvider::set_viewport(const Rectf &viewport)
 	{
 		OpenGL::set_active(this);
-		glViewport(
-			GLsizei(viewport.left),
-			GLsizei(viewport.top),
-			GLsizei(viewport.right - viewport.left),
-			GLsizei(viewport.bottom - viewport.top));
+		validate_state_cache();
+
+		Rect rect(GLsizei(viewport.left), GLsizei(viewport.top), Size(GLsizei(viewport.right - viewport.left), GLsizei(viewport.bottom - viewport.top)));
+		if (count_state_change(!state_cache.viewport_known || state_cache.viewport != rect))
+		{
+			glViewport(rect.left, rect.top, rect.get_width(), rect.get_height());
+			state_cache.viewport_known = true;
+			state_cache.viewport = rect;
+		}
 	}
 
 	void GL3GraphicContextProvider::set_viewport(int index, const Rectf &viewport)
@@ -773,6 +883,8 @@ namespace clan
 		if (glViewportIndexedf)
 		{
 			OpenGL::set_active(this);
+			if (index == 0)
+				state_cache.viewport_known = false;
 			glViewportIndexedf(index,
 				GLfloat(viewport.left),
 				GLfloat(viewport.top),
@@ -821,6 +933,9 @@ namespace clan
 			glDrawBuffer(OpenGL::to_enum(buffer));
 #endif
 
+		// Binding the frame buffers again restores the draw buffers they expect
+		state_cache.draw_framebuffer = StateCache::unknown;
+		state_cache.read_framebuffer = StateCache::unknown;
 	}
 
 	void GL3GraphicContextProvider::make_current() const
@@ -838,4 +953,24 @@ namespace clan
 	{
 		return *render_window;
 	}
+
+	void GL3GraphicContextProvider::validate_state_cache()
+	{
+		int generation = state_cache_generation;
+		if (state_cache.generation != generation)
+		{
+			state_cache = StateCache();
+			state_cache.generation = generation;
+		}
+	}
+
+	bool GL3GraphicContextProvider::count_state_change(bool changed)
+	{
+		GraphicContextStatistics &statistics = get_current_statistics();
+		if (changed)
+			statistics.state_changes++;
+		else
+			statistics.state_changes_skipped++;
+		return changed;
+	}
 }
@@ -46,6 +46,7 @@
 #include "../State/opengl_rasterizer_state.h"
 #include "../State/opengl_depth_stencil_state.h"
 #include <map>
+#include <atomic>
 
 namespace clan
 {
@@ -99,6 +100,8 @@ namespace clan
 		bool has_compute_shader_support() const override { return false; }
 		std::unique_ptr<TextureProvider> alloc_texture(TextureDimensions texture_dimensions) override;
 		std::unique_ptr<OcclusionQueryProvider> alloc_occlusion_query() override;
+		std::unique_ptr<TimerQueryProvider> alloc_timer_query() override;
+		bool is_timer_query_supported() override;
 		std::unique_ptr<ProgramObjectProvider> alloc_program_object() override;
 		std::unique_ptr<ShaderObjectProvider> alloc_shader_object() override;
 		std::unique_ptr<FrameBufferProvider> alloc_frame_buffer() override;
@@ -168,7 +171,53 @@ namespace clan
 
 		void flush() override;
 
+		/// \brief Forgets the OpenGL bindings cached by all graphic contexts
+		///
+		/// Must be called when an OpenGL object is deleted, as its name may be reused by a new object.
+		static void invalidate_state_caches() { state_cache_generation++; }
+
+		/// \brief Forgets the texture units that have a texture bound, in the caches of all graphic contexts
+		///
+		/// Must be called when a texture is deleted, as its name may be reused by a new texture.
+		/// Other bindings stay cached.
+		static void invalidate_texture_bindings(GLuint handle);
+
+		/// \brief Forgets the OpenGL bindings cached by this graphic context
+		///
+		/// Call this after changing bindings with raw OpenGL calls.
+		void invalidate_state_cache() { state_cache = StateCache(); }
+
 	private:
+		/// \brief Shadow copy of the OpenGL bindings, used to skip redundant state changes
+		struct StateCache
+		{
+			static const GLuint unknown = 0xffffffff;
+
+			struct TextureBinding
+			{
+				GLenum target = 0;
+				GLuint handle = unknown;
+			};
+
+			int generation = -1;
+			GLuint program = unknown;
+			GLuint vertex_array = unknown;
+			GLuint draw_framebuffer = unknown;
+			GLuint read_framebuffer = unknown;
+			int active_texture_unit = -1;
+			std::vector<TextureBinding> textures;
+			bool viewport_known = false;
+			Rect viewport;
+			int scissor_enabled = -1;
+			bool scissor_known = false;
+			Rect scissor;
+		};
+
+		void validate_state_cache();
+		bool count_state_change(bool changed);
+		void bind_texture(int unit_index, GLenum target, GLuint handle);
+		void forget_texture(GLuint handle);
+
 		void on_dispose() override;
 		void create_standard_programs();
 
@@ -197,5 +246,11 @@ namespace clan
 		OpenGLDepthStencilState selected_depth_stencil_state;
 
 		GL3StandardPrograms standard_programs;
+
+		StateCache state_cache;
+
+		bool timer_query_support_known = false;
+		bool timer_query_supported = false;
+		static std::atomic_int state_cache_generation;
 	};
 }
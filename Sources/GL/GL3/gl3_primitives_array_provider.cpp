@@ -72,6 +72,7 @@ namespace clan
 		{
 			OpenGL::set_active(gc_provider);
 			glDeleteVertexArrays(1, &handle);
+			GL3GraphicContextProvider::invalidate_state_caches();
 		}
 		gc_provider->remove_disposable(this);
 	}
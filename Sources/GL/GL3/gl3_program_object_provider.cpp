@@ -35,6 +35,7 @@
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Display/Render/shared_gc_data.h"
+#include "API/Core/System/databuffer.h"
 #include "gl3_graphic_context_provider.h"
 #include "gl3_uniform_buffer_provider.h"
 
@@ -61,6 +62,7 @@ namespace clan
 			if (OpenGL::set_active())
 			{
 				glDeleteProgram(handle);
+				GL3GraphicContextProvider::invalidate_state_caches();
 			}
 		}
 	}
@@ -361,6 +363,70 @@ namespace clan
 #endif
 	}
 
+	std::string GL3ProgramObjectProvider::get_binary_driver_id() const
+	{
+		throw_if_disposed();
+		OpenGL::set_active();
+		if (glGetProgramBinary == nullptr || glProgramBinary == nullptr)
+			return std::string();
+
+		GLint num_formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+		if (num_formats <= 0)
+			return std::string();
+
+		const char *vendor = (const char *)glGetString(GL_VENDOR);
+		const char *renderer = (const char *)glGetString(GL_RENDERER);
+		const char *version = (const char *)glGetString(GL_VERSION);
+		if (!vendor || !renderer || !version)
+			return std::string();
+
+		return string_format("%1\n%2\n%3", vendor, renderer, version);
+	}
+
+	void GL3ProgramObjectProvider::set_binary_retrievable_hint()
+	{
+		throw_if_disposed();
+		OpenGL::set_active();
+		if (glProgramParameteri)
+			glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	bool GL3ProgramObjectProvider::get_program_binary(unsigned int &out_format, DataBuffer &out_binary) const
+	{
+		throw_if_disposed();
+		OpenGL::set_active();
+		if (glGetProgramBinary == nullptr)
+			return false;
+
+		GLint length = 0;
+		glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return false;
+
+		out_binary = DataBuffer(length);
+		GLsizei written = 0;
+		GLenum format = 0;
+		glGetProgramBinary(handle, length, &written, &format, out_binary.get_data());
+		if (written <= 0)
+			return false;
+
+		out_binary.set_size(written);
+		out_format = format;
+		return true;
+	}
+
+	bool GL3ProgramObjectProvider::load_program_binary(unsigned int format, const DataBuffer &binary)
+	{
+		throw_if_disposed();
+		OpenGL::set_active();
+		if (glProgramBinary == nullptr)
+			return false;
+
+		glProgramBinary(handle, format, binary.get_data(), binary.get_size());
+		return get_link_status();
+	}
+
 	/////////////////////////////////////////////////////////////////////////////
 
 	ProgramObjectStateTracker::ProgramObjectStateTracker(GLuint handle) : program_set(false)
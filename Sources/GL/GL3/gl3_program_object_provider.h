@@ -110,6 +110,11 @@ namespace clan
 		void set_uniform_buffer_index(int block_index, int bind_index) override;
 		void set_storage_buffer_index(int buffer_index, int bind_unit_index) override;
 
+		std::string get_binary_driver_id() const override;
+		void set_binary_retrievable_hint() override;
+		bool get_program_binary(unsigned int &out_format, DataBuffer &out_binary) const override;
+		bool load_program_binary(unsigned int format, const DataBuffer &binary) override;
+
 	private:
 		void on_dispose() override;
 
@@ -166,6 +166,64 @@ highp vec4 sampleTexture(int index, highp vec2 pos)
 void main() {
     cl_FragColor = Color * sampleTexture(TexIndex, TexCoord);
 }
+)";
+
+	const std::string::value_type *cl_glsl_fragment_distance_field_glyph = R"(
+#version 430
+
+uniform sampler2D Texture0;
+uniform sampler2D Texture1;
+uniform sampler2D Texture2;
+uniform sampler2D Texture3;
+uniform sampler2D Texture4;
+uniform sampler2D Texture5;
+uniform sampler2D Texture6;
+uniform sampler2D Texture7;
+uniform sampler2D Texture8;
+uniform sampler2D Texture9;
+uniform sampler2D Texture10;
+uniform sampler2D Texture11;
+uniform sampler2D Texture12;
+uniform sampler2D Texture13;
+uniform sampler2D Texture14;
+uniform sampler2D Texture15;
+
+in vec4 Color;
+in vec2 TexCoord;
+flat in int TexIndex;
+out vec4 cl_FragColor;
+
+highp float sampleDistance(int index, highp vec2 pos)
+{
+    switch (index)
+    {
+        case 0: return texture(Texture0, pos).a;
+        case 1: return texture(Texture1, pos).a;
+        case 2: return texture(Texture2, pos).a;
+        case 3: return texture(Texture3, pos).a;
+        case 4: return texture(Texture4, pos).a;
+        case 5: return texture(Texture5, pos).a;
+        case 6: return texture(Texture6, pos).a;
+        case 7: return texture(Texture7, pos).a;
+        case 8: return texture(Texture8, pos).a;
+        case 9: return texture(Texture9, pos).a;
+        case 10: return texture(Texture10, pos).a;
+        case 11: return texture(Texture11, pos).a;
+        case 12: return texture(Texture12, pos).a;
+        case 13: return texture(Texture13, pos).a;
+        case 14: return texture(Texture14, pos).a;
+        case 15: return texture(Texture15, pos).a;
+        default: return 1.0;
+    }
+}
+
+void main() {
+    // 0.5 is on the outline. Smooth over about one screen pixel, whatever the scale the glyph is drawn at.
+    float distance = sampleDistance(TexIndex, TexCoord);
+    float width = max(fwidth(distance) * 0.7, 0.0001);
+    float coverage = smoothstep(0.5 - width, 0.5 + width, distance);
+    cl_FragColor = Color * coverage;
+}
 )";
 
 	const std::string::value_type* cl_glsl_vertex_path = R"(
@@ -318,6 +376,7 @@ void main()
 		ProgramObject single_texture_program;
 		ProgramObject sprite_program;
 		ProgramObject path_program;
+		ProgramObject distance_field_glyph_program;
 
 	};
 
@@ -325,6 +384,23 @@ void main()
 	{
 	}
 
+	static void link_standard_program(ProgramObject &program, const std::string &name)
+	{
+		if (program.link())
+			return;
+
+		// link() compiles the shaders, so tell a compile error apart from a link error
+		for (auto &shader : program.get_shaders())
+		{
+			if (!shader.get_provider()->get_compile_status())
+			{
+				std::string type = shader.get_shader_type() == ShaderType::vertex ? "vertex" : "fragment";
+				throw Exception("Unable to compile the standard shader program: '" + type + " " + name + "' Error:" + shader.get_info_log());
+			}
+		}
+		throw Exception("Unable to link the standard shader program: '" + name + "' Error:" + program.get_info_log());
+	}
+
 	GL3StandardPrograms::GL3StandardPrograms(GL3GraphicContextProvider *provider) : impl(std::make_shared<GL3StandardPrograms_Impl>())
 	{
 		//int glsl_version_major;
@@ -332,37 +408,16 @@ void main()
 		//provider->get_opengl_shading_language_version(glsl_version_major, glsl_version_minor);
 
 		ShaderObject vertex_color_only_shader(provider, ShaderType::vertex, cl_glsl_vertex_color_only);
-		if (!vertex_color_only_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'vertex color only' Error:" + vertex_color_only_shader.get_info_log());
-
 		ShaderObject fragment_color_only_shader(provider, ShaderType::fragment, cl_glsl_fragment_color_only);
-		if (!fragment_color_only_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'fragment color only' Error:" + fragment_color_only_shader.get_info_log());
-
 		ShaderObject vertex_single_texture_shader(provider, ShaderType::vertex, cl_glsl_vertex_single_texture);
-		if (!vertex_single_texture_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'vertex single texture' Error:" + vertex_single_texture_shader.get_info_log());
-
 		ShaderObject fragment_single_texture_shader(provider, ShaderType::fragment, cl_glsl_fragment_single_texture);
-		if (!fragment_single_texture_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'fragment single texture' Error:" + fragment_single_texture_shader.get_info_log());
-
 		ShaderObject vertex_sprite_shader(provider, ShaderType::vertex,cl_glsl_vertex_sprite);
-		if (!vertex_sprite_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'vertex sprite' Error:" + vertex_sprite_shader.get_info_log());
-
 		ShaderObject fragment_sprite_shader(provider, ShaderType::fragment, cl_glsl_fragment_sprite);
-		if (!fragment_sprite_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'fragment sprite' Error:" + fragment_sprite_shader.get_info_log());
-
+		ShaderObject fragment_distance_field_glyph_shader(provider, ShaderType::fragment, cl_glsl_fragment_distance_field_glyph);
 		ShaderObject vertex_path_shader(provider, ShaderType::vertex, cl_glsl_vertex_path);
-		if (!vertex_path_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'vertex path' Error:" + vertex_path_shader.get_info_log());
-
 		ShaderObject fragment_path_shader(provider, ShaderType::fragment, cl_glsl_fragment_path);
-		if (!fragment_path_shader.compile())
-			throw Exception("Unable to compile the standard shader program: 'fragment path' Error:" + fragment_path_shader.get_info_log());
 
+		// The shaders are compiled by ProgramObject::link(), unless it finds the programs in the binary cache
 		ProgramObject color_only_program(provider);
 		color_only_program.attach(vertex_color_only_shader);
 		color_only_program.attach(fragment_color_only_shader);
@@ -372,8 +427,7 @@ void main()
 #ifndef CLANLIB_OPENGL_ES3
 		color_only_program.bind_frag_data_location(0, "cl_FragColor");
 #endif
-		if (!color_only_program.link())
-			throw Exception("Unable to link the standard shader program: 'color only' Error:" + color_only_program.get_info_log());
+		link_standard_program(color_only_program, "color only");
 
 		ProgramObject single_texture_program(provider);
 		single_texture_program.attach(vertex_single_texture_shader);
@@ -386,8 +440,7 @@ void main()
 		single_texture_program.bind_frag_data_location(0, "cl_FragColor");
 #endif
 
-		if (!single_texture_program.link())
-			throw Exception("Unable to link the standard shader program: 'single texture' Error:" + single_texture_program.get_info_log());
+		link_standard_program(single_texture_program, "single texture");
 		single_texture_program.set_uniform1i("Texture0", 0);
 
 		ProgramObject sprite_program(provider);
@@ -402,8 +455,7 @@ void main()
 		sprite_program.bind_frag_data_location(0, "cl_FragColor");
 #endif
 
-		if (!sprite_program.link())
-			throw Exception("Unable to link the standard shader program: 'sprite' Error:" + sprite_program.get_info_log());
+		link_standard_program(sprite_program, "sprite");
 
 		sprite_program.set_uniform1i("Texture0", 0);
 		sprite_program.set_uniform1i("Texture1", 1);
@@ -422,6 +474,23 @@ void main()
 		sprite_program.set_uniform1i("Texture14", 14);
 		sprite_program.set_uniform1i("Texture15", 15);
 
+		ProgramObject distance_field_glyph_program(provider);
+		distance_field_glyph_program.attach(vertex_sprite_shader);
+		distance_field_glyph_program.attach(fragment_distance_field_glyph_shader);
+		distance_field_glyph_program.bind_attribute_location(0, "Position");
+		distance_field_glyph_program.bind_attribute_location(1, "Color0");
+		distance_field_glyph_program.bind_attribute_location(2, "TexCoord0");
+		distance_field_glyph_program.bind_attribute_location(3, "TexIndex0");
+
+#ifndef CLANLIB_OPENGL_ES3
+		distance_field_glyph_program.bind_frag_data_location(0, "cl_FragColor");
+#endif
+
+		link_standard_program(distance_field_glyph_program, "distance field glyph");
+
+		for (int i = 0; i < 16; i++)
+			distance_field_glyph_program.set_uniform1i("Texture" + StringHelp::int_to_text(i), i);
+
 		ProgramObject path_program(provider);
 		path_program.attach(vertex_path_shader);
 		path_program.attach(fragment_path_shader);
@@ -431,8 +500,7 @@ void main()
 		path_program.bind_frag_data_location(0, "cl_FragColor");
 #endif
 
-		if (!path_program.link())
-			throw Exception("Unable to link the standard shader program: 'path' Error:" + path_program.get_info_log());
+		link_standard_program(path_program, "path");
 		path_program.set_uniform1i("mask_texture", 0);
 		path_program.set_uniform1i("instance_data", 1);
 		path_program.set_uniform1i("image_texture", 2);
@@ -441,6 +509,7 @@ void main()
 		impl->single_texture_program = single_texture_program;
 		impl->sprite_program = sprite_program;
 		impl->path_program = path_program;
+		impl->distance_field_glyph_program = distance_field_glyph_program;
 
 		RenderBatchTriangle::max_textures = 16; // Too many hacks..
 	}
@@ -457,6 +526,7 @@ void main()
 		case StandardProgram::single_texture: return impl->single_texture_program;
 		case StandardProgram::sprite: return impl->sprite_program;
 		case StandardProgram::path: return impl->path_program;
+		case StandardProgram::distance_field_glyph: return impl->distance_field_glyph_program;
 		}
 		throw Exception("Unsupported standard program");
 	}
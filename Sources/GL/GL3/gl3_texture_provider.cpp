@@ -139,6 +139,7 @@ namespace clan
 			if (OpenGL::set_active())
 			{
 				glDeleteTextures(1, &handle);
+				GL3GraphicContextProvider::invalidate_texture_bindings(handle);
 			}
 		}
 	}
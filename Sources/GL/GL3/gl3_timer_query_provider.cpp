@@ -0,0 +1,112 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "GL/precomp.h"
+#include "gl3_timer_query_provider.h"
+#include "API/GL/opengl_wrap.h"
+#include "API/Display/Render/shared_gc_data.h"
+#include "gl3_graphic_context_provider.h"
+
+namespace clan
+{
+	GL3TimerQueryProvider::GL3TimerQueryProvider(GL3GraphicContextProvider *gc_provider)
+		: handle(0), gc_provider(gc_provider)
+	{
+		SharedGCData::add_disposable(this);
+		OpenGL::set_active(gc_provider);
+		glGenQueries(1, &handle);
+	}
+
+	GL3TimerQueryProvider::~GL3TimerQueryProvider()
+	{
+		dispose();
+		SharedGCData::remove_disposable(this);
+	}
+
+	void GL3TimerQueryProvider::on_dispose()
+	{
+		if (handle)
+		{
+			if (OpenGL::set_active())
+			{
+				glDeleteQueries(1, &handle);
+			}
+			handle = 0;
+		}
+	}
+
+	bool GL3TimerQueryProvider::is_result_ready() const
+	{
+		OpenGL::set_active(gc_provider);
+		GLuint available = 0;
+		glGetQueryObjectuiv(handle, GL_QUERY_RESULT_AVAILABLE, &available);
+		return (available != 0);
+	}
+
+	uint64_t GL3TimerQueryProvider::get_result() const
+	{
+		OpenGL::set_active(gc_provider);
+#ifdef CLANLIB_OPENGL_ES3
+		throw Exception("GL3TimerQueryProvider::get_result() not supported");
+#else
+		GLuint64 result = 0;
+		glGetQueryObjectui64v(handle, GL_QUERY_RESULT, &result);
+		return result;
+#endif
+	}
+
+	void GL3TimerQueryProvider::begin()
+	{
+		OpenGL::set_active(gc_provider);
+#ifdef CLANLIB_OPENGL_ES3
+		throw Exception("GL3TimerQueryProvider::begin() not supported");
+#else
+		glBeginQuery(GL_TIME_ELAPSED, handle);
+#endif
+	}
+
+	void GL3TimerQueryProvider::end()
+	{
+		OpenGL::set_active(gc_provider);
+#ifdef CLANLIB_OPENGL_ES3
+		throw Exception("GL3TimerQueryProvider::end() not supported");
+#else
+		glEndQuery(GL_TIME_ELAPSED);
+#endif
+	}
+
+	void GL3TimerQueryProvider::timestamp()
+	{
+		OpenGL::set_active(gc_provider);
+#ifdef CLANLIB_OPENGL_ES3
+		throw Exception("GL3TimerQueryProvider::timestamp() not supported");
+#else
+		glQueryCounter(handle, GL_TIMESTAMP);
+#endif
+	}
+}
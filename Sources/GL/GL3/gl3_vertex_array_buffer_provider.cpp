@@ -50,6 +50,10 @@ namespace clan
 
 	void GL3VertexArrayBufferProvider::create(void *data, int size, BufferUsage usage)
 	{
-		buffer.create(data, size, usage, GL_ARRAY_BUFFER_BINDING, GL_ARRAY_BUFFER);
+		// Streamed vertices are written by the CPU directly into mapped memory where the driver supports it
+		if (usage == BufferUsage::stream_draw)
+			buffer.create_persistent(data, size, usage, GL_ARRAY_BUFFER_BINDING, GL_ARRAY_BUFFER);
+		else
+			buffer.create(data, size, usage, GL_ARRAY_BUFFER_BINDING, GL_ARRAY_BUFFER);
 	}
 }
@@ -52,6 +52,10 @@ namespace clan
 		void copy_from(GraphicContext &gc, TransferBuffer &transfer_buffer, int dest_pos, int src_pos, int size) override { buffer.copy_from(gc, transfer_buffer, dest_pos, src_pos, size); }
 		void copy_to(GraphicContext &gc, TransferBuffer &transfer_buffer, int dest_pos, int src_pos, int size) override { buffer.copy_to(gc, transfer_buffer, dest_pos, src_pos, size); }
 
+		void *map_stream(GraphicContext &gc) override { return buffer.map_stream(gc); }
+		void upload_stream(GraphicContext &gc, const void *data, int size) override { buffer.upload_stream(gc, data, size); }
+		void fence_stream(GraphicContext &gc) override { buffer.fence_stream(gc); }
+
 	private:
 		GL3BufferObjectProvider buffer;
 	};
@@ -60,8 +60,10 @@ namespace clan
 	}
 
 
-	void OpenGLBlendState::apply()
+	bool OpenGLBlendState::apply()
 	{
+		bool changed = changed_desc || changed_blend_color;
+
 		if (changed_desc)
 		{
 			changed_desc = false;
@@ -131,5 +133,7 @@ namespace clan
 			if (glBlendColor)
 				glBlendColor(blend_color.r, blend_color.g, blend_color.b, blend_color.a);
 		}
+
+		return changed;
 	}
 }
@@ -53,7 +53,7 @@ namespace clan
 
 		void set(const BlendStateDescription &new_state, const Vec4f &new_blend_color);
 		void set(const OpenGLBlendState &new_state);
-		void apply();
+		bool apply();
 
 	private:
 		BlendStateDescription desc;
@@ -52,8 +52,10 @@ namespace clan
 		set(new_state.desc);
 	}
 
-	void OpenGLDepthStencilState::apply()
+	bool OpenGLDepthStencilState::apply()
 	{
+		bool changed = changed_desc;
+
 		if (changed_desc)
 		{
 			changed_desc = false;
@@ -87,5 +89,7 @@ namespace clan
 			glDepthFunc(OpenGL::to_enum(desc.get_depth_compare_function()));
 
 		}
+
+		return changed;
 	}
 }
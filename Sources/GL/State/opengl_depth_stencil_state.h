@@ -53,7 +53,7 @@ namespace clan
 
 		void set(const DepthStencilStateDescription &new_state);
 		void set(const OpenGLDepthStencilState &new_state);
-		void apply();
+		bool apply();
 
 	private:
 		DepthStencilStateDescription desc;
@@ -52,8 +52,10 @@ namespace clan
 		set(new_state.desc);
 	}
 
-	void OpenGLRasterizerState::apply()
+	bool OpenGLRasterizerState::apply()
 	{
+		bool changed = changed_desc;
+
 		if (changed_desc)
 		{
 			changed_desc = false;
@@ -115,5 +117,7 @@ namespace clan
 				glPolygonOffset(factor, units);
 			}
 		}
+
+		return changed;
 	}
 }
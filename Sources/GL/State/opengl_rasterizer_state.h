@@ -53,7 +53,7 @@ namespace clan
 
 		void set(const RasterizerStateDescription &new_state);
 		void set(const OpenGLRasterizerState &new_state);
-		void apply();
+		bool apply();
 
 	private:
 		RasterizerStateDescription desc;
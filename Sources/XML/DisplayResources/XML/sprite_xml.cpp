@@ -37,11 +37,12 @@
 #include "API/Core/Text/string_format.h"
 #include "API/Display/2D/sprite.h"
 #include "API/Display/2D/canvas.h"
+#include "API/Display/Render/texture.h"
 #include "API/Display/Render/texture_2d.h"
 
 namespace clan
 {
-	Sprite Sprite::load(Canvas &canvas, const std::string &id, const XMLResourceDocument &doc)
+	Sprite Sprite::load(Canvas &canvas, const std::string &id, const XMLResourceDocument &doc, std::function<Resource<Texture>(GraphicContext &, const std::string &)> cb_get_texture)
 	{
 		Sprite sprite(canvas);
 
@@ -123,9 +124,22 @@ namespace clan
 				}
 				else
 				{
-					std::string image_name = cur_element.get_attribute("file");
-					FileSystem fs = resource.get_file_system();
-					Texture2D texture = Texture2D(canvas, PathHelp::combine(resource.get_base_path(), image_name), fs);
+					Texture2D texture;
+					if (cur_element.has_attribute("texture"))
+					{
+						// Images of a sprite sheet refer to a texture resource, so the sprites on the same page can share it
+						std::string texture_id = cur_element.get_attribute("texture");
+						if (cb_get_texture)
+							texture = cb_get_texture(canvas, texture_id).get().to_texture_2d();
+						else
+							texture = Texture::load(canvas, texture_id, doc).to_texture_2d();
+					}
+					else
+					{
+						std::string image_name = cur_element.get_attribute("file");
+						FileSystem fs = resource.get_file_system();
+						texture = Texture2D(canvas, PathHelp::combine(resource.get_base_path(), image_name), fs);
+					}
 
 					DomNode cur_child(cur_element.get_first_child());
 					if (cur_child.is_null())
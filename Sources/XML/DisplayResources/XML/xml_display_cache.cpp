@@ -77,7 +77,7 @@ namespace clan
 			return sprite;
 		}
 
-		Resource<Sprite> sprite = Sprite::load(canvas, id, doc);
+		Resource<Sprite> sprite = Sprite::load(canvas, id, doc, bind_member(this, &XMLDisplayCache::get_texture));
 		sprites[id] = sprite;
 		sprite.get() = sprite.get().clone();
 		return sprite;
@@ -68,9 +68,27 @@ private:
 	void test_aes192_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
 	void test_aes256();
 	void test_aes256_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
+	void test_aes_ctr();
+	template<typename AES_CTR>
+	void test_aes_ctr_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
+	void test_aes_gcm();
+	template<typename AES_GCM>
+	void test_aes_gcm_helper(const char *key_ptr, const char *iv_ptr, const char *aad_ptr, const char *plaintext_ptr, const char *ciphertext_ptr, const char *tag_ptr);
+	void test_aes_benchmark();
+	template<typename Encrypt, typename Decrypt, typename CTR>
+	void test_aes_benchmark_helper(const char *name, const DataBuffer &plaintext);
+	template<typename CBC, typename GCM>
+	void test_aes_record_benchmark_helper(const char *name, const DataBuffer &plaintext);
 	void convert_ascii(const char *src, std::vector<unsigned char> &dest);
 
 	void test_rsa();
+	void test_rsa_benchmark();
+	void test_rsa_benchmark_helper(int key_size_in_bits);
+	void test_sha_multi_buffer();
+	void test_sha_multi_buffer_helper();
+	void test_sha_benchmark();
+	template<typename Hash>
+	double test_sha_benchmark_throughput(const std::vector<unsigned char> &data);
 	void test_md5();
 	void test_hash(const MD5 &sha1, const char *hash_text);
 	void test_sha1();
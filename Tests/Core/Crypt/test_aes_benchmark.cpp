@@ -0,0 +1,164 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+template<typename Cipher>
+static double aes_throughput(Cipher &cipher, const unsigned char *key, const unsigned char *iv, const DataBuffer &input, DataBuffer &output)
+{
+	// Repeat until the measurement is long enough to be meaningful
+	uint64_t start_time = System::get_microseconds();
+	uint64_t total_size = 0;
+	uint64_t elapsed_time = 0;
+	do
+	{
+		cipher.set_iv(iv);
+		cipher.set_key(key);
+		cipher.get_data().set_size(0);
+		cipher.add(input);
+		cipher.calculate();
+		output = cipher.get_data();
+		total_size += input.get_size();
+		elapsed_time = System::get_microseconds() - start_time;
+	} while (elapsed_time < 200000);
+
+	return total_size / (double)elapsed_time;	// Bytes per microsecond is MB/s
+}
+
+template<typename Encrypt, typename Decrypt, typename CTR>
+void TestApp::test_aes_benchmark_helper(const char *name, const DataBuffer &plaintext)
+{
+	std::vector<unsigned char> key(Encrypt::key_size);
+	std::vector<unsigned char> iv(Encrypt::iv_size);
+	for (size_t i = 0; i < key.size(); i++)
+		key[i] = (unsigned char)(i * 7 + 1);
+	for (size_t i = 0; i < iv.size(); i++)
+		iv[i] = (unsigned char)(i * 13 + 5);
+
+	DataBuffer ciphertext, decrypted;
+
+	Encrypt encrypt;
+	encrypt.set_padding(false);
+	double cbc_encrypt_speed = aes_throughput(encrypt, &key[0], &iv[0], plaintext, ciphertext);
+
+	Decrypt decrypt;
+	decrypt.set_padding(false);
+	double cbc_decrypt_speed = aes_throughput(decrypt, &key[0], &iv[0], ciphertext, decrypted);
+	if (decrypted.get_size() != plaintext.get_size() || memcmp(decrypted.get_data(), plaintext.get_data(), plaintext.get_size()))
+		fail();
+
+	CTR ctr;
+	double ctr_speed = aes_throughput(ctr, &key[0], &iv[0], plaintext, ciphertext);
+	CTR ctr_decrypt;
+	ctr_decrypt.set_iv(&iv[0]);
+	ctr_decrypt.set_key(&key[0]);
+	ctr_decrypt.add(ciphertext);
+	ctr_decrypt.calculate();
+	decrypted = ctr_decrypt.get_data();
+	if (decrypted.get_size() != plaintext.get_size() || memcmp(decrypted.get_data(), plaintext.get_data(), plaintext.get_size()))
+		fail();
+
+	Console::write_line(string_format("   %1: CBC encrypt %2 MB/s, CBC decrypt %3 MB/s, CTR %4 MB/s", name, (int)cbc_encrypt_speed, (int)cbc_decrypt_speed, (int)ctr_speed));
+}
+
+// Seals TLS sized records, as the TLS client does for GCM and for CBC with an HMAC-SHA256
+template<typename CBC, typename GCM>
+void TestApp::test_aes_record_benchmark_helper(const char *name, const DataBuffer &plaintext)
+{
+	const int record_size = 16 * 1024;
+	unsigned char key[CBC::key_size] = { 0 };
+	unsigned char iv[CBC::iv_size] = { 0 };
+	unsigned char mac_key[SHA256::hash_size] = { 0 };
+	unsigned char header[13] = { 0 };
+
+	CBC cbc;
+	cbc.set_padding(false);
+	SHA256 sha256;
+	int cbc_records = 0;
+	uint64_t start_time = System::get_microseconds();
+	uint64_t cbc_time = 0;
+	do
+	{
+		sha256.set_hmac(mac_key, sizeof(mac_key));
+		sha256.add(header, sizeof(header));
+		sha256.add(plaintext.get_data(), record_size);
+		sha256.calculate();
+		unsigned char mac[SHA256::hash_size];
+		sha256.get_hash(mac);
+
+		cbc.set_iv(iv);
+		cbc.set_key(key);
+		cbc.get_data().set_size(0);
+		cbc.add(plaintext.get_data(), record_size);
+		cbc.add(mac, sizeof(mac));
+		cbc.calculate();
+		cbc_records++;
+		cbc_time = System::get_microseconds() - start_time;
+	} while (cbc_time < 200000);
+
+	GCM gcm;
+	gcm.set_key(key);
+	int gcm_records = 0;
+	start_time = System::get_microseconds();
+	uint64_t gcm_time = 0;
+	do
+	{
+		gcm.set_iv(iv);
+		gcm.add_aad(header, sizeof(header));
+		gcm.encrypt(plaintext.get_data(), record_size);
+		gcm.calculate();
+		unsigned char tag[GCM::tag_size];
+		gcm.get_tag(tag);
+		gcm_records++;
+		gcm_time = System::get_microseconds() - start_time;
+	} while (gcm_time < 200000);
+
+	Console::write_line(string_format("   %1: 16 KB records, CBC with HMAC-SHA256 %2 records/s, GCM %3 records/s", name, (int)(cbc_records * 1000000.0 / cbc_time), (int)(gcm_records * 1000000.0 / gcm_time)));
+}
+
+void TestApp::test_aes_benchmark()
+{
+	Console::write_line(" Benchmark: AES throughput");
+	Console::write_line(string_format("  AES-NI: %1, PCLMUL: %2", System::detect_cpu_extension(System::aes) ? "yes" : "no", System::detect_cpu_extension(System::pclmul) ? "yes" : "no"));
+
+	DataBuffer plaintext(1024 * 1024);
+	unsigned int seed = 12345;
+	for (unsigned int i = 0; i < plaintext.get_size(); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		plaintext[i] = (char)(seed >> 16);
+	}
+
+	test_aes_benchmark_helper<AES128_Encrypt, AES128_Decrypt, AES128_CTR>("AES-128", plaintext);
+	test_aes_benchmark_helper<AES192_Encrypt, AES192_Decrypt, AES192_CTR>("AES-192", plaintext);
+	test_aes_benchmark_helper<AES256_Encrypt, AES256_Decrypt, AES256_CTR>("AES-256", plaintext);
+
+	test_aes_record_benchmark_helper<AES128_Encrypt, AES128_GCM>("AES-128", plaintext);
+	test_aes_record_benchmark_helper<AES256_Encrypt, AES256_GCM>("AES-256", plaintext);
+}
@@ -0,0 +1,207 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_aes_gcm()
+{
+	Console::write_line(" Header: aes128_gcm.h, aes192_gcm.h and aes256_gcm.h");
+	Console::write_line("  Class: AES128_GCM, AES192_GCM and AES256_GCM");
+
+	// Test data from "The Galois/Counter Mode of Operation (GCM)" by McGrew and Viega (Test Cases 1 to 5, 10 and 16), and a 60 byte IV variant of Test Case 6
+
+	const char *plaintext =
+		"d9313225f88406e5a55909c5aff5269a"
+		"86a7a9531534f7da2e4c303d8a318a72"
+		"1c3c0c95956809532fcf0e2449a6b525"
+		"b16aedf5aa0de657ba637b39";
+
+	const char *ciphertext =
+		"42831ec2217774244b7221b784d0d49c"
+		"e3aa212f2c02a4e035c17e2329aca12e"
+		"21d514b25466931c7d8f6a5aac84aa05"
+		"1ba30b396a0aac973d58e091";
+
+	const char *aad = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+
+	test_aes_gcm_helper<AES128_GCM>("00000000000000000000000000000000", "000000000000000000000000", "", "", "", "58e2fccefa7e3061367f1d57a4e7455a");
+	test_aes_gcm_helper<AES128_GCM>("00000000000000000000000000000000", "000000000000000000000000", "", "00000000000000000000000000000000", "0388dace60b6a392f328c2b971b2fe78", "ab6e47d42cec13bdf53a67b21257bddf");
+
+	test_aes_gcm_helper<AES128_GCM>(
+		"feffe9928665731c6d6a8f9467308308",	// KEY
+		"cafebabefacedbaddecaf888",	// IV
+		"",	// AAD
+		"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"	// PLAINTEXT
+		"1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+		"42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"	// CIPHERTEXT
+		"21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+		"4d5c2af327cd64a62cf35abd2ba6fab4"	// TAG
+		);
+
+	test_aes_gcm_helper<AES128_GCM>("feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", aad, plaintext, ciphertext, "5bc94fbc3221a5db94fae95ae7121a47");
+
+	// Initialisation vectors that are not 96 bits are hashed
+	test_aes_gcm_helper<AES128_GCM>(
+		"feffe9928665731c6d6a8f9467308308",
+		"cafebabefacedbad",
+		aad,
+		plaintext,
+		"61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c742373806900e49f24b22b097544d4896b424989b5e1ebac0f07c23f4598",
+		"3612d2e79e3b0785561be14aaca2fccb"
+		);
+
+	test_aes_gcm_helper<AES128_GCM>(
+		"feffe9928665731c6d6a8f9467308308",
+		"9313225df88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+		aad,
+		plaintext,
+		"2b4b26fb49f400296428f090cdb8671a60f2f674c7d2635c67c52763caccfb7afbde37c47ceaeaf102e38224d71d8e8c6a6ed055a28dcef35ee92cd9",
+		"9a58d4b7c0030413d4cc72a5b67c11df"
+		);
+
+	test_aes_gcm_helper<AES192_GCM>(
+		"feffe9928665731c6d6a8f9467308308feffe9928665731c",
+		"cafebabefacedbaddecaf888",
+		aad,
+		plaintext,
+		"3980ca0b3c00e841eb06fac4872a2757859e1ceaa6efd984628593b40ca1e19c7d773d00c144c525ac619d18c84a3f4718e2448b2fe324d9ccda2710",
+		"2519498e80f1478f37ba55bd6d27618c"
+		);
+
+	test_aes_gcm_helper<AES256_GCM>(
+		"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+		"cafebabefacedbaddecaf888",
+		aad,
+		plaintext,
+		"522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+		"76fc6ece0f4e1768cddf8853bb2d551b"
+		);
+
+	// Longer messages go through the bulk GHASH path. The tag was calculated with another implementation.
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> iv;
+	std::vector<unsigned char> expected_tag;
+	convert_ascii("feffe9928665731c6d6a8f9467308308", key);
+	convert_ascii("cafebabefacedbaddecaf888", iv);
+	convert_ascii("b67181e0b807618c8974b8287c4fff2e", expected_tag);
+
+	std::vector<unsigned char> long_plaintext(1000);
+	std::vector<unsigned char> long_aad(37);
+	for (size_t i = 0; i < long_plaintext.size(); i++)
+		long_plaintext[i] = (unsigned char)(i * 7 + 3);
+	for (size_t i = 0; i < long_aad.size(); i++)
+		long_aad[i] = (unsigned char)(i * 5 + 1);
+
+	AES128_GCM gcm;
+	gcm.set_key(&key[0]);
+	gcm.set_iv(&iv[0]);
+	gcm.add_aad(&long_aad[0], long_aad.size());
+	gcm.encrypt(&long_plaintext[0], long_plaintext.size());
+	gcm.calculate();
+	if (!gcm.verify_tag(&expected_tag[0]))
+		fail();
+	DataBuffer long_ciphertext(gcm.get_data().get_data(), gcm.get_data().get_size());	// Copy, as the next message reuses the databuffer
+
+	// The key is kept between messages, and the data may be fed in uneven pieces
+	for (int piece_size = 1; piece_size < 300; piece_size += 37)
+	{
+		gcm.set_iv(&iv[0]);
+		for (size_t pos = 0; pos < long_aad.size(); pos += piece_size)
+			gcm.add_aad(&long_aad[pos], min((int)(long_aad.size() - pos), piece_size));
+		for (size_t pos = 0; pos < long_plaintext.size(); pos += piece_size)
+			gcm.decrypt(long_ciphertext.get_data() + pos, min((int)(long_plaintext.size() - pos), piece_size));
+		gcm.calculate();
+		if (!gcm.verify_tag(&expected_tag[0]))
+			fail();
+		if (gcm.get_data().get_size() != long_plaintext.size() || memcmp(gcm.get_data().get_data(), &long_plaintext[0], long_plaintext.size()))
+			fail();
+	}
+
+	// A modified ciphertext must be rejected
+	long_ciphertext[500] ^= 1;
+	gcm.set_iv(&iv[0]);
+	gcm.add_aad(&long_aad[0], long_aad.size());
+	gcm.decrypt(long_ciphertext);
+	gcm.calculate();
+	if (gcm.verify_tag(&expected_tag[0]))
+		fail();
+}
+
+template<typename AES_GCM>
+void TestApp::test_aes_gcm_helper(const char *key_ptr, const char *iv_ptr, const char *aad_ptr, const char *plaintext_ptr, const char *ciphertext_ptr, const char *tag_ptr)
+{
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> iv;
+	std::vector<unsigned char> aad;
+	std::vector<unsigned char> plaintext;
+	std::vector<unsigned char> ciphertext;
+	std::vector<unsigned char> tag;
+
+	convert_ascii(key_ptr, key);
+	convert_ascii(iv_ptr, iv);
+	convert_ascii(aad_ptr, aad);
+	convert_ascii(plaintext_ptr, plaintext);
+	convert_ascii(ciphertext_ptr, ciphertext);
+	convert_ascii(tag_ptr, tag);
+
+	AES_GCM encrypt;
+	encrypt.set_key(&key[0]);
+	encrypt.set_iv(&iv[0], iv.size());
+	if (!aad.empty())
+		encrypt.add_aad(&aad[0], aad.size());
+	if (!plaintext.empty())
+		encrypt.encrypt(&plaintext[0], plaintext.size());
+	encrypt.calculate();
+	DataBuffer buffer = encrypt.get_data();
+	if (buffer.get_size() != ciphertext.size())
+		fail();
+	if (!ciphertext.empty() && memcmp(buffer.get_data(), &ciphertext[0], ciphertext.size()))
+		fail();
+
+	unsigned char calculated_tag[AES_GCM::tag_size];
+	encrypt.get_tag(calculated_tag);
+	if (memcmp(calculated_tag, &tag[0], AES_GCM::tag_size))
+		fail();
+
+	AES_GCM decrypt;
+	decrypt.set_key(&key[0]);
+	decrypt.set_iv(&iv[0], iv.size());
+	if (!aad.empty())
+		decrypt.add_aad(&aad[0], aad.size());
+	if (!ciphertext.empty())
+		decrypt.decrypt(&ciphertext[0], ciphertext.size());
+	decrypt.calculate();
+	if (!decrypt.verify_tag(&tag[0]))
+		fail();
+	DataBuffer buffer2 = decrypt.get_data();
+	if (buffer2.get_size() != plaintext.size())
+		fail();
+	if (!plaintext.empty() && memcmp(buffer2.get_data(), &plaintext[0], plaintext.size()))
+		fail();
+}
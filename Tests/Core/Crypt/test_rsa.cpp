@@ -118,6 +118,18 @@ void TestApp::test_rsa()
 	if (memcmp(server.m_CryptKey.get_data(), client.m_CryptKey.get_data(), server.m_CryptKey.get_size()))
 		fail();
 
-}
+	Console::write_line("   ... Decrypting with the Chinese Remainder Theorem");
 
+	Random random;
+	Secret private_exponent, prime1, prime2, exponent1, exponent2, coefficient;
+	DataBuffer public_exponent, modulus;
+	RSA::create_keypair(random, private_exponent, public_exponent, modulus, prime1, prime2, exponent1, exponent2, coefficient);
 
+	DataBuffer wrapped_key = RSA::encrypt(2, random, public_exponent, modulus, server.m_CryptKey);
+	Secret key = RSA::decrypt(private_exponent, modulus, wrapped_key);
+	Secret crt_key = RSA::decrypt(prime1, prime2, exponent1, exponent2, coefficient, wrapped_key);
+	if (key.get_size() != server.m_CryptKey.get_size() || crt_key.get_size() != key.get_size())
+		fail();
+	if (memcmp(key.get_data(), server.m_CryptKey.get_data(), key.get_size()) || memcmp(crt_key.get_data(), key.get_data(), key.get_size()))
+		fail();
+}
@@ -0,0 +1,96 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_rsa_benchmark_helper(int key_size_in_bits)
+{
+	Random random;
+	Secret private_exponent, prime1, prime2, exponent1, exponent2, coefficient;
+	DataBuffer public_exponent, modulus;
+
+	uint64_t start_time = System::get_microseconds();
+	RSA::create_keypair(random, private_exponent, public_exponent, modulus, prime1, prime2, exponent1, exponent2, coefficient, key_size_in_bits);
+	uint64_t create_time = System::get_microseconds() - start_time;
+
+	Secret plaintext(32);
+	random.get_random_bytes(plaintext.get_data(), plaintext.get_size());
+
+	// Repeat each operation until the measurement is long enough to be meaningful
+	DataBuffer ciphertext;
+	int encrypt_count = 0;
+	uint64_t encrypt_time = 0;
+	start_time = System::get_microseconds();
+	do
+	{
+		ciphertext = RSA::encrypt(2, random, public_exponent, modulus, plaintext);
+		encrypt_count++;
+		encrypt_time = System::get_microseconds() - start_time;
+	} while (encrypt_time < 200000);
+
+	Secret decrypted;
+	int decrypt_count = 0;
+	uint64_t decrypt_time = 0;
+	start_time = System::get_microseconds();
+	do
+	{
+		decrypted = RSA::decrypt(private_exponent, modulus, ciphertext);
+		decrypt_count++;
+		decrypt_time = System::get_microseconds() - start_time;
+	} while (decrypt_time < 200000);
+	if (decrypted.get_size() != plaintext.get_size() || memcmp(decrypted.get_data(), plaintext.get_data(), plaintext.get_size()))
+		fail();
+
+	int crt_decrypt_count = 0;
+	uint64_t crt_decrypt_time = 0;
+	start_time = System::get_microseconds();
+	do
+	{
+		decrypted = RSA::decrypt(prime1, prime2, exponent1, exponent2, coefficient, ciphertext);
+		crt_decrypt_count++;
+		crt_decrypt_time = System::get_microseconds() - start_time;
+	} while (crt_decrypt_time < 200000);
+	if (decrypted.get_size() != plaintext.get_size() || memcmp(decrypted.get_data(), plaintext.get_data(), plaintext.get_size()))
+		fail();
+
+	Console::write_line(string_format("   RSA-%1: create keypair %2 ms, encrypt %3/s, decrypt %4/s, decrypt with CRT %5/s",
+		key_size_in_bits,
+		(int)(create_time / 1000),
+		(int)(encrypt_count * 1000000.0 / encrypt_time),
+		(int)(decrypt_count * 1000000.0 / decrypt_time),
+		(int)(crt_decrypt_count * 1000000.0 / crt_decrypt_time)));
+}
+
+void TestApp::test_rsa_benchmark()
+{
+	Console::write_line(" Benchmark: RSA operations");
+
+	test_rsa_benchmark_helper(2048);
+	test_rsa_benchmark_helper(4096);
+}
@@ -0,0 +1,130 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+template<typename Hash>
+double TestApp::test_sha_benchmark_throughput(const std::vector<unsigned char> &data)
+{
+	int count = 0;
+	uint64_t time = 0;
+	uint64_t start_time = System::get_microseconds();
+	do
+	{
+		Hash hash;
+		hash.add(&data[0], data.size());
+		hash.calculate();
+		count++;
+		time = System::get_microseconds() - start_time;
+	} while (time < 200000);
+
+	return count * (double)data.size() / time;	// Bytes per microsecond is MB/s
+}
+
+void TestApp::test_sha_benchmark()
+{
+	Console::write_line(" Benchmark: SHA-1 and SHA-256");
+	Console::write_line(string_format("   SHA extensions: %1, AVX2: %2",
+		CPUFeatures::get().has(System::sha) ? "yes" : "no",
+		CPUFeatures::get().has(System::avx2) ? "yes" : "no"));
+
+	std::vector<unsigned char> data(1024 * 1024);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (unsigned char)(i * 7 + (i >> 9));
+
+	Console::write_line(string_format("   Single buffer: SHA-1 %1 MB/s, SHA-256 %2 MB/s",
+		(int)test_sha_benchmark_throughput<SHA1>(data),
+		(int)test_sha_benchmark_throughput<SHA256>(data)));
+
+	// Many small messages, as when verifying the files of an asset package
+	const int message_count = 1024;
+	const int message_size = 4096;
+	std::vector<unsigned char> messages(message_count * message_size);
+	std::vector<const void *> message_data(message_count);
+	std::vector<int> message_sizes(message_count);
+	for (int i = 0; i < message_count; i++)
+	{
+		for (int j = 0; j < message_size; j++)
+			messages[i * message_size + j] = (unsigned char)(i + j * 3);
+
+		// Vary the sizes a bit so the lanes do not all finish together
+		message_data[i] = &messages[i * message_size];
+		message_sizes[i] = message_size - (i % 5) * 100;
+	}
+
+	std::vector<unsigned char[20]> sha1_hashes(message_count);
+	std::vector<unsigned char[32]> sha256_hashes(message_count);
+
+	int sequential_count = 0;
+	uint64_t sequential_time = 0;
+	uint64_t start_time = System::get_microseconds();
+	do
+	{
+		for (int i = 0; i < message_count; i++)
+			HashFunctions::sha256(message_data[i], message_sizes[i], sha256_hashes[i]);
+		sequential_count++;
+		sequential_time = System::get_microseconds() - start_time;
+	} while (sequential_time < 200000);
+
+	int multi_buffer_count = 0;
+	uint64_t multi_buffer_time = 0;
+	start_time = System::get_microseconds();
+	do
+	{
+		HashFunctions::sha256_multi_buffer(&message_data[0], &message_sizes[0], message_count, &sha256_hashes[0]);
+		multi_buffer_count++;
+		multi_buffer_time = System::get_microseconds() - start_time;
+	} while (multi_buffer_time < 200000);
+
+	double total_size = 0.0;
+	for (int size : message_sizes)
+		total_size += size;
+
+	Console::write_line(string_format("   SHA-256 of %1 messages: one at a time %2 MB/s, multi buffer %3 MB/s",
+		message_count,
+		(int)(sequential_count * total_size / sequential_time),
+		(int)(multi_buffer_count * total_size / multi_buffer_time)));
+
+	HashFunctions::sha1_multi_buffer(&message_data[0], &message_sizes[0], message_count, &sha1_hashes[0]);
+	for (int i = 0; i < message_count; i++)
+	{
+		unsigned char sha1_hash[20];
+		unsigned char sha256_hash[32];
+		HashFunctions::sha1(message_data[i], message_sizes[i], sha1_hash);
+		HashFunctions::sha256(message_data[i], message_sizes[i], sha256_hash);
+		if (memcmp(sha1_hash, sha1_hashes[i], 20) || memcmp(sha256_hash, sha256_hashes[i], 32))
+			fail();
+	}
+
+	// Hashing a device must give the same result as hashing the data directly
+	DataBuffer buffer(&data[0], data.size());
+	MemoryDevice device(buffer);
+	if (HashFunctions::sha256(device) != HashFunctions::sha256(&data[0], data.size()))
+		fail();
+}
@@ -0,0 +1,201 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+namespace
+{
+	// Digests of the message made by fill_message() for each length, computed with Python's hashlib.
+	// The lengths cover the padding boundaries: 55 and 119 still fit the length field into the last block, 56 and 120 do not.
+	struct KnownDigest
+	{
+		int length;
+		const char *sha1;
+		const char *sha256;
+	};
+
+	const KnownDigest known_digests[] =
+	{
+		{ 0, "da39a3ee5e6b4b0d3255bfef95601890afd80709", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+		{ 1, "bf8b4530d8d246dd74ac53a13471bba17941dff7", "4bf5122f344554c53bde2ebb8cd2b7e3d1600ad631c385a5d7cce23c7785459a" },
+		{ 55, "63ac9708fb581dd150d3647549f9e0cb51dcf1df", "81afe5b788dc2ce138ff83d9b20164db75a94d75d2b2432eea4a0ef605088c72" },
+		{ 56, "5a0c4d0eb2f15e05bbbff6b8dada9ae767fc03f0", "2aba54f0ac632420a2b502431408866e40e1d5e430df4cd822642c78ab2eb9c1" },
+		{ 63, "d94ff3ad53f9b9327704b812ee9c1f3abbba3d48", "733d3d4ee79ee67145bf73da13588f6f235d37414fc64b14a2f00f1762792f5e" },
+		{ 64, "5f55a35e13f1865e7ffc22dca1275b1a49b0ff56", "79322907b3e9d013d7dc2c2f256674dbf733045cde01df3539271c6f5605feb8" },
+		{ 65, "d7f8931010f8342a97383e1410a58c47d057708b", "d85c007c6eb440f085afa2b84f6f2bce4658b240e9f62cb1364bf0485a57e720" },
+		{ 119, "774001b5ad1f46b40c48e1b94cb092c593ead25b", "6c87eedf096b345de205b702e5223b73b447a3207791ded3ea007ba15ed6736e" },
+		{ 120, "6ebf3111dc761f11b13f29df0484848785385973", "42500cf6a1e3936d6b9e0bcfe296d654b63255e525487d3634d0b15fde591c4d" },
+		{ 127, "82d007f6e7e5672722c0717b6bea2ba6f17cd35c", "68f6ff710276900c0ffbbc57426f67e00c2e01f0750c7edc25ac06b8ce7a8095" },
+		{ 128, "0a44ac02432f6ead67d86fcb70a4d8ce589e50ec", "489d55fea9a73af36b6dd0be7b4117d8e5683386d39544e8a44c99a87f368707" },
+		{ 129, "461b146c523c63566b8bf8852dc8462116cf2e3f", "4e1556b2e9a50a3cc9478f3254727b01065f9ac5d2c3a8b4cd538ae7240bb87d" },
+		{ 1000, "7461968a9edb9b418224f1acb305d2feeaa10ba5", "6b0df76627243d095b0c4400cb658b7e804dd03461cc03aee8fc8fe0bcada168" }
+	};
+
+	const int num_known_digests = sizeof(known_digests) / sizeof(known_digests[0]);
+
+	std::vector<unsigned char> fill_message(int length)
+	{
+		std::vector<unsigned char> message(length);
+		for (int i = 0; i < length; i++)
+			message[i] = (unsigned char)(i * 7 + length);
+		return message;
+	}
+
+	std::string to_hex(const unsigned char *hash, int size)
+	{
+		static const char digits[] = "0123456789abcdef";
+		std::string text;
+		for (int i = 0; i < size; i++)
+		{
+			text += digits[hash[i] >> 4];
+			text += digits[hash[i] & 15];
+		}
+		return text;
+	}
+}
+
+void TestApp::test_sha_multi_buffer()
+{
+	Console::write_line(" Header: hash_functions.h");
+	Console::write_line("  Class: HashFunctions");
+	Console::write_line("   Function: sha1_multi_buffer() and sha256_multi_buffer()");
+
+	// Run the same checks on every kernel by hiding the extensions of the faster ones
+	struct Kernel
+	{
+		const char *name;
+		bool supported;
+		unsigned long long disabled;
+	};
+	const CPUFeatures &cpu = CPUFeatures::get();
+	Kernel kernels[] =
+	{
+		{ "SHA extensions", cpu.has_all({ System::sha, System::sse4_1, System::ssse3 }), 0 },
+		{ "AVX2 multi buffer", cpu.has(System::avx2), CPUFeatures::mask(System::sha) },
+		{ "scalar", true, CPUFeatures::mask(System::sha) | CPUFeatures::mask(System::avx2) }
+	};
+
+	for (const Kernel &kernel : kernels)
+	{
+		if (!kernel.supported)
+		{
+			Console::write_line(string_format("    Kernel: %1 (not supported by this CPU, skipped)", kernel.name));
+			continue;
+		}
+		Console::write_line(string_format("    Kernel: %1", kernel.name));
+
+		CPUFeatures::set_disabled_extensions(kernel.disabled);
+		try
+		{
+			test_sha_multi_buffer_helper();
+		}
+		catch (...)
+		{
+			CPUFeatures::set_disabled_extensions(0);
+			throw;
+		}
+		CPUFeatures::set_disabled_extensions(0);
+	}
+}
+
+void TestApp::test_sha_multi_buffer_helper()
+{
+	std::vector<std::vector<unsigned char>> messages;
+	for (const KnownDigest &known : known_digests)
+		messages.push_back(fill_message(known.length));
+
+	// One message at a time, also split in two so the block buffering of add() is used
+	for (int i = 0; i < num_known_digests; i++)
+	{
+		const std::vector<unsigned char> &message = messages[i];
+		int length = known_digests[i].length;
+
+		if (HashFunctions::sha1(message.data(), length) != known_digests[i].sha1) fail();
+		if (HashFunctions::sha256(message.data(), length) != known_digests[i].sha256) fail();
+
+		SHA1 sha1;
+		sha1.add(message.data(), length / 3);
+		sha1.add(message.data() + length / 3, length - length / 3);
+		sha1.calculate();
+		if (sha1.get_hash() != known_digests[i].sha1) fail();
+
+		SHA256 sha256;
+		sha256.add(message.data(), length / 3);
+		sha256.add(message.data() + length / 3, length - length / 3);
+		sha256.calculate();
+		if (sha256.get_hash() != known_digests[i].sha256) fail();
+	}
+
+	// Batches of every size from empty up to past three full groups of eight lanes, each with mixed lengths
+	for (int count = 0; count <= 2 * num_known_digests; count++)
+	{
+		std::vector<const void *> data(count);
+		std::vector<int> sizes(count);
+		std::vector<int> expected(count);
+		for (int i = 0; i < count; i++)
+		{
+			expected[i] = (i * 5 + count) % num_known_digests;
+			data[i] = messages[expected[i]].data();
+			sizes[i] = known_digests[expected[i]].length;
+		}
+
+		std::vector<unsigned char> sha1_hashes(count * 20);
+		std::vector<unsigned char> sha256_hashes(count * 32);
+		HashFunctions::sha1_multi_buffer(data.data(), sizes.data(), count, (unsigned char (*)[20])sha1_hashes.data());
+		HashFunctions::sha256_multi_buffer(data.data(), sizes.data(), count, (unsigned char (*)[32])sha256_hashes.data());
+
+		for (int i = 0; i < count; i++)
+		{
+			if (to_hex(&sha1_hashes[i * 20], 20) != known_digests[expected[i]].sha1) fail();
+			if (to_hex(&sha256_hashes[i * 32], 32) != known_digests[expected[i]].sha256) fail();
+		}
+	}
+
+	// All lanes with the same length, so they finish in the same block
+	for (int i = 0; i < num_known_digests; i++)
+	{
+		const int count = 8;
+		std::vector<const void *> data(count, messages[i].data());
+		std::vector<int> sizes(count, known_digests[i].length);
+
+		unsigned char sha256_hashes[count][32];
+		HashFunctions::sha256_multi_buffer(data.data(), sizes.data(), count, sha256_hashes);
+		for (int j = 0; j < count; j++)
+		{
+			if (to_hex(sha256_hashes[j], 32) != known_digests[i].sha256) fail();
+		}
+
+		unsigned char sha1_hashes[count][20];
+		HashFunctions::sha1_multi_buffer(data.data(), sizes.data(), count, sha1_hashes);
+		for (int j = 0; j < count; j++)
+		{
+			if (to_hex(sha1_hashes[j], 20) != known_digests[i].sha1) fail();
+		}
+	}
+}
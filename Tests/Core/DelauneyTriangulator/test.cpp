@@ -0,0 +1,170 @@
+#include <ClanLib/core.h>
+#include <map>
+using namespace clan;
+
+static std::vector<Pointf> create_random_points(int count, unsigned int seed)
+{
+	std::vector<Pointf> points;
+	points.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		float x = ((seed >> 8) & 0xffff) / 65535.0f * 1000.0f;
+		seed = seed * 1103515245 + 12345;
+		float y = ((seed >> 8) & 0xffff) / 65535.0f * 1000.0f;
+		points.push_back(Pointf(x, y));
+	}
+	return points;
+}
+
+// Grid points are full of collinear and co-circular cases
+static std::vector<Pointf> create_grid_points(int count)
+{
+	std::vector<Pointf> points;
+	int side = (int)std::sqrt((float)count);
+	for (int y = 0; y < side; y++)
+	{
+		for (int x = 0; x < side; x++)
+			points.push_back(Pointf(x * 2.0f, y * 2.0f));
+	}
+	return points;
+}
+
+static double cross(const Pointf &o, const Pointf &a, const Pointf &b)
+{
+	return ((double)a.x - o.x) * ((double)b.y - o.y) - ((double)a.y - o.y) * ((double)b.x - o.x);
+}
+
+static double convex_hull_area(std::vector<Pointf> points)
+{
+	std::sort(points.begin(), points.end(), [](const Pointf &a, const Pointf &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	std::vector<Pointf> hull(points.size() * 2);
+	int k = 0;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0) k--;
+		hull[k++] = points[i];
+	}
+	for (int i = (int)points.size() - 2, t = k + 1; i >= 0; i--)
+	{
+		while (k >= t && cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0) k--;
+		hull[k++] = points[i];
+	}
+
+	double area = 0.0;
+	for (int i = 1; i + 1 < k - 1; i++)
+		area += cross(hull[0], hull[i], hull[i + 1]) * 0.5;
+	return area;
+}
+
+static int count_unique_points(std::vector<Pointf> points)
+{
+	std::sort(points.begin(), points.end(), [](const Pointf &a, const Pointf &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+	return std::unique(points.begin(), points.end()) - points.begin();
+}
+
+// Edges used by only one triangle lie on the convex hull
+static int count_boundary_edges(const std::vector<DelauneyTriangulator_Triangle> &triangles)
+{
+	std::map<std::pair<const void *, const void *>, int> edges;
+	for (auto &triangle : triangles)
+	{
+		const DelauneyTriangulator_Vertex *vertices[3] = { triangle.vertex_A, triangle.vertex_B, triangle.vertex_C };
+		for (int i = 0; i < 3; i++)
+		{
+			const void *a = vertices[i];
+			const void *b = vertices[(i + 1) % 3];
+			edges[a < b ? std::make_pair(a, b) : std::make_pair(b, a)]++;
+		}
+	}
+
+	int count = 0;
+	for (auto &edge : edges)
+	{
+		if (edge.second == 1)
+			count++;
+	}
+	return count;
+}
+
+// Brute force check that no point lies clearly inside the circumcircle of a triangle
+static bool is_delauney(const std::vector<DelauneyTriangulator_Triangle> &triangles, const std::vector<Pointf> &points)
+{
+	for (auto &triangle : triangles)
+	{
+		double ax = triangle.vertex_A->x, ay = triangle.vertex_A->y;
+		double bx = triangle.vertex_B->x, by = triangle.vertex_B->y;
+		double cx = triangle.vertex_C->x, cy = triangle.vertex_C->y;
+		double d = 2.0 * (ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
+		if (d == 0.0)
+			return false;
+		double ux = ((ax * ax + ay * ay) * (by - cy) + (bx * bx + by * by) * (cy - ay) + (cx * cx + cy * cy) * (ay - by)) / d;
+		double uy = ((ax * ax + ay * ay) * (cx - bx) + (bx * bx + by * by) * (ax - cx) + (cx * cx + cy * cy) * (bx - ax)) / d;
+		double radius2 = (ax - ux) * (ax - ux) + (ay - uy) * (ay - uy);
+		for (auto &point : points)
+		{
+			double dist2 = (point.x - ux) * (point.x - ux) + (point.y - uy) * (point.y - uy);
+			if (dist2 < radius2 * (1.0 - 1e-6))
+				return false;
+		}
+	}
+	return true;
+}
+
+static void benchmark(const char *name, const std::vector<Pointf> &points)
+{
+	DelauneyTriangulator triangulator;
+	for (auto &point : points)
+		triangulator.add_vertex(point.x, point.y, nullptr);
+
+	uint64_t start_time = System::get_microseconds();
+	triangulator.generate();
+	uint64_t generate_time = System::get_microseconds() - start_time;
+
+	const std::vector<DelauneyTriangulator_Triangle> &triangles = triangulator.get_triangles();
+
+	// A triangulation of n points with h of them on the convex hull has 2n - 2 - h triangles
+	int expected_triangles = 2 * count_unique_points(points) - 2 - count_boundary_edges(triangles);
+
+	double area = 0.0;
+	for (auto &triangle : triangles)
+	{
+		Pointf a(triangle.vertex_A->x, triangle.vertex_A->y), b(triangle.vertex_B->x, triangle.vertex_B->y), c(triangle.vertex_C->x, triangle.vertex_C->y);
+		area += std::abs(cross(a, b, c)) * 0.5;
+	}
+	double expected_area = convex_hull_area(points);
+
+	std::cout << name << " " << points.size() << " points: " << triangles.size() << " triangles in " << generate_time / 1000.0 << " ms";
+	if ((int)triangles.size() != expected_triangles)
+		std::cout << " (Did not expect: " << expected_triangles << " triangles)";
+	if (std::abs(area - expected_area) > expected_area * 1e-6)
+		std::cout << " (Did not expect: area " << area << " instead of " << expected_area << ")";
+	if (points.size() <= 2000 && !is_delauney(triangles, points))
+		std::cout << " (Did not expect: point inside a circumcircle)";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		int counts[] = { 1000, 10000, 50000, 200000 };
+
+		std::cout << "Triangulating random points:" << std::endl;
+		for (int count : counts)
+			benchmark("random", create_random_points(count, count));
+
+		std::cout << std::endl << "Triangulating grid points:" << std::endl;
+		for (int count : counts)
+			benchmark("grid", create_grid_points(count));
+	}
+	catch (Exception &exception)
+	{
+		std::cout << "Exception caught: " << exception.message.c_str() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include <ClanLib/core.h>
+using namespace clan;
+
+// Wavy circle with some noise on the radius, like a traced outline. Vertices are counter clockwise in a y-up system.
+static std::vector<Pointf> create_polygon(int count, float radius, Pointf center, unsigned int seed)
+{
+	std::vector<Pointf> points;
+	points.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		float noise = ((seed >> 16) & 0x7fff) / 32767.0f;
+		float angle = i * 2.0f * PI / count;
+		float r = radius * (0.8f + 0.1f * std::sin(angle * 7.0f) + 0.05f * std::sin(angle * 23.0f) + 0.02f * noise);
+		points.push_back(Pointf(center.x + r * std::cos(angle), center.y + r * std::sin(angle)));
+	}
+	return points;
+}
+
+static double polygon_area(const std::vector<Pointf> &points)
+{
+	double sum = 0.0;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		const Pointf &a = points[i];
+		const Pointf &b = points[(i + 1) % points.size()];
+		sum += (double)a.x * b.y - (double)b.x * a.y;
+	}
+	return std::abs(sum) * 0.5;
+}
+
+static double triangles_area(EarClipResult &result)
+{
+	double sum = 0.0;
+	for (auto &tri : result.get_triangles())
+		sum += std::abs(((double)tri.x2 - tri.x1) * ((double)tri.y3 - tri.y1) - ((double)tri.x3 - tri.x1) * ((double)tri.y2 - tri.y1)) * 0.5;
+	return sum;
+}
+
+static void benchmark(int count, int hole_count)
+{
+	std::vector<Pointf> outer = create_polygon(count, 1000.0f, Pointf(0.0f, 0.0f), count);
+
+	EarClipTriangulator triangulator;
+	triangulator.set_orientation(cl_clockwise);
+	for (auto &point : outer)
+		triangulator.add_vertex(point);
+
+	double expected_area = polygon_area(outer);
+	int hole_vertices = 0;
+	for (int i = 0; i < hole_count; i++)
+	{
+		// Holes are placed on a ring, walked in the opposite direction of the outer contour
+		float angle = i * 2.0f * PI / hole_count;
+		Pointf center(350.0f * std::cos(angle), 350.0f * std::sin(angle));
+		std::vector<Pointf> hole = create_polygon(count / (4 * hole_count), 150.0f / (hole_count > 4 ? hole_count / 4 : 1), center, i + 1);
+
+		triangulator.begin_hole();
+		for (auto it = hole.rbegin(); it != hole.rend(); ++it)
+			triangulator.add_vertex(*it);
+		triangulator.end_hole();
+
+		expected_area -= polygon_area(hole);
+		hole_vertices += hole.size();
+	}
+
+	uint64_t start_time = System::get_microseconds();
+	EarClipResult result = triangulator.triangulate();
+	uint64_t triangulate_time = System::get_microseconds() - start_time;
+
+	// Every hole adds a bridge of two vertices
+	int expected_triangles = count + hole_vertices + 2 * hole_count - 2;
+	int triangles = result.get_triangles().size();
+	double area = triangles_area(result);
+
+	std::cout << count + hole_vertices << " vertices, " << hole_count << " holes: " << triangles << " triangles in " << triangulate_time / 1000.0 << " ms";
+	if (triangles != expected_triangles)
+		std::cout << " (Did not expect: " << expected_triangles << " triangles)";
+	if (std::abs(area - expected_area) > expected_area * 0.001)
+		std::cout << " (Did not expect: area " << area << " instead of " << expected_area << ")";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		int counts[] = { 16, 1000, 10000, 100000 };
+
+		std::cout << "Triangulating polygons:" << std::endl;
+		for (int count : counts)
+			benchmark(count, 0);
+
+		std::cout << std::endl << "Triangulating polygons with holes:" << std::endl;
+		benchmark(1000, 1);
+		benchmark(10000, 4);
+		benchmark(100000, 16);
+	}
+	catch (Exception &exception)
+	{
+		std::cout << "Exception caught: " << exception.message.c_str() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
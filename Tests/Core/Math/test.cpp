@@ -71,6 +71,8 @@ int TestApp::main()
 		test_line_segment3();
 		test_triangle();
 		test_rect();
+		test_batch_math();
+		test_half_float();
 	
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
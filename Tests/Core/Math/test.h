@@ -93,6 +93,10 @@ private:
 	void test_matrix_mat4();
 	void test_rect();
 	void test_bigint();
+	void test_batch_math();
+	void test_batch_math_kernel(size_t count);
+	void test_half_float();
+	void test_half_float_kernel(bool quiets_nans);
 	void test_rotate_and_get_euler(clan::EulerOrder order);
 	void fail();
 	void test_quaternion_euler(clan::EulerOrder order);
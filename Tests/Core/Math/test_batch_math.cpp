@@ -0,0 +1,228 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+static float random_float(unsigned int &seed, float min_value, float max_value)
+{
+	seed = seed * 1103515245 + 12345;
+	return min_value + ((seed >> 8) & 0xffff) / 65535.0f * (max_value - min_value);
+}
+
+void TestApp::test_batch_math_kernel(size_t count)
+{
+	unsigned int seed = 1;
+
+	Mat4f matrix = Mat4f::perspective(60.0f, 1.5f, 0.1f, 100.0f, Handedness::left, ClipZRange::negative_positive_w) * Mat4f::look_at(5.0f, 3.0f, -10.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	FrustumPlanes frustum(matrix);
+
+	Vec3fSoA points;
+	AxisAlignedBoundingBoxSoA boxes;
+	SphereSoA spheres;
+	for (size_t i = 0; i < count; i++)
+	{
+		Vec3f point(random_float(seed, -50.0f, 50.0f), random_float(seed, -50.0f, 50.0f), random_float(seed, -50.0f, 50.0f));
+		Vec3f size(random_float(seed, 0.0f, 5.0f), random_float(seed, 0.0f, 5.0f), random_float(seed, 0.0f, 5.0f));
+		points.push_back(point);
+		boxes.push_back(AxisAlignedBoundingBox(point, point + size));
+		spheres.push_back(point, size.x);
+	}
+
+	// transform_points()
+	{
+		Vec4fSoA result4;
+		BatchMath::transform_points(matrix, points, result4);
+		if (result4.size() != count) fail();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (result4.get(i) != matrix * Vec4f(points.get(i), 1.0f)) fail();
+		}
+
+		Vec3fSoA result3;
+		BatchMath::transform_points(matrix, points, result3);
+		if (result3.size() != count) fail();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (result3.get(i) != matrix.get_transformed_point(points.get(i))) fail();
+		}
+	}
+
+	// frustum_aabbs()
+	{
+		std::vector<uint32_t> visible;
+		BatchMath::frustum_aabbs(frustum, boxes, visible);
+		if (visible.size() != (count + 31) / 32) fail();
+		size_t visible_count = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			bool expected = IntersectionTest::frustum_aabb(frustum, boxes.get(i)) != IntersectionTest::outside;
+			if (BatchMath::is_set(visible, i) != expected) fail();
+			if (expected) visible_count++;
+		}
+		if (count > 100 && (visible_count == 0 || visible_count == count)) fail();
+	}
+
+	// frustum_spheres()
+	{
+		std::vector<uint32_t> visible;
+		BatchMath::frustum_spheres(frustum, spheres, visible);
+		size_t visible_count = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			Vec3f center = spheres.center.get(i);
+			float radius = spheres.radius[i];
+			bool expected = true;
+			for (const Vec4f &plane : frustum.planes)
+			{
+				float distance = (Vec3f::dot(Vec3f(plane), center) + plane.w) / Vec3f(plane).length();
+				if (distance < -radius - 0.001f)
+					expected = false;
+				else if (distance < -radius + 0.001f)
+					expected = BatchMath::is_set(visible, i);	// Too close to call with float precision
+			}
+			if (BatchMath::is_set(visible, i) != expected) fail();
+			if (expected) visible_count++;
+		}
+		if (count > 100 && (visible_count == 0 || visible_count == count)) fail();
+	}
+
+	// sphere_spheres()
+	{
+		std::vector<uint32_t> overlapping;
+		Vec3f center(3.0f, -4.0f, 5.0f);
+		BatchMath::sphere_spheres(center, 20.0f, spheres, overlapping);
+		for (size_t i = 0; i < count; i++)
+		{
+			bool expected = IntersectionTest::sphere(center, 20.0f, spheres.center.get(i), spheres.radius[i]) == IntersectionTest::overlap;
+			if (BatchMath::is_set(overlapping, i) != expected) fail();
+		}
+	}
+}
+
+void TestApp::test_batch_math(void)
+{
+	Console::write_line(" Header: batch_math.h");
+	Console::write_line("  Class: BatchMath");
+
+	// Run the same checks on every kernel by hiding the extensions of the faster ones.
+	// The odd counts make sure the scalar tail after the vector loops is tested as well.
+	struct Kernel
+	{
+		const char *name;
+		bool supported;
+		unsigned long long disabled;
+	};
+	const CPUFeatures &cpu = CPUFeatures::get();
+	Kernel kernels[] =
+	{
+		{ "AVX", cpu.has(System::avx), 0 },
+		{ "SSE2", cpu.has(System::sse2), CPUFeatures::mask(System::avx) },
+		{ "scalar", true, CPUFeatures::mask(System::avx) | CPUFeatures::mask(System::sse2) }
+	};
+	const size_t counts[] = { 0, 1, 3, 4, 7, 8, 9, 15, 17, 1003 };
+
+	for (const Kernel &kernel : kernels)
+	{
+		if (!kernel.supported)
+		{
+			Console::write_line(string_format("   Kernel: %1 (not supported by this CPU, skipped)", kernel.name));
+			continue;
+		}
+		Console::write_line(string_format("   Kernel: %1", kernel.name));
+
+		CPUFeatures::set_disabled_extensions(kernel.disabled);
+		try
+		{
+			for (size_t count : counts)
+				test_batch_math_kernel(count);
+		}
+		catch (...)
+		{
+			CPUFeatures::set_disabled_extensions(0);
+			throw;
+		}
+		CPUFeatures::set_disabled_extensions(0);
+	}
+
+	unsigned int seed = 1;
+	Mat4f matrix = Mat4f::perspective(60.0f, 1.5f, 0.1f, 100.0f, Handedness::left, ClipZRange::negative_positive_w) * Mat4f::look_at(5.0f, 3.0f, -10.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	FrustumPlanes frustum(matrix);
+
+	Console::write_line("   Benchmark: 100000 objects, batch vs one at a time");
+	{
+		const size_t bench_count = 100000;
+		const int iterations = 20;
+
+		Vec3fSoA bench_points;
+		AxisAlignedBoundingBoxSoA bench_boxes;
+		std::vector<Vec3f> aos_points;
+		std::vector<AxisAlignedBoundingBox> aos_boxes;
+		for (size_t i = 0; i < bench_count; i++)
+		{
+			Vec3f point(random_float(seed, -50.0f, 50.0f), random_float(seed, -50.0f, 50.0f), random_float(seed, -50.0f, 50.0f));
+			bench_points.push_back(point);
+			aos_points.push_back(point);
+			bench_boxes.push_back(AxisAlignedBoundingBox(point, point + Vec3f(1.0f)));
+			aos_boxes.push_back(AxisAlignedBoundingBox(point, point + Vec3f(1.0f)));
+		}
+
+		Vec4fSoA transformed;
+		std::vector<Vec4f> aos_transformed(bench_count);
+		std::vector<uint32_t> visible;
+		std::vector<bool> aos_visible(bench_count);
+
+		uint64_t start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+			BatchMath::transform_points(matrix, bench_points, transformed);
+		uint64_t batch_transform_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+		{
+			for (size_t i = 0; i < bench_count; i++)
+				aos_transformed[i] = matrix * Vec4f(aos_points[i], 1.0f);
+		}
+		uint64_t single_transform_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+			BatchMath::frustum_aabbs(frustum, bench_boxes, visible);
+		uint64_t batch_cull_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+		{
+			for (size_t i = 0; i < bench_count; i++)
+				aos_visible[i] = IntersectionTest::frustum_aabb(frustum, aos_boxes[i]) != IntersectionTest::outside;
+		}
+		uint64_t single_cull_time = System::get_microseconds() - start_time;
+
+		Console::write_line(string_format("    transform_points: %1 ms, one at a time: %2 ms", batch_transform_time / 1000.0 / iterations, single_transform_time / 1000.0 / iterations));
+		Console::write_line(string_format("    frustum_aabbs: %1 ms, one at a time: %2 ms", batch_cull_time / 1000.0 / iterations, single_cull_time / 1000.0 / iterations));
+	}
+}
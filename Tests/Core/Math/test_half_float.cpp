@@ -0,0 +1,250 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <cstring>
+#include <cmath>
+
+static unsigned int float_bits(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float bits_float(unsigned int bits)
+{
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// Straightforward decoding of a half, to check the tables and the kernels against
+static unsigned int reference_half_to_float_bits(unsigned short h)
+{
+	unsigned int sign = (h & 0x8000) << 16;
+	unsigned int exponent = (h >> 10) & 0x1f;
+	unsigned int mantissa = h & 0x3ff;
+	if (exponent == 0x1f)
+		return sign | 0x7f800000 | (mantissa << 13);
+	float value = exponent == 0 ? std::ldexp((float)mantissa, -24) : std::ldexp((float)(mantissa | 0x400), (int)exponent - 25);
+	return sign | float_bits(value);
+}
+
+void TestApp::test_half_float_kernel(bool quiets_nans)
+{
+	// F16C converts signaling NaNs to quiet NaNs. Everything else must match the tables bit for bit.
+	const unsigned int float_quiet_bit = quiets_nans ? 0x00400000 : 0;
+	const unsigned short half_quiet_bit = quiets_nans ? 0x0200 : 0;
+
+	// Every half value, plus a few more so the scalar tail is used
+	{
+		std::vector<unsigned short> input(65536 + 3);
+		for (size_t i = 0; i < input.size(); i++)
+			input[i] = (unsigned short)i;
+
+		std::vector<float> output(input.size());
+		HalfFloat::half_to_float(input.data(), output.data(), input.size());
+		for (size_t i = 0; i < input.size(); i++)
+		{
+			unsigned int expected = reference_half_to_float_bits(input[i]);
+			if (float_bits(HalfFloat::half_to_float(input[i])) != expected) fail();
+
+			bool is_nan = (input[i] & 0x7c00) == 0x7c00 && (input[i] & 0x3ff) != 0;
+			if (is_nan)
+				expected |= float_quiet_bit;
+			if (float_bits(output[i]) != expected) fail();
+		}
+
+		// All halfs except NaNs survive the round trip
+		std::vector<unsigned short> round_trip(input.size());
+		HalfFloat::float_to_half(output.data(), round_trip.data(), output.size());
+		for (size_t i = 0; i < input.size(); i++)
+		{
+			bool is_nan = (input[i] & 0x7c00) == 0x7c00 && (input[i] & 0x3ff) != 0;
+			if (!is_nan && round_trip[i] != input[i]) fail();
+		}
+	}
+
+	// Edge cases with known results. Rounding is towards zero, also for ties.
+	{
+		struct Case
+		{
+			unsigned int float_value;
+			unsigned short half_value;
+		};
+		const Case cases[] =
+		{
+			{ 0x00000000, 0x0000 }, { 0x80000000, 0x8000 },	// Zero
+			{ 0x3f800000, 0x3c00 }, { 0xbf800000, 0xbc00 },	// One
+			{ 0x3f801000, 0x3c00 }, { 0xbf801000, 0xbc00 },	// Tie between 1 and the next half
+			{ 0x3f803000, 0x3c01 }, { 0x3f802fff, 0x3c01 },	// Tie between the next two halfs, and just below it
+			{ 0x477fe000, 0x7bff }, { 0x477fefff, 0x7bff },	// 65504, the largest half, and just below the tie with 65536
+			{ 0x477ff000, 0x7bff }, { 0xc77ff000, 0xfbff },	// 65520, the tie itself
+			{ 0x477fffff, 0x7bff },								// Largest float below 65536
+			{ 0x47800000, 0x7c00 }, { 0xc7800000, 0xfc00 },	// 65536 overflows to infinity
+			{ 0x7f7fffff, 0x7c00 }, { 0xff7fffff, 0xfc00 },	// Largest float
+			{ 0x7f800000, 0x7c00 }, { 0xff800000, 0xfc00 },	// Infinity
+			{ 0x38800000, 0x0400 }, { 0x387fffff, 0x03ff },	// Smallest normal half, and just below it
+			{ 0x33800000, 0x0001 }, { 0xb3800000, 0x8001 },	// Smallest denormal half
+			{ 0x33000000, 0x0000 }, { 0xb3000000, 0x8000 },	// Tie between zero and the smallest denormal
+			{ 0x33c00000, 0x0001 },								// Tie between the two smallest denormals
+			{ 0x00000001, 0x0000 }, { 0x807fffff, 0x8000 },	// Float denormals
+			{ 0x7fc00000, 0x7e00 }, { 0xffc00000, 0xfe00 },	// Quiet NaN
+			{ 0x7fc02000, 0x7e01 }, { 0x7fffe000, 0x7fff },	// Quiet NaN payloads
+			{ 0x7fa00000, 0x7d00 | half_quiet_bit },			// Signaling NaN payload
+			{ 0x7f802000, 0x7c01 | half_quiet_bit }
+		};
+		const size_t num_cases = sizeof(cases) / sizeof(cases[0]);
+
+		// Repeat the cases eight times so every case is converted by the kernel, in every lane
+		std::vector<float> input;
+		for (int repeat = 0; repeat < 8; repeat++)
+		{
+			for (const Case &c : cases)
+				input.push_back(bits_float(c.float_value));
+		}
+
+		std::vector<unsigned short> output(input.size());
+		HalfFloat::float_to_half(input.data(), output.data(), input.size());
+		for (size_t i = 0; i < input.size(); i++)
+		{
+			if (output[i] != cases[i % num_cases].half_value) fail();
+		}
+	}
+
+	// Sample the whole range of float bit patterns
+	{
+		std::vector<float> input;
+		for (uint64_t bits = 0; bits <= 0xffffffffULL; bits += 4093)
+			input.push_back(bits_float((unsigned int)bits));
+
+		std::vector<unsigned short> output(input.size());
+		HalfFloat::float_to_half(input.data(), output.data(), input.size());
+		for (size_t i = 0; i < input.size(); i++)
+		{
+			unsigned short expected = HalfFloat::float_to_half(input[i]);
+			if (input[i] != input[i])
+			{
+				// Signaling NaNs with only low payload bits come out of the tables as infinity
+				expected |= half_quiet_bit;
+			}
+			if (output[i] != expected) fail();
+		}
+	}
+}
+
+void TestApp::test_half_float(void)
+{
+	Console::write_line(" Header: half_float.h");
+	Console::write_line("  Class: HalfFloat");
+
+	if (HalfFloat(-1.0f).to_float() != -1.0f) fail();
+	if (HalfFloat(-0.5f).to_float() != -0.5f) fail();
+
+	Console::write_line("   Function: half_to_float(const unsigned short *, float *, size_t)");
+	Console::write_line("   Function: float_to_half(const float *, unsigned short *, size_t)");
+
+	// Run the checks on every kernel by hiding the extensions of the faster ones
+	struct Kernel
+	{
+		const char *name;
+		bool supported;
+		unsigned long long disabled;
+		bool quiets_nans;
+	};
+	const CPUFeatures &cpu = CPUFeatures::get();
+	Kernel kernels[] =
+	{
+		{ "F16C", cpu.has(System::f16c), 0, true },
+		{ "SSE2", cpu.has(System::sse2), CPUFeatures::mask(System::f16c), false },
+		{ "scalar", true, CPUFeatures::mask(System::f16c) | CPUFeatures::mask(System::sse2), false }
+	};
+
+	for (const Kernel &kernel : kernels)
+	{
+		if (!kernel.supported)
+		{
+			Console::write_line(string_format("    Kernel: %1 (not supported by this CPU, skipped)", kernel.name));
+			continue;
+		}
+		Console::write_line(string_format("    Kernel: %1", kernel.name));
+
+		CPUFeatures::set_disabled_extensions(kernel.disabled);
+		try
+		{
+			test_half_float_kernel(kernel.quiets_nans);
+		}
+		catch (...)
+		{
+			CPUFeatures::set_disabled_extensions(0);
+			throw;
+		}
+		CPUFeatures::set_disabled_extensions(0);
+	}
+
+	Console::write_line("   Benchmark: 1000000 values, array vs one at a time");
+	{
+		const size_t bench_count = 1000000;
+		const int iterations = 10;
+
+		std::vector<float> floats(bench_count);
+		std::vector<unsigned short> halfs(bench_count);
+		for (size_t i = 0; i < bench_count; i++)
+			floats[i] = (float)i / bench_count * 100.0f - 50.0f;
+
+		uint64_t start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+			HalfFloat::float_to_half(floats.data(), halfs.data(), bench_count);
+		uint64_t array_to_half_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+		{
+			for (size_t i = 0; i < bench_count; i++)
+				halfs[i] = HalfFloat::float_to_half(floats[i]);
+		}
+		uint64_t single_to_half_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+			HalfFloat::half_to_float(halfs.data(), floats.data(), bench_count);
+		uint64_t array_to_float_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int j = 0; j < iterations; j++)
+		{
+			for (size_t i = 0; i < bench_count; i++)
+				floats[i] = HalfFloat::half_to_float(halfs[i]);
+		}
+		uint64_t single_to_float_time = System::get_microseconds() - start_time;
+
+		Console::write_line(string_format("    float_to_half: %1 ms, one at a time: %2 ms", array_to_half_time / 1000.0 / iterations, single_to_half_time / 1000.0 / iterations));
+		Console::write_line(string_format("    half_to_float: %1 ms, one at a time: %2 ms", array_to_float_time / 1000.0 / iterations, single_to_float_time / 1000.0 / iterations));
+	}
+}
@@ -1,6 +1,109 @@
 #include <ClanLib/core.h>
 using namespace clan;
 
+static std::vector<Size> create_mixed_sizes(int count)
+{
+	// Mostly glyph sized rects with the occasional sprite, from a fixed seed so every method packs the same input
+	std::vector<Size> sizes;
+	unsigned int seed = 12345;
+	for (int i = 0; i < count; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		unsigned int value = (seed >> 8);
+		if (value % 10 == 0)
+			sizes.push_back(Size(32 + value % 97, 32 + (value / 97) % 97));
+		else
+			sizes.push_back(Size(6 + value % 19, 14 + (value / 19) % 9));
+	}
+	return sizes;
+}
+
+static bool has_overlaps(const std::vector<RectPacker::AllocatedRect> &allocations)
+{
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		for (size_t j = i + 1; j < allocations.size(); j++)
+		{
+			if (allocations[i].group_index == allocations[j].group_index && allocations[i].rect.is_overlapped(allocations[j].rect))
+				return true;
+		}
+	}
+	return false;
+}
+
+static void benchmark_method(RectPacker::PackingMethod method, const char *name, const std::vector<Size> &sizes)
+{
+	const Size group_size(512, 512);
+	RectPacker packer(group_size, RectPacker::search_previous_groups, method);
+
+	std::vector<RectPacker::AllocatedRect> allocations;
+	allocations.reserve(sizes.size());
+
+	uint64_t start_time = System::get_microseconds();
+	for (const auto &size : sizes)
+		allocations.push_back(packer.add(size));
+	uint64_t add_time = System::get_microseconds() - start_time;
+
+	// The last group is only partly filled, so leave it out of the occupancy
+	int full_groups = std::max(packer.get_group_count() - 1, 1);
+	int64_t used_area = 0;
+	for (int i = 0; i < full_groups; i++)
+		used_area += packer.get_used_area(i);
+	double occupancy = used_area * 100.0 / (full_groups * (int64_t)group_size.width * group_size.height);
+
+	std::cout << name << ": " << packer.get_group_count() << " groups, " << occupancy << "% occupancy, ";
+	std::cout << (int)(sizes.size() * 1000000.0 / std::max(add_time, (uint64_t)1)) << " adds/s";
+	if (has_overlaps(allocations))
+		std::cout << " (Did not expect: overlapping rects)";
+	std::cout << std::endl;
+
+	// Free every other rect and refill, as a glyph atlas does when evicting
+	int group_count = packer.get_group_count();
+	for (size_t i = 0; i < allocations.size(); i += 2)
+		packer.remove(allocations[i]);
+
+	start_time = System::get_microseconds();
+	for (size_t i = 0; i < allocations.size(); i += 2)
+		allocations[i] = packer.add(sizes[i]);
+	uint64_t readd_time = System::get_microseconds() - start_time;
+
+	std::cout << name << ": remove and re-add " << (packer.get_group_count() - group_count) << " extra groups, ";
+	std::cout << (int)(sizes.size() / 2 * 1000000.0 / std::max(readd_time, (uint64_t)1)) << " adds/s";
+	if (has_overlaps(allocations))
+		std::cout << " (Did not expect: overlapping rects)";
+	std::cout << std::endl;
+}
+
+static void benchmark_add_all(RectPacker::PackingMethod method, const char *name, const std::vector<Size> &sizes)
+{
+	const Size group_size(512, 512);
+	RectPacker packer(group_size, RectPacker::search_previous_groups, method);
+
+	uint64_t start_time = System::get_microseconds();
+	std::vector<RectPacker::AllocatedRect> allocations = packer.add_all(sizes);
+	uint64_t add_time = System::get_microseconds() - start_time;
+
+	int full_groups = std::max(packer.get_group_count() - 1, 1);
+	int64_t used_area = 0;
+	for (int i = 0; i < full_groups; i++)
+		used_area += packer.get_used_area(i);
+	double occupancy = used_area * 100.0 / (full_groups * (int64_t)group_size.width * group_size.height);
+
+	std::cout << name << " add_all: " << packer.get_group_count() << " groups, " << occupancy << "% occupancy, ";
+	std::cout << (int)(sizes.size() * 1000000.0 / std::max(add_time, (uint64_t)1)) << " adds/s";
+	if (has_overlaps(allocations))
+		std::cout << " (Did not expect: overlapping rects)";
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		if (allocations[i].rect.get_size() != sizes[i])
+		{
+			std::cout << " (Did not expect: rects out of order)";
+			break;
+		}
+	}
+	std::cout << std::endl;
+}
+
 int main(int argc, char** argv)
 {
 	try
@@ -95,6 +198,71 @@ int main(int argc, char** argv)
 	{
 		std::cout << "Expected: " << e.message.c_str() << std::endl;		
 	}
+
+	for (int add_all = 0; add_all < 2; add_all++)
+	{
+		RectPacker packer(Size(100,100), RectPacker::create_new_group);
+		try
+		{
+			std::cout << "Testing failing " << (add_all ? "add_all" : "add") << " because of empty size:" << std::endl;
+
+			if (add_all)
+				packer.add_all({ Size(50,50), Size(0,0) });
+			else
+				packer.add(Size(0,0));
+
+			std::cout << "Did not expect: Allocation OK" << std::endl;
+		}
+		catch (Exception &e)
+		{
+			std::cout << "Expected: " << e.message.c_str() << std::endl;
+		}
+
+		if (packer.get_group_count() != 0)
+			std::cout << "Did not expect: Group created for an empty size" << std::endl;
+	}
+
+	const RectPacker::PackingMethod methods[] = { RectPacker::guillotine, RectPacker::skyline_bottom_left, RectPacker::max_rects };
+	const char *method_names[] = { "guillotine", "skyline_bottom_left", "max_rects" };
+
+	for (int i = 0; i < 3; i++)
+	{
+		try
+		{
+			std::cout << std::endl << "Testing remove with " << method_names[i] << ":" << std::endl;
+
+			RectPacker packer(Size(100,100), RectPacker::fail_if_full, methods[i]);
+			RectPacker::AllocatedRect allocation1 = packer.add(Size(50,50));
+			RectPacker::AllocatedRect allocation2 = packer.add(Size(50,50));
+			RectPacker::AllocatedRect allocation3 = packer.add(Size(50,50));
+			RectPacker::AllocatedRect allocation4 = packer.add(Size(50,50));
+			packer.remove(allocation2);
+			RectPacker::AllocatedRect allocation5 = packer.add(Size(50,50));
+
+			std::cout << "Expected: Allocation OK" << std::endl;
+			std::cout << "allocation2: Id: " << allocation2.group_index << " Pos: " << allocation2.rect.left << ", " << allocation2.rect.top << std::endl;
+			std::cout << "allocation5: Id: " << allocation5.group_index << " Pos: " << allocation5.rect.left << ", " << allocation5.rect.top << std::endl;
+			std::cout << "rect count: " << packer.get_total_rect_count() << std::endl;
+
+			packer.remove(allocation2);
+			packer.remove(allocation2);
+			std::cout << "Did not expect: Double remove OK" << std::endl;
+		}
+		catch (Exception &e)
+		{
+			std::cout << "Expected: " << e.message.c_str() << std::endl;
+		}
+	}
+
+	std::cout << std::endl << "Packing 5000 mixed glyph and sprite sizes into 512x512 groups:" << std::endl;
+	std::vector<Size> sizes = create_mixed_sizes(5000);
+	for (int i = 0; i < 3; i++)
+		benchmark_method(methods[i], method_names[i], sizes);
+
+	std::cout << std::endl << "Packing the same sizes with add_all:" << std::endl;
+	for (int i = 0; i < 3; i++)
+		benchmark_add_all(methods[i], method_names[i], sizes);
+
 	return 0;
 }
 
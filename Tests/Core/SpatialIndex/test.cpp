@@ -0,0 +1,254 @@
+#include <ClanLib/core.h>
+#include <algorithm>
+using namespace clan;
+
+static unsigned int seed = 12345;
+
+static float random_float(float min_value, float max_value)
+{
+	seed = seed * 1103515245 + 12345;
+	return min_value + ((seed >> 8) & 0xffff) / 65535.0f * (max_value - min_value);
+}
+
+static AxisAlignedBoundingBox random_box(float world_size)
+{
+	Vec3f center(random_float(0.0f, world_size), random_float(0.0f, world_size), random_float(0.0f, world_size));
+	Vec3f extents(random_float(0.1f, 2.0f), random_float(0.1f, 2.0f), random_float(0.1f, 2.0f));
+	return AxisAlignedBoundingBox(center - extents, center + extents);
+}
+
+static Rectf random_rect(float world_size)
+{
+	Pointf center(random_float(-10.0f, world_size + 10.0f), random_float(-10.0f, world_size + 10.0f));
+	Sizef size(random_float(0.1f, 8.0f), random_float(0.1f, 8.0f));
+	return Rectf(center.x - size.width * 0.5f, center.y - size.height * 0.5f, center.x + size.width * 0.5f, center.y + size.height * 0.5f);
+}
+
+static bool same_objects(std::vector<int> a, std::vector<int> b)
+{
+	std::sort(a.begin(), a.end());
+	std::sort(b.begin(), b.end());
+	return a == b;
+}
+
+// Separating axis test: the segment misses the rectangle if their bounding boxes are disjoint or all corners are on one side of the line
+static bool segment_rect(const Pointf &start, const Pointf &end, const Rectf &rect)
+{
+	if (std::max(start.x, end.x) < rect.left || std::min(start.x, end.x) > rect.right || std::max(start.y, end.y) < rect.top || std::min(start.y, end.y) > rect.bottom)
+		return false;
+
+	Pointf corners[4] = { rect.get_top_left(), rect.get_top_right(), rect.get_bottom_right(), rect.get_bottom_left() };
+	int positive = 0, negative = 0;
+	for (auto &corner : corners)
+	{
+		float side = (end.x - start.x) * (corner.y - start.y) - (end.y - start.y) * (corner.x - start.x);
+		if (side > 0.0f) positive++;
+		if (side < 0.0f) negative++;
+	}
+	return positive != 4 && negative != 4;
+}
+
+static void test_aabb_tree(int count)
+{
+	const float world_size = 200.0f;
+	AxisAlignedBoundingBoxTree tree(0.5f);
+	std::vector<int> proxies;
+	std::vector<AxisAlignedBoundingBox> boxes;
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < count; i++)
+	{
+		boxes.push_back(random_box(world_size));
+		proxies.push_back(tree.insert(boxes.back()));
+	}
+	uint64_t insert_time = System::get_microseconds() - start_time;
+
+	// Move everything a bit and remove every tenth object
+	start_time = System::get_microseconds();
+	for (int i = 0; i < count; i++)
+	{
+		Vec3f displacement(random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f));
+		boxes[i] = AxisAlignedBoundingBox(boxes[i].aabb_min + displacement, boxes[i].aabb_max + displacement);
+		tree.move(proxies[i], boxes[i], displacement);
+	}
+	uint64_t move_time = System::get_microseconds() - start_time;
+
+	for (int i = count - 1; i >= 0; i -= 10)
+	{
+		tree.remove(proxies[i]);
+		proxies.erase(proxies.begin() + i);
+		boxes.erase(boxes.begin() + i);
+	}
+
+	Mat4f projection = Mat4f::perspective(60.0f, 1.5f, 1.0f, 100.0f, Handedness::right, ClipZRange::negative_positive_w);
+	Mat4f view = Mat4f::look_at(100.0f, 100.0f, -10.0f, 100.0f, 100.0f, 100.0f, 0.0f, 1.0f, 0.0f);
+	FrustumPlanes frustum(projection * view);
+	AxisAlignedBoundingBox query_box(Vec3f(80.0f), Vec3f(90.0f));
+	Vec3f point = boxes[0].center();
+	Vec3f ray_start(0.0f, 100.0f, 100.0f), ray_end(200.0f, 110.0f, 105.0f);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			start_time = System::get_microseconds();
+			tree.rebuild();
+			std::cout << "  Rebuild: " << (System::get_microseconds() - start_time) / 1000.0 << " ms" << std::endl;
+		}
+
+		std::vector<int> expected_frustum, expected_box, expected_point, expected_ray;
+		start_time = System::get_microseconds();
+		for (int i = 0; i < 10; i++)
+		{
+			expected_frustum.clear();
+			for (size_t j = 0; j < boxes.size(); j++)
+			{
+				if (IntersectionTest::frustum_aabb(frustum, boxes[j]) != IntersectionTest::outside)
+					expected_frustum.push_back(proxies[j]);
+			}
+		}
+		uint64_t brute_force_time = (System::get_microseconds() - start_time) / 10;
+
+		for (size_t i = 0; i < boxes.size(); i++)
+		{
+			if (IntersectionTest::aabb(query_box, boxes[i]) == IntersectionTest::overlap)
+				expected_box.push_back(proxies[i]);
+			if (point.x >= boxes[i].aabb_min.x && point.y >= boxes[i].aabb_min.y && point.z >= boxes[i].aabb_min.z &&
+				point.x <= boxes[i].aabb_max.x && point.y <= boxes[i].aabb_max.y && point.z <= boxes[i].aabb_max.z)
+				expected_point.push_back(proxies[i]);
+			if (IntersectionTest::ray_aabb(ray_start, ray_end, boxes[i]) == IntersectionTest::overlap)
+				expected_ray.push_back(proxies[i]);
+		}
+
+		std::vector<int> result;
+		start_time = System::get_microseconds();
+		for (int i = 0; i < 10; i++)
+			tree.query(frustum, result);
+		uint64_t frustum_time = (System::get_microseconds() - start_time) / 10;
+		if (!same_objects(result, expected_frustum))
+			throw Exception("Frustum query did not match brute force");
+
+		start_time = System::get_microseconds();
+		tree.query_ray(ray_start, ray_end, result);
+		uint64_t ray_time = System::get_microseconds() - start_time;
+		if (!same_objects(result, expected_ray))
+			throw Exception("Ray query did not match brute force");
+
+		tree.query(query_box, result);
+		if (!same_objects(result, expected_box))
+			throw Exception("Box query did not match brute force");
+
+		tree.query(point, result);
+		if (!same_objects(result, expected_point))
+			throw Exception("Point query did not match brute force");
+
+		if (pass == 0)
+		{
+			std::cout << "AxisAlignedBoundingBoxTree, " << count << " boxes:" << std::endl;
+			std::cout << "  Insert: " << insert_time / 1000.0 << " ms, move: " << move_time / 1000.0 << " ms" << std::endl;
+		}
+		std::cout << "  Height " << tree.get_height() << ", frustum query: " << expected_frustum.size() << " visible in " << frustum_time / 1000.0 << " ms (brute force " << brute_force_time / 1000.0 << " ms)";
+		std::cout << ", ray query: " << expected_ray.size() << " hit in " << ray_time / 1000.0 << " ms" << std::endl;
+	}
+
+	for (int proxy : proxies)
+		tree.remove(proxy);
+	if (tree.get_proxy_count() != 0 || tree.get_height() != 0)
+		throw Exception("Tree not empty after removing all boxes");
+}
+
+static void test_loose_quadtree(int count)
+{
+	const float world_size = 1000.0f;
+	LooseQuadtree tree(Rectf(0.0f, 0.0f, world_size, world_size));
+	std::vector<int> proxies;
+	std::vector<Rectf> rects;
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < count; i++)
+	{
+		rects.push_back(random_rect(world_size));
+		proxies.push_back(tree.insert(rects.back()));
+	}
+	uint64_t insert_time = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < count; i++)
+	{
+		rects[i].translate(random_float(-5.0f, 5.0f), random_float(-5.0f, 5.0f));
+		tree.move(proxies[i], rects[i]);
+	}
+	uint64_t move_time = System::get_microseconds() - start_time;
+
+	for (int i = count - 1; i >= 0; i -= 10)
+	{
+		tree.remove(proxies[i]);
+		proxies.erase(proxies.begin() + i);
+		rects.erase(rects.begin() + i);
+	}
+
+	Rectf query_rect(100.0f, 100.0f, 300.0f, 200.0f);
+	Pointf point(rects[0].left + 0.01f, rects[0].top + 0.01f);
+	Pointf ray_start(-20.0f, 300.0f), ray_end(1020.0f, 420.0f);
+
+	std::vector<int> expected_rect, expected_point, expected_ray;
+	start_time = System::get_microseconds();
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		if (rects[i].is_overlapped(query_rect))
+			expected_rect.push_back(proxies[i]);
+	}
+	uint64_t brute_force_time = System::get_microseconds() - start_time;
+
+	for (size_t i = 0; i < rects.size(); i++)
+	{
+		if (rects[i].contains(point))
+			expected_point.push_back(proxies[i]);
+		if (segment_rect(ray_start, ray_end, rects[i]))
+			expected_ray.push_back(proxies[i]);
+	}
+
+	std::vector<int> result;
+	start_time = System::get_microseconds();
+	tree.query(query_rect, result);
+	uint64_t rect_time = System::get_microseconds() - start_time;
+	if (!same_objects(result, expected_rect))
+		throw Exception("Rect query did not match brute force");
+
+	tree.query(point, result);
+	if (!same_objects(result, expected_point))
+		throw Exception("Point query did not match brute force");
+
+	tree.query_ray(ray_start, ray_end, result);
+	if (!same_objects(result, expected_ray))
+		throw Exception("Ray query did not match brute force");
+
+	std::cout << "LooseQuadtree, " << count << " rects:" << std::endl;
+	std::cout << "  Insert: " << insert_time / 1000.0 << " ms, move: " << move_time / 1000.0 << " ms" << std::endl;
+	std::cout << "  Rect query: " << expected_rect.size() << " found in " << rect_time / 1000.0 << " ms (brute force " << brute_force_time / 1000.0 << " ms)";
+	std::cout << ", ray query: " << result.size() << " hit" << std::endl;
+
+	for (int proxy : proxies)
+		tree.remove(proxy);
+	if (tree.get_proxy_count() != 0)
+		throw Exception("Quadtree not empty after removing all rects");
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		int counts[] = { 1000, 10000, 100000 };
+		for (int count : counts)
+			test_aabb_tree(count);
+		for (int count : counts)
+			test_loose_quadtree(count);
+	}
+	catch (Exception &exception)
+	{
+		std::cout << "Exception caught: " << exception.message.c_str() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
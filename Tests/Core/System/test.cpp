@@ -55,6 +55,7 @@ int TestApp::main()
 		Console::write_line("Directory: API/Core/System");
 
 		test_datetime();
+		test_cpu_features();
 		
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
@@ -72,6 +72,7 @@ public:
 	int main();
 private:
 	void test_datetime();
+	void test_cpu_features();
 
 	std::string convert_time(DateTime &datetime);
 	void fail(void);
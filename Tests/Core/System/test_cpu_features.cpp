@@ -0,0 +1,104 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+static int dispatch_fallback() { return 0; }
+static int dispatch_sse2() { return 1; }
+static int dispatch_impossible() { return 2; }
+
+void TestApp::test_cpu_features()
+{
+	Console::write_line(" Header: cpu_features.h");
+	Console::write_line("  Class: CPUFeatures");
+
+	const CPUFeatures &cpu = CPUFeatures::get();
+
+	Console::write_line("   Function: get()");
+	if (&cpu != &CPUFeatures::get()) fail();
+
+	Console::write_line("   Function: has()");
+	for (int ext = System::mmx; ext <= System::osxsave; ext++)
+	{
+		if (cpu.has((System::CPU_ExtensionX86)ext) != System::detect_cpu_extension((System::CPU_ExtensionX86)ext)) fail();
+	}
+
+	// Extensions that imply others
+	if (cpu.has(System::avx2) && !cpu.has(System::avx)) fail();
+	if (cpu.has(System::avx) && !cpu.has(System::osxsave)) fail();
+	if (cpu.has(System::avx512bw) && !cpu.has(System::avx512f)) fail();
+	if (cpu.has(System::sse4_2) && !cpu.has(System::sse2)) fail();
+
+	Console::write_line("   Function: has_all()");
+	if (!cpu.has_all({})) fail();
+	if (cpu.has_all({ System::sse2, System::avx }) != (cpu.has(System::sse2) && cpu.has(System::avx))) fail();
+
+	std::string supported;
+	const char *names[] = { "mmx", "mmx_ex", "3dnow", "3dnow_ex", "sse", "sse2", "sse3", "ssse3", "sse4a", "sse4.1", "sse4.2", "xop", "avx", "aes", "fma3", "fma4", "f16c", "avx2", "avx512f", "avx512bw", "pclmul", "sha", "bmi1", "bmi2", "popcnt", "osxsave" };
+	for (int ext = System::mmx; ext <= System::osxsave; ext++)
+	{
+		if (cpu.has((System::CPU_ExtensionX86)ext))
+			supported += std::string(" ") + names[ext];
+	}
+	Console::write_line("    Supported:" + supported);
+
+	Console::write_line("  Class: CPUDispatch");
+	{
+		CPUDispatch<int(*)()> none({}, dispatch_fallback);
+		if (none() != 0) fail();
+
+		CPUDispatch<int(*)()> dispatch({ { System::sse2, dispatch_sse2 } }, dispatch_fallback);
+		if (dispatch() != (cpu.has(System::sse2) ? 1 : 0)) fail();
+
+		// A variant is only picked if all its extensions are supported
+		if (!cpu.has_all({ System::mmx_ex, System::avx512bw }))
+		{
+			CPUDispatch<int(*)()> impossible({ { { System::mmx_ex, System::avx512bw }, dispatch_impossible } }, dispatch_fallback);
+			if (impossible.get() != dispatch_fallback) fail();
+		}
+	}
+
+	Console::write_line("   Function: set_disabled_extensions()");
+	{
+		unsigned long long detected = cpu.get_extensions();
+		CPUDispatch<int(*)()> dispatch({ { System::sse2, dispatch_sse2 } }, dispatch_fallback);
+
+		unsigned int generation = CPUFeatures::get_generation();
+		CPUFeatures::set_disabled_extensions(CPUFeatures::mask(System::sse2));
+		if (CPUFeatures::get_generation() == generation) fail();
+		if (cpu.has(System::sse2)) fail();
+		if (cpu.get_extensions() != (detected & ~CPUFeatures::mask(System::sse2))) fail();
+		if (dispatch() != 0) fail();
+
+		// Clearing the mask reports exactly the detected extensions again
+		CPUFeatures::set_disabled_extensions(0);
+		if (cpu.get_extensions() != detected) fail();
+		if (dispatch() != (cpu.has(System::sse2) ? 1 : 0)) fail();
+	}
+}
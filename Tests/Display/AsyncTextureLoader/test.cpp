@@ -0,0 +1,150 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	clan::OpenGLTarget::set_current();
+
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: API/Display/Render (AsyncTextureLoader)");
+
+		DisplayWindow window("AsyncTextureLoader", 320, 240, false, false);
+		GraphicContext gc = window.get_gc();
+
+		// The odd heights leave a short last slice, and the small budgets use more slices than there are transfer textures
+		test_streaming(gc, 300, 257, 16 * 1024);
+		test_streaming(gc, 64, 1, 16 * 1024);
+		test_streaming(gc, 33, 100, 1);
+		test_streaming(gc, 128, 128, 4 * 1024 * 1024);
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+// Streams an image through the loader one frame at a time, then reads the texture back
+void TestApp::test_streaming(GraphicContext &gc, int width, int height, int upload_budget)
+{
+	Console::write_line(string_format("   Streaming %1x%2 with a budget of %3 bytes per frame", width, height, upload_budget));
+
+	PixelBuffer image(width, height, TextureFormat::rgba8);
+	for (int y = 0; y < height; y++)
+	{
+		uint32_t *line = image.get_line_uint32(y);
+		for (int x = 0; x < width; x++)
+			line[x] = (x * 7 + y * 13) | (y << 8) | ((x ^ y) << 16) | 0xff000000;
+	}
+
+	const std::string filename = "AsyncTextureLoader.png";
+	PNGProvider::save(image, filename);
+
+	AsyncTextureLoader loader(gc, upload_budget);
+
+	bool failed = false;
+	Slot slot_failed = loader.sig_load_failed().connect([&](const std::string &, const std::string &) { failed = true; });
+
+	Resource<Texture> resource = loader.load(filename);
+	if (resource.get() != loader.get_placeholder())
+		fail();
+
+	int frames = 0;
+	uint64_t start_time = System::get_microseconds();
+	while (loader.get_pending_count() > 0)
+	{
+		loader.update(gc);
+		gc.flush();
+		frames++;
+
+		if (System::get_microseconds() - start_time > 10000000)
+			fail();
+		System::sleep(1);
+	}
+	FileHelp::delete_file(filename);
+
+	if (failed)
+		fail();
+
+	// Each frame uploads at most one slice of the budget, so a small budget must take several frames
+	int64_t image_bytes = (int64_t)width * height * 4;
+	int min_frames = (int)std::min((int64_t)height, (image_bytes + std::max(upload_budget, 1) - 1) / std::max(upload_budget, 1));
+	if (frames < min_frames)
+		fail();
+	Console::write_line(string_format("    Uploaded in %1 frames", frames));
+
+	Texture2D texture = resource.get().to_texture_2d();
+	if (texture.is_null() || texture.get_width() != width || texture.get_height() != height)
+		fail();
+
+	// Compare with the source image and with a texture uploaded directly, without transfer textures
+	PixelBuffer streamed = texture.get_pixeldata(gc, TextureFormat::rgba8);
+	PixelBuffer direct = Texture2D(gc, image).get_pixeldata(gc, TextureFormat::rgba8);
+	for (int y = 0; y < height; y++)
+	{
+		if (memcmp(streamed.get_line(y), image.get_line(y), width * 4) != 0)
+			fail();
+		if (memcmp(streamed.get_line(y), direct.get_line(y), width * 4) != 0)
+			fail();
+	}
+
+	// A missing file must report a failure and keep the placeholder
+	Resource<Texture> missing = loader.load("AsyncTextureLoader_missing.png");
+	loader.finish(gc);
+	if (!failed)
+		fail();
+	if (missing.get() != loader.get_placeholder())
+		fail();
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
@@ -0,0 +1,178 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	clan::OpenGLTarget::set_current();
+
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: Display/Font (GlyphCache lookup)");
+
+		DisplayWindow window("GlyphCache benchmark", 1024, 768, false, false);
+		Canvas canvas(window);
+		Font font("Sans", 12);
+
+		// 5000 distinct glyphs from the CJK unified ideographs block
+		const int num_glyphs = 5000;
+		std::string text;
+		for (int i = 0; i < num_glyphs; i++)
+			text += StringHelp::unicode_to_utf8(0x4e00 + i);
+
+		std::string ascii_text;
+		for (int i = 0; i < num_glyphs; i++)
+			ascii_text += (char)(' ' + i % 95);
+
+		double first_draw = measure_draw(canvas, font, text, 1);
+		Console::write_line("First draw of %1 glyphs (rasterizing): %2 ms", num_glyphs, StringHelp::double_to_text(first_draw, 2));
+
+		const int iterations = 20;
+		double cjk_draw = measure_draw(canvas, font, text, iterations);
+		double cjk_measure = measure_measure(canvas, font, text, iterations);
+		double ascii_draw = measure_draw(canvas, font, ascii_text, iterations);
+		double ascii_measure = measure_measure(canvas, font, ascii_text, iterations);
+
+		Console::write_line("draw_text, %1 distinct CJK glyphs:    %2 ms", num_glyphs, StringHelp::double_to_text(cjk_draw, 3));
+		Console::write_line("measure_text, %1 distinct CJK glyphs: %2 ms", num_glyphs, StringHelp::double_to_text(cjk_measure, 3));
+		Console::write_line("draw_text, %1 ASCII characters:       %2 ms", num_glyphs, StringHelp::double_to_text(ascii_draw, 3));
+		Console::write_line("measure_text, %1 ASCII characters:    %2 ms", num_glyphs, StringHelp::double_to_text(ascii_measure, 3));
+		write_statistics(font.get_glyph_atlas_statistics());
+
+		// Text views measure and hit test the same string several times per frame
+		uint64_t layout_start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+			font.get_character_indices(canvas, ascii_text);
+		double cached_indices = (System::get_microseconds() - layout_start) / 1000.0 / iterations;
+
+		FontFamily uncached_family("Sans");
+		uncached_family.set_text_layout_cache_budget(0);
+		Font uncached_font(uncached_family, 12);
+		double uncached_measure = measure_measure(canvas, uncached_font, ascii_text, iterations);
+		layout_start = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+			uncached_font.get_character_indices(canvas, ascii_text);
+		double uncached_indices = (System::get_microseconds() - layout_start) / 1000.0 / iterations;
+
+		Console::write_line("get_character_indices, %1 ASCII characters: %2 ms (%3 ms without layout cache)", num_glyphs, StringHelp::double_to_text(cached_indices, 3), StringHelp::double_to_text(uncached_indices, 3));
+		Console::write_line("measure_text without layout cache:         %1 ms", StringHelp::double_to_text(uncached_measure, 3));
+
+		// Same text with the atlas limited to four 256x256 pages
+		FontFamily budget_family("Sans");
+		budget_family.set_glyph_atlas_budget(4 * 256 * 256 * 4);
+		Font budget_font(budget_family, 12);
+		double budget_draw = measure_draw(canvas, budget_font, text, iterations);
+		Console::write_line("draw_text, %1 CJK glyphs, 1 MB atlas:  %2 ms", num_glyphs, StringHelp::double_to_text(budget_draw, 3));
+		write_statistics(budget_font.get_glyph_atlas_statistics());
+
+		// Rasterize the glyphs on worker threads before the first draw
+		FontFamily prewarm_family("Sans");
+		prewarm_family.set_background_rasterization();
+		Font prewarm_font(prewarm_family, 13);
+		uint64_t prewarm_start = System::get_microseconds();
+		prewarm_font.prewarm(canvas, text);
+		double prewarm_time = (System::get_microseconds() - prewarm_start) / 1000.0;
+		System::sleep(2000);
+		double prewarmed_first_draw = measure_draw(canvas, prewarm_font, text, 1);
+		Console::write_line("prewarm() call: %1 ms, first draw after prewarm: %2 ms", StringHelp::double_to_text(prewarm_time, 2), StringHelp::double_to_text(prewarmed_first_draw, 2));
+
+		// Rasterize into a glyph disk cache, then load a new font family from it as the next run would
+		std::string disk_cache_dir = PathHelp::combine(System::get_exe_path(), "glyph_cache");
+		{
+			FontFamily disk_family("Sans");
+			disk_family.set_glyph_disk_cache(disk_cache_dir);
+			Font disk_font(disk_family, 15);
+			double disk_first_draw = measure_draw(canvas, disk_font, text, 1);
+			disk_family.save_glyph_disk_cache();
+			Console::write_line("First draw, filling the glyph disk cache: %1 ms", StringHelp::double_to_text(disk_first_draw, 2));
+		}
+		{
+			FontFamily disk_family("Sans");
+			disk_family.set_glyph_disk_cache(disk_cache_dir);
+			Font disk_font(disk_family, 15);
+			double disk_loaded_draw = measure_draw(canvas, disk_font, text, 1);
+			Console::write_line("First draw, loading from the glyph disk cache: %1 ms", StringHelp::double_to_text(disk_loaded_draw, 2));
+		}
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+// Returns the average time in milliseconds to draw the text
+double TestApp::measure_draw(Canvas &canvas, Font &font, const std::string &text, int iterations)
+{
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+	{
+		canvas.clear();
+		font.draw_text(canvas, 0.0f, 20.0f, text);
+		canvas.flush();
+	}
+	canvas.get_gc().flush();
+	uint64_t end_time = System::get_microseconds();
+	return (end_time - start_time) / 1000.0 / iterations;
+}
+
+void TestApp::write_statistics(const GlyphAtlasStatistics &stats)
+{
+	Console::write_line("  Hit rate: %1%%, glyphs: %2, pages: %3, bytes: %4, occupancy: %5%%, evicted pages: %6, compactions: %7",
+		StringHelp::double_to_text(stats.get_hit_rate() * 100.0, 1), stats.glyph_count, stats.page_count, (int)stats.bytes,
+		StringHelp::double_to_text(stats.occupancy * 100.0, 1), stats.evicted_pages, stats.compactions);
+}
+
+// Returns the average time in milliseconds to measure the text
+double TestApp::measure_measure(Canvas &canvas, Font &font, const std::string &text, int iterations)
+{
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+		font.measure_text(canvas, text);
+	uint64_t end_time = System::get_microseconds();
+	return (end_time - start_time) / 1000.0 / iterations;
+}
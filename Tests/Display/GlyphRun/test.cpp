@@ -0,0 +1,162 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+// This is the Program class that is called by Application
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	clan::OpenGLTarget::set_current();
+
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: Display/Font (GlyphRun)");
+
+		DisplayWindow window("GlyphRun benchmark", 1024, 768, false, false);
+		Canvas canvas(window);
+		Font font("Sans", 12);
+
+		// A HUD full of short, unchanging labels
+		const int num_labels = 2000;
+		std::vector<std::string> labels;
+		std::vector<GlyphRun> runs;
+		for (int i = 0; i < num_labels; i++)
+		{
+			labels.push_back(string_format("Label %1: health %2/100", i, i % 100));
+			runs.push_back(GlyphRun(font, labels.back()));
+		}
+
+		// Resolve the glyphs once, so neither loop measures rasterization
+		labels_per_second_glyph_run(canvas, runs, 1);
+
+		const int frames = 50;
+		double draw_text_rate = labels_per_second_draw_text(canvas, font, labels, frames);
+		double glyph_run_rate = labels_per_second_glyph_run(canvas, runs, frames);
+
+		Console::write_line("Font::draw_text: %1 labels/second", (int)draw_text_rate);
+		Console::write_line("GlyphRun::draw:  %1 labels/second (%2x)", (int)glyph_run_rate, StringHelp::double_to_text(glyph_run_rate / draw_text_rate, 2));
+
+		// Changing the font must resolve the runs again, drawing the same pixels as a freshly built run
+		PixelBuffer image_12 = render_run(canvas, runs[0]);
+		font.set_height(14);
+		PixelBuffer image_14 = render_run(canvas, runs[0]);
+		GlyphRun fresh_run(font, labels[0]);
+		if (!is_same_image(image_14, render_run(canvas, fresh_run)))
+			fail();
+		if (is_same_image(image_14, image_12))
+			fail();
+
+		font.set_weight(FontWeight::bold);
+		PixelBuffer image_bold = render_run(canvas, runs[0]);
+		GlyphRun fresh_bold_run(font, labels[0]);
+		if (!is_same_image(image_bold, render_run(canvas, fresh_bold_run)))
+			fail();
+		font.set_weight(FontWeight::normal);
+
+		labels_per_second_glyph_run(canvas, runs, 1);
+		Console::write_line("Resolved again after changing the font height: %1 labels/second", (int)labels_per_second_glyph_run(canvas, runs, frames));
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+double TestApp::labels_per_second_draw_text(Canvas &canvas, Font &font, const std::vector<std::string> &labels, int frames)
+{
+	uint64_t start_time = System::get_microseconds();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		canvas.clear();
+		for (size_t i = 0; i < labels.size(); i++)
+			font.draw_text(canvas, (float)(i % 5) * 200.0f, 14.0f + (float)(i / 5 % 50) * 15.0f, labels[i]);
+		canvas.flush();
+	}
+	canvas.get_gc().flush();
+	uint64_t end_time = System::get_microseconds();
+	return labels.size() * frames / ((end_time - start_time) / 1000000.0);
+}
+
+double TestApp::labels_per_second_glyph_run(Canvas &canvas, std::vector<GlyphRun> &runs, int frames)
+{
+	uint64_t start_time = System::get_microseconds();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		canvas.clear();
+		for (size_t i = 0; i < runs.size(); i++)
+			runs[i].draw(canvas, (float)(i % 5) * 200.0f, 14.0f + (float)(i / 5 % 50) * 15.0f);
+		canvas.flush();
+	}
+	canvas.get_gc().flush();
+	uint64_t end_time = System::get_microseconds();
+	return runs.size() * frames / ((end_time - start_time) / 1000000.0);
+}
+
+PixelBuffer TestApp::render_run(Canvas &canvas, GlyphRun &run)
+{
+	canvas.clear();
+	run.draw(canvas, 10.0f, 40.0f);
+	canvas.flush();
+	return canvas.get_pixeldata(Rect(0, 0, 400, 60));
+}
+
+bool TestApp::is_same_image(const PixelBuffer &a, const PixelBuffer &b)
+{
+	if (a.get_size() != b.get_size())
+		return false;
+	for (int y = 0; y < a.get_height(); y++)
+	{
+		if (memcmp(a.get_line(y), b.get_line(y), a.get_width() * 4) != 0)
+			return false;
+	}
+	return true;
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
@@ -0,0 +1,307 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+#define cl_s_curve(t) ( t * t * t * ( t * ( t * 6.0f - 15.0f ) + 10.0f ) )
+#define cl_floor_to_int(value) ( ((value)>0.0f) ? ((int)value) : ((int)value-1 ) )
+#define cl_lerp(t, a, b) ((a) + (t)*((b)-(a)))
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: Display/Image (PerlinNoise)");
+
+		unsigned char table[256];
+		for (int i = 0; i < 256; i++)
+			table[i] = (i * 167 + 13) & 0xff;
+
+		const int size = 2048;
+		const int octaves = 4;
+
+		PerlinNoise noise;
+		noise.set_permutations(table);
+		noise.set_size(size, size);
+		noise.set_format(TextureFormat::r32f);
+		noise.set_octaves(octaves);
+
+		ReferenceNoise reference(table);
+
+		uint64_t start_time = System::get_microseconds();
+		std::vector<float> reference_2d = reference.create_noise2d(size, size, octaves, -3.5f, 60.0f, 0.0f, 60.0f);
+		uint64_t reference_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		PixelBuffer noise_2d = noise.create_noise2d(-3.5f, 60.0f, 0.0f, 60.0f);
+		uint64_t noise_time = System::get_microseconds() - start_time;
+
+		Console::write_line("%1x%2 2D noise, %3 octaves:", size, size, octaves);
+		Console::write_line("   Scalar reference: %1 ms", (int)(reference_time / 1000));
+		Console::write_line("   PerlinNoise:      %1 ms (%2x)", (int)(noise_time / 1000), StringHelp::double_to_text(reference_time / (double)noise_time, 2));
+		if (!compare(noise_2d, reference_2d))
+			throw Exception("2D noise does not match the scalar reference");
+
+		start_time = System::get_microseconds();
+		std::vector<float> reference_3d = reference.create_noise3d(size, size, octaves, 0.0f, 32.0f, -8.25f, 32.0f, 3.7f);
+		reference_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		PixelBuffer noise_3d = noise.create_noise3d(0.0f, 32.0f, -8.25f, 32.0f, 3.7f);
+		noise_time = System::get_microseconds() - start_time;
+
+		Console::write_line("%1x%2 3D noise, %3 octaves:", size, size, octaves);
+		Console::write_line("   Scalar reference: %1 ms", (int)(reference_time / 1000));
+		Console::write_line("   PerlinNoise:      %1 ms (%2x)", (int)(noise_time / 1000), StringHelp::double_to_text(reference_time / (double)noise_time, 2));
+		if (!compare(noise_3d, reference_3d))
+			throw Exception("3D noise does not match the scalar reference");
+
+		start_time = System::get_microseconds();
+		PixelBuffer simplex_2d = noise.create_simplex_noise2d(-3.5f, 60.0f, 0.0f, 60.0f);
+		noise_time = System::get_microseconds() - start_time;
+		Console::write_line("%1x%2 2D simplex noise, %3 octaves: %4 ms", size, size, octaves, (int)(noise_time / 1000));
+
+		start_time = System::get_microseconds();
+		PixelBuffer simplex_3d = noise.create_simplex_noise3d(0.0f, 32.0f, -8.25f, 32.0f, 3.7f);
+		noise_time = System::get_microseconds() - start_time;
+		Console::write_line("%1x%2 3D simplex noise, %3 octaves: %4 ms", size, size, octaves, (int)(noise_time / 1000));
+
+		// Simplex noise is scaled to the same range as perlin noise
+		const float *values = simplex_2d.get_data<float>();
+		float min_value = 0.0f, max_value = 0.0f;
+		for (int i = 0; i < size * size; i++)
+		{
+			min_value = std::min(min_value, values[i]);
+			max_value = std::max(max_value, values[i]);
+		}
+		Console::write_line("2D simplex noise range: %1 to %2", StringHelp::float_to_text(min_value, 3), StringHelp::float_to_text(max_value, 3));
+		if (min_value < -2.0f || max_value > 2.0f || max_value - min_value < 0.5f)
+			throw Exception("2D simplex noise is out of range");
+
+		Console::write_line("All Tests Complete");
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		return -1;
+	}
+
+	return 0;
+}
+
+bool TestApp::compare(const PixelBuffer &pixels, const std::vector<float> &reference)
+{
+	for (int y = 0; y < pixels.get_height(); y++)
+	{
+		const float *line = (const float *)pixels.get_line(y);
+		for (int x = 0; x < pixels.get_width(); x++)
+		{
+			if (line[x] != reference[y * pixels.get_width() + x])
+			{
+				Console::write_line("Mismatch at %1,%2: %3 versus %4", x, y, StringHelp::float_to_text(line[x], 6), StringHelp::float_to_text(reference[y * pixels.get_width() + x], 6));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+ReferenceNoise::ReferenceNoise(const unsigned char *table)
+{
+	memcpy(permutation_table, table, 256);
+	memcpy(permutation_table + 256, table, 256);
+}
+
+std::vector<float> ReferenceNoise::create_noise2d(int width, int height, int octaves, float start_x, float end_x, float start_y, float end_y)
+{
+	std::vector<float> result_values;
+	result_values.reserve(width * height);
+
+	float size_x = end_x - start_x;
+	float size_y = end_y - start_y;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			float result = 0.0f;
+			float current_amplitude = 1.0f;
+			float value_x = start_x + (((float)x) * size_x) / (float)width;
+			float value_y = start_y + (((float)y) * size_y) / (float)height;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result += current_amplitude * noise_2d(value_x, value_y);
+				value_x *= 2.0f;
+				value_y *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			result_values.push_back(result);
+		}
+	}
+	return result_values;
+}
+
+std::vector<float> ReferenceNoise::create_noise3d(int width, int height, int octaves, float start_x, float end_x, float start_y, float end_y, float z_position)
+{
+	std::vector<float> result_values;
+	result_values.reserve(width * height);
+
+	float size_x = end_x - start_x;
+	float size_y = end_y - start_y;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			float result = 0.0f;
+			float current_amplitude = 1.0f;
+			float value_x = start_x + (((float)x) * size_x) / (float)width;
+			float value_y = start_y + (((float)y) * size_y) / (float)height;
+			float value_z = z_position;
+
+			for (int i = 0; i < octaves; i++)
+			{
+				result += current_amplitude * noise_3d(value_x, value_y, value_z);
+				value_x *= 2.0f;
+				value_y *= 2.0f;
+				value_z *= 2.0f;
+				current_amplitude *= 0.5f;
+			}
+
+			result_values.push_back(result);
+		}
+	}
+	return result_values;
+}
+
+float ReferenceNoise::gradient_2d(int permutation_value, float x, float y)
+{
+	float u = (permutation_value & 4) ? y : x;
+	float v = (permutation_value & 4) ? x : y;
+	if (permutation_value & 1)
+		u = -u;
+	if (permutation_value & 2)
+		v = -v;
+	return u + (2.0f * v);
+}
+
+float ReferenceNoise::gradient_3d(int permutation_value, float x, float y, float z)
+{
+	permutation_value = permutation_value & 15;
+	float u = (permutation_value & 8) ? y : x;
+	float v = (permutation_value & 4) ? ((permutation_value >= 12) ? x : z) : y;
+	if (permutation_value & 1)
+		u = -u;
+	if (permutation_value & 2)
+		v = -v;
+	return u + v;
+}
+
+float ReferenceNoise::noise_2d(float x, float y)
+{
+	int ix0 = cl_floor_to_int(x);
+	int iy0 = cl_floor_to_int(y);
+	float fx0 = x - ix0;
+	float fy0 = y - iy0;
+	float fx1 = fx0 - 1.0f;
+	float fy1 = fy0 - 1.0f;
+	int ix1 = (ix0 + 1) & 0xff;
+	int iy1 = (iy0 + 1) & 0xff;
+	ix0 = ix0 & 0xff;
+	iy0 = iy0 & 0xff;
+
+	float t = cl_s_curve(fy0);
+	float s = cl_s_curve(fx0);
+
+	float nx0 = gradient_2d(permutation_table[ix0 + permutation_table[iy0]], fx0, fy0);
+	float nx1 = gradient_2d(permutation_table[ix0 + permutation_table[iy1]], fx0, fy1);
+	float n0 = cl_lerp(t, nx0, nx1);
+
+	nx0 = gradient_2d(permutation_table[ix1 + permutation_table[iy0]], fx1, fy0);
+	nx1 = gradient_2d(permutation_table[ix1 + permutation_table[iy1]], fx1, fy1);
+	float n1 = cl_lerp(t, nx0, nx1);
+
+	return cl_lerp(s, n0, n1);
+}
+
+float ReferenceNoise::noise_3d(float x, float y, float z)
+{
+	int ix0 = cl_floor_to_int(x);
+	int iy0 = cl_floor_to_int(y);
+	int iz0 = cl_floor_to_int(z);
+	float fx0 = x - ix0;
+	float fy0 = y - iy0;
+	float fz0 = z - iz0;
+	float fx1 = fx0 - 1.0f;
+	float fy1 = fy0 - 1.0f;
+	float fz1 = fz0 - 1.0f;
+	int ix1 = (ix0 + 1) & 0xff;
+	int iy1 = (iy0 + 1) & 0xff;
+	int iz1 = (iz0 + 1) & 0xff;
+	ix0 = ix0 & 0xff;
+	iy0 = iy0 & 0xff;
+	iz0 = iz0 & 0xff;
+
+	float r = cl_s_curve(fz0);
+	float t = cl_s_curve(fy0);
+	float s = cl_s_curve(fx0);
+
+	float nxy0 = gradient_3d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz0]]], fx0, fy0, fz0);
+	float nxy1 = gradient_3d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz1]]], fx0, fy0, fz1);
+	float nx0 = cl_lerp(r, nxy0, nxy1);
+
+	nxy0 = gradient_3d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz0]]], fx0, fy1, fz0);
+	nxy1 = gradient_3d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz1]]], fx0, fy1, fz1);
+	float nx1 = cl_lerp(r, nxy0, nxy1);
+
+	float n0 = cl_lerp(t, nx0, nx1);
+
+	nxy0 = gradient_3d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz0]]], fx1, fy0, fz0);
+	nxy1 = gradient_3d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz1]]], fx1, fy0, fz1);
+	nx0 = cl_lerp(r, nxy0, nxy1);
+
+	nxy0 = gradient_3d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz0]]], fx1, fy1, fz0);
+	nxy1 = gradient_3d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz1]]], fx1, fy1, fz1);
+	nx1 = cl_lerp(r, nxy0, nxy1);
+
+	float n1 = cl_lerp(t, nx0, nx1);
+
+	return cl_lerp(s, n0, n1);
+}
@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+using namespace clan;
+
+// The scalar implementation PerlinNoise used before it was vectorized, to compare results and speed against
+class ReferenceNoise
+{
+public:
+	ReferenceNoise(const unsigned char *table);
+
+	std::vector<float> create_noise2d(int width, int height, int octaves, float start_x, float end_x, float start_y, float end_y);
+	std::vector<float> create_noise3d(int width, int height, int octaves, float start_x, float end_x, float start_y, float end_y, float z_position);
+
+private:
+	float gradient_2d(int permutation_value, float x, float y);
+	float gradient_3d(int permutation_value, float x, float y, float z);
+	float noise_2d(float x, float y);
+	float noise_3d(float x, float y, float z);
+
+	unsigned char permutation_table[512];
+};
+
+class TestApp
+{
+public:
+	int main();
+private:
+	bool compare(const PixelBuffer &pixels, const std::vector<float> &reference);
+};
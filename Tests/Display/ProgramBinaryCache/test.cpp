@@ -0,0 +1,101 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	clan::OpenGLTarget::set_current();
+
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: API/Display/Render (ProgramObject binary cache)");
+
+		const std::string cache_directory = "ProgramBinaryCache";
+		Directory::remove(cache_directory, true, false);
+
+		double without_cache = measure_startup();
+
+		ProgramObject::set_binary_cache_directory(cache_directory);
+		double cold_cache = measure_startup();
+		double warm_cache = measure_startup();
+
+		Console::write_line("Startup without cache:    %1 ms", StringHelp::double_to_text(without_cache, 2));
+		Console::write_line("Startup with empty cache: %1 ms", StringHelp::double_to_text(cold_cache, 2));
+		Console::write_line("Startup with warm cache:  %1 ms", StringHelp::double_to_text(warm_cache, 2));
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+// Creates a window, which builds the standard programs, plus a shader effect, and returns the time taken in milliseconds
+double TestApp::measure_startup()
+{
+	uint64_t start_time = System::get_microseconds();
+
+	DisplayWindow window("ProgramObject binary cache", 320, 240, false, false);
+	GraphicContext gc = window.get_gc();
+
+	ShaderEffectDescription effect_description;
+	effect_description.set_vertex_shader(
+		"#version 330\n"
+		"in vec4 PositionInProjection;\n"
+		"void main() { gl_Position = PositionInProjection; }\n");
+	effect_description.set_fragment_shader(
+		"#version 330\n"
+		"out vec4 FragColor;\n"
+		"void main() { FragColor = vec4(1.0, 0.5, 0.25, 1.0); }\n");
+	effect_description.set_attribute_screen_quad("PositionInProjection");
+	effect_description.set_frag_data_to_back_buffer("FragColor");
+	effect_description.set_glsl_version(330);
+	ShaderEffect effect(gc, effect_description);
+
+	uint64_t end_time = System::get_microseconds();
+	return (end_time - start_time) / 1000.0;
+}
@@ -0,0 +1,200 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2020 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	clan::OpenGLTarget::set_current();
+
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: API/Display/Render (TimerQuery, FrameProfiler)");
+
+		TimerQuery outlives_window;
+		{
+			DisplayWindow window("TimerQuery", 320, 240, false, false);
+			Canvas canvas(window);
+
+			test_timer_query(canvas);
+			test_frame_profiler(canvas);
+
+			// Disposing the graphic context deletes the query, and destroying the query afterwards must not delete it again
+			GraphicContext gc = canvas.get_gc();
+			if (TimerQuery::is_supported(gc))
+				outlives_window = TimerQuery(gc);
+		}
+		outlives_window = TimerQuery();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch(Exception error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_timer_query(Canvas &canvas)
+{
+	GraphicContext gc = canvas.get_gc();
+
+	Console::write_line("   Function: TimerQuery::is_supported()");
+	bool supported = TimerQuery::is_supported(gc);
+	if (TimerQuery::is_supported(gc) != supported)
+		fail();
+	Console::write_line(string_format("    Timer queries supported: %1", supported ? "yes" : "no"));
+	if (!supported)
+		return;
+
+	Console::write_line("   Function: TimerQuery::begin(), end() and get_result()");
+	{
+		TimerQuery query(gc);
+		query.begin();
+		draw_something(canvas);
+		query.end();
+		wait_for_result(gc, query);
+
+		// The elapsed time is in nanoseconds, and drawing a few rectangles takes well under a second
+		uint64_t elapsed = query.get_result();
+		if (elapsed >= 1000000000)
+			fail();
+		Console::write_line(string_format("    Elapsed: %1 us", elapsed / 1000.0));
+
+		// A query can be used again
+		query.begin();
+		draw_something(canvas);
+		query.end();
+		wait_for_result(gc, query);
+		if (query.get_result() >= 1000000000)
+			fail();
+	}
+
+	Console::write_line("   Function: TimerQuery::timestamp()");
+	{
+		TimerQuery first(gc);
+		TimerQuery second(gc);
+		first.timestamp();
+		draw_something(canvas);
+		second.timestamp();
+		wait_for_result(gc, first);
+		wait_for_result(gc, second);
+		if (second.get_result() < first.get_result())
+			fail();
+	}
+}
+
+void TestApp::test_frame_profiler(Canvas &canvas)
+{
+	GraphicContext gc = canvas.get_gc();
+
+	Console::write_line("   Class: FrameProfiler");
+	FrameProfiler profiler(gc, 8);
+	if (profiler.is_gpu_timing_supported() != TimerQuery::is_supported(gc))
+		fail();
+
+	const int frame_count = 20;
+	for (int frame = 0; frame < frame_count; frame++)
+	{
+		profiler.begin_frame(gc);
+		{
+			FrameProfileScope scope(profiler, gc, "draw");
+			FrameProfileScope nested(profiler, gc, "rectangles");
+			draw_something(canvas);
+		}
+		profiler.end_frame(gc);
+		gc.flush();
+		System::sleep(1);
+	}
+
+	// Only the last 8 frames are kept, each with two scopes
+	std::vector<FrameProfilerScope> scopes = profiler.get_scopes();
+	if (scopes.empty() || scopes.size() > 8 * 2)
+		fail();
+
+	int gpu_valid = 0;
+	for (const FrameProfilerScope &scope : scopes)
+	{
+		if (scope.depth != (scope.name == "draw" ? 0 : 1))
+			fail();
+		if (scope.cpu_end < scope.cpu_begin)
+			fail();
+		if (scope.gpu_valid)
+		{
+			gpu_valid++;
+			if (scope.gpu_end < scope.gpu_begin)
+				fail();
+		}
+	}
+	if (profiler.is_gpu_timing_supported() && gpu_valid == 0)
+		fail();
+
+	if (profiler.to_chrome_trace().find("\"rectangles\"") == std::string::npos)
+		fail();
+}
+
+void TestApp::draw_something(Canvas &canvas)
+{
+	for (int i = 0; i < 100; i++)
+		canvas.fill_rect(i, i, i + 100.0f, i + 100.0f, Colorf(i / 100.0f, 0.5f, 0.25f));
+	canvas.flush();
+}
+
+void TestApp::wait_for_result(GraphicContext &gc, TimerQuery &query)
+{
+	uint64_t start_time = System::get_microseconds();
+	while (!query.is_result_ready())
+	{
+		gc.flush();
+		if (System::get_microseconds() - start_time > 5000000)
+			fail();
+		System::sleep(1);
+	}
+}
+
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
@@ -10,11 +10,14 @@ void test2();
 void send_request(TCPConnection &connection);
 DataBuffer receive_response(TCPConnection &connection);
 
-int main(int, char**)
+int main(int argc, char **argv)
 {
 	try
 	{
-		test1();
+		if (argc > 1 && std::string(argv[1]) == "tls")
+			test2();
+		else
+			test1();
 	}
 	catch (Exception e)
 	{
@@ -50,6 +53,81 @@ void test1()
 	Console::write_line("");
 }
 
+// Streams data through TLSClient to a local TLS server and measures the records per second.
+// Start the server with: openssl s_server -accept 4433 -cert cert.pem -key key.pem -quiet -cipher AES128-GCM-SHA256
+void test2()
+{
+	Console::write_line("");
+	Console::write_line("--- Begin of test2 ---");
+	Console::write_line("");
+
+	SocketName socket_name("127.0.0.1", "4433");
+	TCPConnection connection(socket_name);
+	TLSClient tls;
+
+	DataBuffer payload(1024 * 1024);
+	for (unsigned int i = 0; i < payload.get_size(); i++)
+		payload[i] = (char)('a' + i % 26);
+
+	const int total_size = 64 * 1024 * 1024;
+	const int record_size = 16 * 1024;	// TLSClient puts at most 16 KB of application data in each record
+
+	NetworkConditionVariable wait_condition;
+	std::mutex mutex;
+	std::unique_lock<std::mutex> lock(mutex);
+
+	uint64_t start_time = System::get_microseconds();
+	int bytes_sent = 0;
+	while (bytes_sent < total_size || tls.get_encrypted_data_available() > 0)
+	{
+		bool is_idle = true;
+
+		if (bytes_sent < total_size)
+		{
+			int offset = bytes_sent % payload.get_size();
+			int bytes_consumed = tls.encrypt(payload.get_data() + offset, min(total_size - bytes_sent, (int)payload.get_size() - offset));
+			bytes_sent += bytes_consumed;
+			if (bytes_consumed > 0)
+				is_idle = false;
+		}
+
+		int encrypted_available = tls.get_encrypted_data_available();
+		if (encrypted_available > 0)
+		{
+			int bytes_written = connection.write(tls.get_encrypted_data(), encrypted_available);
+			if (bytes_written > 0)
+			{
+				tls.encrypted_data_consumed(bytes_written);
+				is_idle = false;
+			}
+		}
+
+		char buffer[16 * 1024];
+		int bytes_read = connection.read(buffer, sizeof(buffer));
+		if (bytes_read == 0)
+			throw Exception("Connection closed by the server");
+		for (int pos = 0; pos < bytes_read;)
+			pos += tls.decrypt(buffer + pos, bytes_read - pos);
+		if (bytes_read > 0)
+			is_idle = false;
+		tls.decrypted_data_consumed(tls.get_decrypted_data_available());
+
+		if (is_idle)
+		{
+			NetworkEvent *events[] = { &connection };
+			wait_condition.wait(lock, 1, events, 10);
+		}
+	}
+	uint64_t delta_time = System::get_microseconds() - start_time;
+
+	Console::write_line("Sent %1 MB in %2 ms", total_size / (1024 * 1024), (int)(delta_time / 1000));
+	Console::write_line("Records per second: %1", (int)((total_size / record_size) * 1000000.0 / delta_time));
+
+	Console::write_line("");
+	Console::write_line("--- End of test2 ---");
+	Console::write_line("");
+}
+
 void send_request(TCPConnection &connection)
 {
 	std::string request =
@@ -122,7 +200,7 @@ DataBuffer receive_response(TCPConnection &connection)
 
 	for (auto &line : StringHelp::split_text(std::string(response_data.data(), pos), "\r\n"))
 	{
-		Console::write_line(StringHelp::local8_to_text(line));
+		Console::write_line(line);
 	}
 
 	return DataBuffer();